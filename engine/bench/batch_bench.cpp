@@ -0,0 +1,91 @@
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "keys.h"
+#include "nodes/registry.h"
+#include "object/batch_builder.h"
+#include "object/typed_column.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+// Every candidate appears twice on average
+void MergeDedup(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0, state.rows() / 2);
+  ExecContext ctx;
+  auto runner = NodeRegistry::Instance().Create("core:merge");
+  nlohmann::json params = {{"dedup", "max_base"}};
+  state.SetBytesPerIteration(
+      static_cast<int64_t>(state.rows() * (sizeof(int64_t) + sizeof(float))));
+  state.Run([&] {
+    CandidateBatch output = runner->Run(ctx, batch, params);
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+// Writing one value clones that column; the others stay shared
+void BuilderCowClone(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), state.dim());
+  state.SetBytesPerIteration(static_cast<int64_t>(2 * state.rows() * sizeof(float)));
+  state.Run([&] {
+    BatchBuilder builder(batch);
+    builder.Set(0, keys::id::SCORE_BASE, 1.0f);
+    ColumnBatch output = builder.Build();
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+// Adding a fresh column only shares the input's
+void BuilderAddColumn(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), state.dim());
+  auto column = std::make_shared<F32Column>(state.rows());
+  state.Run([&] {
+    BatchBuilder builder(batch);
+    builder.AddF32Column(keys::id::SCORE_FINAL, column);
+    ColumnBatch output = builder.Build();
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+// Typed column lookup per row, as row-wise runners do
+void TypedLookupPerRow(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * sizeof(float)));
+  state.Run([&] {
+    float sum = 0.0f;
+    for (size_t i = 0; i < batch.RowCount(); ++i) {
+      const F32Column* column = batch.GetF32Column(keys::id::SCORE_BASE);
+      sum += column->IsNull(i) ? 0.0f : column->Get(i);
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+// Lookup once, then read the column
+void TypedLookupHoisted(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * sizeof(float)));
+  state.Run([&] {
+    const F32Column* column = batch.GetF32Column(keys::id::SCORE_BASE);
+    float sum = 0.0f;
+    for (size_t i = 0; i < batch.RowCount(); ++i) {
+      sum += column->IsNull(i) ? 0.0f : column->Get(i);
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+}  // namespace
+
+RANKDSL_BENCHMARK(MergeDedup, "batch/merge_dedup", kRowCounts, kNoDim, MergeDedup);
+RANKDSL_BENCHMARK(BuilderCowClone, "batch/builder_cow_clone", kRowCounts, kNoDim,
+                  BuilderCowClone);
+RANKDSL_BENCHMARK(BuilderAddColumn, "batch/builder_add_column", kRowCounts, kEmbeddingDims,
+                  BuilderAddColumn);
+RANKDSL_BENCHMARK(TypedLookupPerRow, "batch/typed_lookup_per_row", kRowCounts, kNoDim,
+                  TypedLookupPerRow);
+RANKDSL_BENCHMARK(TypedLookupHoisted, "batch/typed_lookup_hoisted", kRowCounts, kNoDim,
+                  TypedLookupHoisted);
+
+}  // namespace ranking_dsl::bench
@@ -0,0 +1,108 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "keys.h"
+#include "object/typed_column.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+std::vector<BenchSpec>& Registry() {
+  static std::vector<BenchSpec> specs;
+  return specs;
+}
+
+}  // namespace
+
+void BenchState::Run(const std::function<void()>& body) {
+  using Clock = std::chrono::steady_clock;
+  auto time_ns = [&](int64_t iterations) {
+    auto start = Clock::now();
+    for (int64_t i = 0; i < iterations; ++i) {
+      body();
+    }
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+  };
+
+  // Warm up, then grow the iteration count until one batch fills min_time
+  double min_ns = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(options_.min_time).count());
+  double elapsed = time_ns(1);
+  int64_t iterations = 1;
+  while (elapsed < min_ns) {
+    double scale = elapsed > 0 ? std::min(10.0, 1.2 * min_ns / elapsed) : 10.0;
+    iterations = std::max(iterations + 1, static_cast<int64_t>(iterations * scale));
+    elapsed = time_ns(iterations);
+  }
+
+  std::vector<double> per_iter;
+  per_iter.push_back(elapsed / iterations);
+  for (int rep = 1; rep < options_.repetitions; ++rep) {
+    per_iter.push_back(time_ns(iterations) / iterations);
+  }
+  std::nth_element(per_iter.begin(), per_iter.begin() + per_iter.size() / 2, per_iter.end());
+  iterations_ = iterations;
+  ns_per_iter_ = per_iter[per_iter.size() / 2];
+}
+
+BenchResult BenchState::Result(const std::string& name) const {
+  BenchResult result;
+  result.name = name;
+  result.rows = rows_;
+  result.dim = dim_;
+  result.iterations = iterations_;
+  result.ns_per_iter = ns_per_iter_;
+  result.ns_per_row = rows_ > 0 ? ns_per_iter_ / rows_ : 0.0;
+  result.bytes_per_iter = bytes_per_iter_;
+  result.gb_per_s = ns_per_iter_ > 0 ? bytes_per_iter_ / ns_per_iter_ : 0.0;  // bytes/ns
+  return result;
+}
+
+bool RegisterBenchmark(BenchSpec spec) {
+  Registry().push_back(std::move(spec));
+  return true;
+}
+
+std::vector<BenchSpec> RegisteredBenchmarks() {
+  std::vector<BenchSpec> specs = Registry();
+  std::sort(specs.begin(), specs.end(),
+            [](const BenchSpec& a, const BenchSpec& b) { return a.name < b.name; });
+  return specs;
+}
+
+ColumnBatch MakeCandidateBatch(size_t rows, size_t dim, size_t distinct_ids) {
+  std::mt19937_64 rng(rows * 31 + dim);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  auto ids = std::make_shared<I64Column>(rows);
+  auto base = std::make_shared<F32Column>(rows);
+  auto ml = std::make_shared<F32Column>(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    ids->Set(i, static_cast<int64_t>(distinct_ids > 0 ? rng() % distinct_ids : i));
+    base->Set(i, unit(rng));
+    ml->Set(i, unit(rng));
+  }
+
+  ColumnBatch batch(rows);
+  batch.SetColumn(keys::id::CAND_CANDIDATE_ID, ids);
+  batch.SetColumn(keys::id::SCORE_BASE, base);
+  batch.SetColumn(keys::id::SCORE_ML, ml);
+  if (dim > 0) {
+    for (int32_t key : {keys::id::FEAT_EMBEDDING, keys::id::FEAT_QUERY_EMBEDDING}) {
+      std::vector<float> data(rows * dim);
+      for (float& value : data) {
+        value = unit(rng) - 0.5f;
+      }
+      batch.SetColumn(key, std::make_shared<F32VecColumn>(std::move(data), dim,
+                                                          std::vector<bool>(rows, false)));
+    }
+  }
+  return batch;
+}
+
+}  // namespace ranking_dsl::bench
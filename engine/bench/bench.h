@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "object/column_batch.h"
+
+namespace ranking_dsl::bench {
+
+/**
+ * Keep the compiler from discarding a computed value.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * Timing settings shared by every benchmark of a run.
+ */
+struct BenchOptions {
+  std::chrono::milliseconds min_time{200};  // Per repetition
+  int repetitions = 5;                      // The median repetition is reported
+};
+
+/**
+ * One measured case (benchmark x rows x dim).
+ */
+struct BenchResult {
+  std::string name;
+  size_t rows = 0;
+  size_t dim = 0;
+  int64_t iterations = 0;   // Per repetition
+  double ns_per_iter = 0.0;
+  double ns_per_row = 0.0;
+  double gb_per_s = 0.0;    // Bytes touched per iteration / time (0 = not reported)
+  int64_t bytes_per_iter = 0;
+};
+
+/**
+ * State handed to a benchmark: its parameters, and Run() to time the body.
+ * Setup before Run() (building batches, compiling) is not timed.
+ */
+class BenchState {
+ public:
+  BenchState(size_t rows, size_t dim, const BenchOptions& options)
+      : rows_(rows), dim_(dim), options_(options) {}
+
+  size_t rows() const { return rows_; }
+  size_t dim() const { return dim_; }
+
+  /**
+   * Bytes read and written by one iteration, for the GB/s figure.
+   */
+  void SetBytesPerIteration(int64_t bytes) { bytes_per_iter_ = bytes; }
+
+  /**
+   * Time body: one warm-up call, then enough iterations per repetition to
+   * fill options.min_time. Call once per benchmark.
+   */
+  void Run(const std::function<void()>& body);
+
+  BenchResult Result(const std::string& name) const;
+
+ private:
+  size_t rows_;
+  size_t dim_;
+  BenchOptions options_;
+  int64_t bytes_per_iter_ = 0;
+  int64_t iterations_ = 0;
+  double ns_per_iter_ = 0.0;
+};
+
+using BenchFn = std::function<void(BenchState&)>;
+
+/**
+ * A benchmark and the parameters it runs over (every rows x dims pair).
+ */
+struct BenchSpec {
+  std::string name;  // "<area>/<case>"
+  std::vector<size_t> rows;
+  std::vector<size_t> dims;  // {0} for benchmarks without an embedding
+  BenchFn fn;
+};
+
+inline const std::vector<size_t> kRowCounts = {1000, 10000, 100000, 1000000};
+inline const std::vector<size_t> kNoDim = {0};
+inline const std::vector<size_t> kEmbeddingDims = {16, 64, 256};
+
+/**
+ * Add a benchmark to the global list (see RANKDSL_BENCHMARK).
+ */
+bool RegisterBenchmark(BenchSpec spec);
+
+/**
+ * Every registered benchmark, sorted by name.
+ */
+std::vector<BenchSpec> RegisteredBenchmarks();
+
+/**
+ * Candidate batch with rows rows: cand.candidate_id (distinct_ids distinct
+ * values, 0 = all distinct), score.base and score.ml in [0, 1), and when
+ * dim > 0 feat.embedding / feat.query_embedding of that width. Seeded, so
+ * every run sees the same data.
+ */
+ColumnBatch MakeCandidateBatch(size_t rows, size_t dim, size_t distinct_ids = 0);
+
+/**
+ * Helper macro for registering benchmarks at static initialization.
+ */
+#define RANKDSL_BENCHMARK(id, name, rows, dims, fn) \
+  static bool _bench_registered_##id = ::ranking_dsl::bench::RegisterBenchmark({name, rows, dims, fn})
+
+}  // namespace ranking_dsl::bench
@@ -0,0 +1,137 @@
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "logging/metrics.h"
+#include "logging/trace.h"
+
+using namespace ranking_dsl;
+using namespace ranking_dsl::bench;
+
+namespace {
+
+using CaseKey = std::tuple<std::string, size_t, size_t>;  // name, rows, dim
+
+nlohmann::json ResultToJson(const BenchResult& result) {
+  return {{"name", result.name},
+          {"rows", result.rows},
+          {"dim", result.dim},
+          {"iterations", result.iterations},
+          {"ns_per_iter", result.ns_per_iter},
+          {"ns_per_row", result.ns_per_row},
+          {"gb_per_s", result.gb_per_s},
+          {"bytes_per_iter", result.bytes_per_iter}};
+}
+
+// ns_per_iter of every case in a previous results file
+bool LoadBaseline(const std::string& path, std::map<CaseKey, double>& baseline,
+                  std::string* error_out) {
+  std::ifstream file(path);
+  auto results = nlohmann::json::parse(file, nullptr, false);
+  if (results.is_discarded() || !results.contains("benchmarks")) {
+    *error_out = "Cannot read benchmark results: " + path;
+    return false;
+  }
+  for (const auto& result : results["benchmarks"]) {
+    baseline[{result.value("name", ""), result.value("rows", size_t{0}),
+              result.value("dim", size_t{0})}] = result.value("ns_per_iter", 0.0);
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  CLI::App app{"Ranking DSL Engine - microbenchmarks"};
+
+  std::string filter;
+  std::string out_path;
+  std::string baseline_path;
+  size_t max_rows = 0;
+  int64_t min_time_ms = 200;
+  BenchOptions options;
+  bool list = false;
+
+  app.add_option("--filter,-f", filter, "Run benchmarks whose name contains this string");
+  app.add_option("--max-rows", max_rows, "Skip row counts above this (0 = all)");
+  app.add_option("--min-time-ms", min_time_ms, "Minimum timed duration per repetition")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--repetitions", options.repetitions, "Repetitions per case (median reported)")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--out,-o", out_path, "Write results as JSON to this file");
+  app.add_option("--baseline", baseline_path, "Compare against a previous --out file")
+      ->check(CLI::ExistingFile);
+  app.add_flag("--list", list, "List benchmarks and exit");
+
+  CLI11_PARSE(app, argc, argv);
+  options.min_time = std::chrono::milliseconds(min_time_ms);
+
+  std::map<CaseKey, double> baseline;
+  if (!baseline_path.empty()) {
+    std::string error;
+    if (!LoadBaseline(baseline_path, baseline, &error)) {
+      fmt::print(stderr, "Error: {}\n", error);
+      return 1;
+    }
+  }
+
+  // Measure the code, not the instrumentation around it
+  Tracer::SetEnabled(false);
+  Metrics::SetEnabled(false);
+
+  std::vector<BenchResult> results;
+  fmt::print("{:<32} {:>8} {:>5} {:>12} {:>10} {:>8}{}\n", "benchmark", "rows", "dim",
+             "ns/iter", "ns/row", "GB/s", baseline.empty() ? "" : "   change");
+  for (const BenchSpec& spec : RegisteredBenchmarks()) {
+    if (!filter.empty() && spec.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    for (size_t rows : spec.rows) {
+      if (max_rows > 0 && rows > max_rows) {
+        continue;
+      }
+      for (size_t dim : spec.dims) {
+        if (list) {
+          fmt::print("{} rows={} dim={}\n", spec.name, rows, dim);
+          continue;
+        }
+        BenchState state(rows, dim, options);
+        spec.fn(state);
+        BenchResult result = state.Result(spec.name);
+
+        std::string change;
+        auto it = baseline.find({spec.name, rows, dim});
+        if (it != baseline.end() && it->second > 0) {
+          change = fmt::format("  {:+7.1f}%", 100.0 * (result.ns_per_iter / it->second - 1.0));
+        }
+        fmt::print("{:<32} {:>8} {:>5} {:>12.0f} {:>10.3f} {:>8.2f}{}\n", result.name,
+                   result.rows, result.dim, result.ns_per_iter, result.ns_per_row,
+                   result.gb_per_s, change);
+        results.push_back(std::move(result));
+      }
+    }
+  }
+
+  if (!out_path.empty() && !list) {
+    nlohmann::json output;
+    output["context"] = {{"min_time_ms", min_time_ms}, {"repetitions", options.repetitions}};
+    output["benchmarks"] = nlohmann::json::array();
+    for (const BenchResult& result : results) {
+      output["benchmarks"].push_back(ResultToJson(result));
+    }
+    std::ofstream file(out_path);
+    file << output.dump(2) << "\n";
+    if (!file) {
+      fmt::print(stderr, "Error writing results: {}\n", out_path);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "expr/expr.h"
+#include "keys.h"
+#include "nodes/registry.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+// score.base * 0.7 + score.ml * 0.3
+const char* kBlendExpr = R"({"op": "add", "args": [
+  {"op": "mul", "args": [{"op": "signal", "key_id": 3001}, {"op": "const", "value": 0.7}]},
+  {"op": "mul", "args": [{"op": "signal", "key_id": 3002}, {"op": "const", "value": 0.3}]}
+]})";
+
+const char* kCosExpr = R"({"op": "cos",
+  "a": {"op": "signal", "key_id": 2002},
+  "b": {"op": "signal", "key_id": 2003}})";
+
+BatchSchema SchemaOf(const ColumnBatch& batch) {
+  BatchSchema schema;
+  schema.known = true;
+  for (const auto& [key, column] : batch.Columns()) {
+    schema.Set(key, column->Type());
+  }
+  return schema;
+}
+
+void EvalRowWise(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  ExprNode expr = ParseExpr(nlohmann::json::parse(kBlendExpr));
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * 2 * sizeof(float)));
+  state.Run([&] {
+    float sum = 0.0f;
+    for (size_t i = 0; i < batch.RowCount(); ++i) {
+      sum += EvalExpr(expr, batch, i);
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+void EvalCompiled(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  ExprNode expr = ParseExpr(nlohmann::json::parse(kBlendExpr));
+  CompiledExpr compiled = CompiledExpr::Compile(expr, SchemaOf(batch));
+  std::vector<float> out(state.rows());
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * 3 * sizeof(float)));
+  state.Run([&] {
+    compiled.Eval(batch, out.data());
+    DoNotOptimize(out.data());
+  });
+}
+
+void ScoreFormulaNode(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  BatchSchema schema = SchemaOf(batch);
+  ExecContext ctx;
+  ctx.input_schema = &schema;
+  auto runner = NodeRegistry::Instance().Create("core:score_formula");
+  nlohmann::json params = {{"expr", nlohmann::json::parse(kBlendExpr)}};
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * 3 * sizeof(float)));
+  state.Run([&] {
+    CandidateBatch output = runner->Run(ctx, batch, params);
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+void CosSimilarity(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), state.dim());
+  ExprNode expr = ParseExpr(nlohmann::json::parse(kCosExpr));
+  CompiledExpr compiled = CompiledExpr::Compile(expr, SchemaOf(batch));
+  std::vector<float> out(state.rows());
+  state.SetBytesPerIteration(
+      static_cast<int64_t>(state.rows() * (2 * state.dim() + 1) * sizeof(float)));
+  state.Run([&] {
+    compiled.Eval(batch, out.data());
+    DoNotOptimize(out.data());
+  });
+}
+
+}  // namespace
+
+RANKDSL_BENCHMARK(EvalRowWise, "expr/eval_row", kRowCounts, kNoDim, EvalRowWise);
+RANKDSL_BENCHMARK(EvalCompiled, "expr/eval_compiled", kRowCounts, kNoDim, EvalCompiled);
+RANKDSL_BENCHMARK(ScoreFormulaNode, "expr/score_formula_node", kRowCounts, kNoDim,
+                  ScoreFormulaNode);
+RANKDSL_BENCHMARK(CosSimilarity, "expr/cos_similarity", kRowCounts, kEmbeddingDims,
+                  CosSimilarity);
+
+}  // namespace ranking_dsl::bench
@@ -0,0 +1,119 @@
+#include <set>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "keys.h"
+#include "nodes/js/batch_context.h"
+#include "nodes/js/njs_runner.h"
+#include "object/batch_builder.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+// The JS bridge copies every value; 1M rows would exceed any sane CPU cap
+const std::vector<size_t> kModuleRowCounts = {1000, 10000, 100000};
+
+NjsBudget UnlimitedBudget() {
+  NjsBudget budget;
+  budget.max_write_bytes = int64_t{1} << 40;
+  budget.max_write_cells = int64_t{1} << 40;
+  return budget;
+}
+
+// Zero-copy column views handed to njs code
+void ReadF32(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  BatchBuilder builder(batch);
+  NjsBudget budget = UnlimitedBudget();
+  std::set<int32_t> writes;
+  BatchContext ctx(batch, builder, nullptr, writes, budget);
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * sizeof(float)));
+  state.Run([&] {
+    auto [data, size] = ctx.GetF32Raw(keys::id::SCORE_BASE);
+    float sum = 0.0f;
+    for (size_t i = 0; i < size; ++i) {
+      sum += data[i];
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+// Copying read (ctx.batch.f32 semantics)
+void ReadF32Copy(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  BatchBuilder builder(batch);
+  NjsBudget budget = UnlimitedBudget();
+  std::set<int32_t> writes;
+  BatchContext ctx(batch, builder, nullptr, writes, budget);
+  state.SetBytesPerIteration(static_cast<int64_t>(2 * state.rows() * sizeof(float)));
+  state.Run([&] {
+    std::vector<float> values = ctx.GetF32(keys::id::SCORE_BASE);
+    DoNotOptimize(values.data());
+  });
+}
+
+void ReadF32Vec(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), state.dim());
+  BatchBuilder builder(batch);
+  NjsBudget budget = UnlimitedBudget();
+  std::set<int32_t> writes;
+  BatchContext ctx(batch, builder, nullptr, writes, budget);
+  state.SetBytesPerIteration(
+      static_cast<int64_t>(state.rows() * state.dim() * sizeof(float)));
+  state.Run([&] {
+    F32VecView view = ctx.GetF32VecRaw(keys::id::FEAT_EMBEDDING);
+    float sum = 0.0f;
+    for (size_t i = 0; i < view.data_size; ++i) {
+      sum += view.data[i];
+    }
+    DoNotOptimize(sum);
+  });
+}
+
+// Allocate a writable column, fill it and commit it to the builder
+void WriteCommit(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  std::set<int32_t> writes = {keys::id::SCORE_FINAL};
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * sizeof(float)));
+  state.Run([&] {
+    BatchBuilder builder(batch);
+    NjsBudget budget = UnlimitedBudget();
+    BatchContext ctx(batch, builder, nullptr, writes, budget);
+    float* out = ctx.AllocateF32(keys::id::SCORE_FINAL);
+    for (size_t i = 0; i < state.rows(); ++i) {
+      out[i] = static_cast<float>(i);
+    }
+    ctx.Commit();
+    ColumnBatch output = builder.Build();
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+// Whole njs node: QuickJS context, JS read of two columns, write, commit
+void RunModule(BenchState& state) {
+  ColumnBatch batch = MakeCandidateBatch(state.rows(), 0);
+  NjsPolicy policy;
+  policy.LoadFromJson(R"({"max_cpu_ms": 600000})");
+  NjsRunner runner;
+  runner.SetPolicy(&policy);
+  ExecContext ctx;
+  nlohmann::json params = {{"module", std::string(RANKDSL_BENCH_NJS_DIR) + "/blend.njs"}};
+  state.SetBytesPerIteration(static_cast<int64_t>(state.rows() * 3 * sizeof(float)));
+  state.Run([&] {
+    CandidateBatch output = runner.Run(ctx, batch, params);
+    DoNotOptimize(output.RowCount());
+  });
+}
+
+}  // namespace
+
+RANKDSL_BENCHMARK(ReadF32, "njs/read_f32", kRowCounts, kNoDim, ReadF32);
+RANKDSL_BENCHMARK(ReadF32Copy, "njs/read_f32_copy", kRowCounts, kNoDim, ReadF32Copy);
+RANKDSL_BENCHMARK(ReadF32Vec, "njs/read_f32vec", kRowCounts, kEmbeddingDims, ReadF32Vec);
+RANKDSL_BENCHMARK(WriteCommit, "njs/write_commit", kRowCounts, kNoDim, WriteCommit);
+RANKDSL_BENCHMARK(RunModule, "njs/run_module", kModuleRowCounts, kNoDim, RunModule);
+
+}  // namespace ranking_dsl::bench
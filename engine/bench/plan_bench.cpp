@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "bench.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/complexity.h"
+#include "plan/plan.h"
+#include "plan/synthetic.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+// rows = plan nodes, dim = plan depth; up to the default budget's limits
+const std::vector<size_t> kNodeCounts = {250, 500, 1000, 2000};
+const std::vector<size_t> kDepths = {8, 32, 120};
+
+// A plan that fails to generate or compile would time the error path
+[[noreturn]] void Fail(const BenchState& state, const std::string& error) {
+  fmt::print(stderr, "plan bench (nodes={}, depth={}): {}\n", state.rows(), state.dim(), error);
+  std::exit(1);
+}
+
+nlohmann::json MakePlan(const BenchState& state) {
+  SyntheticPlanOptions options;
+  options.nodes = state.rows();
+  options.depth = state.dim();
+  nlohmann::json plan;
+  std::string error;
+  if (!GenerateSyntheticPlan(options, plan, &error)) {
+    Fail(state, error);
+  }
+  return plan;
+}
+
+// JSON text to Plan, as a plan-validation request arrives
+void Parse(BenchState& state) {
+  std::string text = MakePlan(state).dump();
+  state.SetBytesPerIteration(static_cast<int64_t>(text.size()));
+  state.Run([&] {
+    Plan plan;
+    ParsePlan(nlohmann::json::parse(text), plan);
+    DoNotOptimize(plan.nodes.size());
+  });
+}
+
+void Complexity(BenchState& state) {
+  Plan plan;
+  std::string error;
+  if (!ParsePlan(MakePlan(state), plan, &error)) {
+    Fail(state, error);
+  }
+  state.Run([&] {
+    ComplexityMetrics metrics = ComputeComplexityMetrics(plan);
+    DoNotOptimize(metrics.max_depth);
+  });
+}
+
+void Compile(BenchState& state) {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  if (!ParsePlan(MakePlan(state), plan, &error)) {
+    Fail(state, error);
+  }
+  PlanCompiler compiler(registry);
+  CompiledPlan compiled;
+  if (!compiler.Compile(plan, compiled, &error)) {
+    Fail(state, error);
+  }
+  state.Run([&] {
+    CompiledPlan out;
+    compiler.Compile(plan, out);
+    DoNotOptimize(out.exec_order.size());
+  });
+}
+
+}  // namespace
+
+RANKDSL_BENCHMARK(PlanParse, "plan/parse", kNodeCounts, kDepths, Parse);
+RANKDSL_BENCHMARK(PlanComplexity, "plan/complexity", kNodeCounts, kDepths, Complexity);
+RANKDSL_BENCHMARK(PlanCompile, "plan/compile", kNodeCounts, kDepths, Compile);
+
+}  // namespace ranking_dsl::bench
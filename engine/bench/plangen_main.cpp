@@ -0,0 +1,125 @@
+/**
+ * rankdsl_plangen - writes synthetic plans for compile-time scalability
+ * testing, and optionally profiles compiling them pass by pass.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+#include "plan/synthetic.h"
+
+using namespace ranking_dsl;
+
+namespace {
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+// Parse and compile the plan runs times; print median ms per phase
+int Profile(const nlohmann::json& plan_json, int runs) {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+  std::string text = plan_json.dump();
+
+  std::vector<std::string> order = {"parse"};
+  std::map<std::string, std::vector<double>> samples;
+  CompiledPlan compiled;
+  for (int run = 0; run < runs; ++run) {
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    Plan plan;
+    if (!ParsePlan(nlohmann::json::parse(text), plan, &error)) {
+      fmt::print(stderr, "Error: {}\n", error);
+      return 1;
+    }
+    samples["parse"].push_back(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count());
+    if (!compiler.Compile(plan, compiled, &error)) {
+      fmt::print(stderr, "Error: {}\n", error);
+      return 1;
+    }
+    for (const CompilePhase& phase : compiled.phases) {
+      if (run == 0) {
+        order.push_back(phase.name);
+      }
+      samples[phase.name].push_back(phase.ms);
+    }
+  }
+
+  const ComplexityMetrics& metrics = compiled.complexity;
+  fmt::print("nodes {}  edges {}  depth {}  fanin_peak {}  fanout_peak {}  bytes {}\n",
+             metrics.node_count, metrics.edge_count, metrics.max_depth, metrics.fanin_peak,
+             metrics.fanout_peak, text.size());
+  fmt::print("{:<16} {:>10}\n", "phase", "median_ms");
+  double total = 0.0;
+  for (const auto& name : order) {
+    double ms = Median(samples[name]);
+    total += ms;
+    fmt::print("{:<16} {:>10.3f}\n", name, ms);
+  }
+  fmt::print("{:<16} {:>10.3f}\n", "total", total);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  CLI::App app{"Ranking DSL Engine - synthetic plan generator"};
+
+  SyntheticPlanOptions options;
+  std::string out_path;
+  int profile_runs = 0;
+
+  app.add_option("--nodes,-n", options.nodes, "Total node count");
+  app.add_option("--depth,-d", options.depth, "Longest path, in nodes");
+  app.add_option("--fan-in", options.fan_in, "Max inputs per core:merge (>= 2)");
+  app.add_option("--fan-out", options.fan_out, "Max consumers per node for extra merge inputs");
+  app.add_option("--merge-fraction", options.merge_fraction,
+                 "Share of mixing-layer nodes that are core:merge");
+  app.add_option("--param-bytes", options.param_bytes, "Approximate params size per node");
+  app.add_option("--seed", options.seed, "Random seed");
+  app.add_option("--out,-o", out_path, "Write the plan JSON to this file (default: stdout)");
+  app.add_option("--profile", profile_runs,
+                 "Parse and compile the plan this many times and print median ms per phase");
+
+  CLI11_PARSE(app, argc, argv);
+
+  nlohmann::json plan;
+  std::string error;
+  if (!GenerateSyntheticPlan(options, plan, &error)) {
+    fmt::print(stderr, "Error: {}\n", error);
+    return 1;
+  }
+
+  if (!out_path.empty()) {
+    std::ofstream file(out_path);
+    file << plan.dump(2) << "\n";
+    if (!file) {
+      fmt::print(stderr, "Error writing plan: {}\n", out_path);
+      return 1;
+    }
+  } else if (profile_runs <= 0) {
+    std::cout << plan.dump(2) << "\n";
+  }
+
+  if (profile_runs > 0) {
+    return Profile(plan, profile_runs);
+  }
+  return 0;
+}
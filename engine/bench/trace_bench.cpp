@@ -0,0 +1,60 @@
+#include <ostream>
+#include <vector>
+#include <streambuf>
+#include <string>
+
+#include "bench.h"
+#include "logging/trace.h"
+
+namespace ranking_dsl::bench {
+
+namespace {
+
+// Output sink that discards everything
+class NullBuffer : public std::streambuf {
+ protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// Two events per span; stays within the default per-thread ring (4096
+// events) so no iteration measures dropped events
+const std::vector<size_t> kSpanCounts = {100, 1000};
+
+// rows = node spans (start + end) per iteration
+void Spans(BenchState& state, bool enabled) {
+  static NullBuffer buffer;
+  static std::ostream null_out(&buffer);
+  TraceOptions options;
+  options.out = &null_out;
+  options.flush_interval = std::chrono::milliseconds(0);
+  Tracer::Configure(options);
+  bool was_enabled = Tracer::IsEnabled();
+  Tracer::SetEnabled(enabled);
+
+  const std::string plan = "bench_plan";
+  const std::string node = "node";
+  const std::string op = "core:score_formula";
+  const std::string trace_key = "blend";
+  state.Run([&] {
+    for (size_t i = 0; i < state.rows(); ++i) {
+      Tracer::LogNodeStart(plan, node, op, trace_key);
+      Tracer::LogNodeEnd(plan, node, op, 0.01, 1000, 1000, "", trace_key);
+    }
+    Tracer::Flush();  // Formatting counts against the spans that caused it
+  });
+
+  Tracer::SetEnabled(was_enabled);
+  Tracer::Configure(TraceOptions{});
+}
+
+void SpansEnabled(BenchState& state) { Spans(state, true); }
+void SpansDisabled(BenchState& state) { Spans(state, false); }
+
+}  // namespace
+
+RANKDSL_BENCHMARK(SpansEnabled, "trace/node_span", kSpanCounts, kNoDim, SpansEnabled);
+RANKDSL_BENCHMARK(SpansDisabled, "trace/node_span_disabled", kSpanCounts, kNoDim,
+                  SpansDisabled);
+
+}  // namespace ranking_dsl::bench
@@ -1,41 +1,211 @@
 #include "executor/executor.h"
 
+#include <algorithm>
 #include <chrono>
+#include <exception>
 #include <memory>
 #include <unordered_map>
 
 #include <fmt/format.h>
 
+#include "executor/fused_pipeline.h"
 #include "keys/registry.h"
+#include "logging/metrics.h"
+#include "logging/perf_counters.h"
 #include "logging/trace.h"
 #include "nodes/node_runner.h"
 #include "nodes/registry.h"
+#include "object/memory_stats.h"
+#include "plan/bindings.h"
 
 namespace ranking_dsl {
 
+namespace {
+
+// Per-request params for bound nodes, plan params for everything else
+const nlohmann::json& ParamsOf(const CompiledPlan& plan,
+                               const std::vector<nlohmann::json>& bound_params, int32_t node) {
+  if (!bound_params.empty() && !bound_params[node].is_null()) {
+    return bound_params[node];
+  }
+  return plan.plan.nodes[node].params;
+}
+
+// Output columns whose key the input does not hold
+int32_t CountAddedColumns(const ColumnBatch& input, const ColumnBatch& output) {
+  int32_t added = 0;
+  for (const auto& [key, column] : output.Columns()) {
+    if (column && !input.HasColumn(key)) {
+      ++added;
+    }
+  }
+  return added;
+}
+
+// Drop input batches whose last consumer is `node` (or the chain it heads)
+void ReleaseInputs(const CompiledPlan& plan, int32_t node, std::vector<CandidateBatch>& outputs,
+                   LiveColumnTracker* live) {
+  if (plan.last_consumer.empty()) {
+    return;
+  }
+  for (int32_t input : plan.graph.Inputs(node)) {
+    if (plan.last_consumer[input] == node) {
+      if (live) {
+        live->Release(outputs[input]);
+      }
+      outputs[input] = CandidateBatch(0);
+    }
+  }
+}
+
+// Per node: whether a sampled request dumps its output (empty = not sampled)
+std::vector<bool> SampledDumpNodes(const CompiledPlan& plan, const ExecContext& ctx) {
+  const PlanLogging& logging = plan.plan.logging;
+  if (logging.dump_keys.empty()) {
+    return {};
+  }
+  bool sampled = ctx.sample ? *ctx.sample : Tracer::ShouldSample(logging.sample_rate);
+  if (!sampled) {
+    return {};
+  }
+  if (logging.dump_nodes.empty()) {
+    return std::vector<bool>(plan.plan.nodes.size(), true);
+  }
+  std::vector<bool> dump(plan.plan.nodes.size(), false);
+  for (const auto& id : logging.dump_nodes) {
+    int32_t node = plan.graph.IndexOf(id);
+    if (node >= 0) {
+      dump[node] = true;
+    }
+  }
+  return dump;
+}
+
+}  // namespace
+
 Executor::Executor(const KeyRegistry& registry) : registry_(registry) {}
 
 CandidateBatch Executor::Execute(const CompiledPlan& plan, std::string* error_out) {
-  ExecContext ctx;
-  ctx.registry = &registry_;
+  return Execute(plan, ExecContext{}, error_out);
+}
 
-  // Map node ID to its output
-  std::unordered_map<std::string, CandidateBatch> outputs;
+CandidateBatch Executor::Execute(const CompiledPlan& plan, ExecContext ctx,
+                                 std::string* error_out) {
+  std::vector<CandidateBatch> outputs;
+  if (!RunNodes(plan, ctx, outputs, error_out) || plan.sink_indices.empty()) {
+    return CandidateBatch(0);
+  }
+
+  // Return the primary output
+  return std::move(outputs[plan.sink_indices.front()]);
+}
+
+std::unordered_map<std::string, CandidateBatch> Executor::ExecuteOutputs(
+    const CompiledPlan& plan, ExecContext ctx, std::string* error_out) {
+  std::vector<CandidateBatch> outputs;
+  if (!RunNodes(plan, ctx, outputs, error_out)) {
+    return {};
+  }
+
+  std::unordered_map<std::string, CandidateBatch> sinks;
+  for (int32_t sink : plan.sink_indices) {
+    sinks[plan.plan.nodes[sink].id] = outputs[sink];
+  }
+  // Requested outputs merged into another sink share its batch
+  for (const auto& [requested, kept] : plan.sink_aliases) {
+    auto it = sinks.find(kept);
+    if (it != sinks.end()) {
+      sinks[requested] = it->second;
+    }
+  }
+  return sinks;
+}
+
+bool Executor::RunNodes(const CompiledPlan& plan, ExecContext& ctx,
+                        std::vector<CandidateBatch>& outputs,
+                        std::string* error_out) {
+  if (!ctx.registry) {
+    ctx.registry = &registry_;
+  }
+
+  // Node outputs by plan index
+  outputs.assign(plan.plan.nodes.size(), CandidateBatch(0));
 
-  // Build node lookup
-  std::unordered_map<std::string, const PlanNode*> node_by_id;
-  for (const auto& node : plan.plan.nodes) {
-    node_by_id[node.id] = &node;
+  // Resolve bindings once per request; only bound nodes get a params copy
+  std::vector<nlohmann::json> bound_params;
+  std::unordered_map<std::string, nlohmann::json> binding_values;
+  if (!plan.bound_nodes.empty()) {
+    if (!ResolveBindingValues(plan.plan.bindings, ctx.bindings, binding_values, error_out)) {
+      return false;
+    }
+    bound_params.resize(plan.plan.nodes.size());
+    for (int32_t node : plan.bound_nodes) {
+      bound_params[node] = SubstituteBindings(plan.plan.nodes[node].params, binding_values);
+    }
+    ctx.binding_values = &binding_values;
   }
 
-  // Execute in topological order
-  for (const auto& node_id : plan.topo_order) {
-    const auto* spec = node_by_id[node_id];
-    if (!spec) {
+  // Sampling is decided once per request; unsampled requests skip dumps entirely
+  const std::vector<bool> dump_at = SampledDumpNodes(plan, ctx);
+  auto dump_output = [&](int32_t node) {
+    Tracer::LogSampleDump(plan.plan.name, plan.plan.nodes[node].id, outputs[node],
+                          plan.plan.logging.dump_keys);
+  };
+  Instrumentation inst;
+  inst.traced = ctx.trace ? *ctx.trace : Tracer::ShouldTraceRequest();
+  inst.perf = ctx.perf_counters ? PerfCounterGroup::ForCurrentThread() : nullptr;
+
+  // Live column bytes are tracked only when node_end events or ctx.stats read them
+  LiveColumnTracker live;
+  if (inst.traced || ctx.stats) {
+    inst.live = &live;
+  }
+  if (ctx.stats) {
+    *ctx.stats = ExecStats{};
+  }
+  inst.request_start = std::chrono::high_resolution_clock::now();
+
+  // Schemas describe generated candidates unless the plan declared supplied
+  // ones; otherwise runners probe the request's columns
+  bool use_schemas = !plan.input_schemas.empty() &&
+                     (!ctx.candidates || plan.candidate_schema.has_value());
+
+  // Execute in topological order (nodes pruned by the compiler are absent)
+  for (int32_t node_index : plan.exec_order) {
+    const PlanNode* spec = &plan.plan.nodes[node_index];
+    const std::string& node_id = spec->id;
+
+    // Stop before starting a node once the request deadline has passed
+    if (ctx.deadline && std::chrono::steady_clock::now() >= *ctx.deadline) {
       if (error_out) {
-        *error_out = "Node not found: " + node_id;
+        *error_out = "Request deadline exceeded before node: " + node_id;
+      }
+      return false;
+    }
+
+    // Inferred input columns and precompiled formula (fused chains set their
+    // members' own)
+    ctx.input_schema = use_schemas ? &plan.input_schemas[node_index] : nullptr;
+    ctx.compiled_expr =
+        use_schemas && !plan.compiled_exprs.empty() ? plan.compiled_exprs[node_index].get()
+                                                     : nullptr;
+
+    // Fused chains run as a unit when their first node comes up
+    int32_t chain_index = plan.fused_chain_of.empty() ? -1 : plan.fused_chain_of[node_index];
+    if (chain_index >= 0) {
+      const FusedChain& chain = plan.fused_chains[chain_index];
+      if (chain.nodes.front() == node_index) {
+        if (!RunChain(plan, chain, ctx, bound_params, inst, outputs, error_out)) {
+          return false;
+        }
+        // A chain's output is its tail's; dump it if any member asked for one
+        if (!dump_at.empty() && std::any_of(chain.nodes.begin(), chain.nodes.end(),
+                                            [&](int32_t member) { return dump_at[member]; })) {
+          dump_output(chain.nodes.back());
+        }
+        ReleaseInputs(plan, node_index, outputs, inst.live);
       }
-      return CandidateBatch(0);
+      continue;
     }
 
     // Create runner
@@ -44,18 +214,16 @@ CandidateBatch Executor::Execute(const CompiledPlan& plan, std::string* error_ou
       if (error_out) {
         *error_out = "Unknown op: " + spec->op;
       }
-      return CandidateBatch(0);
+      return false;
     }
 
     // Gather input batch
     // For now, we take the first input or an empty batch
     // The merge node handles combining multiple batches
     CandidateBatch input(0);
-    if (!spec->inputs.empty()) {
-      auto it = outputs.find(spec->inputs[0]);
-      if (it != outputs.end()) {
-        input = it->second;
-      }
+    auto inputs = plan.graph.Inputs(node_index);
+    if (!inputs.empty()) {
+      input = outputs[inputs.front()];
     }
 
     // Run node with tracing
@@ -70,27 +238,213 @@ CandidateBatch Executor::Execute(const CompiledPlan& plan, std::string* error_ou
       trace_ctx->trace_prefix = Tracer::DeriveTracePrefix(module_path);
     }
 
-    Tracer::LogNodeStart(plan.plan.name, node_id, spec->op, spec->trace_key,
-                         trace_ctx.get());
+    if (inst.traced) {
+      Tracer::LogNodeStart(plan.plan.name, node_id, spec->op, spec->trace_key,
+                           trace_ctx.get());
+    }
+    PerfCounts perf_start;
+    if (inst.perf) {
+      inst.perf->Read(perf_start);
+    }
+    double cpu_start = ctx.stats ? ThreadCpuMs() : 0.0;
+
+    NodeMemoryStats runner_memory;  // njs heap growth, reported by the runner
+    ctx.node_memory = &runner_memory;
+    CandidateBatch output(0);
+    try {
+      output = runner->Run(ctx, input, ParamsOf(plan, bound_params, node_index));
+    } catch (const std::exception& e) {
+      // Runners throw on budget, deadline and sandbox violations (njs)
+      ctx.node_memory = nullptr;
+      if (inst.traced) {
+        auto failed = std::chrono::high_resolution_clock::now();
+        Tracer::LogNodeEnd(plan.plan.name, node_id, spec->op,
+                           std::chrono::duration<double, std::milli>(failed - start).count(),
+                           input.RowCount(), 0, e.what(), spec->trace_key, trace_ctx.get());
+      }
+      if (error_out) {
+        *error_out = node_id + ": " + e.what();
+      }
+      return false;
+    }
+    ctx.node_memory = nullptr;
 
-    CandidateBatch output = runner->Run(ctx, input, spec->params);
+    // Drop columns no downstream node (or the plan output) reads
+    const ColumnLiveness& liveness = plan.liveness[node_index];
+    if (liveness.prune) {
+      output.RetainColumns(liveness.live_keys);
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    const PerfCounts* perf_delta = nullptr;
+    PerfCounts perf_end;
+    if (inst.perf && inst.perf->Read(perf_end)) {
+      perf_end = PerfCounts::Delta(perf_start, perf_end);
+      perf_delta = &perf_end;
+    }
+
+    size_t rows_out = output.RowCount();
+    NodeMemoryStats memory = AccountNodeMemory(input, output);
+    memory.njs_heap_bytes = runner_memory.njs_heap_bytes;
+    int32_t columns_added = ctx.stats ? CountAddedColumns(input, output) : 0;
+    outputs[node_index] = std::move(output);
+    if (inst.live) {
+      inst.live->Hold(outputs[node_index]);
+      memory.live_bytes = inst.live->LiveBytes();
+    }
 
-    Tracer::LogNodeEnd(plan.plan.name, node_id, spec->op,
-                       duration_ms, input.RowCount(), output.RowCount(),
-                       "", spec->trace_key, trace_ctx.get());
+    inst.allocated_bytes += memory.allocated_bytes;
+    Metrics::RecordNode(plan.plan.name, node_id, spec->op, end - start,
+                        input.RowCount(), rows_out, perf_delta, &memory);
+    if (inst.traced) {
+      Tracer::LogNodeEnd(plan.plan.name, node_id, spec->op,
+                         duration_ms, input.RowCount(), rows_out,
+                         "", spec->trace_key, trace_ctx.get(), perf_delta, &memory);
+    }
+    if (ctx.stats) {
+      ExecStats::Node stats{node_id, spec->op, spec->trace_key, {node_index}};
+      stats.start_ms =
+          std::chrono::duration<double, std::milli>(start - inst.request_start).count();
+      stats.wall_ms = duration_ms;
+      stats.cpu_ms = ThreadCpuMs() - cpu_start;
+      stats.rows_in = input.RowCount();
+      stats.rows_out = rows_out;
+      stats.columns_added = columns_added;
+      stats.memory = memory;
+      ctx.stats->Add(std::move(stats));
+    }
 
-    outputs[node_id] = std::move(output);
+    if (!dump_at.empty() && dump_at[node_index]) {
+      dump_output(node_index);
+    }
+    ReleaseInputs(plan, node_index, outputs, inst.live);
   }
 
-  // Return output of last node
-  if (!plan.topo_order.empty()) {
-    return outputs[plan.topo_order.back()];
+  // Request totals
+  auto request_end = std::chrono::high_resolution_clock::now();
+  auto duration_ms =
+      std::chrono::duration<double, std::milli>(request_end - inst.request_start).count();
+  if (ctx.stats) {
+    ctx.stats->wall_ms = duration_ms;
+    ctx.stats->peak_live_bytes = live.PeakBytes();
   }
+  if (inst.traced) {
+    size_t rows_out =
+        plan.sink_indices.empty() ? 0 : outputs[plan.sink_indices.front()].RowCount();
+    Tracer::LogRequestEnd(plan.plan.name, duration_ms, rows_out, inst.allocated_bytes,
+                          live.PeakBytes());
+  }
+
+  return true;
+}
 
-  return CandidateBatch(0);
+bool Executor::RunChain(const CompiledPlan& plan, const FusedChain& chain,
+                        const ExecContext& ctx, const std::vector<nlohmann::json>& bound_params,
+                        Instrumentation& inst, std::vector<CandidateBatch>& outputs,
+                        std::string* error_out) {
+  std::vector<std::unique_ptr<NodeRunner>> runners;
+  std::vector<const nlohmann::json*> params;
+  runners.reserve(chain.nodes.size());
+  std::string chain_id;
+  for (int32_t node : chain.nodes) {
+    const PlanNode& spec = plan.plan.nodes[node];
+    auto runner = NodeRegistry::Instance().Create(spec.op);
+    if (!runner) {
+      if (error_out) {
+        *error_out = "Unknown op: " + spec.op;
+      }
+      return false;
+    }
+    runners.push_back(std::move(runner));
+    params.push_back(&ParamsOf(plan, bound_params, node));
+    chain_id += (chain_id.empty() ? "" : "+") + spec.id;
+  }
+
+  // The chain head has exactly one input when it has any
+  CandidateBatch input(0);
+  auto inputs = plan.graph.Inputs(chain.nodes.front());
+  if (!inputs.empty()) {
+    input = outputs[inputs.front()];
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  if (inst.traced) {
+    Tracer::LogNodeStart(plan.plan.name, chain_id, "fused", "");
+  }
+  PerfCounts perf_start;
+  if (inst.perf) {
+    inst.perf->Read(perf_start);
+  }
+  double cpu_start = ctx.stats ? ThreadCpuMs() : 0.0;
+
+  CandidateBatch output(0);
+  std::string chain_error;
+  bool chain_ok;
+  try {
+    chain_ok = RunFusedChain(ctx, plan, chain, runners, params, input, output, &chain_error);
+  } catch (const std::exception& e) {
+    chain_ok = false;
+    chain_error = e.what();
+  }
+  if (!chain_ok) {
+    if (inst.traced) {
+      auto failed = std::chrono::high_resolution_clock::now();
+      Tracer::LogNodeEnd(plan.plan.name, chain_id, "fused",
+                         std::chrono::duration<double, std::milli>(failed - start).count(),
+                         input.RowCount(), 0, chain_error);
+    }
+    if (error_out) {
+      *error_out = chain_id + ": " + chain_error;
+    }
+    return false;
+  }
+
+  int32_t tail = chain.nodes.back();
+  const ColumnLiveness& liveness = plan.liveness[tail];
+  if (liveness.prune) {
+    output.RetainColumns(liveness.live_keys);
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  auto duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  const PerfCounts* perf_delta = nullptr;
+  PerfCounts perf_end;
+  if (inst.perf && inst.perf->Read(perf_end)) {
+    perf_end = PerfCounts::Delta(perf_start, perf_end);
+    perf_delta = &perf_end;
+  }
+
+  size_t rows_out = output.RowCount();
+  NodeMemoryStats memory = AccountNodeMemory(input, output);
+  int32_t columns_added = ctx.stats ? CountAddedColumns(input, output) : 0;
+  outputs[tail] = std::move(output);
+  if (inst.live) {
+    inst.live->Hold(outputs[tail]);
+    memory.live_bytes = inst.live->LiveBytes();
+  }
+
+  inst.allocated_bytes += memory.allocated_bytes;
+  Metrics::RecordNode(plan.plan.name, chain_id, "fused", end - start,
+                      input.RowCount(), rows_out, perf_delta, &memory);
+  if (inst.traced) {
+    Tracer::LogNodeEnd(plan.plan.name, chain_id, "fused",
+                       duration_ms, input.RowCount(), rows_out,
+                       "", "", nullptr, perf_delta, &memory);
+  }
+  if (ctx.stats) {
+    ExecStats::Node stats{chain_id, "fused", "", chain.nodes};
+    stats.start_ms =
+        std::chrono::duration<double, std::milli>(start - inst.request_start).count();
+    stats.wall_ms = duration_ms;
+    stats.cpu_ms = ThreadCpuMs() - cpu_start;
+    stats.rows_in = input.RowCount();
+    stats.rows_out = rows_out;
+    stats.columns_added = columns_added;
+    stats.memory = memory;
+    ctx.stats->Add(std::move(stats));
+  }
+  return true;
 }
 
 }  // namespace ranking_dsl
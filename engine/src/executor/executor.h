@@ -1,14 +1,51 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <nlohmann/json.hpp>
+
+#include "nodes/node_runner.h"
 #include "object/candidate_batch.h"
+#include "object/memory_stats.h"
 #include "plan/compiler.h"
 
 namespace ranking_dsl {
 
 class KeyRegistry;
+class PerfCounterGroup;
+
+/**
+ * Per-request execution stats, filled when ExecContext::stats is set.
+ */
+struct ExecStats {
+  struct Node {
+    std::string node_id;             // Fused chains: "a+b+c"
+    std::string op;                  // Fused chains: "fused"
+    std::string trace_key;
+    std::vector<int32_t> plan_nodes;  // Plan indices run (a fused chain's members)
+    double start_ms = 0.0;            // Offset from the request start
+    double wall_ms = 0.0;
+    double cpu_ms = 0.0;              // Executing thread's CPU time
+    size_t rows_in = 0;
+    size_t rows_out = 0;
+    int32_t columns_added = 0;        // Output keys the input lacks
+    NodeMemoryStats memory;
+  };
+
+  std::vector<Node> nodes;      // In execution order
+  double wall_ms = 0.0;         // Whole request
+  int64_t allocated_bytes = 0;  // Sum of the nodes' allocated bytes
+  int64_t peak_live_bytes = 0;  // Most column bytes held at once
+
+  void Add(Node node) {
+    allocated_bytes += node.memory.allocated_bytes;
+    nodes.push_back(std::move(node));
+  }
+};
 
 /**
  * Executor - runs a compiled plan.
@@ -19,13 +56,43 @@ class Executor {
 
   /**
    * Execute a compiled plan.
-   * Returns the final candidate batch.
+   * Returns the primary output batch (plan.sinks[0]).
    */
   CandidateBatch Execute(const CompiledPlan& plan,
                          std::string* error_out = nullptr);
 
+  /**
+   * Execute a compiled plan with request-level context (e.g. deadline).
+   * ctx.registry defaults to the executor's registry if not set.
+   */
+  CandidateBatch Execute(const CompiledPlan& plan, ExecContext ctx,
+                         std::string* error_out = nullptr);
+
+  /**
+   * Execute a compiled plan and return the batch of every sink, keyed by
+   * node ID; an output merged into a duplicate (sink_aliases) is returned
+   * under its own ID too. Empty on error.
+   */
+  std::unordered_map<std::string, CandidateBatch> ExecuteOutputs(
+      const CompiledPlan& plan, ExecContext ctx, std::string* error_out = nullptr);
+
  private:
   const KeyRegistry& registry_;
+
+  bool RunNodes(const CompiledPlan& plan, ExecContext& ctx,
+                std::vector<CandidateBatch>& outputs, std::string* error_out);
+  // Per-request instrumentation, decided once in RunNodes
+  struct Instrumentation {
+    bool traced = false;                // Log node spans
+    PerfCounterGroup* perf = nullptr;   // Hardware counters (nullptr = off)
+    LiveColumnTracker* live = nullptr;  // Live column bytes (nullptr = off)
+    int64_t allocated_bytes = 0;        // Running request total
+    std::chrono::high_resolution_clock::time_point request_start;
+  };
+
+  bool RunChain(const CompiledPlan& plan, const FusedChain& chain, const ExecContext& ctx,
+                const std::vector<nlohmann::json>& bound_params, Instrumentation& inst,
+                std::vector<CandidateBatch>& outputs, std::string* error_out);
 };
 
 }  // namespace ranking_dsl
@@ -0,0 +1,62 @@
+#include "executor/explain.h"
+
+#include <fmt/format.h>
+
+#include "executor/schedule.h"
+
+namespace ranking_dsl {
+
+// ExecStats and ScheduleAnalysis both list nodes in execution order, so
+// their indices coincide.
+
+std::vector<size_t> CriticalPath(const CompiledPlan& plan, const ExecStats& stats) {
+  ScheduleAnalysis schedule;
+  if (!AnalyzeSchedule(plan, SpansOf(stats), schedule)) {
+    return {};
+  }
+  return schedule.critical_path;
+}
+
+std::string FormatExplainAnalyze(const CompiledPlan& plan, const ExecStats& stats) {
+  ScheduleAnalysis schedule;
+  std::string error;
+  if (!AnalyzeSchedule(plan, SpansOf(stats), schedule, &error)) {
+    return "EXPLAIN ANALYZE failed: " + error + "\n";
+  }
+
+  std::string out = fmt::format("EXPLAIN ANALYZE {} ({} nodes, {:.3f} ms, {} bytes allocated)\n",
+                                plan.plan.name, stats.nodes.size(), stats.wall_ms,
+                                stats.allocated_bytes);
+  out += fmt::format("  {:<24} {:<14} {:<12} {:>9} {:>9} {:>6} {:>8} {:>8} {:>6} {:>5} {:>12} "
+                     "{:>9}  {}\n",
+                     "node", "op", "trace_key", "wall_ms", "cpu_ms", "share", "rows_in",
+                     "rows_out", "sel", "+cols", "allocated", "slack_ms", "inputs");
+  for (size_t i = 0; i < stats.nodes.size(); ++i) {
+    const ExecStats::Node& node = stats.nodes[i];
+    const ScheduleAnalysis::Node& scheduled = schedule.nodes[i];
+    double share = stats.wall_ms > 0 ? 100.0 * node.wall_ms / stats.wall_ms : 0.0;
+    std::string selectivity =
+        node.rows_in > 0 ? fmt::format("{:.3f}", static_cast<double>(node.rows_out) / node.rows_in)
+                         : "-";
+    std::string input_ids;
+    for (size_t input : scheduled.inputs) {
+      input_ids += (input_ids.empty() ? "" : ",") + stats.nodes[input].node_id;
+    }
+    out += fmt::format("{} {:<24} {:<14} {:<12} {:>9.3f} {:>9.3f} {:>5.1f}% {:>8} {:>8} {:>6} "
+                       "{:>5} {:>12} {:>9.3f}  {}\n",
+                       scheduled.critical ? '*' : ' ', node.node_id, node.op,
+                       node.trace_key.empty() ? "-" : node.trace_key, node.wall_ms, node.cpu_ms,
+                       share, node.rows_in, node.rows_out, selectivity, node.columns_added,
+                       node.memory.allocated_bytes, scheduled.slack_ms,
+                       input_ids.empty() ? "-" : input_ids);
+  }
+
+  std::string path_ids;
+  for (size_t entry : schedule.critical_path) {
+    path_ids += (path_ids.empty() ? "" : " -> ") + stats.nodes[entry].node_id;
+  }
+  out += fmt::format("* critical path ({:.3f} ms): {}\n", schedule.unlimited_cores_ms, path_ids);
+  return out;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "executor/executor.h"
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+/**
+ * Indices into stats.nodes of the critical path: the chain of dependent
+ * nodes (or fused chains) with the largest total wall time, source first.
+ * No schedule of the plan can finish faster than this path.
+ */
+std::vector<size_t> CriticalPath(const CompiledPlan& plan, const ExecStats& stats);
+
+/**
+ * EXPLAIN ANALYZE report of an executed request: one row per node in
+ * execution order with op, trace_key, wall/CPU time, share of the request,
+ * rows in/out, selectivity, columns added, bytes allocated, schedule
+ * slack and inputs. Nodes without slack (see ScheduleAnalysis) are marked
+ * with '*'.
+ */
+std::string FormatExplainAnalyze(const CompiledPlan& plan, const ExecStats& stats);
+
+}  // namespace ranking_dsl
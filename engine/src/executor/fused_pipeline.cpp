@@ -0,0 +1,117 @@
+#include "executor/fused_pipeline.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "object/batch_builder.h"
+#include "object/row_block.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+// Full-height output for one key written by the chain
+struct OutputColumn {
+  ColumnType type;
+  size_t dim;
+  std::vector<float> data;
+};
+
+}  // namespace
+
+bool RunFusedChain(const ExecContext& ctx, const CompiledPlan& plan, const FusedChain& chain,
+                   const std::vector<std::unique_ptr<NodeRunner>>& runners,
+                   const std::vector<const nlohmann::json*>& params,
+                   const CandidateBatch& input, CandidateBatch& output,
+                   std::string* error_out, size_t block_rows) {
+  size_t row_count = input.RowCount();
+  if (row_count == 0 || chain.nodes.empty()) {
+    output = input;  // Fusible nodes pass empty batches through unchanged
+    return true;
+  }
+  block_rows = std::max<size_t>(block_rows, 1);
+  for (const auto& runner : runners) {
+    if (!runner->RunsBlocks()) {
+      if (error_out) {
+        *error_out = runner->TypeName() + " cannot run row blocks";
+      }
+      return false;
+    }
+  }
+
+  const ColumnLiveness& liveness = plan.liveness[chain.nodes.back()];
+  auto is_live = [&](int32_t key_id) {
+    return !liveness.prune || std::binary_search(liveness.live_keys.begin(),
+                                                 liveness.live_keys.end(), key_id);
+  };
+
+  // Each member sees its own inferred schema and precompiled formula, if the
+  // executor trusted the head's
+  std::vector<ExecContext> member_ctx(chain.nodes.size(), ctx);
+  for (size_t i = 0; ctx.input_schema && i < chain.nodes.size(); ++i) {
+    int32_t node = chain.nodes[i];
+    member_ctx[i].input_schema =
+        plan.input_schemas.empty() ? nullptr : &plan.input_schemas[node];
+    member_ctx[i].compiled_expr =
+        plan.compiled_exprs.empty() ? nullptr : plan.compiled_exprs[node].get();
+  }
+
+  RowBlock block(input);
+  std::unordered_map<int32_t, OutputColumn> outputs;
+  std::vector<int32_t> output_order;
+
+  for (size_t begin = 0; begin < row_count; begin += block_rows) {
+    size_t size = std::min(block_rows, row_count - begin);
+    block.Reset(begin, size);
+
+    for (size_t i = 0; i < chain.nodes.size(); ++i) {
+      runners[i]->RunBlock(member_ctx[i], block, *params[i]);
+    }
+
+    // Copy live results out of block scratch
+    for (const auto& written : block.WrittenKeys()) {
+      if (!is_live(written.key_id)) {
+        continue;
+      }
+      auto [it, inserted] = outputs.try_emplace(written.key_id);
+      OutputColumn& out = it->second;
+      if (inserted) {
+        out.type = written.type;
+        out.dim = written.dim;
+        out.data.assign(row_count * written.dim, 0.0f);
+        output_order.push_back(written.key_id);
+      }
+      if (out.dim != written.dim) {
+        // Rows of one column must share a dim; the unfused runner would
+        // have produced a single column, so no block result is usable
+        if (error_out) {
+          *error_out = fmt::format(
+              "Fused chain wrote key {} with dim {} at row {} after dim {} in earlier rows",
+              written.key_id, written.dim, begin, out.dim);
+        }
+        return false;
+      }
+      const float* src = block.WrittenData(written.key_id);
+      std::copy(src, src + size * written.dim, out.data.begin() + begin * written.dim);
+    }
+  }
+
+  // Unchanged input columns are shared (COW)
+  BatchBuilder builder(input);
+  for (int32_t key_id : output_order) {
+    OutputColumn& out = outputs[key_id];
+    if (out.type == ColumnType::F32Vec) {
+      builder.AddF32VecColumn(key_id, std::make_shared<F32VecColumn>(
+          std::move(out.data), out.dim, std::vector<bool>(row_count, false)));
+    } else {
+      builder.AddF32Column(key_id, std::make_shared<F32Column>(
+          std::move(out.data), std::vector<bool>(row_count, false)));
+    }
+  }
+  output = builder.Build();
+  return true;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "nodes/node_runner.h"
+#include "object/candidate_batch.h"
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+/**
+ * Rows per block for fused chains. Small enough that a block's scalar
+ * columns plus a 128-d embedding (256 x 128 x 4 B = 128 KiB) stay in L2.
+ */
+inline constexpr size_t kFusedBlockRows = 256;
+
+/**
+ * Run a fused chain over `input` one row block at a time.
+ *
+ * runners[i] runs chain.nodes[i] with params[i]. Keys written inside the chain are copied
+ * into full output columns only if they are live after the chain's last
+ * node; intermediate-only keys never leave block-local scratch.
+ *
+ * Fails if a vector key's dim differs between blocks, since its rows could
+ * not form one output column.
+ */
+bool RunFusedChain(const ExecContext& ctx, const CompiledPlan& plan, const FusedChain& chain,
+                   const std::vector<std::unique_ptr<NodeRunner>>& runners,
+                   const std::vector<const nlohmann::json*>& params,
+                   const CandidateBatch& input, CandidateBatch& output,
+                   std::string* error_out = nullptr, size_t block_rows = kFusedBlockRows);
+
+}  // namespace ranking_dsl
@@ -0,0 +1,403 @@
+#include "executor/load_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <istream>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "logging/perf_counters.h"
+#include "object/typed_column.h"
+#include "plan/schema.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+const KeyRegistry::KeyInfo* ResolveKey(const KeyRegistry& registry, const std::string& name) {
+  if (const auto* info = registry.GetByName(name)) {
+    return info;
+  }
+  if (!name.empty() && std::all_of(name.begin(), name.end(),
+                                   [](unsigned char c) { return std::isdigit(c); })) {
+    return registry.GetById(std::stoi(name));
+  }
+  return nullptr;
+}
+
+// JSON value as a Value of the key's type, or false on a mismatch
+bool ToValue(const json& value, keys::KeyType type, size_t dim, Value& out) {
+  switch (type) {
+    case keys::KeyType::Bool:
+      if (!value.is_boolean()) return false;
+      out = value.get<bool>();
+      return true;
+    case keys::KeyType::I64:
+      if (!value.is_number_integer()) return false;
+      out = value.get<int64_t>();
+      return true;
+    case keys::KeyType::F32:
+      if (!value.is_number()) return false;
+      out = value.get<float>();
+      return true;
+    case keys::KeyType::String:
+      if (!value.is_string()) return false;
+      out = value.get<std::string>();
+      return true;
+    case keys::KeyType::Bytes: {
+      if (!value.is_array()) return false;
+      std::vector<uint8_t> bytes;
+      for (const auto& byte : value) {
+        if (!byte.is_number_integer() || byte.get<int64_t>() < 0 || byte.get<int64_t>() > 255) {
+          return false;
+        }
+        bytes.push_back(static_cast<uint8_t>(byte.get<int64_t>()));
+      }
+      out = std::move(bytes);
+      return true;
+    }
+    case keys::KeyType::F32Vec: {
+      if (!value.is_array() || value.size() != dim) return false;
+      std::vector<float> vec;
+      for (const auto& element : value) {
+        if (!element.is_number()) return false;
+        vec.push_back(element.get<float>());
+      }
+      out = std::move(vec);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseBatch(const json& rows, const KeyRegistry& registry, CandidateBatch& out,
+                std::string* error_out) {
+  auto fail = [&](const std::string& message) {
+    if (error_out) {
+      *error_out = message;
+    }
+    return false;
+  };
+
+  // Columns by key ID (a key may be named or numbered); f32vec width from
+  // the registry or the first value
+  struct Column {
+    const KeyRegistry::KeyInfo* key = nullptr;
+    size_t dim = 0;
+    TypedColumnPtr typed;
+  };
+  std::unordered_map<std::string, const KeyRegistry::KeyInfo*> keys_by_name;
+  std::map<int32_t, Column> columns;
+  for (size_t r = 0; r < rows.size(); ++r) {
+    if (!rows[r].is_object()) {
+      return fail(fmt::format("row {} is not an object", r));
+    }
+    for (const auto& [name, value] : rows[r].items()) {
+      auto [named, inserted] = keys_by_name.try_emplace(name, nullptr);
+      if (inserted) {
+        named->second = ResolveKey(registry, name);
+      }
+      if (!named->second) {
+        return fail(fmt::format("unknown key: {}", name));
+      }
+      Column& column = columns[named->second->id];
+      if (!column.key) {
+        column.key = named->second;
+        column.dim = column.key->dim;
+      }
+      if (column.key->type == keys::KeyType::F32Vec && column.dim == 0 && value.is_array()) {
+        column.dim = value.size();
+      }
+    }
+  }
+
+  for (auto& [id, column] : columns) {
+    column.typed = MakeTypedColumn(ColumnTypeOf(column.key->type), rows.size(), column.dim);
+  }
+  for (size_t r = 0; r < rows.size(); ++r) {
+    for (const auto& [name, value] : rows[r].items()) {
+      if (value.is_null()) {
+        continue;  // Columns start null
+      }
+      Column& column = columns[keys_by_name[name]->id];
+      Value typed_value;
+      if (!ToValue(value, column.key->type, column.dim, typed_value)) {
+        return fail(fmt::format("row {}: {} expects {}{}", r, name,
+                                KeyTypeToString(column.key->type),
+                                column.dim ? fmt::format("[{}]", column.dim) : ""));
+      }
+      column.typed->SetValue(r, typed_value);
+    }
+  }
+
+  CandidateBatch batch(rows.size());
+  for (auto& [id, column] : columns) {
+    batch.SetColumn(id, std::move(column.typed));
+  }
+  out = std::move(batch);
+  return true;
+}
+
+json QuantilesMs(const HistogramSnapshot& histogram) {
+  auto ms = [](uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+  return {{"p50", ms(histogram.ValueAtQuantile(0.5))},
+          {"p90", ms(histogram.ValueAtQuantile(0.9))},
+          {"p99", ms(histogram.ValueAtQuantile(0.99))},
+          {"p999", ms(histogram.ValueAtQuantile(0.999))},
+          {"max", ms(histogram.max)},
+          {"mean", histogram.count ? ms(histogram.sum / histogram.count) : 0.0}};
+}
+
+}  // namespace
+
+BatchSchema CandidateSchemaOf(const std::vector<CandidateBatch>& corpus) {
+  if (corpus.empty()) {
+    return BatchSchema{};
+  }
+  std::map<int32_t, ColumnType> types;
+  std::map<int32_t, size_t> batches_with;
+  for (const CandidateBatch& batch : corpus) {
+    for (int32_t key : batch.ColumnKeys()) {
+      ColumnType type = batch.GetColumn(key)->Type();
+      auto [it, inserted] = types.try_emplace(key, type);
+      if (it->second != type) {
+        return BatchSchema{};
+      }
+      ++batches_with[key];
+    }
+  }
+  BatchSchema schema;
+  schema.known = true;
+  for (const auto& [key, type] : types) {
+    if (batches_with[key] == corpus.size()) {
+      schema.Set(key, type);
+    }
+  }
+  return schema;
+}
+
+bool ReadCandidateCorpus(std::istream& in, const KeyRegistry& registry,
+                         std::vector<CandidateBatch>& out, std::string* error_out) {
+  std::string line;
+  for (size_t line_number = 1; std::getline(in, line); ++line_number) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    json request = json::parse(line, nullptr, false);
+    const json* rows = &request;
+    if (request.is_object() && request.contains("candidates")) {
+      rows = &request["candidates"];
+    }
+    if (!rows->is_array()) {
+      if (error_out) {
+        *error_out = fmt::format("Corpus line {}: expected an array of candidate rows",
+                                 line_number);
+      }
+      return false;
+    }
+    CandidateBatch batch;
+    std::string error;
+    if (!ParseBatch(*rows, registry, batch, &error)) {
+      if (error_out) {
+        *error_out = fmt::format("Corpus line {}: {}", line_number, error);
+      }
+      return false;
+    }
+    out.push_back(std::move(batch));
+  }
+  return true;
+}
+
+std::vector<CandidateBatch> SyntheticCandidateCorpus(size_t batches, size_t rows, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  std::vector<CandidateBatch> corpus;
+  int64_t next_id = 1;
+  for (size_t b = 0; b < batches; ++b) {
+    auto ids = std::make_shared<I64Column>(rows);
+    auto base = std::make_shared<F32Column>(rows);
+    auto ml = std::make_shared<F32Column>(rows);
+    for (size_t i = 0; i < rows; ++i) {
+      ids->Set(i, next_id++);
+      base->Set(i, score(rng));
+      ml->Set(i, score(rng));
+    }
+    CandidateBatch batch(rows);
+    batch.SetColumn(keys::id::CAND_CANDIDATE_ID, ids);
+    batch.SetColumn(keys::id::SCORE_BASE, base);
+    batch.SetColumn(keys::id::SCORE_ML, ml);
+    corpus.push_back(std::move(batch));
+  }
+  return corpus;
+}
+
+bool RunLoad(const CompiledPlan& plan, const KeyRegistry& registry,
+             const std::vector<CandidateBatch>& corpus, const LoadOptions& options,
+             LoadReport& report, std::string* error_out) {
+  if (options.threads == 0 || !(options.qps > 0.0)) {
+    if (error_out) {
+      *error_out = "Load needs at least one thread and a positive qps";
+    }
+    return false;
+  }
+
+  const std::chrono::duration<double, std::nano> interval(1e9 / options.qps);
+  auto requests_in = [&](std::chrono::milliseconds window) {
+    return static_cast<uint64_t>(std::ceil(options.qps * window.count() / 1e3));
+  };
+  const uint64_t warmup_requests = requests_in(options.warmup);
+  const uint64_t total_requests = warmup_requests + requests_in(options.duration);
+
+  // Per-thread results, merged at the end
+  struct Shard {
+    HistogramSnapshot latency_ns;
+    HistogramSnapshot service_ns;
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    double cpu_ms = 0.0;
+    std::string first_error;
+    Clock::time_point last_end;
+  };
+  std::vector<Shard> shards(options.threads);
+  std::atomic<uint64_t> next{0};
+
+  const Clock::time_point start = Clock::now();
+  const Clock::time_point window_start =
+      start + std::chrono::duration_cast<Clock::duration>(interval * double(warmup_requests));
+
+  auto worker = [&](Shard& shard) {
+    Executor executor(registry);
+    ExecContext ctx;
+    ctx.njs_policy = options.njs_policy;
+    std::string error;
+    for (;;) {
+      uint64_t i = next.fetch_add(1, std::memory_order_relaxed);
+      if (i >= total_requests) {
+        break;
+      }
+      // Open loop: the schedule does not wait for earlier requests
+      Clock::time_point scheduled =
+          start + std::chrono::duration_cast<Clock::duration>(interval * double(i));
+      std::this_thread::sleep_until(scheduled);
+
+      ctx.candidates = corpus.empty() ? nullptr : &corpus[i % corpus.size()];
+      Clock::time_point begin = Clock::now();
+      if (options.deadline.count() > 0) {
+        ctx.deadline = begin + options.deadline;
+      }
+      double cpu_start = ThreadCpuMs();
+      error.clear();
+      try {
+        executor.Execute(plan, ctx, &error);
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+      double cpu_ms = ThreadCpuMs() - cpu_start;
+      Clock::time_point end = Clock::now();
+      if (i < warmup_requests) {
+        continue;
+      }
+
+      shard.latency_ns.Record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - scheduled).count()));
+      shard.service_ns.Record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+      shard.requests += 1;
+      shard.cpu_ms += cpu_ms;
+      shard.last_end = std::max(shard.last_end, end);
+      if (!error.empty()) {
+        shard.errors += 1;
+        if (shard.first_error.empty()) {
+          shard.first_error = error;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (Shard& shard : shards) {
+    threads.emplace_back(worker, std::ref(shard));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  report = LoadReport{};
+  report.threads = options.threads;
+  report.target_qps = options.qps;
+  double cpu_ms = 0.0;
+  Clock::time_point last_end = window_start;
+  for (const Shard& shard : shards) {
+    report.latency_ns.Merge(shard.latency_ns);
+    report.service_ns.Merge(shard.service_ns);
+    report.requests += shard.requests;
+    report.errors += shard.errors;
+    cpu_ms += shard.cpu_ms;
+    last_end = std::max(last_end, shard.last_end);
+    if (report.first_error.empty()) {
+      report.first_error = shard.first_error;
+    }
+  }
+  report.elapsed_s = std::chrono::duration<double>(last_end - window_start).count();
+  if (report.elapsed_s > 0.0) {
+    report.achieved_qps = static_cast<double>(report.requests) / report.elapsed_s;
+  }
+  if (report.requests > 0) {
+    report.cpu_ms_per_request = cpu_ms / static_cast<double>(report.requests);
+  }
+  return true;
+}
+
+std::string FormatLoadReport(const LoadReport& report) {
+  std::string out = fmt::format(
+      "Load: {} threads, target {:.1f} qps, achieved {:.1f} qps over {:.2f} s\n", report.threads,
+      report.target_qps, report.achieved_qps, report.elapsed_s);
+  out += fmt::format("Requests: {} ({} errors), CPU {:.3f} ms/request\n", report.requests,
+                     report.errors, report.cpu_ms_per_request);
+  out += fmt::format("  {:<12} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "latency_ms", "p50", "p90",
+                     "p99", "p999", "max");
+  auto row = [&](const char* name, const HistogramSnapshot& histogram) {
+    json q = QuantilesMs(histogram);
+    out += fmt::format("  {:<12} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f}\n", name,
+                       q["p50"].get<double>(), q["p90"].get<double>(), q["p99"].get<double>(),
+                       q["p999"].get<double>(), q["max"].get<double>());
+  };
+  row("scheduled", report.latency_ns);  // Coordinated-omission corrected
+  row("service", report.service_ns);
+  if (!report.first_error.empty()) {
+    out += fmt::format("First error: {}\n", report.first_error);
+  }
+  return out;
+}
+
+json LoadReportToJson(const LoadReport& report) {
+  json out = {{"threads", report.threads},
+              {"target_qps", report.target_qps},
+              {"achieved_qps", report.achieved_qps},
+              {"elapsed_s", report.elapsed_s},
+              {"requests", report.requests},
+              {"errors", report.errors},
+              {"cpu_ms_per_request", report.cpu_ms_per_request},
+              {"latency_ms", QuantilesMs(report.latency_ns)},
+              {"service_ms", QuantilesMs(report.service_ns)}};
+  if (!report.first_error.empty()) {
+    out["first_error"] = report.first_error;
+  }
+  return out;
+}
+
+}  // namespace ranking_dsl
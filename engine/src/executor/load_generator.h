@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "logging/metrics.h"
+#include "object/batch_schema.h"
+#include "object/candidate_batch.h"
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+class KeyRegistry;
+class NjsPolicy;
+
+/**
+ * Read a candidate corpus: JSON lines, one request per line, each an array
+ * of rows or {"candidates": [rows]}. A row maps key names (or numeric key
+ * IDs) to values of the key's type; f32vec values are arrays, and keys a
+ * row omits are null. Blank lines are skipped.
+ */
+bool ReadCandidateCorpus(std::istream& in, const KeyRegistry& registry,
+                         std::vector<CandidateBatch>& out, std::string* error_out = nullptr);
+
+/**
+ * batches seeded candidate batches of rows rows: cand.candidate_id,
+ * score.base and score.ml in [0, 1).
+ */
+std::vector<CandidateBatch> SyntheticCandidateCorpus(size_t batches, size_t rows,
+                                                     uint64_t seed = 1);
+
+/**
+ * Columns every batch of corpus carries with one type, for
+ * PlanCompiler::SetCandidateSchema. Keys only some batches carry are left
+ * out (runners probe them); a key with different types across batches, or
+ * an empty corpus, gives an unknown schema.
+ */
+BatchSchema CandidateSchemaOf(const std::vector<CandidateBatch>& corpus);
+
+/**
+ * Load shape for RunLoad.
+ */
+struct LoadOptions {
+  size_t threads = 4;
+  double qps = 100.0;                             // Target arrival rate, all threads
+  std::chrono::milliseconds duration{10000};      // Measured window
+  std::chrono::milliseconds warmup{1000};         // Run before the window, not recorded
+  std::chrono::milliseconds deadline{0};          // Per-request deadline (0 = none)
+  const NjsPolicy* njs_policy = nullptr;          // ExecContext::njs_policy of every request
+};
+
+/**
+ * Results of the measured window.
+ */
+struct LoadReport {
+  HistogramSnapshot latency_ns;  // Scheduled start -> completion (includes queueing)
+  HistogramSnapshot service_ns;  // Actual start -> completion
+  uint64_t requests = 0;         // Completed, errors included
+  uint64_t errors = 0;
+  std::string first_error;
+  size_t threads = 0;
+  double target_qps = 0.0;
+  double achieved_qps = 0.0;       // requests / elapsed_s
+  double elapsed_s = 0.0;          // Window start -> last completion
+  double cpu_ms_per_request = 0.0; // Executing thread's CPU time
+};
+
+/**
+ * Drive the executor open-loop: request i is scheduled at
+ * start + i / qps regardless of how earlier requests fared, and threads
+ * take requests in schedule order. Each request runs the next corpus batch
+ * (ExecContext::candidates, round-robin; an empty corpus lets sourcers
+ * generate). Compile plan with CandidateSchemaOf(corpus) so its schemas
+ * describe the corpus; otherwise requests run without them. Latency is
+ * measured from the scheduled start, so time spent
+ * waiting for a free thread counts - this corrects for coordinated
+ * omission, which would otherwise hide queueing once the engine saturates.
+ */
+bool RunLoad(const CompiledPlan& plan, const KeyRegistry& registry,
+             const std::vector<CandidateBatch>& corpus, const LoadOptions& options,
+             LoadReport& report, std::string* error_out = nullptr);
+
+/**
+ * Human-readable report: throughput, p50/p90/p99/p999/max of both
+ * latencies in ms, CPU per request.
+ */
+std::string FormatLoadReport(const LoadReport& report);
+
+/**
+ * Report as JSON (latencies in ms).
+ */
+nlohmann::json LoadReportToJson(const LoadReport& report);
+
+}  // namespace ranking_dsl
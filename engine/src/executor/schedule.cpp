@@ -0,0 +1,228 @@
+#include "executor/schedule.h"
+
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <unordered_map>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace ranking_dsl {
+
+namespace {
+
+// Float tolerance for zero slack
+constexpr double kSlackEpsilonMs = 1e-6;
+
+}  // namespace
+
+bool AnalyzeSchedule(const CompiledPlan& plan, const std::vector<ScheduleSpan>& spans,
+                     ScheduleAnalysis& out, std::string* error_out) {
+  out = ScheduleAnalysis{};
+  const size_t node_count = plan.plan.nodes.size();
+  std::vector<size_t> exec_position(node_count, std::numeric_limits<size_t>::max());
+  for (size_t i = 0; i < plan.exec_order.size(); ++i) {
+    exec_position[plan.exec_order[i]] = i;
+  }
+
+  // Resolve each span's plan nodes ("a+b+c" for fused chains)
+  std::vector<int64_t> span_of(node_count, -1);
+  std::vector<std::pair<size_t, size_t>> order;  // {exec position, span}
+  for (size_t s = 0; s < spans.size(); ++s) {
+    size_t first = std::numeric_limits<size_t>::max();
+    size_t begin = 0;
+    const std::string& id = spans[s].node_id;
+    while (begin <= id.size()) {
+      size_t end = std::min(id.find('+', begin), id.size());
+      int32_t node = plan.graph.IndexOf(id.substr(begin, end - begin));
+      if (node < 0) {
+        if (error_out) {
+          *error_out = fmt::format("Span '{}' names no node of plan '{}'", id, plan.plan.name);
+        }
+        return false;
+      }
+      if (span_of[node] >= 0) {
+        if (error_out) {
+          *error_out = fmt::format("Node '{}' has more than one span", plan.plan.nodes[node].id);
+        }
+        return false;
+      }
+      span_of[node] = static_cast<int64_t>(s);
+      first = std::min(first, exec_position[node]);
+      begin = end + 1;
+    }
+    order.emplace_back(first, s);
+  }
+  std::sort(order.begin(), order.end());
+
+  // Nodes in execution order; inputs precede their consumers
+  std::vector<int64_t> index_of(spans.size(), -1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    index_of[order[i].second] = static_cast<int64_t>(i);
+  }
+  double first_start = std::numeric_limits<double>::max();
+  double last_end = 0.0;
+  for (const ScheduleSpan& span : spans) {
+    first_start = std::min(first_start, span.start_ms);
+    last_end = std::max(last_end, span.end_ms);
+  }
+
+  out.nodes.resize(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const ScheduleSpan& span = spans[order[i].second];
+    ScheduleAnalysis::Node& node = out.nodes[i];
+    node.node_id = span.node_id;
+    node.start_ms = span.start_ms - first_start;
+    node.duration_ms = std::max(0.0, span.end_ms - span.start_ms);
+    out.total_node_ms += node.duration_ms;
+  }
+  for (int32_t plan_node = 0; plan_node < static_cast<int32_t>(node_count); ++plan_node) {
+    if (span_of[plan_node] < 0) {
+      continue;
+    }
+    size_t i = static_cast<size_t>(index_of[span_of[plan_node]]);
+    for (int32_t input : plan.graph.Inputs(plan_node)) {
+      if (span_of[input] < 0) {
+        continue;
+      }
+      size_t j = static_cast<size_t>(index_of[span_of[input]]);
+      auto& inputs = out.nodes[i].inputs;
+      // Edges inside a fused chain are not dependencies
+      if (j != i && std::find(inputs.begin(), inputs.end(), j) == inputs.end()) {
+        inputs.push_back(j);
+      }
+    }
+  }
+  if (out.nodes.empty()) {
+    return true;
+  }
+  out.observed_ms = last_end - first_start;
+
+  // Forward pass: earliest start with unlimited cores
+  std::vector<double> earliest_end(out.nodes.size(), 0.0);
+  for (size_t i = 0; i < out.nodes.size(); ++i) {
+    ScheduleAnalysis::Node& node = out.nodes[i];
+    double inputs_end = 0.0;
+    for (size_t input : node.inputs) {
+      node.earliest_start_ms = std::max(node.earliest_start_ms, earliest_end[input]);
+      inputs_end = std::max(inputs_end, out.nodes[input].start_ms + out.nodes[input].duration_ms);
+    }
+    node.wait_ms = node.inputs.empty() ? 0.0 : std::max(0.0, node.start_ms - inputs_end);
+    earliest_end[i] = node.earliest_start_ms + node.duration_ms;
+    out.unlimited_cores_ms = std::max(out.unlimited_cores_ms, earliest_end[i]);
+  }
+
+  // Backward pass: latest start that keeps the unlimited-core latency
+  std::vector<double> latest_end(out.nodes.size(), out.unlimited_cores_ms);
+  for (size_t i = out.nodes.size(); i-- > 0;) {
+    ScheduleAnalysis::Node& node = out.nodes[i];
+    node.latest_start_ms = latest_end[i] - node.duration_ms;
+    node.slack_ms = std::max(0.0, node.latest_start_ms - node.earliest_start_ms);
+    node.critical = node.slack_ms <= kSlackEpsilonMs;
+    for (size_t input : node.inputs) {
+      latest_end[input] = std::min(latest_end[input], node.latest_start_ms);
+    }
+  }
+
+  // Walk back from the last node to finish through inputs that gate it
+  size_t last = 0;
+  for (size_t i = 0; i < out.nodes.size(); ++i) {
+    if (earliest_end[i] > earliest_end[last]) {
+      last = i;
+    }
+  }
+  for (int64_t i = static_cast<int64_t>(last); i >= 0;) {
+    out.critical_path.push_back(static_cast<size_t>(i));
+    const ScheduleAnalysis::Node& node = out.nodes[i];
+    int64_t gate = -1;
+    for (size_t input : node.inputs) {
+      if (gate < 0 || earliest_end[input] > earliest_end[gate]) {
+        gate = static_cast<int64_t>(input);
+      }
+    }
+    i = gate;
+  }
+  std::reverse(out.critical_path.begin(), out.critical_path.end());
+  return true;
+}
+
+std::vector<ScheduleSpan> SpansOf(const ExecStats& stats) {
+  std::vector<ScheduleSpan> spans;
+  spans.reserve(stats.nodes.size());
+  for (const ExecStats::Node& node : stats.nodes) {
+    spans.push_back({node.node_id, node.start_ms, node.start_ms + node.wall_ms});
+  }
+  return spans;
+}
+
+bool ReadTraceSpans(std::istream& trace, const std::string& plan_name,
+                    std::vector<ScheduleSpan>& spans, std::string* error_out) {
+  // A request runs on one thread, but requests on different threads
+  // interleave in the trace: collect open spans per tid
+  std::unordered_map<int64_t, std::vector<ScheduleSpan>> open;
+  int64_t last_tid = 0;
+  bool complete = false;
+  std::string line;
+  int64_t line_number = 0;
+  while (std::getline(trace, line)) {
+    ++line_number;
+    if (line.empty() || line[0] != '{') {
+      continue;  // Plan output and other non-trace lines
+    }
+    auto event = nlohmann::json::parse(line, nullptr, false);
+    if (event.is_discarded()) {
+      if (error_out) {
+        *error_out = fmt::format("Trace line {}: invalid JSON", line_number);
+      }
+      return false;
+    }
+    if (event.value("plan_name", "") != plan_name) {
+      continue;
+    }
+    std::string kind = event.value("event", "");
+    int64_t tid = event.value("tid", int64_t{0});
+    if (kind == "request_end") {
+      spans = std::move(open[tid]);
+      open.erase(tid);
+      complete = true;
+    } else if (kind == "node_end") {
+      double end_ms = event.value("ts_us", 0.0) / 1000.0;
+      open[tid].push_back(
+          {event.value("node_id", ""), end_ms - event.value("duration_ms", 0.0), end_ms});
+      last_tid = tid;
+    }
+  }
+  if (!complete) {
+    spans = std::move(open[last_tid]);
+  }
+  if (spans.empty()) {
+    if (error_out) {
+      *error_out = fmt::format("Trace has no node_end events for plan '{}'", plan_name);
+    }
+    return false;
+  }
+  return true;
+}
+
+std::string FormatScheduleAnalysis(const ScheduleAnalysis& analysis) {
+  std::string out = fmt::format(
+      "Schedule: one core {:.3f} ms, observed {:.3f} ms, unlimited cores {:.3f} ms\n",
+      analysis.total_node_ms, analysis.observed_ms, analysis.unlimited_cores_ms);
+  out += fmt::format("  {:<24} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "node", "start_ms",
+                     "dur_ms", "wait_ms", "earliest", "latest", "slack_ms");
+  for (const ScheduleAnalysis::Node& node : analysis.nodes) {
+    out += fmt::format("{} {:<24} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f}\n",
+                       node.critical ? '*' : ' ', node.node_id, node.start_ms, node.duration_ms,
+                       node.wait_ms, node.earliest_start_ms, node.latest_start_ms,
+                       node.slack_ms);
+  }
+  std::string path;
+  for (size_t i : analysis.critical_path) {
+    path += (path.empty() ? "" : " -> ") + analysis.nodes[i].node_id;
+  }
+  out += fmt::format("* critical path ({:.3f} ms): {}\n", analysis.unlimited_cores_ms, path);
+  return out;
+}
+
+}  // namespace ranking_dsl
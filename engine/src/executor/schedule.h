@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "executor/executor.h"
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+/**
+ * Observed execution of one node (or fused chain) of a request.
+ */
+struct ScheduleSpan {
+  std::string node_id;  // Fused chains: "a+b+c"
+  double start_ms = 0.0;
+  double end_ms = 0.0;
+};
+
+/**
+ * A request's recorded schedule replayed over the plan DAG.
+ *
+ * Earliest starts assume unlimited cores: a node starts as soon as its
+ * inputs end. Latest starts are the latest that still finish the request
+ * by the unlimited-core latency, and slack is their difference; nodes
+ * without slack form the critical path.
+ */
+struct ScheduleAnalysis {
+  struct Node {
+    std::string node_id;
+    std::vector<size_t> inputs;      // Indices of the nodes it waited on
+    double start_ms = 0.0;           // Observed, relative to the first start
+    double duration_ms = 0.0;
+    double wait_ms = 0.0;            // Observed start minus its inputs' last observed end
+    double earliest_start_ms = 0.0;
+    double latest_start_ms = 0.0;
+    double slack_ms = 0.0;
+    bool critical = false;
+  };
+
+  std::vector<Node> nodes;            // In plan execution order
+  std::vector<size_t> critical_path;  // Indices into nodes, source first
+  double observed_ms = 0.0;           // First start to last end
+  double total_node_ms = 0.0;         // Sum of node durations (one core)
+  double unlimited_cores_ms = 0.0;    // Critical path length
+};
+
+/**
+ * Analyze one request's spans against the plan's edges. Spans are matched
+ * to plan nodes by ID; plan nodes without a span (pruned, failed) are left
+ * out. Fails on unknown or repeated node IDs.
+ */
+bool AnalyzeSchedule(const CompiledPlan& plan, const std::vector<ScheduleSpan>& spans,
+                     ScheduleAnalysis& out, std::string* error_out = nullptr);
+
+/**
+ * Spans of a request run with ExecContext::stats.
+ */
+std::vector<ScheduleSpan> SpansOf(const ExecStats& stats);
+
+/**
+ * Spans of the last request of plan_name in a JSON-lines trace, taken from
+ * node_end events (start = ts_us - duration_ms). Events are grouped by tid
+ * (a request runs on one thread) and each thread's requests are delimited by
+ * its request_end events; without one, the spans of the thread that logged
+ * the last node_end are returned.
+ */
+bool ReadTraceSpans(std::istream& trace, const std::string& plan_name,
+                    std::vector<ScheduleSpan>& spans, std::string* error_out = nullptr);
+
+/**
+ * Per-node table (start, duration, wait, earliest/latest start, slack) with
+ * the critical path and the one-core / observed / unlimited-core latencies.
+ */
+std::string FormatScheduleAnalysis(const ScheduleAnalysis& analysis);
+
+}  // namespace ranking_dsl
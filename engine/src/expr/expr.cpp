@@ -8,6 +8,7 @@
 #include <nlohmann/json.hpp>
 
 #include "keys/registry.h"
+#include "plan/bindings.h"
 
 namespace ranking_dsl {
 
@@ -16,16 +17,12 @@ namespace {
 // Compute cosine similarity between two vectors
 // Returns 0 if either vector is empty or has zero norm
 // Clamps result to [-1, 1]
-float CosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) {
-  if (a.empty() || b.empty() || a.size() != b.size()) {
-    return 0.0f;
-  }
-
+float CosineSimilarity(const float* a, const float* b, size_t n) {
   float dot = 0.0f;
   float norm_a = 0.0f;
   float norm_b = 0.0f;
 
-  for (size_t i = 0; i < a.size(); ++i) {
+  for (size_t i = 0; i < n; ++i) {
     dot += a[i] * b[i];
     norm_a += a[i] * a[i];
     norm_b += b[i] * b[i];
@@ -41,6 +38,13 @@ float CosineSimilarity(const std::vector<float>& a, const std::vector<float>& b)
   return std::clamp(result, -1.0f, 1.0f);
 }
 
+float CosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) {
+  if (a.empty() || b.empty() || a.size() != b.size()) {
+    return 0.0f;
+  }
+  return CosineSimilarity(a.data(), b.data(), a.size());
+}
+
 // Get a float value from an Obj, defaulting to 0 if missing or wrong type
 float GetFloatValue(const Obj& obj, int32_t key_id) {
   auto val = obj.Get(key_id);
@@ -102,6 +106,9 @@ ExprNode ParseExpr(const nlohmann::json& json, std::string* error_out) {
     std::string op = json["op"].get<std::string>();
 
     if (op == "const") {
+      if (const std::string* binding = BindingRefName(json["value"])) {
+        return ConstExpr{0.0f, *binding};
+      }
       return ConstExpr{json["value"].get<float>()};
     }
 
@@ -262,7 +269,7 @@ float EvalExpr(const ExprNode& expr, const Obj& obj, const KeyRegistry* registry
       expr);
 }
 
-std::vector<int32_t> CollectKeyIds(const ExprNode& expr) {
+std::vector<int32_t> CollectKeyIds(const ExprNode& expr, const KeyRegistry* registry) {
   std::vector<int32_t> result;
 
   std::visit(
@@ -278,28 +285,38 @@ std::vector<int32_t> CollectKeyIds(const ExprNode& expr) {
                           std::is_same_v<T, std::unique_ptr<MinExpr>> ||
                           std::is_same_v<T, std::unique_ptr<MaxExpr>>) {
           for (const auto& arg : node->args) {
-            auto sub = CollectKeyIds(arg);
+            auto sub = CollectKeyIds(arg, registry);
             result.insert(result.end(), sub.begin(), sub.end());
           }
         }
 
         else if constexpr (std::is_same_v<T, std::unique_ptr<CosExpr>>) {
-          auto sub_a = CollectKeyIds(node->a);
-          auto sub_b = CollectKeyIds(node->b);
+          auto sub_a = CollectKeyIds(node->a, registry);
+          auto sub_b = CollectKeyIds(node->b, registry);
           result.insert(result.end(), sub_a.begin(), sub_a.end());
           result.insert(result.end(), sub_b.begin(), sub_b.end());
         }
 
         else if constexpr (std::is_same_v<T, std::unique_ptr<ClampExpr>>) {
-          auto sub_x = CollectKeyIds(node->x);
-          auto sub_lo = CollectKeyIds(node->lo);
-          auto sub_hi = CollectKeyIds(node->hi);
+          auto sub_x = CollectKeyIds(node->x, registry);
+          auto sub_lo = CollectKeyIds(node->lo, registry);
+          auto sub_hi = CollectKeyIds(node->hi, registry);
           result.insert(result.end(), sub_x.begin(), sub_x.end());
           result.insert(result.end(), sub_lo.begin(), sub_lo.end());
           result.insert(result.end(), sub_hi.begin(), sub_hi.end());
         }
 
-        // ConstExpr and PenaltyExpr don't reference key IDs directly
+        else if constexpr (std::is_same_v<T, std::unique_ptr<PenaltyExpr>>) {
+          // Penalties read "penalty.<name>" when a registry can resolve it
+          if (registry) {
+            const auto* key_info = registry->GetByName("penalty." + node->name);
+            if (key_info) {
+              result.push_back(key_info->id);
+            }
+          }
+        }
+
+        // ConstExpr doesn't reference key IDs
       },
       expr);
 
@@ -393,4 +410,346 @@ float EvalExpr(const ExprNode& expr, const ColumnBatch& batch, size_t row_index,
       expr);
 }
 
+namespace {
+
+// Typed load kernels for CompiledExpr; null rows read as 0
+
+void LoadF32(const F32Column& col, float* out, size_t n) {
+  const float* data = col.Data();
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = col.IsNull(i) ? 0.0f : data[i];
+  }
+}
+
+void LoadI64AsF32(const I64Column& col, float* out, size_t n) {
+  const int64_t* data = col.Data();
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = col.IsNull(i) ? 0.0f : static_cast<float>(data[i]);
+  }
+}
+
+void LoadProbed(const ColumnBatch& batch, int32_t key_id, float* out, size_t n) {
+  if (auto* col = batch.GetF32Column(key_id)) {
+    LoadF32(*col, out, n);
+  } else if (auto* col = batch.GetI64Column(key_id)) {
+    LoadI64AsF32(*col, out, n);
+  } else {
+    std::fill(out, out + n, 0.0f);
+  }
+}
+
+}  // namespace
+
+CompiledExpr CompiledExpr::Compile(const ExprNode& expr, const BatchSchema& schema,
+                                   const KeyRegistry* registry) {
+  compile_count_.fetch_add(1, std::memory_order_relaxed);
+  CompiledExpr compiled;
+  compiled.Emit(expr, schema, registry, 0);
+  return compiled;
+}
+
+bool CompiledExpr::FromProgram(std::vector<Step> program, std::vector<std::string> bindings,
+                               CompiledExpr& out) {
+  size_t depth = 0;
+  size_t max_depth = 0;
+  for (const Step& step : program) {
+    size_t pops = 0;
+    switch (step.op) {
+      case Step::Op::kConst:
+      case Step::Op::kCos:
+        break;
+      case Step::Op::kBound:
+        if (step.binding >= bindings.size()) {
+          return false;
+        }
+        break;
+      case Step::Op::kLoad:
+        if (step.load != Load::kF32 && step.load != Load::kI64 &&
+            step.load != Load::kAbsent && step.load != Load::kProbe) {
+          return false;
+        }
+        break;
+      case Step::Op::kAdd:
+      case Step::Op::kMul:
+      case Step::Op::kMin:
+      case Step::Op::kMax:
+        pops = step.argc;
+        break;
+      case Step::Op::kClamp:
+        if (step.argc != 3) {
+          return false;
+        }
+        pops = 3;
+        break;
+      default:
+        return false;
+    }
+    if (pops > depth) {
+      return false;
+    }
+    depth = depth - pops + 1;
+    max_depth = std::max(max_depth, depth);
+  }
+  if (!program.empty() && depth != 1) {
+    return false;
+  }
+
+  out.program_ = std::move(program);
+  out.bindings_ = std::move(bindings);
+  out.max_depth_ = max_depth;
+  return true;
+}
+
+void CompiledExpr::Emit(const ExprNode& expr, const BatchSchema& schema,
+                        const KeyRegistry* registry, size_t depth) {
+  max_depth_ = std::max(max_depth_, depth + 1);
+
+  auto emit_load = [&](int32_t key_id) {
+    Step step;
+    step.op = Step::Op::kLoad;
+    step.key = key_id;
+    if (!schema.known) {
+      step.load = Load::kProbe;
+    } else if (auto type = schema.TypeOf(key_id)) {
+      step.load = *type == ColumnType::F32   ? Load::kF32
+                  : *type == ColumnType::I64 ? Load::kI64
+                                             : Load::kAbsent;  // Not numeric: reads as 0
+    }
+    program_.push_back(step);
+  };
+  auto emit_const = [&](float value) {
+    Step step;
+    step.value = value;
+    program_.push_back(step);
+  };
+  auto emit_args = [&](Step::Op op, const std::vector<ExprNode>& args) {
+    for (size_t i = 0; i < args.size(); ++i) {
+      Emit(args[i], schema, registry, depth + i);
+    }
+    Step step;
+    step.op = op;
+    step.argc = args.size();
+    program_.push_back(step);
+  };
+
+  std::visit(
+      [&](auto&& node) {
+        using T = std::decay_t<decltype(node)>;
+
+        if constexpr (std::is_same_v<T, ConstExpr>) {
+          if (node.binding.empty()) {
+            emit_const(node.value);
+            return;
+          }
+          // Operand index per distinct binding
+          auto it = std::find(bindings_.begin(), bindings_.end(), node.binding);
+          Step step;
+          step.op = Step::Op::kBound;
+          step.binding = static_cast<size_t>(it - bindings_.begin());
+          if (it == bindings_.end()) {
+            bindings_.push_back(node.binding);
+          }
+          program_.push_back(step);
+        } else if constexpr (std::is_same_v<T, SignalExpr>) {
+          emit_load(node.key_id);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<AddExpr>>) {
+          emit_args(Step::Op::kAdd, node->args);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<MulExpr>>) {
+          emit_args(Step::Op::kMul, node->args);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<MinExpr>>) {
+          emit_args(Step::Op::kMin, node->args);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<MaxExpr>>) {
+          emit_args(Step::Op::kMax, node->args);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<CosExpr>>) {
+          // Vector operands must be signals (as in row-wise evaluation)
+          const auto* sig_a = std::get_if<SignalExpr>(&node->a);
+          const auto* sig_b = std::get_if<SignalExpr>(&node->b);
+          if (!sig_a || !sig_b) {
+            emit_const(0.0f);
+            return;
+          }
+          Step step;
+          step.op = Step::Op::kCos;
+          step.key = sig_a->key_id;
+          step.key_b = sig_b->key_id;
+          program_.push_back(step);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<ClampExpr>>) {
+          Emit(node->x, schema, registry, depth);
+          Emit(node->lo, schema, registry, depth + 1);
+          Emit(node->hi, schema, registry, depth + 2);
+          Step step;
+          step.op = Step::Op::kClamp;
+          step.argc = 3;
+          program_.push_back(step);
+        } else if constexpr (std::is_same_v<T, std::unique_ptr<PenaltyExpr>>) {
+          // Resolve penalty.{name} now rather than per batch
+          const auto* key_info =
+              registry ? registry->GetByName("penalty." + node->name) : nullptr;
+          if (key_info) {
+            emit_load(key_info->id);
+          } else {
+            emit_const(0.0f);  // Default if not found
+          }
+        }
+      },
+      expr);
+}
+
+template <typename SlotFn, typename LoadFn, typename CosFn>
+void CompiledExpr::Run(size_t n, const float* bound, SlotFn&& slot, LoadFn&& load,
+                       CosFn&& cos) const {
+  // Operand stack: slot(d) holds n rows for stack depth d
+  size_t depth = 0;
+
+  for (const Step& step : program_) {
+    switch (step.op) {
+      case Step::Op::kConst:
+        std::fill(slot(depth), slot(depth) + n, step.value);
+        ++depth;
+        break;
+
+      case Step::Op::kBound:
+        std::fill(slot(depth), slot(depth) + n, bound ? bound[step.binding] : 0.0f);
+        ++depth;
+        break;
+
+      case Step::Op::kLoad:
+        load(step, slot(depth++));
+        break;
+
+      case Step::Op::kAdd:
+      case Step::Op::kMul:
+      case Step::Op::kMin:
+      case Step::Op::kMax: {
+        if (step.argc == 0) {
+          float identity = step.op == Step::Op::kMul ? 1.0f : 0.0f;
+          std::fill(slot(depth), slot(depth) + n, identity);
+          ++depth;
+          break;
+        }
+        depth -= step.argc;
+        float* acc = slot(depth);
+        for (size_t a = 1; a < step.argc; ++a) {
+          const float* arg = slot(depth + a);
+          if (step.op == Step::Op::kAdd) {
+            for (size_t i = 0; i < n; ++i) acc[i] += arg[i];
+          } else if (step.op == Step::Op::kMul) {
+            for (size_t i = 0; i < n; ++i) acc[i] *= arg[i];
+          } else if (step.op == Step::Op::kMin) {
+            for (size_t i = 0; i < n; ++i) acc[i] = std::min(acc[i], arg[i]);
+          } else {
+            for (size_t i = 0; i < n; ++i) acc[i] = std::max(acc[i], arg[i]);
+          }
+        }
+        ++depth;
+        break;
+      }
+
+      case Step::Op::kClamp: {
+        depth -= 3;
+        float* x = slot(depth);
+        const float* lo = slot(depth + 1);
+        const float* hi = slot(depth + 2);
+        for (size_t i = 0; i < n; ++i) x[i] = std::clamp(x[i], lo[i], hi[i]);
+        ++depth;
+        break;
+      }
+
+      case Step::Op::kCos:
+        cos(step, slot(depth++));
+        break;
+    }
+  }
+}
+
+void CompiledExpr::Eval(const ColumnBatch& batch, float* out, const float* bound) const {
+  const size_t n = batch.RowCount();
+  if (n == 0 || program_.empty()) {
+    return;
+  }
+
+  std::vector<float> stack(max_depth_ * n);
+  auto slot = [&](size_t d) { return stack.data() + d * n; };
+  auto load = [&](const Step& step, float* dst) {
+    const F32Column* f32 = nullptr;
+    const I64Column* i64 = nullptr;
+    switch (step.load) {
+      case Load::kF32:
+        f32 = batch.GetF32Column(step.key);
+        break;
+      case Load::kI64:
+        i64 = batch.GetI64Column(step.key);
+        break;
+      case Load::kAbsent:  // Probed all the same: the batch may not match the schema
+      case Load::kProbe:
+        break;
+    }
+    if (f32) {
+      LoadF32(*f32, dst, n);
+    } else if (i64) {
+      LoadI64AsF32(*i64, dst, n);
+    } else {
+      LoadProbed(batch, step.key, dst, n);  // Unknown, or not the inferred type
+    }
+  };
+  auto cos = [&](const Step& step, float* dst) {
+    auto* a = batch.GetF32VecColumn(step.key);
+    auto* b = batch.GetF32VecColumn(step.key_b);
+    if (!a || !b || a->Dim() == 0 || a->Dim() != b->Dim()) {
+      std::fill(dst, dst + n, 0.0f);
+      return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = a->IsNull(i) || b->IsNull(i)
+                   ? 0.0f
+                   : CosineSimilarity(a->GetRow(i), b->GetRow(i), a->Dim());
+    }
+  };
+  Run(n, bound, slot, load, cos);
+
+  std::copy(stack.data(), stack.data() + n, out);
+}
+
+void CompiledExpr::EvalBlock(RowBlock& block, float* out, const float* bound) const {
+  const size_t n = block.Size();
+  if (n == 0 || program_.empty()) {
+    return;
+  }
+
+  // The operand stack lives in the block's temps; RowBlock reads resolve the
+  // column type, and earlier stages' writes, per window
+  auto slot = [&](size_t d) { return block.Temp(d); };
+  auto load = [&](const Step& step, float* dst) {
+    const float* values = block.ReadF32(step.key);
+    std::copy(values, values + n, dst);
+  };
+  auto cos = [&](const Step& step, float* dst) {
+    size_t dim_a = 0;
+    size_t dim_b = 0;
+    const float* a = block.ReadF32Vec(step.key, &dim_a);
+    const float* b = block.ReadF32Vec(step.key_b, &dim_b);
+    if (!a || !b || dim_a != dim_b) {
+      std::fill(dst, dst + n, 0.0f);
+      return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = CosineSimilarity(a + i * dim_a, b + i * dim_b, dim_a);
+    }
+  };
+  Run(n, bound, slot, load, cos);
+
+  const float* result = block.Temp(0);
+  std::copy(result, result + n, out);
+}
+
+std::vector<std::pair<int32_t, CompiledExpr::Load>> CompiledExpr::Loads() const {
+  std::vector<std::pair<int32_t, Load>> loads;
+  for (const Step& step : program_) {
+    if (step.op == Step::Op::kLoad) {
+      loads.emplace_back(step.key, step.load);
+    }
+  }
+  return loads;
+}
+
 }  // namespace ranking_dsl
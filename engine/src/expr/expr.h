@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <variant>
@@ -7,8 +9,10 @@
 
 #include <nlohmann/json_fwd.hpp>
 
+#include "object/batch_schema.h"
 #include "object/column_batch.h"
 #include "object/obj.h"
+#include "object/row_block.h"
 #include "object/value.h"
 
 namespace ranking_dsl {
@@ -20,6 +24,7 @@ class KeyRegistry;
  */
 struct ConstExpr {
   float value;
+  std::string binding;  // {"$bind": name} value: set per request, value unused
 };
 
 struct SignalExpr {
@@ -109,9 +114,109 @@ float EvalExpr(const ExprNode& expr, const Obj& obj, const KeyRegistry* registry
 float EvalExpr(const ExprNode& expr, const ColumnBatch& batch, size_t row_index,
                const KeyRegistry* registry = nullptr);
 
+/**
+ * An expression compiled against the schema of the batches it will read.
+ *
+ * Every signal is bound up front to a typed load kernel: F32 columns are
+ * read directly and I64 columns through an I64 -> F32 promotion kernel.
+ * Keys the schema cannot vouch for (unknown schema, a key the schema lacks,
+ * or a batch that turns out not to match) are probed once per batch, so a
+ * stale schema costs a lookup rather than a wrong result. Evaluation is
+ * columnar, so the hot loops carry no type dispatch; results match the
+ * row-wise ColumnBatch overload of EvalExpr.
+ *
+ * Constants bound to plan bindings compile to binding operands (Bindings()),
+ * so one program serves every request; Eval takes their values.
+ *
+ * The plan compiler builds one per score_formula node (CompiledPlan::
+ * compiled_exprs); a CompiledExpr is immutable and safe to share across
+ * threads.
+ */
+class CompiledExpr {
+ public:
+  /**
+   * How a signal is loaded.
+   */
+  enum class Load {
+    kF32,     // F32 column, read directly
+    kI64,     // I64 column, promoted to float
+    kAbsent,  // Not in the schema: probed, normally reads as 0
+    kProbe,   // Type unknown until run time
+  };
+
+  /**
+   * Postfix program step.
+   */
+  struct Step {
+    enum class Op { kConst, kLoad, kAdd, kMul, kMin, kMax, kClamp, kCos, kBound };
+    Op op = Op::kConst;
+    Load load = Load::kAbsent;  // kLoad
+    int32_t key = 0;            // kLoad, kCos
+    int32_t key_b = 0;          // kCos
+    float value = 0.0f;         // kConst
+    size_t argc = 0;            // kAdd, kMul, kMin, kMax, kClamp
+    size_t binding = 0;         // kBound: index into Bindings()
+  };
+
+  static CompiledExpr Compile(const ExprNode& expr, const BatchSchema& schema,
+                              const KeyRegistry* registry = nullptr);
+
+  /**
+   * Rebuild from Program() and Bindings() (plan artifacts).
+   * Returns false if the program is malformed.
+   */
+  static bool FromProgram(std::vector<Step> program, std::vector<std::string> bindings,
+                          CompiledExpr& out);
+
+  /**
+   * Number of Compile calls in this process (tests check that plans reuse
+   * their programs).
+   */
+  static uint64_t CompileCount() { return compile_count_.load(std::memory_order_relaxed); }
+
+  /**
+   * Evaluate for every row of batch, writing batch.RowCount() results to out.
+   * bound holds the value of each of Bindings() (nullptr: they read as 0).
+   */
+  void Eval(const ColumnBatch& batch, float* out, const float* bound = nullptr) const;
+
+  /**
+   * Evaluate for every row of a RowBlock (fused execution), writing
+   * block.Size() results to out. Loads go through the block, so they see
+   * keys written by earlier stages of the chain; results match Eval.
+   */
+  void EvalBlock(RowBlock& block, float* out, const float* bound = nullptr) const;
+
+  const std::vector<Step>& Program() const { return program_; }
+
+  /**
+   * Plan bindings the program's binding operands read, by index.
+   */
+  const std::vector<std::string>& Bindings() const { return bindings_; }
+
+  /**
+   * Load kernel bound to each signal, in expression order.
+   */
+  std::vector<std::pair<int32_t, Load>> Loads() const;
+
+ private:
+  void Emit(const ExprNode& expr, const BatchSchema& schema, const KeyRegistry* registry,
+            size_t depth);
+
+  template <typename SlotFn, typename LoadFn, typename CosFn>
+  void Run(size_t n, const float* bound, SlotFn&& slot, LoadFn&& load, CosFn&& cos) const;
+
+  std::vector<Step> program_;
+  std::vector<std::string> bindings_;
+  size_t max_depth_ = 0;  // Operand stack depth
+
+  static inline std::atomic<uint64_t> compile_count_{0};
+};
+
 /**
  * Collect all key IDs referenced by an expression.
+ * With a registry, penalty references resolve to their "penalty.<name>" key.
  */
-std::vector<int32_t> CollectKeyIds(const ExprNode& expr);
+std::vector<int32_t> CollectKeyIds(const ExprNode& expr, const KeyRegistry* registry = nullptr);
 
 }  // namespace ranking_dsl
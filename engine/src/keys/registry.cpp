@@ -71,6 +71,7 @@ bool KeyRegistry::LoadFromJson(const std::string& json_str, std::string* error_o
         return false;
       }
       info.type = *type_opt;
+      info.dim = key_json.value("dim", uint32_t{0});
 
       info.scope = key_json["scope"].get<std::string>();
       info.owner = key_json["owner"].get<std::string>();
@@ -101,6 +102,7 @@ void KeyRegistry::LoadFromCompiled() {
     info.id = def.id;
     info.name = std::string(def.name);
     info.type = def.type;
+    info.dim = def.dim;
     // scope/owner/doc not available in compiled header
     info.scope = "";
     info.owner = "";
@@ -26,6 +26,7 @@ class KeyRegistry {
     int32_t id;
     std::string name;
     keys::KeyType type;
+    uint32_t dim = 0;  // f32vec dimension (0 = not declared)
     std::string scope;
     std::string owner;
     std::string doc;
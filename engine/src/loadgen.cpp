@@ -0,0 +1,150 @@
+/**
+ * rankdsl_loadgen - drives the executor from many threads at a target QPS
+ * and reports tail latency, throughput and CPU per request.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "executor/load_generator.h"
+#include "keys/registry.h"
+#include "logging/metrics.h"
+#include "logging/trace.h"
+#include "nodes/js/njs_runner.h"
+#include "plan/artifact.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+
+int main(int argc, char* argv[]) {
+  CLI::App app{"Ranking DSL Engine - load generator"};
+
+  std::string plan_path;
+  std::string keys_path;
+  std::string corpus_path;
+  std::string out_path;
+  std::string metrics_out_path;
+  std::string njs_policy_path;
+  size_t synthetic_batches = 64;
+  size_t synthetic_rows = 1000;
+  int64_t duration_ms = 10000;
+  int64_t warmup_ms = 1000;
+  int64_t deadline_ms = 0;
+  bool no_complexity_check = false;
+  LoadOptions options;
+
+  app.add_option("plan", plan_path, "Path to plan.json or binary plan artifact")->required();
+  app.add_option("--keys,-k", keys_path,
+                 "Path to keys.json (uses compiled-in keys if not specified)");
+  app.add_option("--corpus", corpus_path,
+                 "Candidate batches, one request per JSON line (default: synthetic)")
+      ->check(CLI::ExistingFile);
+  app.add_option("--synthetic-batches", synthetic_batches, "Synthetic corpus size");
+  app.add_option("--synthetic-rows", synthetic_rows, "Candidates per synthetic batch");
+  app.add_option("--threads,-t", options.threads, "Worker threads")->check(CLI::PositiveNumber);
+  app.add_option("--qps", options.qps, "Target requests per second, all threads")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--duration-ms", duration_ms, "Measured window")->check(CLI::PositiveNumber);
+  app.add_option("--warmup-ms", warmup_ms, "Load before the measured window, not recorded");
+  app.add_option("--deadline-ms", deadline_ms, "Per-request deadline (0 = none)");
+  app.add_option("--out,-o", out_path, "Write the report as JSON to this file");
+  app.add_option("--metrics-out", metrics_out_path,
+                 "Write per-node Prometheus metrics for the run to this file");
+  app.add_option("--njs-policy", njs_policy_path,
+                 "njs policy JSON (IO allowlist, CPU caps, require_embedded)")
+      ->check(CLI::ExistingFile);
+  app.add_flag("--no-complexity-check", no_complexity_check, "Disable complexity checking");
+
+  CLI11_PARSE(app, argc, argv);
+  options.duration = std::chrono::milliseconds(duration_ms);
+  options.warmup = std::chrono::milliseconds(warmup_ms);
+  options.deadline = std::chrono::milliseconds(deadline_ms);
+
+  // Node spans would dominate short requests
+  Tracer::SetEnabled(false);
+
+  KeyRegistry registry;
+  std::string error;
+  if (!keys_path.empty()) {
+    if (!registry.LoadFromFile(keys_path, &error)) {
+      fmt::print(stderr, "Error loading keys: {}\n", error);
+      return 1;
+    }
+  } else {
+    registry.LoadFromCompiled();
+  }
+
+  std::vector<CandidateBatch> corpus;
+  if (!corpus_path.empty()) {
+    std::ifstream corpus_file(corpus_path);
+    if (!ReadCandidateCorpus(corpus_file, registry, corpus, &error)) {
+      fmt::print(stderr, "Error loading corpus: {}\n", error);
+      return 1;
+    }
+  } else {
+    corpus = SyntheticCandidateCorpus(synthetic_batches, synthetic_rows);
+  }
+
+  CompiledPlan compiled;
+  if (IsPlanArtifactFile(plan_path)) {
+    if (!LoadPlanArtifact(plan_path, registry, compiled, &error)) {
+      fmt::print(stderr, "Error loading plan artifact: {}\n", error);
+      return 1;
+    }
+  } else {
+    Plan plan;
+    if (!ParsePlanFile(plan_path, plan, &error)) {
+      fmt::print(stderr, "Error loading plan: {}\n", error);
+      return 1;
+    }
+    PlanCompiler compiler(registry);
+    if (no_complexity_check) {
+      compiler.DisableComplexityCheck();
+    }
+    // Sourcers pass the corpus batches through
+    if (!corpus.empty()) {
+      compiler.SetCandidateSchema(CandidateSchemaOf(corpus));
+    }
+    if (!compiler.Compile(plan, compiled, &error)) {
+      fmt::print(stderr, "Error compiling plan: {}\n", error);
+      return 1;
+    }
+  }
+
+  NjsPolicy njs_policy;
+  if (!njs_policy_path.empty()) {
+    if (!njs_policy.LoadFromFile(njs_policy_path, &error)) {
+      fmt::print(stderr, "Error loading njs policy: {}\n", error);
+      return 1;
+    }
+    options.njs_policy = &njs_policy;
+  }
+
+  LoadReport report;
+  if (!RunLoad(compiled, registry, corpus, options, report, &error)) {
+    fmt::print(stderr, "Error: {}\n", error);
+    return 1;
+  }
+  fmt::print("{}", FormatLoadReport(report));
+
+  if (!out_path.empty()) {
+    std::ofstream out(out_path);
+    out << LoadReportToJson(report).dump(2) << "\n";
+    if (!out) {
+      fmt::print(stderr, "Error writing report: {}\n", out_path);
+      return 1;
+    }
+  }
+  if (!metrics_out_path.empty() && !Metrics::WritePrometheusFile(metrics_out_path, &error)) {
+    fmt::print(stderr, "Error writing metrics: {}\n", error);
+    return 1;
+  }
+  return report.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,627 @@
+#include "logging/metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+namespace ranking_dsl {
+
+size_t HistogramSnapshot::BucketOf(uint64_t value) {
+  value = std::min(value, kMaxValue);
+  constexpr uint64_t kLinear = uint64_t{2} << kSubBucketBits;
+  if (value < kLinear) {
+    return static_cast<size_t>(value);
+  }
+  int shift = std::bit_width(value) - 1 - kSubBucketBits;
+  return (static_cast<size_t>(shift) << kSubBucketBits) + static_cast<size_t>(value >> shift);
+}
+
+uint64_t HistogramSnapshot::BucketMax(size_t bucket) {
+  constexpr size_t kLinear = size_t{2} << kSubBucketBits;
+  if (bucket < kLinear) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+  uint64_t top = (bucket & ((size_t{1} << kSubBucketBits) - 1)) | (size_t{1} << kSubBucketBits);
+  return ((top + 1) << shift) - 1;
+}
+
+uint64_t HistogramSnapshot::ValueAtQuantile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  double clamped = std::clamp(q, 0.0, 1.0);
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * count)));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < counts.size(); ++bucket) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      return std::min(BucketMax(bucket), max);
+    }
+  }
+  return max;
+}
+
+void HistogramSnapshot::Record(uint64_t value) {
+  counts[BucketOf(value)] += 1;
+  count += 1;
+  sum += value;
+  max = std::max(max, value);
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+  for (size_t bucket = 0; bucket < counts.size(); ++bucket) {
+    counts[bucket] += other.counts[bucket];
+  }
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+}
+
+namespace {
+
+// Node series are keyed by (plan, node, op); njs module series by module
+// (in `node`)
+enum class SeriesKind : char { kNode = 'n', kNjsModule = 'm' };
+
+// Merged totals of one series
+struct SeriesTotals {
+  HistogramSnapshot latency_ns;
+  uint64_t cpu_ns = 0;           // njs modules
+  uint64_t budget_exceeded = 0;  // njs modules
+  uint64_t rows_in = 0;
+  uint64_t rows_out = 0;
+  PerfCounts perf;
+  uint64_t allocated_bytes = 0;
+  uint64_t copied_bytes = 0;
+  uint64_t njs_heap_bytes = 0;
+};
+
+struct Series;
+
+// One thread's cells for one series. Only the owning thread writes, so
+// updates are plain load + store; readers may see a record half-applied.
+struct SeriesCells {
+  explicit SeriesCells(Series* series) : series(series) {}
+
+  static void Add(std::atomic<uint64_t>& cell, uint64_t value) {
+    cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  void RecordLatency(uint64_t duration_ns) {
+    Add(buckets[HistogramSnapshot::BucketOf(duration_ns)], 1);
+    Add(count, 1);
+    Add(sum, duration_ns);
+    if (duration_ns > max.load(std::memory_order_relaxed)) {
+      max.store(duration_ns, std::memory_order_relaxed);
+    }
+  }
+
+  void Record(uint64_t duration_ns, uint64_t in, uint64_t out, const PerfCounts* counts,
+              const NodeMemoryStats* memory) {
+    RecordLatency(duration_ns);
+    Add(rows_in, in);
+    Add(rows_out, out);
+    if (counts && counts->present) {
+      for (size_t i = 0; i < kPerfCounterCount; ++i) {
+        Add(perf[i], counts->values[i]);
+      }
+      perf_present.store(perf_present.load(std::memory_order_relaxed) | counts->present,
+                         std::memory_order_relaxed);
+    }
+    if (memory) {
+      Add(allocated_bytes, static_cast<uint64_t>(memory->allocated_bytes));
+      Add(copied_bytes, static_cast<uint64_t>(memory->copied_bytes));
+      Add(njs_heap_bytes, static_cast<uint64_t>(memory->njs_heap_bytes));
+    }
+  }
+
+  void ReadInto(SeriesTotals& totals) const {
+    HistogramSnapshot& latency = totals.latency_ns;
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+      latency.counts[bucket] += buckets[bucket].load(std::memory_order_relaxed);
+    }
+    latency.count += count.load(std::memory_order_relaxed);
+    latency.sum += sum.load(std::memory_order_relaxed);
+    latency.max = std::max(latency.max, max.load(std::memory_order_relaxed));
+    totals.cpu_ns += cpu_ns.load(std::memory_order_relaxed);
+    totals.budget_exceeded += budget_exceeded.load(std::memory_order_relaxed);
+    totals.rows_in += rows_in.load(std::memory_order_relaxed);
+    totals.rows_out += rows_out.load(std::memory_order_relaxed);
+    totals.perf.present |= perf_present.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      totals.perf.values[i] += perf[i].load(std::memory_order_relaxed);
+    }
+    totals.allocated_bytes += allocated_bytes.load(std::memory_order_relaxed);
+    totals.copied_bytes += copied_bytes.load(std::memory_order_relaxed);
+    totals.njs_heap_bytes += njs_heap_bytes.load(std::memory_order_relaxed);
+  }
+
+  Series* const series;                // Valid while !forgotten (registry lock)
+  std::atomic<bool> forgotten{false};  // Series dropped by ForgetPlan
+  std::array<std::atomic<uint64_t>, HistogramSnapshot::kBucketCount> buckets{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> max{0};
+  std::atomic<uint64_t> cpu_ns{0};           // njs modules
+  std::atomic<uint64_t> budget_exceeded{0};  // njs modules
+  std::atomic<uint64_t> rows_in{0};
+  std::atomic<uint64_t> rows_out{0};
+  std::array<std::atomic<uint64_t>, kPerfCounterCount> perf{};
+  std::atomic<uint32_t> perf_present{0};
+  std::atomic<uint64_t> allocated_bytes{0};
+  std::atomic<uint64_t> copied_bytes{0};
+  std::atomic<uint64_t> njs_heap_bytes{0};
+};
+
+// One series: the cells of threads recording into it, plus the folded
+// totals of threads that have exited (allocated on the first exit)
+struct Series {
+  SeriesKind kind = SeriesKind::kNode;
+  std::string plan;
+  std::string node;
+  std::string op;
+  std::vector<std::shared_ptr<SeriesCells>> live;
+  std::unique_ptr<SeriesTotals> retired;
+
+  SeriesTotals Totals() const {
+    SeriesTotals totals = retired ? *retired : SeriesTotals{};
+    for (const auto& cells : live) {
+      cells->ReadInto(totals);
+    }
+    return totals;
+  }
+};
+
+// Sorts by (kind, plan, node, op): '\0' orders below any label character
+void AssignSeriesKey(std::string& key, SeriesKind kind, const std::string& plan,
+                     const std::string& node, const std::string& op) {
+  key.assign(1, static_cast<char>(kind)).append(plan).append(1, '\0').append(node);
+  key.append(1, '\0').append(op);
+}
+
+// Labels of the series that absorbs records past the series cap
+constexpr const char* kOverflowLabel = "_overflow";
+
+// Default cap on distinct series (node and njs module)
+constexpr size_t kDefaultMaxSeries = 4096;
+
+// A thread's cells, folded into their series when the thread exits
+struct ThreadShard {
+  ~ThreadShard();
+
+  std::unordered_map<std::string, SeriesCells*> by_key;  // Requested series key
+  std::unordered_map<const Series*, std::shared_ptr<SeriesCells>> by_series;
+  std::string key;          // Scratch for lookups
+  uint64_t generation = 0;  // Registry generation the cache reflects
+};
+
+// Escape a Prometheus label value
+std::string LabelValue(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+class MetricsRegistry {
+ public:
+  ~MetricsRegistry() { StopExport(); }
+
+  // Thread-local cache in front of the shared map; only first sightings lock
+  SeriesCells& Local(SeriesKind kind, const std::string& plan, const std::string& node,
+                     const std::string& op) {
+    thread_local ThreadShard shard;
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (shard.generation != generation) {
+      // ForgetPlan ran: release cells of dropped series
+      std::erase_if(shard.by_key, [](const auto& entry) {
+        return entry.second->forgotten.load(std::memory_order_relaxed);
+      });
+      std::erase_if(shard.by_series, [](const auto& entry) {
+        return entry.second->forgotten.load(std::memory_order_relaxed);
+      });
+      shard.generation = generation;
+    }
+    AssignSeriesKey(shard.key, kind, plan, node, op);
+    auto it = shard.by_key.find(shard.key);
+    if (it != shard.by_key.end()) {
+      return *it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    Series& series = FindOrCreate(kind, plan, node, op);
+    std::shared_ptr<SeriesCells>& cells = shard.by_series[&series];
+    if (!cells) {
+      // Requested keys that overflow share the thread's one overflow cells
+      cells = std::make_shared<SeriesCells>(&series);
+      series.live.push_back(cells);
+    }
+    shard.by_key.emplace(shard.key, cells.get());
+    return *cells;
+  }
+
+  // Fold an exiting thread's cells into their series
+  void Retire(ThreadShard& shard) {
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (auto& entry : shard.by_series) {
+      const std::shared_ptr<SeriesCells>& cells = entry.second;
+      if (cells->forgotten.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      Series& series = *cells->series;
+      if (!series.retired) {
+        series.retired = std::make_unique<SeriesTotals>();
+      }
+      cells->ReadInto(*series.retired);
+      std::erase(series.live, cells);
+    }
+  }
+
+  void ForgetPlan(const std::string& plan) {
+    {
+      std::lock_guard<std::mutex> lock(series_mutex_);
+      std::erase_if(series_, [&](auto& entry) {
+        const Series& series = entry.second;
+        if (series.kind != SeriesKind::kNode || series.plan != plan) {
+          return false;
+        }
+        for (const auto& cells : series.live) {
+          cells->forgotten.store(true, std::memory_order_relaxed);
+        }
+        return true;
+      });
+    }
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  void SetMaxSeries(size_t max_series) {
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    max_series_ = max_series;
+  }
+
+  std::vector<NodeMetrics> Snapshot() {
+    std::vector<NodeMetrics> result;
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (const auto& [key, series] : series_) {
+      if (series.kind != SeriesKind::kNode) {
+        continue;
+      }
+      SeriesTotals totals = series.Totals();
+      NodeMetrics& metrics = result.emplace_back();
+      metrics.plan_name = series.plan;
+      metrics.node_id = series.node;
+      metrics.op = series.op;
+      metrics.latency_ns = std::move(totals.latency_ns);
+      metrics.rows_in = totals.rows_in;
+      metrics.rows_out = totals.rows_out;
+      metrics.perf = totals.perf;
+      metrics.allocated_bytes = totals.allocated_bytes;
+      metrics.copied_bytes = totals.copied_bytes;
+      metrics.njs_heap_bytes = totals.njs_heap_bytes;
+    }
+    return result;
+  }
+
+  std::vector<NjsModuleMetrics> NjsModuleSnapshot() {
+    std::vector<NjsModuleMetrics> result;
+    std::lock_guard<std::mutex> lock(series_mutex_);
+    for (const auto& [key, series] : series_) {
+      if (series.kind != SeriesKind::kNjsModule) {
+        continue;
+      }
+      SeriesTotals totals = series.Totals();
+      NjsModuleMetrics& metrics = result.emplace_back();
+      metrics.module = series.node;
+      metrics.latency_ns = std::move(totals.latency_ns);
+      metrics.cpu_ns = totals.cpu_ns;
+      metrics.budget_exceeded = totals.budget_exceeded;
+    }
+    return result;
+  }
+
+  void WritePrometheus(std::ostream& out) {
+    static constexpr std::pair<const char*, double> kQuantiles[] = {
+        {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+
+    std::vector<NodeMetrics> snapshot = Snapshot();
+    std::vector<std::string> labels;
+    labels.reserve(snapshot.size());
+    for (const auto& metrics : snapshot) {
+      labels.push_back(fmt::format("plan=\"{}\",node=\"{}\",op=\"{}\"",
+                                   LabelValue(metrics.plan_name), LabelValue(metrics.node_id),
+                                   LabelValue(metrics.op)));
+    }
+
+    out << "# HELP rankdsl_node_latency_seconds Node execution latency.\n"
+        << "# TYPE rankdsl_node_latency_seconds summary\n";
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+      const HistogramSnapshot& latency = snapshot[i].latency_ns;
+      for (const auto& [name, q] : kQuantiles) {
+        out << fmt::format("rankdsl_node_latency_seconds{{{},quantile=\"{}\"}} {:.9f}\n",
+                           labels[i], name, latency.ValueAtQuantile(q) / 1e9);
+      }
+      out << fmt::format("rankdsl_node_latency_seconds_sum{{{}}} {:.9f}\n", labels[i],
+                         latency.sum / 1e9);
+      out << fmt::format("rankdsl_node_latency_seconds_count{{{}}} {}\n", labels[i], latency.count);
+    }
+
+    auto write_counter = [&](const char* name, const char* help, uint64_t NodeMetrics::*field) {
+      out << fmt::format("# HELP {0} {1}\n# TYPE {0} counter\n", name, help);
+      for (size_t i = 0; i < snapshot.size(); ++i) {
+        out << fmt::format("{}{{{}}} {}\n", name, labels[i], snapshot[i].*field);
+      }
+    };
+    write_counter("rankdsl_node_rows_in_total", "Rows received by the node.",
+                  &NodeMetrics::rows_in);
+    write_counter("rankdsl_node_rows_out_total", "Rows produced by the node.",
+                  &NodeMetrics::rows_out);
+    write_counter("rankdsl_node_allocated_bytes_total", "Column bytes the node allocated.",
+                  &NodeMetrics::allocated_bytes);
+    write_counter("rankdsl_node_copied_bytes_total",
+                  "Allocated column bytes replacing an input column of the same key.",
+                  &NodeMetrics::copied_bytes);
+    write_counter("rankdsl_node_njs_heap_bytes_total", "JavaScript heap growth in the node.",
+                  &NodeMetrics::njs_heap_bytes);
+
+    for (size_t c = 0; c < kPerfCounterCount; ++c) {
+      auto counter = static_cast<PerfCounter>(c);
+      bool header = false;
+      for (size_t i = 0; i < snapshot.size(); ++i) {
+        if (!snapshot[i].perf.Has(counter)) {
+          continue;
+        }
+        if (!header) {
+          out << fmt::format("# HELP rankdsl_node_perf_{0}_total Hardware {0} in the node.\n"
+                             "# TYPE rankdsl_node_perf_{0}_total counter\n",
+                             PerfCounterName(counter));
+          header = true;
+        }
+        out << fmt::format("rankdsl_node_perf_{}_total{{{}}} {}\n", PerfCounterName(counter),
+                           labels[i], snapshot[i].perf.Get(counter));
+      }
+    }
+
+    std::vector<NjsModuleMetrics> modules = NjsModuleSnapshot();
+    if (modules.empty()) {
+      return;
+    }
+    out << "# HELP rankdsl_njs_module_latency_seconds njs module execution latency.\n"
+        << "# TYPE rankdsl_njs_module_latency_seconds summary\n";
+    for (const auto& module : modules) {
+      std::string label = fmt::format("module=\"{}\"", LabelValue(module.module));
+      for (const auto& [name, q] : kQuantiles) {
+        out << fmt::format("rankdsl_njs_module_latency_seconds{{{},quantile=\"{}\"}} {:.9f}\n",
+                           label, name, module.latency_ns.ValueAtQuantile(q) / 1e9);
+      }
+      out << fmt::format("rankdsl_njs_module_latency_seconds_sum{{{}}} {:.9f}\n", label,
+                         module.latency_ns.sum / 1e9);
+      out << fmt::format("rankdsl_njs_module_latency_seconds_count{{{}}} {}\n", label,
+                         module.latency_ns.count);
+    }
+    out << "# HELP rankdsl_njs_module_cpu_seconds_total Thread CPU time in the module.\n"
+        << "# TYPE rankdsl_njs_module_cpu_seconds_total counter\n";
+    for (const auto& module : modules) {
+      out << fmt::format("rankdsl_njs_module_cpu_seconds_total{{module=\"{}\"}} {:.9f}\n",
+                         LabelValue(module.module), module.cpu_ns / 1e9);
+    }
+    out << "# HELP rankdsl_njs_module_budget_exceeded_total Executions aborted by the CPU "
+           "budget or request deadline.\n"
+        << "# TYPE rankdsl_njs_module_budget_exceeded_total counter\n";
+    for (const auto& module : modules) {
+      out << fmt::format("rankdsl_njs_module_budget_exceeded_total{{module=\"{}\"}} {}\n",
+                         LabelValue(module.module), module.budget_exceeded);
+    }
+  }
+
+  bool WriteFile(const std::string& path, std::string* error_out = nullptr) {
+    std::string temp_path = path + ".tmp";
+    {
+      std::ofstream out(temp_path, std::ios::trunc);
+      if (!out) {
+        if (error_out) {
+          *error_out = "Cannot write metrics file: " + temp_path;
+        }
+        return false;
+      }
+      WritePrometheus(out);
+      if (!out.flush()) {
+        if (error_out) {
+          *error_out = "Failed writing metrics file: " + temp_path;
+        }
+        return false;
+      }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      if (error_out) {
+        *error_out = "Cannot replace metrics file: " + path;
+      }
+      std::remove(temp_path.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool StartExport(const MetricsExportOptions& options, std::string* error_out) {
+    if (!WriteFile(options.path, error_out)) {
+      return false;
+    }
+    StopExport();
+    std::lock_guard<std::mutex> lock(export_mutex_);
+    export_options_ = options;
+    stop_ = false;
+    export_thread_ = std::thread([this] { RunExport(); });
+    return true;
+  }
+
+  void StopExport() {
+    std::thread thread;
+    std::string path;
+    {
+      std::lock_guard<std::mutex> lock(export_mutex_);
+      stop_ = true;
+      thread.swap(export_thread_);
+      path = export_options_.path;
+    }
+    wake_.notify_one();
+    if (thread.joinable()) {
+      thread.join();
+      WriteFile(path);
+    }
+  }
+
+ private:
+  void RunExport() {
+    std::unique_lock<std::mutex> lock(export_mutex_);
+    while (!stop_) {
+      auto interval = std::max(export_options_.interval, std::chrono::milliseconds(1));
+      if (wake_.wait_for(lock, interval, [&] { return stop_; })) {
+        break;
+      }
+      std::string path = export_options_.path;
+      lock.unlock();
+      WriteFile(path);
+      lock.lock();
+    }
+  }
+
+  // Series past the cap record into an overflow series (one per kind)
+  Series& FindOrCreate(SeriesKind kind, const std::string& plan, const std::string& node,
+                       const std::string& op) {
+    std::string key;
+    AssignSeriesKey(key, kind, plan, node, op);
+    auto it = series_.find(key);
+    if (it != series_.end()) {
+      return it->second;
+    }
+    if (series_.size() >= max_series_ && node != kOverflowLabel) {
+      return kind == SeriesKind::kNode
+                 ? FindOrCreate(kind, kOverflowLabel, kOverflowLabel, kOverflowLabel)
+                 : FindOrCreate(kind, plan, kOverflowLabel, op);
+    }
+    Series& series = series_[key];
+    series.kind = kind;
+    series.plan = plan;
+    series.node = node;
+    series.op = op;
+    return series;
+  }
+
+  std::mutex series_mutex_;
+  std::map<std::string, Series> series_;  // By SeriesKey
+  size_t max_series_ = kDefaultMaxSeries;
+  std::atomic<uint64_t> generation_{0};  // Bumped by ForgetPlan
+
+  std::mutex export_mutex_;
+  std::condition_variable wake_;
+  MetricsExportOptions export_options_;
+  bool stop_ = false;
+  std::thread export_thread_;
+};
+
+MetricsRegistry& Registry() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+std::atomic<bool> enabled{true};
+
+ThreadShard::~ThreadShard() {
+  Registry().Retire(*this);
+}
+
+}  // namespace
+
+void Metrics::RecordNode(const std::string& plan_name,
+                         const std::string& node_id,
+                         const std::string& op,
+                         std::chrono::nanoseconds duration,
+                         size_t rows_in,
+                         size_t rows_out,
+                         const PerfCounts* perf,
+                         const NodeMemoryStats* memory) {
+  if (!enabled.load(std::memory_order_relaxed)) return;
+
+  uint64_t duration_ns = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+  Registry()
+      .Local(SeriesKind::kNode, plan_name, node_id, op)
+      .Record(duration_ns, rows_in, rows_out, perf, memory);
+}
+
+void Metrics::RecordNjsModule(const std::string& module,
+                              std::chrono::nanoseconds wall,
+                              std::chrono::nanoseconds cpu,
+                              bool budget_exceeded) {
+  if (!enabled.load(std::memory_order_relaxed)) return;
+
+  SeriesCells& cells = Registry().Local(SeriesKind::kNjsModule, "", module, "njs");
+  cells.RecordLatency(static_cast<uint64_t>(std::max<int64_t>(wall.count(), 0)));
+  SeriesCells::Add(cells.cpu_ns, static_cast<uint64_t>(std::max<int64_t>(cpu.count(), 0)));
+  if (budget_exceeded) {
+    SeriesCells::Add(cells.budget_exceeded, 1);
+  }
+}
+
+std::vector<NodeMetrics> Metrics::Snapshot() {
+  return Registry().Snapshot();
+}
+
+std::vector<NjsModuleMetrics> Metrics::NjsModuleSnapshot() {
+  return Registry().NjsModuleSnapshot();
+}
+
+void Metrics::WritePrometheus(std::ostream& out) {
+  Registry().WritePrometheus(out);
+}
+
+bool Metrics::WritePrometheusFile(const std::string& path, std::string* error_out) {
+  return Registry().WriteFile(path, error_out);
+}
+
+bool Metrics::StartExport(const MetricsExportOptions& options, std::string* error_out) {
+  return Registry().StartExport(options, error_out);
+}
+
+void Metrics::StopExport() {
+  Registry().StopExport();
+}
+
+void Metrics::ForgetPlan(const std::string& plan_name) {
+  Registry().ForgetPlan(plan_name);
+}
+
+void Metrics::SetMaxSeries(size_t max_series) {
+  Registry().SetMaxSeries(max_series);
+}
+
+void Metrics::SetEnabled(bool value) {
+  enabled.store(value, std::memory_order_relaxed);
+}
+
+bool Metrics::IsEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "logging/perf_counters.h"
+#include "object/memory_stats.h"
+
+namespace ranking_dsl {
+
+/**
+ * Merged view of a latency histogram (values in nanoseconds).
+ *
+ * Buckets are log-linear (HDR-style): exact below 64 ns, then 32
+ * sub-buckets per power of two, so any recorded value is reported within
+ * 1/32 (~3%) of its true value. Values above kMaxValue are clamped.
+ */
+struct HistogramSnapshot {
+  static constexpr int kSubBucketBits = 5;
+  static constexpr uint64_t kMaxValue = (uint64_t{1} << 40) - 1;  // ~18 minutes
+  static constexpr size_t kBucketCount = (40 - kSubBucketBits + 1) << kSubBucketBits;
+
+  std::vector<uint64_t> counts = std::vector<uint64_t>(kBucketCount, 0);
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  /**
+   * Bucket holding value (clamped to kMaxValue).
+   */
+  static size_t BucketOf(uint64_t value);
+
+  /**
+   * Highest value that falls in bucket.
+   */
+  static uint64_t BucketMax(size_t bucket);
+
+  /**
+   * Value at quantile q in [0, 1] (0 when empty): the highest value of the
+   * bucket holding the q-th recorded value, capped at the recorded max.
+   */
+  uint64_t ValueAtQuantile(double q) const;
+
+  /**
+   * Add one value (single writer; for histograms kept outside Metrics).
+   */
+  void Record(uint64_t value);
+
+  void Merge(const HistogramSnapshot& other);
+};
+
+/**
+ * Aggregated metrics of one (plan, node, op) series, merged across threads.
+ */
+struct NodeMetrics {
+  std::string plan_name;
+  std::string node_id;
+  std::string op;
+  HistogramSnapshot latency_ns;
+  uint64_t rows_in = 0;
+  uint64_t rows_out = 0;
+  PerfCounts perf;  // Hardware counter totals (only counters ever sampled)
+  uint64_t allocated_bytes = 0;
+  uint64_t copied_bytes = 0;
+  uint64_t njs_heap_bytes = 0;
+};
+
+/**
+ * Aggregated executions of one njs module, merged across threads. Keyed by
+ * "name@version" (or the module path when meta.name is empty).
+ */
+struct NjsModuleMetrics {
+  std::string module;
+  HistogramSnapshot latency_ns;  // Wall time per execution
+  uint64_t cpu_ns = 0;           // Thread CPU time, all executions
+  uint64_t budget_exceeded = 0;  // Executions aborted by CPU budget or deadline
+};
+
+/**
+ * Periodic Prometheus text export.
+ */
+struct MetricsExportOptions {
+  std::string path;                                   // Replaced atomically on each export
+  std::chrono::milliseconds interval{10000};
+};
+
+/**
+ * Metrics - in-process aggregate node metrics.
+ *
+ * Each thread records into its own shard of per-series histograms and
+ * counters (single-writer atomics, no locks once a thread has seen a
+ * series); readers merge every shard on demand. A thread's shard is folded
+ * into one retired total per series when the thread exits. Series are keyed
+ * by (plan, node, op); fused chains record as one "fused" series.
+ *
+ * Series are bounded: past SetMaxSeries distinct series, new ones record
+ * into a shared "_overflow" series, and ForgetPlan drops a plan's series
+ * (e.g. when the plan is unloaded).
+ */
+class Metrics {
+ public:
+  /**
+   * Record one node execution.
+   * @param perf Optional hardware counter deltas for the node
+   * @param memory Optional memory accounting for the node
+   */
+  static void RecordNode(const std::string& plan_name,
+                         const std::string& node_id,
+                         const std::string& op,
+                         std::chrono::nanoseconds duration,
+                         size_t rows_in,
+                         size_t rows_out,
+                         const PerfCounts* perf = nullptr,
+                         const NodeMemoryStats* memory = nullptr);
+
+  /**
+   * Record one njs module execution (NjsRunner calls this whether the
+   * module returned or was aborted).
+   */
+  static void RecordNjsModule(const std::string& module,
+                              std::chrono::nanoseconds wall,
+                              std::chrono::nanoseconds cpu,
+                              bool budget_exceeded);
+
+  /**
+   * Every series, merged across threads, sorted by (plan, node, op).
+   */
+  static std::vector<NodeMetrics> Snapshot();
+
+  /**
+   * Every njs module series, merged across threads, sorted by module.
+   */
+  static std::vector<NjsModuleMetrics> NjsModuleSnapshot();
+
+  /**
+   * Write the merged metrics in Prometheus text exposition format:
+   * a rankdsl_node_latency_seconds summary (p50/p90/p99/p999),
+   * rankdsl_node_rows_{in,out}_total and
+   * rankdsl_node_{allocated,copied,njs_heap}_bytes_total counters, for
+   * sampled hardware counters rankdsl_node_perf_<counter>_total, and per njs
+   * module rankdsl_njs_module_latency_seconds,
+   * rankdsl_njs_module_cpu_seconds_total and
+   * rankdsl_njs_module_budget_exceeded_total.
+   */
+  static void WritePrometheus(std::ostream& out);
+
+  /**
+   * WritePrometheus to path via a temporary file and rename, so scrapers
+   * (e.g. a node_exporter textfile collector) never see a partial file.
+   */
+  static bool WritePrometheusFile(const std::string& path, std::string* error_out = nullptr);
+
+  /**
+   * Start (or retarget) a background thread that writes the file every
+   * interval. Fails if the file cannot be written.
+   */
+  static bool StartExport(const MetricsExportOptions& options, std::string* error_out = nullptr);
+
+  /**
+   * Stop the export thread after one final write.
+   */
+  static void StopExport();
+
+  /**
+   * Drop every node series of plan_name. Threads release their cells for
+   * it on their next record.
+   */
+  static void ForgetPlan(const std::string& plan_name);
+
+  /**
+   * Cap on distinct series (default 4096). Series first seen past the cap
+   * record into plan="_overflow",node="_overflow",op="_overflow" (njs
+   * modules into module="_overflow").
+   */
+  static void SetMaxSeries(size_t max_series);
+
+  /**
+   * Enable/disable recording (enabled by default).
+   */
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+};
+
+}  // namespace ranking_dsl
@@ -0,0 +1,183 @@
+#include "logging/perf_counters.h"
+
+#include <ctime>
+#include <memory>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace ranking_dsl {
+
+const char* PerfCounterName(PerfCounter counter) {
+  switch (counter) {
+    case PerfCounter::kCycles: return "cycles";
+    case PerfCounter::kInstructions: return "instructions";
+    case PerfCounter::kCacheMisses: return "cache_misses";
+    case PerfCounter::kBranchMisses: return "branch_misses";
+    case PerfCounter::kLlcLoads: return "llc_loads";
+  }
+  return "unknown";
+}
+
+int64_t ThreadCpuNanos() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+  return static_cast<int64_t>(std::clock() * (1e9 / CLOCKS_PER_SEC));  // Process-wide fallback
+#endif
+}
+
+double ThreadCpuMs() {
+  return static_cast<double>(ThreadCpuNanos()) / 1e6;
+}
+
+PerfCounts PerfCounts::Delta(const PerfCounts& start, const PerfCounts& end) {
+  PerfCounts delta;
+  for (size_t i = 0; i < kPerfCounterCount; ++i) {
+    auto counter = static_cast<PerfCounter>(i);
+    if (start.Has(counter) && end.Has(counter)) {
+      // Multiplexing scale-up can make consecutive estimates dip slightly
+      uint64_t a = start.Get(counter);
+      uint64_t b = end.Get(counter);
+      delta.Set(counter, b > a ? b - a : 0);
+    }
+  }
+  return delta;
+}
+
+PerfCounterGroup* PerfCounterGroup::ForCurrentThread(std::string* error_out) {
+  struct Slot {
+    std::unique_ptr<PerfCounterGroup> group;
+    std::string error;
+    bool tried = false;
+  };
+  thread_local Slot slot;
+  if (!slot.tried) {
+    slot.tried = true;
+    std::unique_ptr<PerfCounterGroup> group(new PerfCounterGroup());
+    if (group->Open(&slot.error)) {
+      slot.group = std::move(group);
+    }
+  }
+  if (!slot.group && error_out) {
+    *error_out = slot.error;
+  }
+  return slot.group.get();
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct CounterConfig {
+  PerfCounter counter;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr CounterConfig kCounterConfigs[kPerfCounterCount] = {
+    {PerfCounter::kCycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PerfCounter::kInstructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PerfCounter::kCacheMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PerfCounter::kBranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PerfCounter::kLlcLoads, PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16)},
+};
+
+int OpenCounter(const CounterConfig& config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = config.type;
+  attr.config = config.config;
+  attr.exclude_kernel = 1;  // Allowed at perf_event_paranoid <= 2
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Calling thread, any CPU
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+}  // namespace
+
+bool PerfCounterGroup::Open(std::string* error_out) {
+  int first_errno = 0;
+  for (const auto& config : kCounterConfigs) {
+    int fd = OpenCounter(config, leader_fd_);
+    if (fd < 0) {
+      first_errno = first_errno ? first_errno : errno;
+      continue;
+    }
+    if (leader_fd_ < 0) {
+      leader_fd_ = fd;
+    }
+    fds_[static_cast<size_t>(config.counter)] = fd;
+    read_order_[open_count_++] = config.counter;
+  }
+  if (open_count_ == 0) {
+    if (error_out) {
+      *error_out = std::string("perf_event_open failed: ") + std::strerror(first_errno);
+    }
+    return false;
+  }
+  return true;
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+bool PerfCounterGroup::Read(PerfCounts& out) const {
+  // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr]
+  uint64_t buffer[3 + kPerfCounterCount];
+  ssize_t size = read(leader_fd_, buffer, sizeof(buffer));
+  if (size < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != open_count_) {
+    return false;
+  }
+  uint64_t enabled = buffer[1];
+  uint64_t running = buffer[2];
+  out = PerfCounts{};
+  if (running == 0) {
+    return true;  // Not scheduled yet: every counter absent
+  }
+  for (size_t i = 0; i < open_count_; ++i) {
+    uint64_t value = buffer[3 + i];
+    if (running < enabled) {
+      value = static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+    }
+    out.Set(read_order_[i], value);
+  }
+  return true;
+}
+
+#else
+
+bool PerfCounterGroup::Open(std::string* error_out) {
+  if (error_out) {
+    *error_out = "hardware counters require Linux perf_event_open";
+  }
+  return false;
+}
+
+PerfCounterGroup::~PerfCounterGroup() = default;
+
+bool PerfCounterGroup::Read(PerfCounts&) const {
+  return false;
+}
+
+#endif
+
+}  // namespace ranking_dsl
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ranking_dsl {
+
+/**
+ * Hardware counters sampled per node.
+ */
+enum class PerfCounter : uint8_t {
+  kCycles,
+  kInstructions,
+  kCacheMisses,
+  kBranchMisses,
+  kLlcLoads,
+};
+
+inline constexpr size_t kPerfCounterCount = 5;
+
+/**
+ * Trace / metrics name of a counter ("cycles", "llc_loads", ...).
+ */
+const char* PerfCounterName(PerfCounter counter);
+
+/**
+ * CPU time consumed by the calling thread (process-wide where the platform
+ * has no per-thread clock).
+ */
+int64_t ThreadCpuNanos();
+double ThreadCpuMs();
+
+/**
+ * Counter values; counters the host could not open are absent.
+ */
+struct PerfCounts {
+  std::array<uint64_t, kPerfCounterCount> values{};
+  uint32_t present = 0;  // Bit per PerfCounter
+
+  bool Has(PerfCounter counter) const {
+    return present & (1u << static_cast<uint32_t>(counter));
+  }
+  uint64_t Get(PerfCounter counter) const { return values[static_cast<size_t>(counter)]; }
+  void Set(PerfCounter counter, uint64_t value) {
+    values[static_cast<size_t>(counter)] = value;
+    present |= 1u << static_cast<uint32_t>(counter);
+  }
+
+  /**
+   * Counts between two reads of the same group (end - start).
+   */
+  static PerfCounts Delta(const PerfCounts& start, const PerfCounts& end);
+};
+
+/**
+ * PerfCounterGroup - the calling thread's hardware counters (Linux
+ * perf_event_open, user space only).
+ *
+ * Counters are opened as one group so a single read() returns all of them,
+ * scaled for multiplexing. Counters the CPU or VM does not expose are left
+ * out; if none can be opened (non-Linux, perf_event_paranoid, seccomp) the
+ * group is unavailable and callers run without counters.
+ */
+class PerfCounterGroup {
+ public:
+  /**
+   * The calling thread's group, opened on first use.
+   * Returns nullptr (with the reason in error_out) if no counter is available.
+   */
+  static PerfCounterGroup* ForCurrentThread(std::string* error_out = nullptr);
+
+  ~PerfCounterGroup();
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+  /**
+   * Current totals of every open counter.
+   */
+  bool Read(PerfCounts& out) const;
+
+ private:
+  PerfCounterGroup() = default;
+  bool Open(std::string* error_out);
+
+  int leader_fd_ = -1;
+  std::array<int, kPerfCounterCount> fds_{-1, -1, -1, -1, -1};
+  std::array<PerfCounter, kPerfCounterCount> read_order_{};  // Counter of each group value
+  size_t open_count_ = 0;
+};
+
+}  // namespace ranking_dsl
@@ -1,13 +1,583 @@
 #include "logging/trace.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
 
+#include "object/column_batch.h"
+
 namespace ranking_dsl {
 
-bool Tracer::enabled_ = true;
+namespace {
+
+enum class TraceEvent : uint8_t { kNodeStart, kNodeEnd, kRequestEnd };
+
+// One logged event; strings are IDs in the intern table (0 = empty)
+struct TraceRecord {
+  TraceEvent event;
+  uint32_t plan;
+  uint32_t node;
+  uint32_t op;
+  uint32_t trace_key;
+  uint32_t trace_prefix;
+  uint32_t njs_file;
+  uint32_t error;
+  int64_t ts_ns;  // Since the tracer started
+  double duration_ms;
+  uint64_t rows_in;
+  uint64_t rows_out;
+  PerfCounts perf;
+  bool has_memory;
+  NodeMemoryStats memory;  // kRequestEnd: allocated total, live_bytes = peak
+};
+
+nlohmann::json PerfToJson(const PerfCounts& perf) {
+  nlohmann::json counters = nlohmann::json::object();
+  for (size_t i = 0; i < kPerfCounterCount; ++i) {
+    auto counter = static_cast<PerfCounter>(i);
+    if (perf.Has(counter)) {
+      counters[PerfCounterName(counter)] = perf.Get(counter);
+    }
+  }
+  return counters;
+}
+
+nlohmann::json MemoryToJson(const NodeMemoryStats& memory) {
+  nlohmann::json bytes;
+  bytes["allocated_bytes"] = memory.allocated_bytes;
+  bytes["copied_bytes"] = memory.copied_bytes;
+  bytes["shared_bytes"] = memory.shared_bytes;
+  if (memory.njs_heap_bytes) {
+    bytes["njs_heap_bytes"] = memory.njs_heap_bytes;
+  }
+  if (memory.live_bytes >= 0) {
+    bytes["live_bytes"] = memory.live_bytes;
+  }
+  return bytes;
+}
+
+// Columns of a sampled batch, shared with the request
+struct SampleDump {
+  uint32_t plan = 0;
+  uint32_t node = 0;
+  uint32_t tid = 0;
+  int64_t ts_ns = 0;
+  size_t rows = 0;
+  std::vector<std::pair<int32_t, TypedColumnPtr>> columns;
+};
+
+nlohmann::json ValueToJson(const Value& value) {
+  return std::visit(
+      [](auto&& v) -> nlohmann::json {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, NullValue>) {
+          return nullptr;
+        } else {
+          return v;
+        }
+      },
+      value);
+}
+
+// Single-producer (owning thread), single-consumer (drain) ring
+struct TraceRing {
+  TraceRing(size_t capacity, uint32_t tid) : records(capacity), tid(tid) {}
+
+  bool Push(const TraceRecord& record) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= records.size()) {
+      return false;
+    }
+    records[head % records.size()] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Fn>
+  void Drain(Fn&& fn) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (; tail < head; ++tail) {
+      fn(records[tail % records.size()]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  std::vector<TraceRecord> records;
+  const uint32_t tid;
+  std::atomic<bool> closed{false};  // Owning thread has exited
+
+ private:
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+};
+
+class TraceWriter {
+ public:
+  TraceWriter() : epoch_(std::chrono::steady_clock::now()) {
+    strings_.emplace_back();  // ID 0
+  }
+
+  ~TraceWriter() {
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    FinishOutput();
+  }
+
+  int64_t Now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch_)
+        .count();
+  }
+
+  void Record(TraceRecord& record) {
+    record.ts_ns = Now();
+    if (!LocalRing().Push(record)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Sampled requests only, so a locked queue is fine here. Bounded: each
+  // dump keeps its request's columns alive until the writer gets to it.
+  void RecordDump(SampleDump dump) {
+    dump.tid = LocalRing().tid;  // Also starts the writer
+    std::lock_guard<std::mutex> lock(dumps_mutex_);
+    if (dumps_.size() >= dump_capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    dumps_.push_back(std::move(dump));
+  }
+
+  // Thread-local cache in front of the shared table; only first sightings lock
+  uint32_t Intern(const std::string& value) {
+    if (value.empty()) {
+      return 0;
+    }
+    thread_local std::unordered_map<std::string, uint32_t> cache;
+    auto it = cache.find(value);
+    if (it != cache.end()) {
+      return it->second;
+    }
+    std::lock_guard<std::mutex> lock(strings_mutex_);
+    auto [shared, inserted] =
+        string_ids_.try_emplace(value, static_cast<uint32_t>(strings_.size()));
+    if (inserted) {
+      strings_.push_back(value);
+    }
+    cache.emplace(value, shared->second);
+    return shared->second;
+  }
+
+  void Configure(const TraceOptions& options) {
+    {
+      // Finish the previous stream before anything is written to the new one
+      std::lock_guard<std::mutex> lock(drain_mutex_);
+      FinishOutput();
+
+      std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+      options_ = options;
+      reconfigured_ = true;
+    }
+    {
+      std::lock_guard<std::mutex> lock(dumps_mutex_);
+      dump_capacity_ = std::max<size_t>(options.dump_queue_capacity, 1);
+    }
+    wake_.notify_one();
+  }
+
+  void Flush() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    FlushLocked();
+  }
+
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  double RequestSampleRate() {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    return options_.request_sample_rate;
+  }
+
+ private:
+  // Closes the thread's ring when the thread exits
+  struct RingHolder {
+    std::shared_ptr<TraceRing> ring;
+    ~RingHolder() {
+      if (ring) {
+        ring->closed.store(true);
+      }
+    }
+  };
+
+  // Requires drain_mutex_
+  void FlushLocked() {
+    std::string batch;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+      std::lock_guard<std::mutex> rings_lock(rings_mutex_);
+      rings = rings_;
+      std::erase_if(rings_, [](const auto& ring) { return ring->closed.load(); });
+    }
+    std::vector<SampleDump> dumps;
+    {
+      std::lock_guard<std::mutex> dumps_lock(dumps_mutex_);
+      dumps.swap(dumps_);
+    }
+    size_t dump_rows;
+    {
+      std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+      dump_rows = options_.sample_dump_rows;
+      chrome_ = options_.format == TraceFormat::kChromeTrace;
+    }
+    {
+      std::lock_guard<std::mutex> strings_lock(strings_mutex_);
+      for (const auto& ring : rings) {
+        ring->Drain([&](const TraceRecord& record) { Format(record, ring->tid, batch); });
+      }
+      for (const auto& dump : dumps) {
+        FormatDump(dump, dump_rows, batch);
+      }
+    }
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped > reported_drops_) {
+      nlohmann::json log;
+      if (chrome_) {
+        log = ChromeEvent("trace_dropped", "i", Now());
+        log["s"] = "g";
+        log["args"]["count"] = dropped - reported_drops_;
+      } else {
+        log["event"] = "trace_dropped";
+        log["count"] = dropped - reported_drops_;
+      }
+      Append(log, batch);
+      reported_drops_ = dropped;
+    }
+    Write(batch);
+  }
+
+  // Writes pending events and closes an open Chrome trace array; requires drain_mutex_
+  void FinishOutput() {
+    FlushLocked();
+    if (array_open_) {
+      Write("\n]\n");
+      array_open_ = false;
+    }
+    named_tids_.clear();
+  }
+
+  // Requires drain_mutex_
+  void Write(const std::string& batch) {
+    if (batch.empty()) {
+      return;
+    }
+    std::ostream* out;
+    {
+      std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+      out = options_.out ? options_.out : &std::cout;
+    }
+    out->write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    out->flush();
+  }
+
+  // One JSON line, or one element of the Chrome trace array. The array is
+  // closed on reconfigure; viewers also accept a file cut off after an element.
+  void Append(const nlohmann::json& event, std::string& batch) {
+    if (chrome_) {
+      batch += array_open_ ? ",\n" : "[\n";
+      array_open_ = true;
+      batch += event.dump();
+    } else {
+      batch += event.dump();
+      batch += '\n';
+    }
+  }
+
+  static nlohmann::json ChromeEvent(const std::string& name, const char* phase, int64_t ts_ns,
+                                    uint32_t tid = 0) {
+    nlohmann::json event;
+    event["name"] = name;
+    event["ph"] = phase;
+    event["ts"] = static_cast<double>(ts_ns) / 1000.0;  // Microseconds
+    event["pid"] = 1;
+    event["tid"] = tid;
+    return event;
+  }
+
+  // Names a thread's track the first time it appears in the output
+  void NameTrack(uint32_t tid, std::string& batch) {
+    if (!named_tids_.insert(tid).second) {
+      return;
+    }
+    nlohmann::json event = ChromeEvent("thread_name", "M", 0, tid);
+    event.erase("ts");
+    event["args"]["name"] = fmt::format("rankdsl-{}", tid);
+    Append(event, batch);
+  }
+
+  TraceRing& LocalRing() {
+    thread_local RingHolder holder;
+    if (!holder.ring) {
+      std::lock_guard<std::mutex> lock(rings_mutex_);
+      size_t capacity;
+      {
+        std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+        capacity = std::max<size_t>(options_.ring_capacity, 1);
+        if (!thread_.joinable() && !stop_) {
+          thread_ = std::thread([this] { Run(); });
+        }
+      }
+      holder.ring = std::make_shared<TraceRing>(capacity, next_tid_++);
+      rings_.push_back(holder.ring);
+    }
+    return *holder.ring;
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stop_) {
+      auto woken = [&] { return stop_ || reconfigured_; };
+      if (options_.flush_interval.count() > 0) {
+        wake_.wait_for(lock, options_.flush_interval, woken);
+      } else {
+        wake_.wait(lock, woken);
+      }
+      if (reconfigured_) {
+        reconfigured_ = false;  // Restart the wait with the new interval
+        continue;
+      }
+      lock.unlock();
+      Flush();
+      lock.lock();
+    }
+  }
+
+  void Format(const TraceRecord& record, uint32_t tid, std::string& batch) {
+    if (chrome_) {
+      FormatChrome(record, tid, batch);
+      return;
+    }
+    if (record.event == TraceEvent::kRequestEnd) {
+      nlohmann::json log;
+      log["event"] = "request_end";
+      log["plan_name"] = strings_[record.plan];
+      log["ts_us"] = record.ts_ns / 1000;
+      log["tid"] = tid;
+      log["duration_ms"] = record.duration_ms;
+      log["rows_out"] = record.rows_out;
+      log["allocated_bytes"] = record.memory.allocated_bytes;
+      log["peak_live_bytes"] = record.memory.live_bytes;
+      Append(log, batch);
+      return;
+    }
+    const std::string& op = strings_[record.op];
+    const std::string& trace_key = strings_[record.trace_key];
+
+    nlohmann::json log;
+    log["event"] = record.event == TraceEvent::kNodeStart ? "node_start" : "node_end";
+    log["plan_name"] = strings_[record.plan];
+    log["node_id"] = strings_[record.node];
+    log["op"] = op;
+    log["span_name"] = Tracer::SpanName(op, trace_key);
+    log["ts_us"] = record.ts_ns / 1000;
+    log["tid"] = tid;
+
+    if (record.event == TraceEvent::kNodeEnd) {
+      log["duration_ms"] = record.duration_ms;
+      log["rows_in"] = record.rows_in;
+      log["rows_out"] = record.rows_out;
+    }
+    if (record.trace_key) {
+      log["trace_key"] = trace_key;
+    }
+    if (record.trace_prefix) {
+      log["trace_prefix"] = strings_[record.trace_prefix];
+    }
+    if (record.njs_file) {
+      log["njs_file"] = strings_[record.njs_file];
+    }
+    if (record.error) {
+      log["error"] = strings_[record.error];
+    }
+    if (record.perf.present) {
+      log["perf"] = PerfToJson(record.perf);
+    }
+    if (record.has_memory) {
+      log["memory"] = MemoryToJson(record.memory);
+    }
+
+    Append(log, batch);
+  }
+
+  void FormatChrome(const TraceRecord& record, uint32_t tid, std::string& batch) {
+    NameTrack(tid, batch);
+    if (record.event == TraceEvent::kRequestEnd) {
+      nlohmann::json event = ChromeEvent("request_end", "i", record.ts_ns, tid);
+      event["s"] = "t";
+      event["args"]["plan_name"] = strings_[record.plan];
+      event["args"]["duration_ms"] = record.duration_ms;
+      event["args"]["rows_out"] = record.rows_out;
+      event["args"]["allocated_bytes"] = record.memory.allocated_bytes;
+      event["args"]["peak_live_bytes"] = record.memory.live_bytes;
+      Append(event, batch);
+      return;
+    }
+    const std::string& op = strings_[record.op];
+    const bool start = record.event == TraceEvent::kNodeStart;
+
+    nlohmann::json event = ChromeEvent(Tracer::SpanName(op, strings_[record.trace_key]),
+                                       start ? "B" : "E", record.ts_ns, tid);
+    event["cat"] = op;
+    nlohmann::json& args = event["args"];
+    args["plan_name"] = strings_[record.plan];
+    args["node_id"] = strings_[record.node];
+    if (start) {
+      if (record.trace_key) {
+        args["trace_key"] = strings_[record.trace_key];
+      }
+      if (record.trace_prefix) {
+        args["trace_prefix"] = strings_[record.trace_prefix];
+      }
+      if (record.njs_file) {
+        args["njs_file"] = strings_[record.njs_file];
+      }
+    } else {
+      args["duration_ms"] = record.duration_ms;
+      args["rows_in"] = record.rows_in;
+      args["rows_out"] = record.rows_out;
+      if (record.error) {
+        args["error"] = strings_[record.error];
+      }
+      if (record.perf.present) {
+        args["perf"] = PerfToJson(record.perf);
+      }
+      if (record.has_memory) {
+        args["memory"] = MemoryToJson(record.memory);
+      }
+    }
+    Append(event, batch);
+
+    if (!start) {
+      nlohmann::json rows = ChromeEvent("rows", "C", record.ts_ns, tid);
+      rows["args"]["rows_in"] = record.rows_in;
+      rows["args"]["rows_out"] = record.rows_out;
+      Append(rows, batch);
+    }
+    if (!start && record.has_memory) {
+      nlohmann::json bytes = ChromeEvent("bytes", "C", record.ts_ns, tid);
+      bytes["args"]["allocated"] = record.memory.allocated_bytes;
+      if (record.memory.live_bytes >= 0) {
+        bytes["args"]["live"] = record.memory.live_bytes;
+      }
+      Append(bytes, batch);
+    }
+  }
+
+  void FormatDump(const SampleDump& dump, size_t max_rows, std::string& batch) {
+    nlohmann::json log;
+    log["event"] = "sample_dump";
+    log["plan_name"] = strings_[dump.plan];
+    log["node_id"] = strings_[dump.node];
+    log["ts_us"] = dump.ts_ns / 1000;
+    log["rows"] = dump.rows;
+
+    nlohmann::json keys = nlohmann::json::array();
+    for (const auto& [key, column] : dump.columns) {
+      keys.push_back(key);
+    }
+    log["dump_keys"] = std::move(keys);
+
+    nlohmann::json rows = nlohmann::json::array();
+    for (size_t row = 0; row < std::min(dump.rows, max_rows); ++row) {
+      nlohmann::json values = nlohmann::json::object();
+      for (const auto& [key, column] : dump.columns) {
+        values[std::to_string(key)] = ValueToJson(column->GetValue(row));
+      }
+      rows.push_back(std::move(values));
+    }
+    log["topN"] = std::move(rows);
+
+    if (chrome_) {
+      NameTrack(dump.tid, batch);
+      nlohmann::json event = ChromeEvent("sample_dump", "i", dump.ts_ns, dump.tid);
+      event["s"] = "t";
+      event["args"] = std::move(log);
+      Append(event, batch);
+    } else {
+      Append(log, batch);
+    }
+  }
+
+  const std::chrono::steady_clock::time_point epoch_;
+
+  std::mutex strings_mutex_;
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+
+  std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<TraceRing>> rings_;
+  uint32_t next_tid_ = 0;
+
+  std::mutex dumps_mutex_;
+  std::vector<SampleDump> dumps_;
+  size_t dump_capacity_ = TraceOptions{}.dump_queue_capacity;  // Guarded by dumps_mutex_
+
+  std::atomic<uint64_t> dropped_{0};
+  std::mutex drain_mutex_;
+  uint64_t reported_drops_ = 0;             // Guarded by drain_mutex_
+  bool chrome_ = false;                     // Guarded by drain_mutex_
+  bool array_open_ = false;                 // Guarded by drain_mutex_
+  std::unordered_set<uint32_t> named_tids_;  // Guarded by drain_mutex_
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  TraceOptions options_;
+  bool reconfigured_ = false;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+TraceWriter& Writer() {
+  static TraceWriter writer;
+  return writer;
+}
+
+TraceRecord MakeRecord(TraceWriter& writer, TraceEvent event, const std::string& plan_name,
+                       const std::string& node_id, const std::string& op,
+                       const std::string& trace_key, const TraceContext* trace_ctx) {
+  TraceRecord record{};
+  record.event = event;
+  record.plan = writer.Intern(plan_name);
+  record.node = writer.Intern(node_id);
+  record.op = writer.Intern(op);
+  record.trace_key = writer.Intern(trace_key);
+  if (trace_ctx) {
+    record.trace_prefix = writer.Intern(trace_ctx->trace_prefix);
+    record.njs_file = writer.Intern(trace_ctx->njs_file);
+  }
+  return record;
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::enabled_{true};
 
 std::string Tracer::SpanName(const std::string& op, const std::string& trace_key) {
   if (trace_key.empty()) {
@@ -54,34 +624,58 @@ std::string Tracer::DeriveTracePrefix(const std::string& njs_file_path) {
   return filename;
 }
 
-void Tracer::LogNodeStart(const std::string& plan_name,
-                          const std::string& node_id,
-                          const std::string& op,
-                          const std::string& trace_key,
-                          const TraceContext* trace_ctx) {
-  if (!enabled_) return;
+bool Tracer::ShouldSample(double rate) {
+  if (rate <= 0.0 || !enabled_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  if (rate >= 1.0) {
+    return true;
+  }
+  // xorshift64*, seeded once per thread
+  thread_local uint64_t state = (uint64_t{std::random_device{}()} << 32 |
+                                 std::random_device{}()) | 1;
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  uint64_t bits = state * 0x2545F4914F6CDD1DULL;
+  return static_cast<double>(bits >> 11) * 0x1.0p-53 < rate;
+}
 
-  nlohmann::json log;
-  log["event"] = "node_start";
-  log["plan_name"] = plan_name;
-  log["node_id"] = node_id;
-  log["op"] = op;
-  log["span_name"] = SpanName(op, trace_key);
+bool Tracer::ShouldTraceRequest() {
+  return ShouldSample(Writer().RequestSampleRate());
+}
 
-  if (!trace_key.empty()) {
-    log["trace_key"] = trace_key;
-  }
+void Tracer::LogSampleDump(const std::string& plan_name,
+                           const std::string& node_id,
+                           const ColumnBatch& batch,
+                           const std::vector<int32_t>& keys) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
 
-  if (trace_ctx) {
-    if (!trace_ctx->trace_prefix.empty()) {
-      log["trace_prefix"] = trace_ctx->trace_prefix;
-    }
-    if (!trace_ctx->njs_file.empty()) {
-      log["njs_file"] = trace_ctx->njs_file;
+  TraceWriter& writer = Writer();
+  SampleDump dump;
+  dump.plan = writer.Intern(plan_name);
+  dump.node = writer.Intern(node_id);
+  dump.ts_ns = writer.Now();
+  dump.rows = batch.RowCount();
+  for (int32_t key : keys) {
+    if (TypedColumnPtr column = batch.GetColumn(key)) {
+      dump.columns.emplace_back(key, std::move(column));
     }
   }
+  writer.RecordDump(std::move(dump));
+}
 
-  std::cout << log.dump() << std::endl;
+void Tracer::LogNodeStart(const std::string& plan_name,
+                          const std::string& node_id,
+                          const std::string& op,
+                          const std::string& trace_key,
+                          const TraceContext* trace_ctx) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
+
+  TraceWriter& writer = Writer();
+  TraceRecord record = MakeRecord(writer, TraceEvent::kNodeStart, plan_name, node_id, op,
+                                  trace_key, trace_ctx);
+  writer.Record(record);
 }
 
 void Tracer::LogNodeEnd(const std::string& plan_name,
@@ -92,45 +686,64 @@ void Tracer::LogNodeEnd(const std::string& plan_name,
                         size_t rows_out,
                         const std::string& error,
                         const std::string& trace_key,
-                        const TraceContext* trace_ctx) {
-  if (!enabled_) return;
-
-  nlohmann::json log;
-  log["event"] = "node_end";
-  log["plan_name"] = plan_name;
-  log["node_id"] = node_id;
-  log["op"] = op;
-  log["span_name"] = SpanName(op, trace_key);
-  log["duration_ms"] = duration_ms;
-  log["rows_in"] = rows_in;
-  log["rows_out"] = rows_out;
+                        const TraceContext* trace_ctx,
+                        const PerfCounts* perf,
+                        const NodeMemoryStats* memory) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
 
-  if (!trace_key.empty()) {
-    log["trace_key"] = trace_key;
+  TraceWriter& writer = Writer();
+  TraceRecord record = MakeRecord(writer, TraceEvent::kNodeEnd, plan_name, node_id, op,
+                                  trace_key, trace_ctx);
+  record.duration_ms = duration_ms;
+  record.rows_in = rows_in;
+  record.rows_out = rows_out;
+  record.error = writer.Intern(error);
+  if (perf) {
+    record.perf = *perf;
   }
-
-  if (trace_ctx) {
-    if (!trace_ctx->trace_prefix.empty()) {
-      log["trace_prefix"] = trace_ctx->trace_prefix;
-    }
-    if (!trace_ctx->njs_file.empty()) {
-      log["njs_file"] = trace_ctx->njs_file;
-    }
+  if (memory) {
+    record.has_memory = true;
+    record.memory = *memory;
   }
+  writer.Record(record);
+}
 
-  if (!error.empty()) {
-    log["error"] = error;
-  }
+void Tracer::LogRequestEnd(const std::string& plan_name,
+                           double duration_ms,
+                           size_t rows_out,
+                           int64_t allocated_bytes,
+                           int64_t peak_live_bytes) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
 
-  std::cout << log.dump() << std::endl;
+  TraceWriter& writer = Writer();
+  TraceRecord record{};
+  record.event = TraceEvent::kRequestEnd;
+  record.plan = writer.Intern(plan_name);
+  record.duration_ms = duration_ms;
+  record.rows_out = rows_out;
+  record.memory.allocated_bytes = allocated_bytes;
+  record.memory.live_bytes = peak_live_bytes;
+  writer.Record(record);
 }
 
 void Tracer::SetEnabled(bool enabled) {
-  enabled_ = enabled;
+  enabled_.store(enabled, std::memory_order_relaxed);
 }
 
 bool Tracer::IsEnabled() {
-  return enabled_;
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+void Tracer::Configure(const TraceOptions& options) {
+  Writer().Configure(options);
+}
+
+void Tracer::Flush() {
+  Writer().Flush();
+}
+
+uint64_t Tracer::DroppedEvents() {
+  return Writer().Dropped();
 }
 
 }  // namespace ranking_dsl
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
+#include <vector>
+
+#include "logging/perf_counters.h"
+#include "object/memory_stats.h"
 
 namespace ranking_dsl {
 
+class ColumnBatch;
+
 /**
  * Tracing context for njs modules.
  * Used to track trace_prefix for nested native calls.
@@ -14,8 +24,43 @@ struct TraceContext {
   std::string njs_file;       // Full njs file path
 };
 
+/**
+ * Trace output format.
+ */
+enum class TraceFormat {
+  kJsonLines,    // One JSON object per line
+  kChromeTrace,  // Chrome Trace Event Format (JSON array; chrome://tracing, Perfetto UI)
+};
+
+/**
+ * Tracer settings. Ring capacity applies to threads that log their first
+ * event after the change.
+ */
+struct TraceOptions {
+  size_t ring_capacity = 4096;                   // Events buffered per thread
+  std::chrono::milliseconds flush_interval{20};  // Background writer period (0 = Flush() only)
+  std::ostream* out = nullptr;                   // nullptr = std::cout
+  size_t sample_dump_rows = 10;                  // Rows written per sample_dump
+  size_t dump_queue_capacity = 64;               // sample_dumps awaiting the writer
+  TraceFormat format = TraceFormat::kJsonLines;
+  double request_sample_rate = 1.0;              // Fraction of requests that log node spans
+};
+
 /**
  * Tracer - structured logging for pipeline execution.
+ *
+ * Log calls append a compact binary record (strings interned to IDs) to a
+ * lock-free per-thread ring and return. A background writer drains the
+ * rings every flush_interval, formats the records as JSON lines and writes
+ * them in one batch. A full ring drops the event instead of blocking; drops
+ * are counted and reported as a "trace_dropped" line. Sample dumps, which
+ * hold their batch's columns until written, queue up to dump_queue_capacity
+ * and are dropped and counted the same way past it.
+ *
+ * With TraceFormat::kChromeTrace the same records are written as Chrome
+ * trace events instead: B/E span pairs on one track per tracing thread
+ * (so nested njs calls nest under their module's span), a "rows" counter
+ * track, and instant events for dumps and drops.
  */
 class Tracer {
  public:
@@ -34,6 +79,8 @@ class Tracer {
    * Log node execution end.
    * @param trace_key Optional trace key for this node (empty = not set)
    * @param trace_ctx Optional trace context for njs nested calls
+   * @param perf Optional hardware counter deltas for the node
+   * @param memory Optional memory accounting for the node
    */
   static void LogNodeEnd(const std::string& plan_name,
                          const std::string& node_id,
@@ -43,7 +90,40 @@ class Tracer {
                          size_t rows_out,
                          const std::string& error = "",
                          const std::string& trace_key = "",
-                         const TraceContext* trace_ctx = nullptr);
+                         const TraceContext* trace_ctx = nullptr,
+                         const PerfCounts* perf = nullptr,
+                         const NodeMemoryStats* memory = nullptr);
+
+  /**
+   * Log a request_end event with request totals: bytes allocated by all
+   * nodes and the peak column bytes held at once.
+   */
+  static void LogRequestEnd(const std::string& plan_name,
+                            double duration_ms,
+                            size_t rows_out,
+                            int64_t allocated_bytes,
+                            int64_t peak_live_bytes);
+
+  /**
+   * Decide whether a request is sampled, with probability `rate`.
+   * Uses a per-thread xorshift generator; false while tracing is disabled.
+   */
+  static bool ShouldSample(double rate);
+
+  /**
+   * Decide whether a request logs node spans (TraceOptions::request_sample_rate).
+   */
+  static bool ShouldTraceRequest();
+
+  /**
+   * Log a sample_dump of `keys` in a node's output batch.
+   * The batch's columns are shared, not copied; rows are formatted by the
+   * background writer. Keys missing from the batch are left out.
+   */
+  static void LogSampleDump(const std::string& plan_name,
+                            const std::string& node_id,
+                            const ColumnBatch& batch,
+                            const std::vector<int32_t>& keys);
 
   /**
    * Compute span name from op and trace_key.
@@ -74,8 +154,27 @@ class Tracer {
    */
   static bool IsEnabled();
 
+  /**
+   * Replace the tracer settings (see TraceOptions).
+   * Pending events are written to the previous stream first, and an open
+   * Chrome trace array there is closed, so the previous stream can be
+   * destroyed once this returns.
+   */
+  static void Configure(const TraceOptions& options);
+
+  /**
+   * Write every event logged before the call, on the calling thread.
+   */
+  static void Flush();
+
+  /**
+   * Events dropped because their thread's ring (or the sample dump queue)
+   * was full.
+   */
+  static uint64_t DroppedEvents();
+
  private:
-  static bool enabled_;
+  static std::atomic<bool> enabled_;
 };
 
 }  // namespace ranking_dsl
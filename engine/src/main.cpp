@@ -1,3 +1,5 @@
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -5,7 +7,13 @@
 #include <fmt/format.h>
 
 #include "executor/executor.h"
+#include "executor/explain.h"
+#include "executor/schedule.h"
+#include "nodes/js/njs_runner.h"
+#include "logging/metrics.h"
+#include "logging/perf_counters.h"
 #include "keys/registry.h"
+#include "plan/artifact.h"
 #include "plan/compiler.h"
 #include "plan/complexity.h"
 #include "plan/plan.h"
@@ -20,12 +28,24 @@ int main(int argc, char* argv[]) {
   std::string plan_path;
   std::string keys_path;
   std::string budget_path;
+  std::string cost_model_path;
+  std::string calibrate_trace_path;
+  std::string artifact_path;
+  std::string schedule_trace_path;
+  std::string trace_out_path;
+  std::string trace_format = "jsonl";
+  std::string metrics_out_path;
+  std::string njs_policy_path;
   int dump_top = 0;
+  int deadline_ms = 0;
   bool quiet = false;
   bool no_complexity_check = false;
+  bool no_fusion = false;
+  bool perf_counters = false;
+  bool memory_report = false;
+  bool explain_analyze = false;
 
-  app.add_option("plan", plan_path, "Path to compiled plan.json")
-      ->required()
+  app.add_option("plan", plan_path, "Path to compiled plan.json or binary plan artifact")
       ->check(CLI::ExistingFile);
 
   app.add_option("--keys,-k", keys_path, "Path to keys.json (uses compiled-in keys if not specified)")
@@ -34,17 +54,104 @@ int main(int argc, char* argv[]) {
   app.add_option("--budget,-b", budget_path, "Path to complexity budget JSON file")
       ->check(CLI::ExistingFile);
 
+  app.add_option("--cost-model", cost_model_path,
+                 "Path to cost model JSON (estimated_ms budget)")
+      ->check(CLI::ExistingFile);
+
+  app.add_option("--calibrate-cost-model", calibrate_trace_path,
+                 "Fit a cost model from a recorded trace (JSON lines), print it and exit")
+      ->check(CLI::ExistingFile);
+
+  app.add_option("--analyze-schedule", schedule_trace_path,
+                 "Critical path and per-node slack of the plan's last request in a trace "
+                 "(JSON lines), then exit")
+      ->check(CLI::ExistingFile);
+
   app.add_option("--dump-top,-n", dump_top, "Number of top results to display")
       ->check(CLI::NonNegativeNumber);
 
+  app.add_option("--deadline-ms", deadline_ms, "Request deadline in milliseconds (0 = none)")
+      ->check(CLI::NonNegativeNumber);
+
+  app.add_option("--emit-artifact", artifact_path,
+                 "Write the compiled plan as a binary artifact to this path and exit");
+
+  app.add_option("--trace-out", trace_out_path,
+                 "Write trace events to this file instead of stdout (also when --quiet)");
+
+  app.add_option("--trace-format", trace_format,
+                 "Trace format: jsonl (JSON lines) or chrome (Chrome trace / Perfetto)")
+      ->check(CLI::IsMember({"jsonl", "chrome"}));
+
+  app.add_option("--metrics-out", metrics_out_path,
+                 "Write per-node latency/row metrics (Prometheus text format) after the run");
+
+  app.add_option("--njs-policy", njs_policy_path,
+                 "njs policy JSON (IO allowlist, CPU caps, require_embedded)")
+      ->check(CLI::ExistingFile);
+
   app.add_flag("--quiet,-q", quiet, "Suppress output except errors");
 
   app.add_flag("--no-complexity-check", no_complexity_check, "Disable complexity checking");
 
+  app.add_flag("--perf-counters", perf_counters,
+               "Attribute hardware counters (cycles, instructions, misses) to each node (Linux)");
+
+  app.add_flag("--explain-analyze", explain_analyze,
+               "Execute the plan and print per-node timings, rows and bytes instead of results");
+
+  app.add_flag("--memory-report", memory_report,
+               "Print column bytes allocated, copied and shared by each node");
+
+  app.add_flag("--no-fusion", no_fusion,
+               "Run fusible nodes one by one (per-node trace spans for calibration)");
+
   CLI11_PARSE(app, argc, argv);
 
-  // Set tracing based on quiet flag
-  Tracer::SetEnabled(!quiet);
+  CostModel cost_model = CostModel::Default();
+  if (!cost_model_path.empty()) {
+    std::string error;
+    cost_model = CostModel::LoadFromFile(cost_model_path, &error);
+    if (!error.empty()) {
+      fmt::print(stderr, "Error loading cost model: {}\n", error);
+      return 1;
+    }
+  }
+
+  if (!calibrate_trace_path.empty()) {
+    std::ifstream trace(calibrate_trace_path);
+    std::string error;
+    CostModel calibrated = CalibrateCostModel(trace, cost_model, &error);
+    if (!error.empty()) {
+      fmt::print(stderr, "Error calibrating cost model: {}\n", error);
+      return 1;
+    }
+    fmt::print("{}\n", calibrated.Dump());
+    return 0;
+  }
+
+  if (plan_path.empty()) {
+    fmt::print(stderr, "Error: plan is required (see --help)\n");
+    return 1;
+  }
+
+  // Set tracing based on quiet flag; a trace file is written regardless.
+  // --explain-analyze replaces the stdout trace with its own report.
+  Tracer::SetEnabled((!quiet && !explain_analyze) || !trace_out_path.empty());
+  static std::ofstream trace_out;  // Outlives the tracer, which closes the trace at exit
+  TraceOptions trace_options;
+  if (trace_format == "chrome") {
+    trace_options.format = TraceFormat::kChromeTrace;
+  }
+  if (!trace_out_path.empty()) {
+    trace_out.open(trace_out_path);
+    if (!trace_out) {
+      fmt::print(stderr, "Error opening trace output: {}\n", trace_out_path);
+      return 1;
+    }
+    trace_options.out = &trace_out;
+  }
+  Tracer::Configure(trace_options);
 
   // Load key registry
   KeyRegistry registry;
@@ -59,43 +166,133 @@ int main(int argc, char* argv[]) {
     registry.LoadFromCompiled();
   }
 
-  // Load plan
-  Plan plan;
   std::string error;
-  if (!ParsePlanFile(plan_path, plan, &error)) {
-    fmt::print(stderr, "Error loading plan: {}\n", error);
-    return 1;
-  }
+  CompiledPlan compiled;
+
+  if (IsPlanArtifactFile(plan_path)) {
+    // Precompiled artifact: already validated and compiled, no JSON parsing
+    if (!LoadPlanArtifact(plan_path, registry, compiled, &error)) {
+      fmt::print(stderr, "Error loading plan artifact: {}\n", error);
+      return 1;
+    }
+  } else {
+    // Load plan
+    Plan plan;
+    if (!ParsePlanFile(plan_path, plan, &error)) {
+      fmt::print(stderr, "Error loading plan: {}\n", error);
+      return 1;
+    }
 
-  // Compile plan with complexity checking
-  PlanCompiler compiler(registry);
+    // Compile plan with complexity checking
+    PlanCompiler compiler(registry);
+    compiler.SetCostModel(cost_model);
+    if (no_fusion) {
+      compiler.DisableFusion();
+    }
 
-  if (no_complexity_check) {
-    compiler.DisableComplexityCheck();
-  } else if (!budget_path.empty()) {
-    auto budget = ComplexityBudget::LoadFromFile(budget_path, &error);
-    if (!error.empty()) {
-      fmt::print(stderr, "Error loading complexity budget: {}\n", error);
+    if (no_complexity_check) {
+      compiler.DisableComplexityCheck();
+    } else if (!budget_path.empty()) {
+      auto budget = ComplexityBudget::LoadFromFile(budget_path, &error);
+      if (!error.empty()) {
+        fmt::print(stderr, "Error loading complexity budget: {}\n", error);
+        return 1;
+      }
+      compiler.SetComplexityBudget(budget);
+    }
+    // If no budget specified and complexity check enabled, uses default budget
+
+    if (!compiler.Compile(plan, compiled, &error)) {
+      fmt::print(stderr, "Error compiling plan: {}\n", error);
       return 1;
     }
-    compiler.SetComplexityBudget(budget);
   }
-  // If no budget specified and complexity check enabled, uses default budget
+  if (!quiet && !compiled.diagnostics.empty()) {
+    fmt::print(stderr, "Warning: {}\n", compiled.diagnostics);
+  }
 
-  CompiledPlan compiled;
-  if (!compiler.Compile(plan, compiled, &error)) {
-    fmt::print(stderr, "Error compiling plan: {}\n", error);
-    return 1;
+  if (!artifact_path.empty()) {
+    if (!WritePlanArtifact(compiled, registry, artifact_path, &error)) {
+      fmt::print(stderr, "Error writing plan artifact: {}\n", error);
+      return 1;
+    }
+    if (!quiet) {
+      fmt::print("Wrote plan artifact: {}\n", artifact_path);
+    }
+    return 0;
+  }
+
+  if (!schedule_trace_path.empty()) {
+    std::ifstream trace(schedule_trace_path);
+    std::vector<ScheduleSpan> spans;
+    ScheduleAnalysis analysis;
+    if (!ReadTraceSpans(trace, compiled.plan.name, spans, &error) ||
+        !AnalyzeSchedule(compiled, spans, analysis, &error)) {
+      fmt::print(stderr, "Error analyzing schedule: {}\n", error);
+      return 1;
+    }
+    fmt::print("{}", FormatScheduleAnalysis(analysis));
+    return 0;
   }
 
   // Execute plan
+  NjsPolicy njs_policy;
+  if (!njs_policy_path.empty() && !njs_policy.LoadFromFile(njs_policy_path, &error)) {
+    fmt::print(stderr, "Error loading njs policy: {}\n", error);
+    return 1;
+  }
   Executor executor(registry);
-  CandidateBatch result = executor.Execute(compiled, &error);
+  ExecContext exec_ctx;
+  exec_ctx.njs_policy = &njs_policy;
+  if (perf_counters) {
+    std::string perf_error;
+    if (PerfCounterGroup::ForCurrentThread(&perf_error)) {
+      exec_ctx.perf_counters = true;
+    } else if (!quiet) {
+      fmt::print(stderr, "Warning: hardware counters unavailable ({}); running without\n",
+                 perf_error);
+    }
+  }
+  ExecStats exec_stats;
+  if (memory_report || explain_analyze) {
+    exec_ctx.stats = &exec_stats;
+  }
+  if (deadline_ms > 0) {
+    exec_ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(deadline_ms);
+  }
+  CandidateBatch result = executor.Execute(compiled, exec_ctx, &error);
+  Tracer::Flush();  // Trace lines precede the results
+  if (!metrics_out_path.empty()) {
+    std::string metrics_error;
+    if (!Metrics::WritePrometheusFile(metrics_out_path, &metrics_error)) {
+      fmt::print(stderr, "Error writing metrics: {}\n", metrics_error);
+      return 1;
+    }
+  }
   if (!error.empty()) {
     fmt::print(stderr, "Error executing plan: {}\n", error);
     return 1;
   }
 
+  if (memory_report) {
+    fmt::print("\n=== Memory ({} nodes) ===\n", exec_stats.nodes.size());
+    fmt::print("  {:<24} {:<16} {:>12} {:>12} {:>12} {:>12} {:>12}\n", "node", "op",
+               "allocated", "copied", "shared", "njs_heap", "live");
+    for (const auto& node : exec_stats.nodes) {
+      const NodeMemoryStats& memory = node.memory;
+      fmt::print("  {:<24} {:<16} {:>12} {:>12} {:>12} {:>12} {:>12}\n", node.node_id, node.op,
+                 memory.allocated_bytes, memory.copied_bytes, memory.shared_bytes,
+                 memory.njs_heap_bytes, memory.live_bytes);
+    }
+    fmt::print("  total allocated={} bytes, peak live={} bytes\n", exec_stats.allocated_bytes,
+               exec_stats.peak_live_bytes);
+  }
+
+  if (explain_analyze) {
+    fmt::print("{}", FormatExplainAnalyze(compiled, exec_stats));
+    return 0;
+  }
+
   // Output results (using columnar API)
   if (!quiet) {
     size_t row_count = result.RowCount();
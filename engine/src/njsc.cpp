@@ -0,0 +1,127 @@
+/**
+ * Build-time njs bytecode compiler (rankdsl_njsc).
+ *
+ * Compiles approved njs modules to QuickJS bytecode and emits a C++ source
+ * file that embeds the bytecode arrays and registers them by digest with
+ * NjsBytecodeRegistry. Invoked by the rankdsl_embed_njs_modules() CMake
+ * function; not meant to be run by hand.
+ *
+ * Usage:
+ *   rankdsl_njsc --out <file.cpp> [--module <path>=<source_file>#<digest>]...
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "nodes/js/njs_bytecode.h"
+
+using namespace ranking_dsl;
+
+struct ModuleArg {
+  std::string path;         // Path as referenced by plans
+  std::string source_file;  // File to compile
+  std::string digest;
+};
+
+// Parse "<path>=<source_file>#<digest>"
+static bool ParseModuleArg(const std::string& arg, ModuleArg& out) {
+  size_t eq = arg.find('=');
+  size_t hash = arg.rfind('#');
+  if (eq == std::string::npos || hash == std::string::npos || hash < eq) {
+    return false;
+  }
+  out.path = arg.substr(0, eq);
+  out.source_file = arg.substr(eq + 1, hash - eq - 1);
+  out.digest = arg.substr(hash + 1);
+  return !out.path.empty() && !out.source_file.empty() && !out.digest.empty();
+}
+
+int main(int argc, char* argv[]) {
+  std::string out_path;
+  std::vector<ModuleArg> modules;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (arg == "--module" && i + 1 < argc) {
+      ModuleArg module;
+      if (!ParseModuleArg(argv[++i], module)) {
+        std::cerr << "Invalid --module (expected <path>=<source_file>#<digest>): "
+                  << argv[i] << std::endl;
+        return 1;
+      }
+      modules.push_back(std::move(module));
+    } else {
+      std::cerr << "Usage: rankdsl_njsc --out <file.cpp> "
+                   "[--module <path>=<source_file>#<digest>]..." << std::endl;
+      return 1;
+    }
+  }
+
+  if (out_path.empty()) {
+    std::cerr << "Missing --out" << std::endl;
+    return 1;
+  }
+
+  std::ostringstream arrays;
+  std::ostringstream registrations;
+
+  for (size_t m = 0; m < modules.size(); ++m) {
+    const auto& module = modules[m];
+
+    std::ifstream file(module.source_file);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open njs module: " << module.source_file << std::endl;
+      return 1;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::string error;
+    std::vector<uint8_t> bytecode = CompileNjsBytecode(buffer.str(), module.path, &error);
+    if (bytecode.empty()) {
+      std::cerr << module.source_file << ": " << error << std::endl;
+      return 1;
+    }
+
+    arrays << fmt::format("// {} ({})\nconst uint8_t kModule{}[] = {{", module.path,
+                          module.digest, m);
+    for (size_t i = 0; i < bytecode.size(); ++i) {
+      arrays << (i % 16 == 0 ? "\n  " : " ") << fmt::format("0x{:02x},", bytecode[i]);
+    }
+    arrays << "\n};\n\n";
+
+    registrations << fmt::format(
+        "  registry.Register({{\"{}\", \"{}\", kModule{}, sizeof(kModule{})}});\n",
+        module.digest, module.path, m, m);
+  }
+
+  std::ofstream out(out_path);
+  if (!out.is_open()) {
+    std::cerr << "Failed to open output file: " << out_path << std::endl;
+    return 1;
+  }
+
+  out << "/**\n"
+      << " * Auto-generated by rankdsl_njsc from RANKING_DSL_NJS_MODULES.\n"
+      << " * DO NOT EDIT.\n"
+      << " */\n\n"
+      << "#include <cstdint>\n\n"
+      << "#include \"nodes/js/njs_bytecode_registry.h\"\n\n"
+      << "namespace ranking_dsl {\n\n"
+      << "namespace {\n\n"
+      << arrays.str()
+      << "}  // namespace\n\n"
+      << "void RegisterEmbeddedNjsModules(NjsBytecodeRegistry& registry) {\n"
+      << (modules.empty() ? "  (void)registry;\n" : registrations.str())
+      << "}\n\n"
+      << "}  // namespace ranking_dsl\n";
+
+  return 0;
+}
@@ -2,8 +2,11 @@
 #include "nodes/registry.h"
 #include "keys.h"
 #include "object/batch_builder.h"
+#include "object/row_block.h"
 #include "object/typed_column.h"
 
+#include <algorithm>
+
 #include <nlohmann/json.hpp>
 
 namespace ranking_dsl {
@@ -76,7 +79,51 @@ class FeaturesNode : public NodeRunner {
     return builder.Build();
   }
 
+  bool RunsBlocks() const override { return true; }
+
+  void RunBlock(const ExecContext& ctx, RowBlock& block,
+                const nlohmann::json& params) override {
+    // Params are identical for every block; parse once per runner
+    if (!block_keys_ready_) {
+      if (params.contains("keys")) {
+        for (const auto& k : params["keys"]) {
+          block_keys_.push_back(k.get<int32_t>());
+        }
+      }
+      block_keys_ready_ = true;
+    }
+
+    const size_t n = block.Size();
+    auto* id_col = block.Input().GetI64Column(keys::id::CAND_CANDIDATE_ID);
+
+    for (int32_t key_id : block_keys_) {
+      if (key_id == keys::id::FEAT_FRESHNESS) {
+        float* out = block.WriteF32(key_id);
+        for (size_t i = 0; i < n; ++i) {
+          size_t row = block.Begin() + i;
+          float freshness = 0.5f;
+          if (id_col && !id_col->IsNull(row)) {
+            freshness = static_cast<float>((id_col->Get(row) % 100)) / 100.0f;
+          }
+          out[i] = freshness;
+        }
+      } else if (key_id == keys::id::FEAT_EMBEDDING ||
+                 key_id == keys::id::FEAT_QUERY_EMBEDDING) {
+        constexpr size_t dim = 128;
+        float* out = block.WriteF32Vec(key_id, dim);
+        std::fill(out, out + n * dim, 0.1f);  // Same embedding for all (stub)
+      } else {
+        float* out = block.WriteF32(key_id);
+        std::fill(out, out + n, 0.0f);
+      }
+    }
+  }
+
   std::string TypeName() const override { return "core:features"; }
+
+ private:
+  std::vector<int32_t> block_keys_;
+  bool block_keys_ready_ = false;
 };
 
 // NodeSpec for core:features (v0.2.8+)
@@ -106,6 +153,7 @@ static NodeSpec CreateFeaturesNodeSpec() {
   // Writes: param-derived from "keys" parameter
   spec.writes.kind = WritesDescriptor::Kind::kParamDerived;
   spec.writes.param_name = "keys";
+  spec.fusible = true;
 
   return spec;
 }
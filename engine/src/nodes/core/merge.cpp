@@ -67,55 +67,7 @@ class MergeNode : public NodeRunner {
     // Sort for deterministic output
     std::sort(selected_rows.begin(), selected_rows.end());
 
-    // Create output batch with selected rows
-    size_t out_row_count = selected_rows.size();
-    ColumnBatch output(out_row_count);
-
-    // Copy columns, selecting only the chosen rows
-    for (int32_t key_id : input.ColumnKeys()) {
-      auto src_col = input.GetColumn(key_id);
-      if (!src_col) continue;
-
-      // Create new column of same type
-      auto dst_col = src_col->Clone();
-      // Note: Clone creates a copy of all data, but we only want selected rows.
-      // For now, create from scratch using GetValue/SetValue.
-
-      // Create output column based on type
-      TypedColumnPtr out_col;
-      switch (src_col->Type()) {
-        case ColumnType::F32:
-          out_col = std::make_shared<F32Column>(out_row_count);
-          break;
-        case ColumnType::I64:
-          out_col = std::make_shared<I64Column>(out_row_count);
-          break;
-        case ColumnType::Bool:
-          out_col = std::make_shared<BoolColumn>(out_row_count);
-          break;
-        case ColumnType::String:
-          out_col = std::make_shared<StringColumn>(out_row_count);
-          break;
-        case ColumnType::F32Vec: {
-          auto* vec_col = static_cast<F32VecColumn*>(src_col.get());
-          out_col = std::make_shared<F32VecColumn>(out_row_count, vec_col->Dim());
-          break;
-        }
-        case ColumnType::Bytes:
-          out_col = std::make_shared<BytesColumn>(out_row_count);
-          break;
-        default:
-          continue;
-      }
-
-      for (size_t out_idx = 0; out_idx < out_row_count; ++out_idx) {
-        size_t src_idx = selected_rows[out_idx];
-        out_col->SetValue(out_idx, src_col->GetValue(src_idx));
-      }
-      output.SetColumn(key_id, out_col);
-    }
-
-    return output;
+    return input.SelectRows(selected_rows);
   }
 
   std::string TypeName() const override { return "core:merge"; }
@@ -2,12 +2,35 @@
 #include "nodes/registry.h"
 #include "keys.h"
 #include "object/batch_builder.h"
+#include "object/row_block.h"
 #include "object/typed_column.h"
 
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 namespace ranking_dsl {
 
+namespace {
+
+// Column values as floats, promoting I64 and reading nulls or a missing
+// column as 0 (as RowBlock::ReadF32 does for the fused path)
+std::vector<float> ReadF32(const CandidateBatch& input, int32_t key_id) {
+  std::vector<float> out(input.RowCount(), 0.0f);
+  if (auto* col = input.GetF32Column(key_id)) {
+    for (size_t i = 0; i < out.size(); ++i) {
+      out[i] = col->IsNull(i) ? 0.0f : col->Get(i);
+    }
+  } else if (auto* col = input.GetI64Column(key_id)) {
+    for (size_t i = 0; i < out.size(); ++i) {
+      out[i] = col->IsNull(i) ? 0.0f : static_cast<float>(col->Get(i));
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
 /**
  * core:model - Runs a model and writes score.ml.
  *
@@ -27,28 +50,16 @@ class ModelNode : public NodeRunner {
       return input;
     }
 
-    // Get input columns (typed access)
-    auto* base_col = input.GetF32Column(keys::id::SCORE_BASE);
-    auto* fresh_col = input.GetF32Column(keys::id::FEAT_FRESHNESS);
+    // Get input columns (I64 promoted, nulls as 0)
+    std::vector<float> base = ReadF32(input, keys::id::SCORE_BASE);
+    std::vector<float> freshness = ReadF32(input, keys::id::FEAT_FRESHNESS);
 
     // Create ML score column
     auto ml_col = std::make_shared<F32Column>(row_count);
 
     for (size_t i = 0; i < row_count; ++i) {
-      float base_score = 0.0f;
-      float freshness = 0.0f;
-
-      if (base_col && !base_col->IsNull(i)) {
-        base_score = base_col->Get(i);
-      }
-
-      if (fresh_col && !fresh_col->IsNull(i)) {
-        freshness = fresh_col->Get(i);
-      }
-
       // Simple weighted combination
-      float ml_score = 0.6f * base_score + 0.4f * freshness;
-      ml_col->Set(i, ml_score);
+      ml_col->Set(i, 0.6f * base[i] + 0.4f * freshness[i]);
     }
 
     // Use BatchBuilder for COW semantics
@@ -58,6 +69,19 @@ class ModelNode : public NodeRunner {
     return builder.Build();
   }
 
+  bool RunsBlocks() const override { return true; }
+
+  void RunBlock(const ExecContext& ctx, RowBlock& block,
+                const nlohmann::json& params) override {
+    const float* base = block.ReadF32(keys::id::SCORE_BASE);
+    const float* freshness = block.ReadF32(keys::id::FEAT_FRESHNESS);
+    float* ml = block.WriteF32(keys::id::SCORE_ML);
+
+    for (size_t i = 0; i < block.Size(); ++i) {
+      ml[i] = 0.6f * base[i] + 0.4f * freshness[i];
+    }
+  }
+
   std::string TypeName() const override { return "core:model"; }
 };
 
@@ -87,6 +111,7 @@ static NodeSpec CreateModelNodeSpec() {
   // Writes: ML score
   spec.writes.kind = WritesDescriptor::Kind::kStatic;
   spec.writes.static_keys = {keys::id::SCORE_ML};
+  spec.fusible = true;
 
   return spec;
 }
@@ -3,16 +3,50 @@
 #include "keys.h"
 #include "expr/expr.h"
 #include "object/batch_builder.h"
+#include "object/row_block.h"
 #include "object/typed_column.h"
 
+#include <algorithm>
+#include <optional>
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 namespace ranking_dsl {
 
+namespace {
+
+ExprNode ParseFormula(const nlohmann::json& params) {
+  std::string error;
+  if (params.contains("expr")) {
+    return ParseExpr(params["expr"], &error);
+  }
+  // Default: just use base score
+  return SignalExpr{keys::id::SCORE_BASE};
+}
+
+// Request values of a precompiled formula's binding operands, by index
+std::vector<float> BoundValues(const CompiledExpr& compiled, const ExecContext& ctx) {
+  std::vector<float> values(compiled.Bindings().size(), 0.0f);
+  for (size_t i = 0; ctx.binding_values && i < values.size(); ++i) {
+    auto it = ctx.binding_values->find(compiled.Bindings()[i]);
+    if (it != ctx.binding_values->end() && it->second.is_number()) {
+      values[i] = it->second.get<float>();
+    }
+  }
+  return values;
+}
+
+}  // namespace
+
 /**
  * core:score_formula - Evaluates an expression and writes the result.
  *
- * Uses columnar evaluation: reads input columns, writes output column.
+ * Uses columnar evaluation: the plan compiler compiles the expression
+ * against the node's inferred input schema once (ExecContext::compiled_expr),
+ * so signals load through typed kernels; bound constants are filled in from
+ * ExecContext::binding_values. Nodes without one (run outside a compiled plan
+ * or without schemas) compile it themselves.
  * Uses BatchBuilder with COW - original columns are shared.
  *
  * Params:
@@ -26,30 +60,30 @@ class ScoreFormulaNode : public NodeRunner {
                      const nlohmann::json& params) override {
     int32_t output_key = params.value("output_key_id", keys::id::SCORE_FINAL);
 
-    // Parse the expression
-    std::string error;
-    ExprNode expr;
-    if (params.contains("expr")) {
-      expr = ParseExpr(params["expr"], &error);
-    } else {
-      // Default: just use base score
-      expr = SignalExpr{keys::id::SCORE_BASE};
-    }
-
     size_t row_count = input.RowCount();
     if (row_count == 0) {
       return input;
     }
 
-    // Create typed F32 output column
-    auto output_col = std::make_shared<F32Column>(row_count);
-
-    // Evaluate expression for each row using columnar API
-    for (size_t i = 0; i < row_count; ++i) {
-      float result = EvalExpr(expr, input, i, ctx.registry);
-      output_col->Set(i, result);
+    // Without a precompiled expression, bind signals to typed loads here;
+    // without a schema they are probed once per batch
+    std::optional<CompiledExpr> local;
+    const CompiledExpr* compiled = ctx.compiled_expr;
+    if (!compiled) {
+      local = CompiledExpr::Compile(ParseFormula(params),
+                                    ctx.input_schema ? *ctx.input_schema : BatchSchema{},
+                                    ctx.registry);
+      compiled = &*local;
     }
 
+    std::vector<float> bound = BoundValues(*compiled, ctx);
+    std::vector<float> values(row_count);
+    compiled->Eval(input, values.data(), bound.data());
+
+    // Create typed F32 output column (every row set)
+    auto output_col = std::make_shared<F32Column>(std::move(values),
+                                                  std::vector<bool>(row_count, false));
+
     // Use BatchBuilder for COW semantics
     BatchBuilder builder(input);
     builder.AddF32Column(output_key, output_col);
@@ -57,7 +91,38 @@ class ScoreFormulaNode : public NodeRunner {
     return builder.Build();
   }
 
+  bool RunsBlocks() const override { return true; }
+
+  void RunBlock(const ExecContext& ctx, RowBlock& block,
+                const nlohmann::json& params) override {
+    // Params are identical for every block; compile once per runner when the
+    // plan did not
+    const CompiledExpr* compiled = ctx.compiled_expr;
+    if (!compiled) {
+      if (!block_expr_) {
+        block_expr_ = CompiledExpr::Compile(ParseFormula(params), BatchSchema{}, ctx.registry);
+      }
+      compiled = &*block_expr_;
+    }
+    if (!block_output_key_) {
+      block_output_key_ = params.value("output_key_id", keys::id::SCORE_FINAL);
+      block_bound_ = BoundValues(*compiled, ctx);
+    }
+
+    // Evaluate before writing: the expression may read the output key
+    block_result_.resize(block.Size());
+    compiled->EvalBlock(block, block_result_.data(), block_bound_.data());
+    float* out = block.WriteF32(*block_output_key_);
+    std::copy(block_result_.begin(), block_result_.end(), out);
+  }
+
   std::string TypeName() const override { return "core:score_formula"; }
+
+ private:
+  std::optional<CompiledExpr> block_expr_;
+  std::optional<int32_t> block_output_key_;
+  std::vector<float> block_bound_;  // Binding operand values, same for every block
+  std::vector<float> block_result_;
 };
 
 // NodeSpec for core:score_formula (v0.2.8+)
@@ -85,13 +150,14 @@ static NodeSpec CreateScoreFormulaNodeSpec() {
     "required": ["expr"]
   })";
 
-  // Reads: depends on expression (dynamic), but we can't statically determine this
-  // For now, leave empty (this could be improved with expression analysis)
+  // Reads: depends on expression (dynamic); the plan compiler's liveness pass
+  // resolves them per node via CollectKeyIds
   spec.reads = {};
 
   // Writes: param-derived from output_key_id parameter
   spec.writes.kind = WritesDescriptor::Kind::kParamDerived;
   spec.writes.param_name = "output_key_id";
+  spec.fusible = true;
 
   return spec;
 }
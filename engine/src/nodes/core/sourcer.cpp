@@ -4,6 +4,10 @@
 #include "object/batch_builder.h"
 #include "object/typed_column.h"
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 namespace ranking_dsl {
@@ -11,7 +15,9 @@ namespace ranking_dsl {
 /**
  * core:sourcer - Generates candidate objects.
  *
- * MVP: Creates fake candidates with candidate_id and base score.
+ * MVP: Creates fake candidates with candidate_id and base score. When the
+ * request supplies candidates (ExecContext::candidates), emits their first k
+ * rows instead, sharing the columns.
  *
  * Params:
  *   - name: string (sourcer name)
@@ -24,6 +30,16 @@ class SourcerNode : public NodeRunner {
                      const nlohmann::json& params) override {
     int k = params.value("k", 100);
 
+    if (ctx.candidates) {
+      const CandidateBatch& candidates = *ctx.candidates;
+      if (static_cast<size_t>(std::max(k, 0)) >= candidates.RowCount()) {
+        return candidates;
+      }
+      std::vector<size_t> rows(static_cast<size_t>(std::max(k, 0)));
+      std::iota(rows.begin(), rows.end(), size_t{0});
+      return candidates.SelectRows(rows);
+    }
+
     // Create typed columns directly
     auto id_column = std::make_shared<I64Column>(k);
     auto score_column = std::make_shared<F32Column>(k);
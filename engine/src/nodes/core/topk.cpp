@@ -0,0 +1,110 @@
+#include "nodes/node_runner.h"
+#include "nodes/registry.h"
+#include "keys.h"
+#include "object/typed_column.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace ranking_dsl {
+
+/**
+ * core:topk - Keeps the k highest-scoring candidates, best first.
+ *
+ * Rows with a null (or missing) score sort last; ties keep input order.
+ *
+ * Params:
+ *   - k: int (number of candidates to keep)
+ *   - key: int (score key to rank by, default score.final)
+ *   - push_to_sources: bool (upstream sourcers emit candidates best-first, so
+ *     the compiler may cap their k at this limit)
+ */
+class TopKNode : public NodeRunner {
+ public:
+  CandidateBatch Run(const ExecContext& ctx,
+                     const CandidateBatch& input,
+                     const nlohmann::json& params) override {
+    size_t k = static_cast<size_t>(std::max<int64_t>(params.value("k", int64_t{0}), 0));
+    int32_t key = params.value("key", keys::id::SCORE_FINAL);
+
+    size_t row_count = input.RowCount();
+    size_t keep = std::min(k, row_count);
+
+    std::vector<float> score(row_count, 0.0f);
+    std::vector<bool> present(row_count, false);
+    if (auto* f32 = input.GetF32Column(key)) {
+      for (size_t i = 0; i < row_count; ++i) {
+        present[i] = !f32->IsNull(i);
+        score[i] = present[i] ? f32->Get(i) : 0.0f;
+      }
+    } else if (auto* i64 = input.GetI64Column(key)) {
+      for (size_t i = 0; i < row_count; ++i) {
+        present[i] = !i64->IsNull(i);
+        score[i] = present[i] ? static_cast<float>(i64->Get(i)) : 0.0f;
+      }
+    }
+
+    // Breaking ties by row index makes the partial sort stable
+    std::vector<size_t> rows(row_count);
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    std::partial_sort(rows.begin(), rows.begin() + keep, rows.end(),
+                      [&](size_t a, size_t b) -> bool {
+                        if (present[a] != present[b]) return present[a];
+                        if (score[a] != score[b]) return score[a] > score[b];
+                        return a < b;
+                      });
+    rows.resize(keep);
+
+    return input.SelectRows(rows);
+  }
+
+  std::string TypeName() const override { return "core:topk"; }
+};
+
+// NodeSpec for core:topk
+static NodeSpec CreateTopKNodeSpec() {
+  NodeSpec spec;
+  spec.op = "core:topk";
+  spec.namespace_path = "core.topk";
+  spec.stability = Stability::kStable;
+  spec.doc = "Keeps the k highest-scoring candidates in descending score order.";
+
+  // Params schema (JSON Schema)
+  spec.params_schema_json = R"({
+    "type": "object",
+    "properties": {
+      "k": {
+        "type": "integer",
+        "description": "Number of candidates to keep",
+        "minimum": 0
+      },
+      "key": {
+        "type": "integer",
+        "description": "Key ID of the score to rank by",
+        "default": 3999
+      },
+      "push_to_sources": {
+        "type": "boolean",
+        "description": "Sources emit candidates best-first; allow the compiler to cap upstream sourcer k at this limit",
+        "default": false
+      }
+    },
+    "required": ["k"]
+  })";
+
+  // Reads: the ranking key (param-derived, resolved by the compiler)
+  spec.reads = {};
+
+  // Writes: selects rows only
+  spec.writes.kind = WritesDescriptor::Kind::kStatic;
+  spec.writes.static_keys = {};
+
+  return spec;
+}
+
+REGISTER_NODE_RUNNER("core:topk", TopKNode, CreateTopKNodeSpec());
+
+}  // namespace ranking_dsl
@@ -21,14 +21,17 @@ BatchContext::BatchContext(const ColumnBatch& batch,
                            BatchBuilder& builder,
                            const KeyRegistry* registry,
                            const std::set<int32_t>& allowed_writes,
-                           NjsBudget& budget)
+                           NjsBudget& budget,
+                           const std::set<int32_t>* allowed_reads)
     : batch_(batch),
       builder_(builder),
       registry_(registry),
       allowed_writes_(allowed_writes),
-      budget_(budget) {}
+      budget_(budget),
+      allowed_reads_(allowed_reads) {}
 
 std::pair<const float*, size_t> BatchContext::GetF32Raw(int32_t key_id) const {
+  CheckReadAllowed(key_id);
   auto* col = batch_.GetF32Column(key_id);
   if (!col) {
     return {nullptr, 0};
@@ -46,6 +49,7 @@ std::vector<float> BatchContext::GetF32(int32_t key_id) const {
 }
 
 F32VecView BatchContext::GetF32VecRaw(int32_t key_id) const {
+  CheckReadAllowed(key_id);
   auto* col = batch_.GetF32VecColumn(key_id);
   if (!col) {
     return {nullptr, 0, 0, 0};
@@ -59,6 +63,7 @@ F32VecView BatchContext::GetF32VecRaw(int32_t key_id) const {
 }
 
 std::vector<std::vector<float>> BatchContext::GetF32Vec(int32_t key_id) const {
+  CheckReadAllowed(key_id);
   std::vector<std::vector<float>> result(batch_.RowCount());
   auto* col = batch_.GetF32VecColumn(key_id);
   if (!col) return result;
@@ -72,6 +77,7 @@ std::vector<std::vector<float>> BatchContext::GetF32Vec(int32_t key_id) const {
 }
 
 std::pair<const int64_t*, size_t> BatchContext::GetI64Raw(int32_t key_id) const {
+  CheckReadAllowed(key_id);
   auto* col = batch_.GetI64Column(key_id);
   if (!col) {
     return {nullptr, 0};
@@ -87,6 +93,13 @@ std::vector<int64_t> BatchContext::GetI64(int32_t key_id) const {
   return std::vector<int64_t>(batch_.RowCount(), 0);
 }
 
+void BatchContext::CheckReadAllowed(int32_t key_id) const {
+  if (allowed_reads_ && allowed_reads_->find(key_id) == allowed_reads_->end()) {
+    throw std::runtime_error("Read of key " + FormatKeyId(key_id, registry_) +
+                             " not allowed - not in meta.reads");
+  }
+}
+
 void BatchContext::CheckWriteAllowed(int32_t key_id, keys::KeyType expected_type) {
   // Check meta.writes
   if (allowed_writes_.find(key_id) == allowed_writes_.end()) {
@@ -23,6 +23,7 @@ struct NjsBudget {
   int64_t max_set_per_obj = 10;        // For row-level API
   int64_t max_io_read_bytes = 0;       // 0 = no IO allowed
   int64_t max_io_read_rows = 0;        // 0 = no IO allowed
+  int64_t max_cpu_ms = 50;             // Thread CPU time per execution (capped by policy)
 
   int64_t bytes_written = 0;
   int64_t cells_written = 0;
@@ -71,7 +72,9 @@ struct F32VecView {
  * - Read-only column views (f32, f32vec, i64) with zero-copy where possible
  * - Write column allocation (writeF32, writeF32Vec, writeI64)
  * - Budget enforcement
- * - meta.writes enforcement
+ * - meta.reads and meta.writes enforcement (the plan compiler prunes columns
+ *   no node declares it reads, so an undeclared read would see a missing
+ *   column rather than fail)
  */
 class BatchContext {
  public:
@@ -79,9 +82,10 @@ class BatchContext {
                BatchBuilder& builder,
                const KeyRegistry* registry,
                const std::set<int32_t>& allowed_writes,
-               NjsBudget& budget);
+               NjsBudget& budget,
+               const std::set<int32_t>* allowed_reads = nullptr);  // nullptr = any key
 
-  // Read APIs
+  // Read APIs (column reads throw if the key is not in meta.reads)
   size_t RowCount() const { return batch_.RowCount(); }
 
   // Get zero-copy view of f32 column (returns pointer + size)
@@ -131,6 +135,7 @@ class BatchContext {
   bool HasColumnWrites() const { return !allocated_columns_.empty(); }
 
  private:
+  void CheckReadAllowed(int32_t key_id) const;
   void CheckWriteAllowed(int32_t key_id, keys::KeyType expected_type);
   void CheckBudget(int64_t bytes, int64_t cells);
 
@@ -139,6 +144,7 @@ class BatchContext {
   const KeyRegistry* registry_;
   const std::set<int32_t>& allowed_writes_;
   NjsBudget& budget_;
+  const std::set<int32_t>* allowed_reads_;
 
   // Track allocated writable columns
   struct AllocatedColumn {
@@ -0,0 +1,56 @@
+#include "nodes/js/njs_bytecode.h"
+
+extern "C" {
+#include "quickjs.h"
+}
+
+namespace ranking_dsl {
+
+std::string WrapNjsModuleSource(const std::string& source) {
+  return R"(
+    (function() {
+      var exports = {};
+      var module = { exports: exports };
+      )" + source + R"(
+      return module.exports.meta ? module.exports : exports;
+    })()
+  )";
+}
+
+std::vector<uint8_t> CompileNjsBytecode(const std::string& source,
+                                        const std::string& filename,
+                                        std::string* error_out) {
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
+
+  std::string wrapped = WrapNjsModuleSource(source);
+  JSValue compiled = JS_Eval(ctx, wrapped.c_str(), wrapped.length(), filename.c_str(),
+                             JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+
+  std::vector<uint8_t> bytecode;
+  if (JS_IsException(compiled)) {
+    if (error_out) {
+      JSValue exc = JS_GetException(ctx);
+      const char* message = JS_ToCString(ctx, exc);
+      *error_out = std::string("njs compile failed: ") + (message ? message : "unknown error");
+      if (message) JS_FreeCString(ctx, message);
+      JS_FreeValue(ctx, exc);
+    }
+  } else {
+    size_t size = 0;
+    uint8_t* buf = JS_WriteObject(ctx, &size, compiled, JS_WRITE_OBJ_BYTECODE);
+    if (buf) {
+      bytecode.assign(buf, buf + size);
+      js_free(ctx, buf);
+    } else if (error_out) {
+      *error_out = "njs bytecode serialization failed";
+    }
+  }
+
+  JS_FreeValue(ctx, compiled);
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+  return bytecode;
+}
+
+}  // namespace ranking_dsl
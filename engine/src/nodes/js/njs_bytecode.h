@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ranking_dsl {
+
+/**
+ * Wrap njs module source so that evaluating it yields the module exports.
+ *
+ * Both the runtime source path and the build-time bytecode compiler use this,
+ * so precompiled modules behave exactly like modules loaded from disk.
+ */
+std::string WrapNjsModuleSource(const std::string& source);
+
+/**
+ * Compile njs module source to QuickJS bytecode (without executing it).
+ * Returns an empty vector and sets error_out on syntax errors.
+ *
+ * @param source Module source (unwrapped)
+ * @param filename Name recorded in the bytecode for error messages
+ */
+std::vector<uint8_t> CompileNjsBytecode(const std::string& source,
+                                        const std::string& filename,
+                                        std::string* error_out = nullptr);
+
+}  // namespace ranking_dsl
@@ -0,0 +1,38 @@
+#include "nodes/js/njs_bytecode_registry.h"
+
+namespace ranking_dsl {
+
+NjsBytecodeRegistry& NjsBytecodeRegistry::Instance() {
+  static NjsBytecodeRegistry instance;
+  return instance;
+}
+
+NjsBytecodeRegistry::NjsBytecodeRegistry() {
+  RegisterEmbeddedNjsModules(*this);
+}
+
+void NjsBytecodeRegistry::Register(NjsBytecodeModule module) {
+  if (!module.path.empty()) {
+    digest_by_path_[module.path] = module.digest;
+  }
+  std::string digest = module.digest;
+  by_digest_[digest] = std::move(module);
+}
+
+const NjsBytecodeModule* NjsBytecodeRegistry::FindByDigest(const std::string& digest) const {
+  auto it = by_digest_.find(digest);
+  if (it == by_digest_.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+const NjsBytecodeModule* NjsBytecodeRegistry::FindByPath(const std::string& path) const {
+  auto it = digest_by_path_.find(path);
+  if (it == digest_by_path_.end()) {
+    return nullptr;
+  }
+  return FindByDigest(it->second);
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace ranking_dsl {
+
+/**
+ * A precompiled njs module (QuickJS bytecode of the wrapped module source).
+ */
+struct NjsBytecodeModule {
+  std::string digest;           // First 16 hex chars of SHA256 of the module source
+  std::string path;             // Module path as referenced by plans
+  const uint8_t* data = nullptr;  // Bytecode (must outlive the registry)
+  size_t size = 0;
+};
+
+/**
+ * Registry of precompiled njs modules, keyed by digest.
+ *
+ * Approved modules are compiled at build time (RANKING_DSL_NJS_MODULES) and
+ * linked into the engine, so NjsRunner can load them without touching the
+ * filesystem or the JS parser. Matches pinned identities
+ * `js:<path>@<ver>#<digest>`.
+ *
+ * Register() is not thread-safe; call it during startup only.
+ */
+class NjsBytecodeRegistry {
+ public:
+  /**
+   * Get the global singleton instance (pre-populated with embedded modules).
+   */
+  static NjsBytecodeRegistry& Instance();
+
+  /**
+   * Register a precompiled module (replaces any module with the same digest).
+   */
+  void Register(NjsBytecodeModule module);
+
+  /**
+   * Look up a module by digest. Returns nullptr if not registered.
+   */
+  const NjsBytecodeModule* FindByDigest(const std::string& digest) const;
+
+  /**
+   * Look up a module by path. Returns nullptr if not registered.
+   */
+  const NjsBytecodeModule* FindByPath(const std::string& path) const;
+
+  /**
+   * Number of registered modules.
+   */
+  size_t Size() const { return by_digest_.size(); }
+
+ private:
+  NjsBytecodeRegistry();
+  std::unordered_map<std::string, NjsBytecodeModule> by_digest_;
+  std::unordered_map<std::string, std::string> digest_by_path_;
+};
+
+/**
+ * Register all modules embedded at build time.
+ * Defined in the build-generated njs_embedded_modules.cpp (see rankdsl_njsc).
+ */
+void RegisterEmbeddedNjsModules(NjsBytecodeRegistry& registry);
+
+}  // namespace ranking_dsl
@@ -1,7 +1,10 @@
 #include "nodes/js/njs_runner.h"
 
+#include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 
@@ -10,7 +13,12 @@ extern "C" {
 }
 
 #include "keys/registry.h"
+#include "logging/metrics.h"
+#include "logging/perf_counters.h"
+#include "nodes/js/njs_bytecode.h"
+#include "nodes/js/njs_bytecode_registry.h"
 #include "nodes/registry.h"
+#include "object/memory_stats.h"
 
 namespace ranking_dsl {
 
@@ -64,6 +72,9 @@ NjsMeta NjsMeta::Parse(const nlohmann::json& j) {
     if (budget.contains("max_io_read_rows")) {
       meta.budget.max_io_read_rows = budget["max_io_read_rows"].get<int64_t>();
     }
+    if (budget.contains("max_cpu_ms")) {
+      meta.budget.max_cpu_ms = budget["max_cpu_ms"].get<int64_t>();
+    }
   }
 
   // Parse capabilities
@@ -100,6 +111,19 @@ bool NjsPolicy::LoadFromJson(const std::string& json_str, std::string* error_out
       csv_assets_dir_ = j["csv_assets_dir"].get<std::string>();
     }
 
+    if (j.contains("max_cpu_ms")) {
+      int64_t max_cpu_ms = j["max_cpu_ms"].get<int64_t>();
+      if (max_cpu_ms <= 0) {
+        if (error_out) *error_out = "max_cpu_ms must be positive";
+        return false;
+      }
+      max_cpu_ms_ = max_cpu_ms;
+    }
+
+    if (j.contains("require_embedded")) {
+      require_embedded_ = j["require_embedded"].get<bool>();
+    }
+
     if (j.contains("modules") && j["modules"].is_array()) {
       for (const auto& mod : j["modules"]) {
         NjsPolicyEntry entry;
@@ -112,6 +136,13 @@ bool NjsPolicy::LoadFromJson(const std::string& json_str, std::string* error_out
         if (mod.contains("allow_io_csv_read")) {
           entry.allow_io_csv_read = mod["allow_io_csv_read"].get<bool>();
         }
+        if (mod.contains("max_cpu_ms")) {
+          entry.max_cpu_ms = mod["max_cpu_ms"].get<int64_t>();
+          if (entry.max_cpu_ms <= 0) {
+            if (error_out) *error_out = "max_cpu_ms of module " + entry.name + " must be positive";
+            return false;
+          }
+        }
         entries_.push_back(entry);
       }
     }
@@ -134,6 +165,25 @@ bool NjsPolicy::IsIoCsvReadAllowed(const std::string& name, const std::string& v
   return false;  // Default deny
 }
 
+int64_t NjsPolicy::MaxCpuMs(const std::string& name, const std::string& version) const {
+  for (const auto& entry : entries_) {
+    if (entry.name == name && (entry.version.empty() || entry.version == version)) {
+      if (entry.max_cpu_ms > 0) {
+        return entry.max_cpu_ms;
+      }
+      break;
+    }
+  }
+  return max_cpu_ms_;
+}
+
+// Why the interrupt handler stopped execution
+enum class JsInterruptReason {
+  kNone,
+  kCpuBudget,
+  kDeadline
+};
+
 // Tracked write array for committing data back
 struct TrackedWriteArray {
   int32_t key_id;
@@ -148,11 +198,14 @@ struct JsContext {
   BatchContext* batch_ctx;
   const nlohmann::json* params;
   const KeyRegistry* registry;
-  int64_t instruction_count;
-  int64_t max_instructions;
-  bool interrupted;
   std::vector<TrackedWriteArray> tracked_writes;
 
+  // CPU budget / deadline enforcement (checked by the interrupt handler)
+  int64_t cpu_start_ns;
+  int64_t max_cpu_ns;
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  JsInterruptReason interrupt_reason;
+
   // IO context
   bool io_enabled;
   std::string csv_assets_dir;
@@ -409,17 +462,56 @@ static JSValue JsonToJs(JSContext* ctx, const nlohmann::json& j) {
   return JS_UNDEFINED;
 }
 
-// Interrupt handler for instruction counting
+// Interrupt handler for CPU budget and deadline enforcement.
+// QuickJS polls this periodically (every few thousand bytecode ops), so a
+// thread CPU clock read here is cheap relative to the work in between.
 static int JsInterruptHandler(JSRuntime* rt, void* opaque) {
   auto* js_ctx = static_cast<JsContext*>(opaque);
-  js_ctx->instruction_count++;
-  if (js_ctx->instruction_count >= js_ctx->max_instructions) {
-    js_ctx->interrupted = true;
+  if (ThreadCpuNanos() - js_ctx->cpu_start_ns > js_ctx->max_cpu_ns) {
+    js_ctx->interrupt_reason = JsInterruptReason::kCpuBudget;
     return 1;  // Signal interrupt
   }
+  if (js_ctx->deadline && std::chrono::steady_clock::now() >= *js_ctx->deadline) {
+    js_ctx->interrupt_reason = JsInterruptReason::kDeadline;
+    return 1;
+  }
   return 0;
 }
 
+// Error message for an execution stopped by the interrupt handler
+static std::string InterruptMessage(JsInterruptReason reason, int64_t max_cpu_ms) {
+  if (reason == JsInterruptReason::kDeadline) {
+    return "njs execution exceeded request deadline";
+  }
+  return "njs execution exceeded CPU budget (max_cpu_ms=" + std::to_string(max_cpu_ms) + ")";
+}
+
+// Records per-module latency when an execution leaves NjsRunner::Run,
+// whether it returns normally or throws.
+class ScopedLatencyRecord {
+ public:
+  explicit ScopedLatencyRecord(std::string module_key)
+      : module_key_(std::move(module_key)),
+        wall_start_(std::chrono::steady_clock::now()),
+        cpu_start_ns_(ThreadCpuNanos()) {}
+
+  ~ScopedLatencyRecord() {
+    Metrics::RecordNjsModule(module_key_, std::chrono::steady_clock::now() - wall_start_,
+                             std::chrono::nanoseconds(ThreadCpuNanos() - cpu_start_ns_),
+                             budget_exceeded_);
+  }
+
+  void SetModuleKey(std::string module_key) { module_key_ = std::move(module_key); }
+  void MarkBudgetExceeded() { budget_exceeded_ = true; }
+  int64_t CpuStartNs() const { return cpu_start_ns_; }
+
+ private:
+  std::string module_key_;
+  std::chrono::steady_clock::time_point wall_start_;
+  int64_t cpu_start_ns_;
+  bool budget_exceeded_ = false;
+};
+
 // ctx.batch.rowCount()
 static JSValue JsBatchRowCount(JSContext* ctx, JSValueConst this_val,
                                 int argc, JSValueConst* argv, int magic, JSValue* func_data) {
@@ -436,7 +528,13 @@ static JSValue JsBatchGetF32(JSContext* ctx, JSValueConst this_val,
   int32_t key_id;
   JS_ToInt32(ctx, &key_id, argv[0]);
 
-  auto [data, size] = js_ctx->batch_ctx->GetF32Raw(key_id);
+  std::pair<const float*, size_t> column;
+  try {
+    column = js_ctx->batch_ctx->GetF32Raw(key_id);  // Throws if not in meta.reads
+  } catch (const std::exception& e) {
+    return JS_ThrowTypeError(ctx, "%s", e.what());
+  }
+  auto [data, size] = column;
   if (!data) {
     return JS_NULL;
   }
@@ -458,7 +556,13 @@ static JSValue JsBatchGetI64(JSContext* ctx, JSValueConst this_val,
   int32_t key_id;
   JS_ToInt32(ctx, &key_id, argv[0]);
 
-  auto [data, size] = js_ctx->batch_ctx->GetI64Raw(key_id);
+  std::pair<const int64_t*, size_t> column;
+  try {
+    column = js_ctx->batch_ctx->GetI64Raw(key_id);  // Throws if not in meta.reads
+  } catch (const std::exception& e) {
+    return JS_ThrowTypeError(ctx, "%s", e.what());
+  }
+  auto [data, size] = column;
   if (!data) {
     return JS_NULL;
   }
@@ -602,50 +706,79 @@ class NjsRunner::Impl {
   }
 };
 
-NjsRunner::NjsRunner() : impl_(std::make_unique<Impl>()) {}
-
-NjsRunner::~NjsRunner() = default;
+// An njs module resolved from params: precompiled bytecode or source from disk
+struct ResolvedNjsModule {
+  std::string path;
+  const NjsBytecodeModule* embedded = nullptr;
+  std::string source;  // Set when not embedded
+};
 
-CandidateBatch NjsRunner::Run(const ExecContext& ctx,
-                              const CandidateBatch& input,
-                              const nlohmann::json& params) {
-  // Load module path from params
-  if (!params.contains("module")) {
+// Resolve params.digest / params.module, preferring bytecode precompiled into
+// the engine (no filesystem or parser). A digest pins the module: it must be
+// precompiled, and neither the path nor the disk can stand in for it. Throws
+// on failure.
+static ResolvedNjsModule ResolveNjsModule(const nlohmann::json& params,
+                                          const NjsPolicy* policy) {
+  if (!params.contains("module") && !params.contains("digest")) {
     throw std::runtime_error("njs node requires 'module' param");
   }
 
-  std::string module_path = params["module"].get<std::string>();
+  ResolvedNjsModule module;
+  module.path = params.value("module", "");
+  std::string digest = params.value("digest", "");
+
+  const auto& bytecode_registry = NjsBytecodeRegistry::Instance();
+  if (!digest.empty()) {
+    module.embedded = bytecode_registry.FindByDigest(digest);
+    if (!module.embedded) {
+      throw std::runtime_error("No precompiled njs module with digest: " + digest);
+    }
+  } else if (!module.path.empty()) {
+    module.embedded = bytecode_registry.FindByPath(module.path);
+  }
+
+  if (module.embedded) {
+    if (module.path.empty()) {
+      module.path = module.embedded->path;
+    }
+    return module;
+  }
+
+  if (policy && policy->RequireEmbedded()) {
+    throw std::runtime_error("njs module is not precompiled: " + module.path);
+  }
 
   // Read the module source
-  std::ifstream file(module_path);
+  std::ifstream file(module.path);
   if (!file.is_open()) {
-    throw std::runtime_error("Failed to open njs module: " + module_path);
+    throw std::runtime_error("Failed to open njs module: " + module.path);
   }
   std::stringstream buffer;
   buffer << file.rdbuf();
-  std::string source = buffer.str();
+  module.source = buffer.str();
+  return module;
+}
 
-  if (input.RowCount() == 0) {
-    return input;
+// Evaluate a resolved module; returns its exports (or an exception value)
+static JSValue EvalNjsModule(JSContext* ctx, const ResolvedNjsModule& module) {
+  if (module.embedded) {
+    JSValue func = JS_ReadObject(ctx, module.embedded->data, module.embedded->size,
+                                 JS_READ_OBJ_BYTECODE);
+    return JS_IsException(func) ? func : JS_EvalFunction(ctx, func);
   }
+  std::string wrapped = WrapNjsModuleSource(module.source);
+  return JS_Eval(ctx, wrapped.c_str(), wrapped.length(), module.path.c_str(),
+                 JS_EVAL_TYPE_GLOBAL);
+}
 
-  // Create a fresh context for this execution
-  JSContext* js_ctx_handle = JS_NewContext(impl_->rt);
-  JS_SetContextOpaque(js_ctx_handle, &impl_->js_ctx);
-
-  // Set up interrupt handler for instruction counting
-  impl_->js_ctx.instruction_count = 0;
-  impl_->js_ctx.max_instructions = 1000000;  // 1M instructions default
-  impl_->js_ctx.interrupted = false;
-  JS_SetInterruptHandler(impl_->rt, JsInterruptHandler, &impl_->js_ctx);
-
-  // Inject Keys global from registry
-  JSValue global = JS_GetGlobalObject(js_ctx_handle);
-  JSValue keys_obj = JS_NewObject(js_ctx_handle);
-  JSValue key_info_obj = JS_NewObject(js_ctx_handle);
+// Inject Keys / KeyInfo globals from the registry
+static void InjectKeyGlobals(JSContext* ctx, const KeyRegistry* registry) {
+  JSValue global = JS_GetGlobalObject(ctx);
+  JSValue keys_obj = JS_NewObject(ctx);
+  JSValue key_info_obj = JS_NewObject(ctx);
 
-  if (ctx.registry) {
-    for (const auto& key_entry : ctx.registry->AllKeys()) {
+  if (registry) {
+    for (const auto& key_entry : registry->AllKeys()) {
       // Convert name to constant format: "score.base" -> "SCORE_BASE"
       std::string const_name = key_entry.name;
       for (char& c : const_name) {
@@ -654,44 +787,119 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
       }
 
       // Keys.SCORE_BASE = 3001
-      JS_SetPropertyStr(js_ctx_handle, keys_obj, const_name.c_str(),
-                        JS_NewInt32(js_ctx_handle, key_entry.id));
+      JS_SetPropertyStr(ctx, keys_obj, const_name.c_str(), JS_NewInt32(ctx, key_entry.id));
 
       // KeyInfo.SCORE_BASE = { id: 3001, name: "score.base", type: "f32" }
-      JSValue info = JS_NewObject(js_ctx_handle);
-      JS_SetPropertyStr(js_ctx_handle, info, "id", JS_NewInt32(js_ctx_handle, key_entry.id));
-      JS_SetPropertyStr(js_ctx_handle, info, "name",
-                        JS_NewString(js_ctx_handle, key_entry.name.c_str()));
+      JSValue info = JS_NewObject(ctx);
+      JS_SetPropertyStr(ctx, info, "id", JS_NewInt32(ctx, key_entry.id));
+      JS_SetPropertyStr(ctx, info, "name", JS_NewString(ctx, key_entry.name.c_str()));
       std::string type_str(KeyTypeToString(key_entry.type));
-      JS_SetPropertyStr(js_ctx_handle, info, "type",
-                        JS_NewString(js_ctx_handle, type_str.c_str()));
-      JS_SetPropertyStr(js_ctx_handle, key_info_obj, const_name.c_str(), info);
+      JS_SetPropertyStr(ctx, info, "type", JS_NewString(ctx, type_str.c_str()));
+      JS_SetPropertyStr(ctx, key_info_obj, const_name.c_str(), info);
     }
   }
 
-  JS_SetPropertyStr(js_ctx_handle, global, "Keys", keys_obj);
-  JS_SetPropertyStr(js_ctx_handle, global, "KeyInfo", key_info_obj);
-  JS_FreeValue(js_ctx_handle, global);
+  JS_SetPropertyStr(ctx, global, "Keys", keys_obj);
+  JS_SetPropertyStr(ctx, global, "KeyInfo", key_info_obj);
+  JS_FreeValue(ctx, global);
+}
+
+bool LoadNjsMeta(const nlohmann::json& params, const KeyRegistry* registry,
+                 NjsMeta& out, std::string* error_out) {
+  ResolvedNjsModule module;
+  try {
+    module = ResolveNjsModule(params, nullptr);
+  } catch (const std::exception& e) {
+    if (error_out) *error_out = e.what();
+    return false;
+  }
 
-  // Wrap module in function to get exports
-  std::string wrapped = R"(
-    (function() {
-      var exports = {};
-      var module = { exports: exports };
-      )" + source + R"(
-      return module.exports.meta ? module.exports : exports;
-    })()
-  )";
+  JSRuntime* rt = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(rt);
 
-  // Evaluate the module
-  JSValue module_val = JS_Eval(js_ctx_handle, wrapped.c_str(), wrapped.length(),
-                               module_path.c_str(), JS_EVAL_TYPE_GLOBAL);
+  // Top-level module code still runs under the default CPU cap
+  JsContext js_ctx{};
+  js_ctx.cpu_start_ns = ThreadCpuNanos();
+  js_ctx.max_cpu_ns = NjsPolicy::kDefaultMaxCpuMs * 1000000;
+  JS_SetContextOpaque(ctx, &js_ctx);
+  JS_SetInterruptHandler(rt, JsInterruptHandler, &js_ctx);
+  InjectKeyGlobals(ctx, registry);
+
+  bool ok = false;
+  JSValue module_val = EvalNjsModule(ctx, module);
+  if (JS_IsException(module_val)) {
+    JSValue exc = JS_GetException(ctx);
+    if (error_out) *error_out = "njs module evaluation failed: " + JsGetString(ctx, exc);
+    JS_FreeValue(ctx, exc);
+  } else {
+    JSValue meta_val = JS_GetPropertyStr(ctx, module_val, "meta");
+    if (JS_IsUndefined(meta_val)) {
+      if (error_out) *error_out = "njs module missing 'meta' export";
+    } else {
+      out = NjsMeta::Parse(JsToJson(ctx, meta_val));
+      ok = true;
+    }
+    JS_FreeValue(ctx, meta_val);
+  }
+
+  JS_FreeValue(ctx, module_val);
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(rt);
+  return ok;
+}
+
+NjsRunner::NjsRunner() : impl_(std::make_unique<Impl>()) {}
+
+NjsRunner::~NjsRunner() = default;
+
+CandidateBatch NjsRunner::Run(const ExecContext& ctx,
+                              const CandidateBatch& input,
+                              const nlohmann::json& params) {
+  // A policy set on the runner overrides the request's
+  const NjsPolicy* policy = policy_ ? policy_ : ctx.njs_policy;
+  ResolvedNjsModule module = ResolveNjsModule(params, policy);
+  const std::string& module_path = module.path;
+
+  if (input.RowCount() == 0) {
+    return input;
+  }
+
+  // Keyed by module path until meta is parsed
+  ScopedLatencyRecord latency(module_path);
+
+  // Heap growth from here to the end of runBatch is charged to the node
+  JSMemoryUsage heap_before{};
+  if (ctx.node_memory) {
+    JS_ComputeMemoryUsage(impl_->rt, &heap_before);
+  }
+
+  // Create a fresh context for this execution
+  JSContext* js_ctx_handle = JS_NewContext(impl_->rt);
+  JS_SetContextOpaque(js_ctx_handle, &impl_->js_ctx);
+
+  // Set up interrupt handler for CPU budget and deadline enforcement.
+  // Until meta is known, module evaluation runs under the policy-wide cap.
+  int64_t max_cpu_ms = policy ? policy->MaxCpuMs() : NjsPolicy::kDefaultMaxCpuMs;
+  impl_->js_ctx.cpu_start_ns = latency.CpuStartNs();
+  impl_->js_ctx.max_cpu_ns = max_cpu_ms * 1000000;
+  impl_->js_ctx.deadline = ctx.deadline;
+  impl_->js_ctx.interrupt_reason = JsInterruptReason::kNone;
+  JS_SetInterruptHandler(impl_->rt, JsInterruptHandler, &impl_->js_ctx);
+
+  InjectKeyGlobals(js_ctx_handle, ctx.registry);
+
+  // Evaluate the module (wrapped in a function to get exports)
+  JSValue module_val = EvalNjsModule(js_ctx_handle, module);
 
   if (JS_IsException(module_val)) {
     JSValue exc = JS_GetException(js_ctx_handle);
     std::string error = JsGetString(js_ctx_handle, exc);
     JS_FreeValue(js_ctx_handle, exc);
     JS_FreeContext(js_ctx_handle);
+    if (impl_->js_ctx.interrupt_reason != JsInterruptReason::kNone) {
+      latency.MarkBudgetExceeded();
+      throw std::runtime_error(InterruptMessage(impl_->js_ctx.interrupt_reason, max_cpu_ms));
+    }
     throw std::runtime_error("njs module evaluation failed: " + error);
   }
 
@@ -707,6 +915,17 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
   JS_FreeValue(js_ctx_handle, meta_val);
   NjsMeta meta = NjsMeta::Parse(meta_json);
 
+  if (!meta.name.empty()) {
+    latency.SetModuleKey(meta.name + "@" + meta.version);
+  }
+
+  // Effective CPU budget: meta.budget.max_cpu_ms clamped to the policy cap
+  int64_t cpu_cap_ms = policy ? policy->MaxCpuMs(meta.name, meta.version)
+                              : NjsPolicy::kDefaultMaxCpuMs;
+  max_cpu_ms = meta.budget.max_cpu_ms > 0 ? std::min(meta.budget.max_cpu_ms, cpu_cap_ms)
+                                          : cpu_cap_ms;
+  impl_->js_ctx.max_cpu_ns = max_cpu_ms * 1000000;
+
   // Extract runBatch
   JSValue run_batch_val = JS_GetPropertyStr(js_ctx_handle, module_val, "runBatch");
   if (!JS_IsFunction(js_ctx_handle, run_batch_val)) {
@@ -723,7 +942,7 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
   NjsBudget budget = meta.budget;
 
   // Create batch context
-  BatchContext batch_ctx(input, builder, ctx.registry, meta.writes, budget);
+  BatchContext batch_ctx(input, builder, ctx.registry, meta.writes, budget, &meta.reads);
 
   // Set up JS context
   impl_->js_ctx.batch_ctx = &batch_ctx;
@@ -742,10 +961,10 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
 
   if (io_requested) {
     // Check policy (default deny if no policy set)
-    if (policy_ && policy_->IsIoCsvReadAllowed(meta.name, meta.version)) {
+    if (policy && policy->IsIoCsvReadAllowed(meta.name, meta.version)) {
       io_allowed = true;
       impl_->js_ctx.io_enabled = true;
-      impl_->js_ctx.csv_assets_dir = policy_->CsvAssetsDir();
+      impl_->js_ctx.csv_assets_dir = policy->CsvAssetsDir();
     }
   }
 
@@ -772,8 +991,8 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
   JSValue args[3] = { objs_arr, ctx_obj, params_js };
   JSValue result = JS_Call(js_ctx_handle, run_batch_val, JS_UNDEFINED, 3, args);
 
-  // Check for interrupt
-  if (impl_->js_ctx.interrupted) {
+  // Check for interrupt (CPU budget or deadline)
+  if (impl_->js_ctx.interrupt_reason != JsInterruptReason::kNone) {
     JS_FreeValue(js_ctx_handle, result);
     JS_FreeValue(js_ctx_handle, args[0]);
     JS_FreeValue(js_ctx_handle, args[1]);
@@ -781,7 +1000,8 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
     JS_FreeValue(js_ctx_handle, run_batch_val);
     JS_FreeValue(js_ctx_handle, module_val);
     JS_FreeContext(js_ctx_handle);
-    throw std::runtime_error("njs execution exceeded instruction limit");
+    latency.MarkBudgetExceeded();
+    throw std::runtime_error(InterruptMessage(impl_->js_ctx.interrupt_reason, max_cpu_ms));
   }
 
   if (JS_IsException(result)) {
@@ -805,6 +1025,13 @@ CandidateBatch NjsRunner::Run(const ExecContext& ctx,
     batch_ctx.Commit();
   }
 
+  if (ctx.node_memory) {
+    JSMemoryUsage heap_after{};
+    JS_ComputeMemoryUsage(impl_->rt, &heap_after);
+    ctx.node_memory->njs_heap_bytes =
+        std::max<int64_t>(0, heap_after.malloc_size - heap_before.malloc_size);
+  }
+
   // Cleanup
   JS_FreeValue(js_ctx_handle, result);
   JS_FreeValue(js_ctx_handle, args[0]);
@@ -835,7 +1062,7 @@ CandidateBatch NjsRunner::RunWithMeta(
   NjsBudget budget = meta.budget;
 
   // Create batch context with enforcement
-  BatchContext batch_ctx(input, builder, ctx.registry, meta.writes, budget);
+  BatchContext batch_ctx(input, builder, ctx.registry, meta.writes, budget, &meta.reads);
 
   // Execute the column-level function
   column_fn(batch_ctx, params);
@@ -864,6 +1091,10 @@ static NodeSpec CreateNjsRunnerSpec() {
         "type": "string",
         "description": "Path to .njs module"
       },
+      "digest": {
+        "type": "string",
+        "description": "Pinned module digest; resolves precompiled bytecode"
+      },
       "params": {
         "type": "object",
         "description": "Parameters for the njs module"
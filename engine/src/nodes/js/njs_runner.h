@@ -3,6 +3,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -26,6 +27,14 @@ struct NjsMeta {
   static NjsMeta Parse(const nlohmann::json& j);
 };
 
+/**
+ * Evaluate an njs module (without calling runBatch) and parse its meta.
+ * Resolves params.digest / params.module like NjsRunner::Run. Used by the
+ * plan compiler to learn an njs node's reads/writes.
+ */
+bool LoadNjsMeta(const nlohmann::json& params, const KeyRegistry* registry,
+                 NjsMeta& out, std::string* error_out = nullptr);
+
 /**
  * Policy entry for a single njs module.
  */
@@ -33,6 +42,7 @@ struct NjsPolicyEntry {
   std::string name;
   std::string version;
   bool allow_io_csv_read = false;
+  int64_t max_cpu_ms = 0;  // Per-module CPU cap (0 = use policy-wide cap)
 };
 
 /**
@@ -55,14 +65,33 @@ class NjsPolicy {
   // Get the CSV assets base directory
   const std::string& CsvAssetsDir() const { return csv_assets_dir_; }
 
+  // Get the CPU time cap for a module (meta.budget.max_cpu_ms is clamped to this)
+  int64_t MaxCpuMs(const std::string& name, const std::string& version) const;
+
+  // Get the policy-wide CPU time cap
+  int64_t MaxCpuMs() const { return max_cpu_ms_; }
+
+  // Only run modules precompiled into the engine (no filesystem loads)
+  bool RequireEmbedded() const { return require_embedded_; }
+
+  // Policy-wide CPU cap used when no policy is configured
+  static constexpr int64_t kDefaultMaxCpuMs = 200;
+
  private:
   std::vector<NjsPolicyEntry> entries_;
   std::string csv_assets_dir_ = "njs/assets/csv";  // Default assets directory
+  int64_t max_cpu_ms_ = kDefaultMaxCpuMs;
+  bool require_embedded_ = false;
 };
 
 /**
  * NjsRunner executes JavaScript njs modules.
  *
+ * Modules are resolved from NjsBytecodeRegistry first (params.digest, then
+ * params.module as path); otherwise params.module is read and parsed from disk.
+ * A params.digest that is not precompiled fails rather than falling back to
+ * the path, which could hold other code.
+ *
  * Supports two execution modes:
  * 1. Row-level: runBatch returns Obj[] with row-level modifications
  * 2. Column-level: runBatch uses ctx.batch.write* APIs and returns undefined
@@ -70,6 +99,9 @@ class NjsPolicy {
  * Enforces:
  * - meta.writes for all write operations
  * - Budget limits (max_write_bytes, max_write_cells, max_set_per_obj)
+ * - CPU budget (meta.budget.max_cpu_ms, capped by policy) and the request
+ *   deadline, both checked from the QuickJS interrupt handler; every
+ *   execution's wall and CPU time is recorded with Metrics::RecordNjsModule
  * - Type checks via KeyRegistry
  * - IO capabilities via policy allowlist (default deny)
  *
@@ -83,7 +115,7 @@ class NjsRunner : public NodeRunner {
   NjsRunner();
   ~NjsRunner() override;
 
-  // Set the policy for IO capabilities (must be called before Run if IO needed)
+  // Set the policy for IO capabilities and CPU caps; overrides ExecContext::njs_policy
   void SetPolicy(const NjsPolicy* policy) { policy_ = policy; }
 
   CandidateBatch Run(const ExecContext& ctx,
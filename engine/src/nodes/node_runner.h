@@ -1,7 +1,11 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 #include <nlohmann/json_fwd.hpp>
 
@@ -9,14 +13,69 @@
 
 namespace ranking_dsl {
 
+class CompiledExpr;
 class KeyRegistry;
+class NjsPolicy;
+class ParamBindings;
+class RowBlock;
+struct BatchSchema;
+struct ExecStats;
+struct NodeMemoryStats;
 
 /**
  * Execution context passed to node runners.
  */
 struct ExecContext {
   const KeyRegistry* registry = nullptr;
-  // Request-level context can be added here
+
+  // Request deadline (wall clock). Long-running nodes (njs) check this
+  // and abort once it has passed.
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+
+  // Engine policy for njs nodes: IO allowlist, CPU caps, embedded-only
+  // loads (nullptr = default deny, default CPU cap, disk loads allowed)
+  const NjsPolicy* njs_policy = nullptr;
+
+  // Request-level values for the plan's declared bindings (nullptr = defaults)
+  const ParamBindings* bindings = nullptr;
+
+  // Every declared binding resolved for this request (request value or
+  // default); set by the executor for runners whose precompiled formula
+  // reads bindings (nullptr = the plan has none)
+  const std::unordered_map<std::string, nlohmann::json>* binding_values = nullptr;
+
+  // Request-supplied candidates; core:sourcer emits these (its first k rows)
+  // instead of generating its own (nullptr = generate)
+  const CandidateBatch* candidates = nullptr;
+
+  // Compile-time schema of the node's input batch (nullptr = not inferred).
+  // Runners use it to bind typed column readers before their row loops.
+  const BatchSchema* input_schema = nullptr;
+
+  // The node's score formula, compiled against input_schema by the plan
+  // compiler (nullptr = the runner compiles its own)
+  const CompiledExpr* compiled_expr = nullptr;
+
+  // Force (true) or suppress (false) the plan's sampled key dumps for this
+  // request; unset = sample with plan.logging.sample_rate
+  std::optional<bool> sample;
+
+  // Force (true) or suppress (false) node spans for this request;
+  // unset = sample with TraceOptions::request_sample_rate
+  std::optional<bool> trace;
+
+  // Attribute hardware counter deltas (cycles, instructions, cache and
+  // branch misses, LLC loads) to each node's trace event and metrics.
+  // Linux only; runs without counters when perf_event_open is unavailable.
+  bool perf_counters = false;
+
+  // Filled with per-node memory accounting and the request's peak live
+  // column bytes (nullptr = not collected)
+  ExecStats* stats = nullptr;
+
+  // Set by the executor around each runner call. Runners add memory their
+  // output batch does not show (njs heap growth); may be nullptr.
+  NodeMemoryStats* node_memory = nullptr;
 };
 
 /**
@@ -34,6 +93,24 @@ class NodeRunner {
                              const CandidateBatch& input,
                              const nlohmann::json& params) = 0;
 
+  /**
+   * Run the node over one row block of a fused chain.
+   * Only called for ops whose NodeSpec sets `fusible` and whose runner
+   * RunsBlocks(); such nodes must be row-independent (same row count in and
+   * out, row i depends only on row i) and produce the same values as Run().
+   * The default throws: a runner without a block path must not be fused.
+   */
+  virtual void RunBlock(const ExecContext& ctx, RowBlock& block,
+                        const nlohmann::json& params) {
+    throw std::logic_error(TypeName() + " cannot run row blocks");
+  }
+
+  /**
+   * True if the runner implements RunBlock; fusion leaves other nodes
+   * unfused even when their NodeSpec is `fusible`.
+   */
+  virtual bool RunsBlocks() const { return false; }
+
   /**
    * Get the node type name.
    */
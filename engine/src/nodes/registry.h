@@ -49,6 +49,7 @@ struct NodeSpec {
   std::string params_schema_json;      // JSON Schema as string
   std::vector<int32_t> reads;          // Key IDs this node reads
   WritesDescriptor writes;             // What this node writes
+  bool fusible = false;                // Row-independent; runner RunsBlocks()
 
   // Optional fields (empty if not applicable)
   std::string budgets_json;            // JSON string with budget constraints
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "object/typed_column.h"
+
+namespace ranking_dsl {
+
+/**
+ * BatchSchema - the columns a batch carries and their types.
+ *
+ * Inferred per plan node by the compiler (see plan/schema.h) so runners can
+ * bind typed column readers up front instead of probing types per row.
+ * An unknown schema (known == false) promises nothing; readers must probe.
+ */
+struct BatchSchema {
+  bool known = false;
+  std::vector<std::pair<int32_t, ColumnType>> columns;  // Sorted by key
+
+  /**
+   * Type of key_id's column, or nullopt if the batch has none.
+   * Always nullopt for an unknown schema.
+   */
+  std::optional<ColumnType> TypeOf(int32_t key_id) const {
+    auto it = Find(key_id);
+    if (!known || it == columns.end() || it->first != key_id) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  /**
+   * Add key_id, or change its type if present.
+   */
+  void Set(int32_t key_id, ColumnType type) {
+    auto it = Find(key_id);
+    if (it != columns.end() && it->first == key_id) {
+      it->second = type;
+    } else {
+      columns.insert(it, {key_id, type});
+    }
+  }
+
+  bool operator==(const BatchSchema& other) const {
+    return known == other.known && columns == other.columns;
+  }
+
+ private:
+  std::vector<std::pair<int32_t, ColumnType>>::const_iterator Find(int32_t key_id) const {
+    return std::lower_bound(columns.begin(), columns.end(), key_id,
+                            [](const auto& column, int32_t key) { return column.first < key; });
+  }
+  std::vector<std::pair<int32_t, ColumnType>>::iterator Find(int32_t key_id) {
+    return std::lower_bound(columns.begin(), columns.end(), key_id,
+                            [](const auto& column, int32_t key) { return column.first < key; });
+  }
+};
+
+}  // namespace ranking_dsl
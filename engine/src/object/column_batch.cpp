@@ -1,5 +1,7 @@
 #include "object/column_batch.h"
 
+#include <algorithm>
+
 namespace ranking_dsl {
 
 ColumnBatch::ColumnBatch(size_t row_count) : row_count_(row_count) {}
@@ -84,6 +86,57 @@ std::vector<int32_t> ColumnBatch::ColumnKeys() const {
   return keys;
 }
 
+size_t ColumnBatch::RetainColumns(const std::vector<int32_t>& live_keys) {
+  size_t removed = 0;
+  for (auto it = columns_.begin(); it != columns_.end();) {
+    if (std::find(live_keys.begin(), live_keys.end(), it->first) == live_keys.end()) {
+      it = columns_.erase(it);
+      ++removed;
+    } else {
+      ++it;
+    }
+  }
+  return removed;
+}
+
+ColumnBatch ColumnBatch::SelectRows(const std::vector<size_t>& rows) const {
+  ColumnBatch output(rows.size());
+  for (const auto& [key_id, column] : columns_) {
+    if (!column) continue;
+
+    TypedColumnPtr selected;
+    switch (column->Type()) {
+      case ColumnType::F32:
+        selected = std::make_shared<F32Column>(rows.size());
+        break;
+      case ColumnType::I64:
+        selected = std::make_shared<I64Column>(rows.size());
+        break;
+      case ColumnType::Bool:
+        selected = std::make_shared<BoolColumn>(rows.size());
+        break;
+      case ColumnType::String:
+        selected = std::make_shared<StringColumn>(rows.size());
+        break;
+      case ColumnType::F32Vec:
+        selected = std::make_shared<F32VecColumn>(
+            rows.size(), static_cast<const F32VecColumn*>(column.get())->Dim());
+        break;
+      case ColumnType::Bytes:
+        selected = std::make_shared<BytesColumn>(rows.size());
+        break;
+      default:
+        continue;
+    }
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+      selected->SetValue(i, column->GetValue(rows[i]));
+    }
+    output.columns_[key_id] = std::move(selected);
+  }
+  return output;
+}
+
 void ColumnBatch::SetColumn(int32_t key_id, TypedColumnPtr column) {
   columns_[key_id] = std::move(column);
 }
@@ -106,6 +106,17 @@ class ColumnBatch {
    */
   void SetColumn(int32_t key_id, TypedColumnPtr column);
 
+  /**
+   * Drop every column whose key_id is not in live_keys.
+   * Returns the number of columns removed.
+   */
+  size_t RetainColumns(const std::vector<int32_t>& live_keys);
+
+  /**
+   * Copy the given rows, in order, into a new batch with the same columns.
+   */
+  ColumnBatch SelectRows(const std::vector<size_t>& rows) const;
+
   /**
    * Get the reference count for a column (for testing COW).
    * Returns 0 if column doesn't exist.
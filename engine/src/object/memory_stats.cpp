@@ -0,0 +1,54 @@
+#include "object/memory_stats.h"
+
+#include <algorithm>
+
+namespace ranking_dsl {
+
+NodeMemoryStats AccountNodeMemory(const ColumnBatch& input, const ColumnBatch& output) {
+  NodeMemoryStats stats;
+  for (const auto& [key, column] : output.Columns()) {
+    if (!column) {
+      continue;
+    }
+    int64_t bytes = static_cast<int64_t>(column->ByteSize());
+    TypedColumnPtr source = input.GetColumn(key);
+    if (source == column) {
+      stats.shared_bytes += bytes;
+    } else {
+      stats.allocated_bytes += bytes;
+      if (source) {
+        stats.copied_bytes += bytes;
+      }
+    }
+  }
+  return stats;
+}
+
+void LiveColumnTracker::Hold(const ColumnBatch& batch) {
+  for (const auto& [key, column] : batch.Columns()) {
+    if (!column) {
+      continue;
+    }
+    Entry& entry = columns_[column.get()];
+    if (entry.refs++ == 0) {
+      entry.bytes = static_cast<int64_t>(column->ByteSize());
+      live_bytes_ += entry.bytes;
+    }
+  }
+  peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+}
+
+void LiveColumnTracker::Release(const ColumnBatch& batch) {
+  for (const auto& [key, column] : batch.Columns()) {
+    auto it = column ? columns_.find(column.get()) : columns_.end();
+    if (it == columns_.end()) {
+      continue;
+    }
+    if (--it->second.refs == 0) {
+      live_bytes_ -= it->second.bytes;
+      columns_.erase(it);
+    }
+  }
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "object/column_batch.h"
+
+namespace ranking_dsl {
+
+/**
+ * Memory attributed to one node's run.
+ *
+ * Column figures compare the node's output batch with its input:
+ * allocated bytes are output columns the input does not hold (fresh or
+ * copied), copied bytes are the part of those that replace an input column
+ * of the same key (BatchBuilder COW clone, row selection), and shared bytes
+ * are output columns reused from the input. Scratch memory a node frees
+ * before returning is not seen.
+ */
+struct NodeMemoryStats {
+  int64_t allocated_bytes = 0;
+  int64_t copied_bytes = 0;
+  int64_t shared_bytes = 0;
+  int64_t njs_heap_bytes = 0;  // QuickJS heap growth during the run (njs nodes)
+  int64_t live_bytes = -1;     // Column bytes the request holds after the node (-1 = untracked)
+};
+
+/**
+ * Account output's columns against input's (see NodeMemoryStats).
+ */
+NodeMemoryStats AccountNodeMemory(const ColumnBatch& input, const ColumnBatch& output);
+
+/**
+ * LiveColumnTracker - distinct column bytes held by a set of batches.
+ *
+ * Columns shared between batches (COW) count once, for as long as any
+ * held batch references them.
+ */
+class LiveColumnTracker {
+ public:
+  void Hold(const ColumnBatch& batch);
+  void Release(const ColumnBatch& batch);
+
+  int64_t LiveBytes() const { return live_bytes_; }
+  int64_t PeakBytes() const { return peak_bytes_; }
+
+ private:
+  struct Entry {
+    int64_t bytes = 0;
+    int32_t refs = 0;
+  };
+
+  std::unordered_map<const TypedColumn*, Entry> columns_;
+  int64_t live_bytes_ = 0;
+  int64_t peak_bytes_ = 0;
+};
+
+}  // namespace ranking_dsl
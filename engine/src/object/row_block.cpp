@@ -0,0 +1,117 @@
+#include "object/row_block.h"
+
+#include <algorithm>
+
+namespace ranking_dsl {
+
+RowBlock::RowBlock(const ColumnBatch& input) : input_(input) {}
+
+void RowBlock::Reset(size_t begin, size_t size) {
+  begin_ = begin;
+  size_ = size;
+  ++epoch_;
+  written_.clear();
+}
+
+RowBlock::Slot& RowBlock::Prepare(int32_t key_id, ColumnType type, size_t dim) {
+  Slot& slot = slots_[key_id];
+  slot.type = type;
+  slot.dim = dim;
+  slot.data.resize(size_ * dim);
+  slot.epoch = epoch_;
+  slot.written = false;
+  return slot;
+}
+
+const float* RowBlock::ReadF32(int32_t key_id) {
+  auto it = slots_.find(key_id);
+  if (it != slots_.end() && it->second.epoch == epoch_ && it->second.type == ColumnType::F32) {
+    return it->second.data.data();
+  }
+
+  Slot& slot = Prepare(key_id, ColumnType::F32, 1);
+  float* out = slot.data.data();
+  if (auto* col = input_.GetF32Column(key_id)) {
+    for (size_t i = 0; i < size_; ++i) {
+      out[i] = col->IsNull(begin_ + i) ? 0.0f : col->Get(begin_ + i);
+    }
+  } else if (auto* col = input_.GetI64Column(key_id)) {
+    for (size_t i = 0; i < size_; ++i) {
+      out[i] = col->IsNull(begin_ + i) ? 0.0f : static_cast<float>(col->Get(begin_ + i));
+    }
+  } else {
+    std::fill(out, out + size_, 0.0f);
+  }
+  return out;
+}
+
+const float* RowBlock::ReadF32Vec(int32_t key_id, size_t* dim) {
+  auto it = slots_.find(key_id);
+  if (it != slots_.end() && it->second.epoch == epoch_ &&
+      it->second.type == ColumnType::F32Vec) {
+    *dim = it->second.dim;
+    return it->second.data.data();
+  }
+
+  auto* col = input_.GetF32VecColumn(key_id);
+  if (!col || col->Dim() == 0) {
+    *dim = 0;
+    return nullptr;
+  }
+
+  *dim = col->Dim();
+  Slot& slot = Prepare(key_id, ColumnType::F32Vec, col->Dim());
+  float* out = slot.data.data();
+  for (size_t i = 0; i < size_; ++i) {
+    float* row = out + i * col->Dim();
+    if (col->IsNull(begin_ + i)) {
+      std::fill(row, row + col->Dim(), 0.0f);
+    } else {
+      const float* src = col->GetRow(begin_ + i);
+      std::copy(src, src + col->Dim(), row);
+    }
+  }
+  return out;
+}
+
+float* RowBlock::WriteF32(int32_t key_id) {
+  return WriteF32Vec(key_id, 0);
+}
+
+float* RowBlock::WriteF32Vec(int32_t key_id, size_t dim) {
+  ColumnType type = dim == 0 ? ColumnType::F32 : ColumnType::F32Vec;
+  size_t width = dim == 0 ? 1 : dim;
+
+  auto it = slots_.find(key_id);
+  bool rewrite = it != slots_.end() && it->second.epoch == epoch_ && it->second.written;
+  Slot& slot = Prepare(key_id, type, width);
+  slot.written = true;
+
+  auto entry = std::find_if(written_.begin(), written_.end(),
+                            [&](const Written& w) { return w.key_id == key_id; });
+  if (rewrite && entry != written_.end()) {
+    entry->type = type;
+    entry->dim = width;
+  } else {
+    written_.push_back({key_id, type, width});
+  }
+  return slot.data.data();
+}
+
+float* RowBlock::Temp(size_t slot) {
+  if (temps_.size() <= slot) {
+    temps_.resize(slot + 1);
+  }
+  temps_[slot].resize(size_);
+  return temps_[slot].data();
+}
+
+const float* RowBlock::WrittenData(int32_t key_id) const {
+  auto it = slots_.find(key_id);
+  if (it == slots_.end() || it->second.epoch != epoch_ || !it->second.written) {
+    return nullptr;
+  }
+  return it->second.data.data();
+}
+
+}  // namespace ranking_dsl
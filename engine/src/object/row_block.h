@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "object/column_batch.h"
+
+namespace ranking_dsl {
+
+/**
+ * RowBlock - a window of rows processed by a fused node chain.
+ *
+ * Fusible nodes (NodeSpec::fusible) run stage by stage over one block of
+ * rows at a time instead of over the whole batch, so a chain such as
+ * features -> model -> score_formula keeps its working set in cache.
+ *
+ * - Write*(key) returns a block-local buffer for the current window. Buffers
+ *   are reused across blocks; only keys that are live after the chain are
+ *   copied into full output columns.
+ * - Read*(key) returns what an earlier stage wrote in this block, else the
+ *   input batch's values for the window, materialized into scratch with the
+ *   same defaults as row-wise reads (missing/null -> 0, I64 -> float).
+ * - Other column types are read from Input() at row Begin() + i.
+ */
+class RowBlock {
+ public:
+  explicit RowBlock(const ColumnBatch& input);
+
+  /**
+   * Move the window to rows [begin, begin + size).
+   * Values written for the previous window are discarded.
+   */
+  void Reset(size_t begin, size_t size);
+
+  size_t Begin() const { return begin_; }
+  size_t Size() const { return size_; }
+  const ColumnBatch& Input() const { return input_; }
+
+  /**
+   * Scalar F32 values for the window (Size() floats).
+   */
+  const float* ReadF32(int32_t key_id);
+
+  /**
+   * F32Vec values for the window (Size() x dim floats, row-major).
+   * Returns nullptr with *dim = 0 if the key holds no vectors.
+   * Null rows read as zero vectors.
+   */
+  const float* ReadF32Vec(int32_t key_id, size_t* dim);
+
+  /**
+   * Block-local output buffers for the window.
+   */
+  float* WriteF32(int32_t key_id);
+  float* WriteF32Vec(int32_t key_id, size_t dim);
+
+  /**
+   * Block-local temporary buffer (Size() floats), distinct per slot.
+   * Used by expression evaluation; contents are undefined on return.
+   */
+  float* Temp(size_t slot);
+
+  /**
+   * A column written by some stage of the chain.
+   */
+  struct Written {
+    int32_t key_id;
+    ColumnType type;  // F32 or F32Vec
+    size_t dim;       // 1 for F32
+  };
+
+  /**
+   * Keys written in the current window, in first-write order.
+   */
+  const std::vector<Written>& WrittenKeys() const { return written_; }
+
+  /**
+   * Buffer written for key_id in the current window (nullptr if none).
+   */
+  const float* WrittenData(int32_t key_id) const;
+
+ private:
+  struct Slot {
+    ColumnType type = ColumnType::F32;
+    size_t dim = 1;
+    std::vector<float> data;
+    size_t epoch = 0;      // Window the data belongs to
+    bool written = false;  // Produced by a stage (vs. materialized input)
+  };
+
+  Slot& Prepare(int32_t key_id, ColumnType type, size_t dim);
+
+  const ColumnBatch& input_;
+  size_t begin_ = 0;
+  size_t size_ = 0;
+  size_t epoch_ = 0;
+  std::unordered_map<int32_t, Slot> slots_;
+  std::vector<std::vector<float>> temps_;
+  std::vector<Written> written_;
+};
+
+}  // namespace ranking_dsl
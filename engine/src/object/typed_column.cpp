@@ -4,6 +4,15 @@
 
 namespace ranking_dsl {
 
+namespace {
+
+// std::vector<bool> packs bits
+size_t MaskBytes(const std::vector<bool>& mask) {
+  return (mask.capacity() + 7) / 8;
+}
+
+}  // namespace
+
 // F32Column implementation
 
 F32Column::F32Column(size_t row_count)
@@ -41,6 +50,10 @@ std::shared_ptr<TypedColumn> F32Column::Clone() const {
   return std::make_shared<F32Column>(data_, null_mask_);
 }
 
+size_t F32Column::ByteSize() const {
+  return data_.capacity() * sizeof(float) + MaskBytes(null_mask_);
+}
+
 bool F32Column::IsNull(size_t row_index) const {
   return row_index >= data_.size() || null_mask_[row_index];
 }
@@ -96,6 +109,10 @@ std::shared_ptr<TypedColumn> I64Column::Clone() const {
   return std::make_shared<I64Column>(data_, null_mask_);
 }
 
+size_t I64Column::ByteSize() const {
+  return data_.capacity() * sizeof(int64_t) + MaskBytes(null_mask_);
+}
+
 bool I64Column::IsNull(size_t row_index) const {
   return row_index >= data_.size() || null_mask_[row_index];
 }
@@ -147,6 +164,10 @@ std::shared_ptr<TypedColumn> BoolColumn::Clone() const {
   return col;
 }
 
+size_t BoolColumn::ByteSize() const {
+  return MaskBytes(data_) + MaskBytes(null_mask_);
+}
+
 bool BoolColumn::IsNull(size_t row_index) const {
   return row_index >= data_.size() || null_mask_[row_index];
 }
@@ -198,6 +219,18 @@ std::shared_ptr<TypedColumn> StringColumn::Clone() const {
   return col;
 }
 
+size_t StringColumn::ByteSize() const {
+  // Strings up to an empty string's capacity live in the inline buffer
+  static const size_t kInlineCapacity = std::string().capacity();
+  size_t bytes = data_.capacity() * sizeof(std::string) + MaskBytes(null_mask_);
+  for (const auto& value : data_) {
+    if (value.capacity() > kInlineCapacity) {
+      bytes += value.capacity() + 1;
+    }
+  }
+  return bytes;
+}
+
 bool StringColumn::IsNull(size_t row_index) const {
   return row_index >= data_.size() || null_mask_[row_index];
 }
@@ -253,6 +286,10 @@ std::shared_ptr<TypedColumn> F32VecColumn::Clone() const {
   return std::make_shared<F32VecColumn>(data_, dim_, null_mask_);
 }
 
+size_t F32VecColumn::ByteSize() const {
+  return data_.capacity() * sizeof(float) + MaskBytes(null_mask_);
+}
+
 bool F32VecColumn::IsNull(size_t row_index) const {
   return row_index >= Size() || null_mask_[row_index];
 }
@@ -318,6 +355,14 @@ std::shared_ptr<TypedColumn> BytesColumn::Clone() const {
   return col;
 }
 
+size_t BytesColumn::ByteSize() const {
+  size_t bytes = data_.capacity() * sizeof(std::vector<uint8_t>) + MaskBytes(null_mask_);
+  for (const auto& value : data_) {
+    bytes += value.capacity();
+  }
+  return bytes;
+}
+
 bool BytesColumn::IsNull(size_t row_index) const {
   return row_index >= data_.size() || null_mask_[row_index];
 }
@@ -58,6 +58,12 @@ class TypedColumn {
    */
   virtual std::shared_ptr<TypedColumn> Clone() const = 0;
 
+  /**
+   * Heap bytes held by the column's storage: allocated capacity including
+   * the null mask, plus per-row string and bytes payloads.
+   */
+  virtual size_t ByteSize() const = 0;
+
   /**
    * Check if value at row index is null.
    */
@@ -87,6 +93,7 @@ class F32Column : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -117,6 +124,7 @@ class I64Column : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -146,6 +154,7 @@ class BoolColumn : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -171,6 +180,7 @@ class StringColumn : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -200,6 +210,7 @@ class F32VecColumn : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -244,6 +255,7 @@ class BytesColumn : public TypedColumn {
   Value GetValue(size_t row_index) const override;
   void SetValue(size_t row_index, const Value& value) override;
   std::shared_ptr<TypedColumn> Clone() const override;
+  size_t ByteSize() const override;
   bool IsNull(size_t row_index) const override;
   void SetNull(size_t row_index) override;
 
@@ -0,0 +1,687 @@
+#include "plan/artifact.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "expr/expr.h"
+#include "keys/registry.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct ArtifactHeader {
+  char magic[8];
+  uint32_t format_version;
+  uint32_t byte_order;
+  uint64_t registry_fingerprint;
+  uint64_t payload_size;
+  uint64_t payload_checksum;
+};
+
+uint64_t Fnv1a(const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+class Writer {
+ public:
+  template <typename T>
+  void Pod(const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void Bytes(const void* data, size_t size) {
+    Pod(static_cast<uint32_t>(size));
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  void String(const std::string& value) { Bytes(value.data(), value.size()); }
+
+  void Ints(const std::vector<int32_t>& values) {
+    Pod(static_cast<uint32_t>(values.size()));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+    buffer_.insert(buffer_.end(), bytes, bytes + values.size() * sizeof(int32_t));
+  }
+
+  void Strings(const std::vector<std::string>& values) {
+    Pod(static_cast<uint32_t>(values.size()));
+    for (const auto& value : values) {
+      String(value);
+    }
+  }
+
+  std::vector<uint8_t>& Buffer() { return buffer_; }
+
+ private:
+  std::vector<uint8_t> buffer_;
+};
+
+// Bounds-checked cursor over artifact bytes; any overrun latches ok = false
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : cursor_(data), end_(data + size) {}
+
+  bool ok() const { return ok_; }
+  bool AtEnd() const { return cursor_ == end_; }
+
+  template <typename T>
+  T Pod() {
+    T value{};
+    if (Take(sizeof(T))) {
+      std::memcpy(&value, cursor_ - sizeof(T), sizeof(T));
+    }
+    return value;
+  }
+
+  std::string String() {
+    uint32_t size = Pod<uint32_t>();
+    if (!Take(size)) return {};
+    return std::string(reinterpret_cast<const char*>(cursor_ - size), size);
+  }
+
+  std::vector<int32_t> Ints() {
+    uint32_t count = Pod<uint32_t>();
+    std::vector<int32_t> values;
+    if (!Take(size_t{count} * sizeof(int32_t))) return values;
+    values.resize(count);
+    std::memcpy(values.data(), cursor_ - count * sizeof(int32_t), count * sizeof(int32_t));
+    return values;
+  }
+
+  std::vector<std::string> Strings() {
+    uint32_t count = Pod<uint32_t>();
+    std::vector<std::string> values;
+    for (uint32_t i = 0; i < count && ok_; ++i) {
+      values.push_back(String());
+    }
+    return values;
+  }
+
+  // Raw view of a length-prefixed blob (valid while the source bytes are)
+  std::pair<const uint8_t*, size_t> Blob() {
+    uint32_t size = Pod<uint32_t>();
+    if (!Take(size)) return {nullptr, 0};
+    return {cursor_ - size, size};
+  }
+
+ private:
+  bool Take(size_t size) {
+    if (!ok_ || static_cast<size_t>(end_ - cursor_) < size) {
+      ok_ = false;
+      return false;
+    }
+    cursor_ += size;
+    return true;
+  }
+
+  const uint8_t* cursor_;
+  const uint8_t* end_;
+  bool ok_ = true;
+};
+
+void WriteNodeInfos(Writer& w, const std::vector<ComplexityMetrics::NodeInfo>& infos) {
+  w.Pod(static_cast<uint32_t>(infos.size()));
+  for (const auto& info : infos) {
+    w.String(info.id);
+    w.String(info.op);
+    w.Pod(info.degree);
+  }
+}
+
+std::vector<ComplexityMetrics::NodeInfo> ReadNodeInfos(Reader& r) {
+  uint32_t count = r.Pod<uint32_t>();
+  std::vector<ComplexityMetrics::NodeInfo> infos;
+  for (uint32_t i = 0; i < count && r.ok(); ++i) {
+    ComplexityMetrics::NodeInfo info;
+    info.id = r.String();
+    info.op = r.String();
+    info.degree = r.Pod<int64_t>();
+    infos.push_back(std::move(info));
+  }
+  return infos;
+}
+
+void WriteNodeCosts(Writer& w, const std::vector<ComplexityMetrics::NodeCost>& costs) {
+  w.Pod(static_cast<uint32_t>(costs.size()));
+  for (const auto& cost : costs) {
+    w.String(cost.id);
+    w.String(cost.op);
+    w.Pod(cost.ms);
+    w.Pod(cost.rows);
+  }
+}
+
+std::vector<ComplexityMetrics::NodeCost> ReadNodeCosts(Reader& r) {
+  uint32_t count = r.Pod<uint32_t>();
+  std::vector<ComplexityMetrics::NodeCost> costs;
+  for (uint32_t i = 0; i < count && r.ok(); ++i) {
+    ComplexityMetrics::NodeCost cost;
+    cost.id = r.String();
+    cost.op = r.String();
+    cost.ms = r.Pod<double>();
+    cost.rows = r.Pod<int64_t>();
+    costs.push_back(std::move(cost));
+  }
+  return costs;
+}
+
+void WriteNodeBytes(Writer& w, const std::vector<ComplexityMetrics::NodeBytes>& nodes) {
+  w.Pod(static_cast<uint32_t>(nodes.size()));
+  for (const auto& node : nodes) {
+    w.String(node.id);
+    w.String(node.op);
+    w.Pod(node.bytes);
+    w.Pod(node.rows);
+  }
+}
+
+std::vector<ComplexityMetrics::NodeBytes> ReadNodeBytes(Reader& r) {
+  uint32_t count = r.Pod<uint32_t>();
+  std::vector<ComplexityMetrics::NodeBytes> nodes;
+  for (uint32_t i = 0; i < count && r.ok(); ++i) {
+    ComplexityMetrics::NodeBytes node;
+    node.id = r.String();
+    node.op = r.String();
+    node.bytes = r.Pod<int64_t>();
+    node.rows = r.Pod<int64_t>();
+    nodes.push_back(std::move(node));
+  }
+  return nodes;
+}
+
+void WriteSchema(Writer& w, const BatchSchema& schema) {
+  std::vector<int32_t> keys;
+  std::vector<int32_t> types;
+  for (const auto& [key, type] : schema.columns) {
+    keys.push_back(key);
+    types.push_back(static_cast<int32_t>(type));
+  }
+  w.Pod(static_cast<uint8_t>(schema.known));
+  w.Ints(keys);
+  w.Ints(types);
+}
+
+// False if the columns are not sorted by key or a type is out of range
+bool ReadSchema(Reader& r, BatchSchema& schema) {
+  schema.known = r.Pod<uint8_t>() != 0;
+  std::vector<int32_t> keys = r.Ints();
+  std::vector<int32_t> types = r.Ints();
+  if (keys.size() != types.size()) return false;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if ((i > 0 && keys[i] <= keys[i - 1]) || types[i] < 0 ||
+        types[i] > static_cast<int32_t>(ColumnType::Null)) {
+      return false;
+    }
+    schema.columns.emplace_back(keys[i], static_cast<ColumnType>(types[i]));
+  }
+  return true;
+}
+
+// Present byte, binding names, then the postfix program step by step
+void WriteCompiledExpr(Writer& w, const CompiledExpr* expr) {
+  w.Pod(static_cast<uint8_t>(expr != nullptr));
+  if (!expr) return;
+  w.Strings(expr->Bindings());
+  const auto& program = expr->Program();
+  w.Pod(static_cast<uint32_t>(program.size()));
+  for (const auto& step : program) {
+    w.Pod(static_cast<uint8_t>(step.op));
+    w.Pod(static_cast<uint8_t>(step.load));
+    w.Pod(step.key);
+    w.Pod(step.key_b);
+    w.Pod(step.value);
+    w.Pod(static_cast<uint32_t>(step.argc));
+    w.Pod(static_cast<uint32_t>(step.binding));
+  }
+}
+
+// False if the program is malformed
+bool ReadCompiledExpr(Reader& r, std::shared_ptr<const CompiledExpr>& expr) {
+  expr.reset();
+  if (r.Pod<uint8_t>() == 0) return true;
+  std::vector<std::string> bindings = r.Strings();
+  uint32_t count = r.Pod<uint32_t>();
+  std::vector<CompiledExpr::Step> program;
+  for (uint32_t i = 0; i < count && r.ok(); ++i) {
+    CompiledExpr::Step step;
+    step.op = static_cast<CompiledExpr::Step::Op>(r.Pod<uint8_t>());
+    step.load = static_cast<CompiledExpr::Load>(r.Pod<uint8_t>());
+    step.key = r.Pod<int32_t>();
+    step.key_b = r.Pod<int32_t>();
+    step.value = r.Pod<float>();
+    step.argc = r.Pod<uint32_t>();
+    step.binding = r.Pod<uint32_t>();
+    program.push_back(step);
+  }
+  CompiledExpr compiled;
+  if (!r.ok() || !CompiledExpr::FromProgram(std::move(program), std::move(bindings), compiled)) {
+    return false;
+  }
+  expr = std::make_shared<const CompiledExpr>(std::move(compiled));
+  return true;
+}
+
+bool InRange(const std::vector<int32_t>& indices, int32_t limit) {
+  for (int32_t index : indices) {
+    if (index < 0 || index >= limit) return false;
+  }
+  return true;
+}
+
+bool ValidCsr(const std::vector<int32_t>& offsets, const std::vector<int32_t>& edges,
+              int32_t node_count) {
+  if (offsets.size() != static_cast<size_t>(node_count) + 1 || offsets.front() != 0 ||
+      offsets.back() != static_cast<int32_t>(edges.size())) {
+    return false;
+  }
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    if (offsets[i] < offsets[i - 1]) return false;
+  }
+  return InRange(edges, node_count);
+}
+
+bool Fail(std::string* error_out, const std::string& message) {
+  if (error_out) {
+    *error_out = "Invalid plan artifact: " + message;
+  }
+  return false;
+}
+
+}  // namespace
+
+uint64_t KeyRegistryFingerprint(const KeyRegistry& registry) {
+  uint64_t hash = Fnv1a(nullptr, 0);
+  for (const auto& key : registry.AllKeys()) {
+    hash = Fnv1a(reinterpret_cast<const uint8_t*>(&key.id), sizeof(key.id), hash);
+    hash = Fnv1a(reinterpret_cast<const uint8_t*>(key.name.data()), key.name.size(), hash);
+    auto type = static_cast<int32_t>(key.type);
+    hash = Fnv1a(reinterpret_cast<const uint8_t*>(&type), sizeof(type), hash);
+    hash = Fnv1a(reinterpret_cast<const uint8_t*>(&key.dim), sizeof(key.dim), hash);
+  }
+  return hash;
+}
+
+std::vector<uint8_t> SerializePlanArtifact(const CompiledPlan& compiled,
+                                           const KeyRegistry& registry) {
+  Writer w;
+  const Plan& plan = compiled.plan;
+
+  // Plan header
+  w.String(plan.name);
+  w.Pod(static_cast<int32_t>(plan.version));
+  w.String(plan.meta.env);
+  w.Pod(plan.logging.sample_rate);
+  w.Ints(plan.logging.dump_keys);
+  w.Strings(plan.logging.dump_nodes);
+  w.Ints(plan.output_keys);
+  w.Strings(plan.outputs);
+  w.Pod(static_cast<uint32_t>(plan.bindings.size()));
+  for (const auto& binding : plan.bindings) {
+    w.String(binding.name);
+    w.Pod(static_cast<uint8_t>(binding.type));
+    std::vector<uint8_t> value = nlohmann::json::to_msgpack(binding.default_value);
+    w.Bytes(value.data(), value.size());
+  }
+
+  // Nodes (params as MessagePack)
+  w.Pod(static_cast<uint32_t>(plan.nodes.size()));
+  for (const auto& node : plan.nodes) {
+    w.String(node.id);
+    w.String(node.op);
+    w.String(node.trace_key);
+    w.Strings(node.inputs);
+    std::vector<uint8_t> params = nlohmann::json::to_msgpack(node.params);
+    w.Bytes(params.data(), params.size());
+  }
+
+  // Graph and schedule
+  const PlanGraph& graph = compiled.graph;
+  w.Pod(graph.edge_count);
+  w.Ints(graph.input_offsets);
+  w.Ints(graph.input_edges);
+  w.Ints(graph.output_offsets);
+  w.Ints(graph.output_edges);
+  w.Ints(compiled.exec_order);
+  w.Ints(compiled.sink_indices);
+  w.Ints(compiled.bound_nodes);
+
+  // Compiler pass results
+  w.Strings(compiled.pruned_nodes);
+  w.Pod(static_cast<uint32_t>(compiled.merged_nodes.size()));
+  for (const auto& [removed, kept] : compiled.merged_nodes) {
+    w.String(removed);
+    w.String(kept);
+  }
+  w.Pod(static_cast<uint32_t>(compiled.sink_aliases.size()));
+  for (const auto& [requested, kept] : compiled.sink_aliases) {
+    w.String(requested);
+    w.String(kept);
+  }
+  w.Strings(compiled.limit_rewrites);
+  w.String(compiled.diagnostics);
+
+  w.Pod(static_cast<uint32_t>(compiled.liveness.size()));
+  for (const auto& liveness : compiled.liveness) {
+    w.Pod(static_cast<uint8_t>(liveness.prune));
+    w.Ints(liveness.live_keys);
+  }
+  w.Pod(static_cast<uint32_t>(compiled.fused_chains.size()));
+  for (const auto& chain : compiled.fused_chains) {
+    w.Ints(chain.nodes);
+  }
+  w.Ints(compiled.fused_chain_of);
+  w.Ints(compiled.last_consumer);
+  w.Pod(static_cast<uint32_t>(compiled.input_schemas.size()));
+  for (const auto& schema : compiled.input_schemas) {
+    WriteSchema(w, schema);
+  }
+  w.Pod(static_cast<uint8_t>(compiled.candidate_schema.has_value()));
+  if (compiled.candidate_schema) {
+    WriteSchema(w, *compiled.candidate_schema);
+  }
+  w.Pod(static_cast<uint32_t>(compiled.compiled_exprs.size()));
+  for (const auto& expr : compiled.compiled_exprs) {
+    WriteCompiledExpr(w, expr.get());
+  }
+
+  // Complexity metrics (reporting only)
+  const ComplexityMetrics& metrics = compiled.complexity;
+  w.Pod(metrics.node_count);
+  w.Pod(metrics.edge_count);
+  w.Pod(metrics.max_depth);
+  w.Pod(metrics.fanout_peak);
+  w.Pod(metrics.fanin_peak);
+  WriteNodeInfos(w, metrics.top_fanout);
+  WriteNodeInfos(w, metrics.top_fanin);
+  w.Strings(metrics.longest_path);
+  w.Pod(metrics.estimated_ms);
+  w.Pod(metrics.estimated_bytes);
+  WriteNodeCosts(w, metrics.top_cost);
+  w.Pod(metrics.peak_memory_bytes);
+  w.String(metrics.peak_memory_node);
+  WriteNodeBytes(w, metrics.top_memory);
+
+  const std::vector<uint8_t>& payload = w.Buffer();
+  ArtifactHeader header{};
+  std::memcpy(header.magic, kPlanArtifactMagic, sizeof(header.magic));
+  header.format_version = kPlanArtifactVersion;
+  header.byte_order = kByteOrderMark;
+  header.registry_fingerprint = KeyRegistryFingerprint(registry);
+  header.payload_size = payload.size();
+  header.payload_checksum = Fnv1a(payload.data(), payload.size());
+
+  std::vector<uint8_t> artifact(sizeof(header) + payload.size());
+  std::memcpy(artifact.data(), &header, sizeof(header));
+  std::memcpy(artifact.data() + sizeof(header), payload.data(), payload.size());
+  return artifact;
+}
+
+bool DeserializePlanArtifact(const uint8_t* data, size_t size, const KeyRegistry& registry,
+                             CompiledPlan& out, std::string* error_out) {
+  ArtifactHeader header;
+  if (size < sizeof(header)) {
+    return Fail(error_out, "truncated header");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kPlanArtifactMagic, sizeof(header.magic)) != 0) {
+    return Fail(error_out, "bad magic");
+  }
+  if (header.format_version != kPlanArtifactVersion) {
+    return Fail(error_out, fmt::format("format version {} (expected {})", header.format_version,
+                                       kPlanArtifactVersion));
+  }
+  if (header.byte_order != kByteOrderMark) {
+    return Fail(error_out, "built on a machine with different byte order");
+  }
+  if (header.registry_fingerprint != KeyRegistryFingerprint(registry)) {
+    return Fail(error_out, "built against a different key registry");
+  }
+  const uint8_t* payload = data + sizeof(header);
+  if (header.payload_size != size - sizeof(header)) {
+    return Fail(error_out, "payload size mismatch");
+  }
+  if (header.payload_checksum != Fnv1a(payload, header.payload_size)) {
+    return Fail(error_out, "checksum mismatch");
+  }
+
+  Reader r(payload, header.payload_size);
+  CompiledPlan compiled;
+  Plan& plan = compiled.plan;
+
+  plan.name = r.String();
+  plan.version = r.Pod<int32_t>();
+  plan.meta.env = r.String();
+  plan.logging.sample_rate = r.Pod<float>();
+  plan.logging.dump_keys = r.Ints();
+  plan.logging.dump_nodes = r.Strings();
+  plan.output_keys = r.Ints();
+  plan.outputs = r.Strings();
+  uint32_t binding_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < binding_count && r.ok(); ++i) {
+    PlanBinding binding;
+    binding.name = r.String();
+    uint8_t type = r.Pod<uint8_t>();
+    if (type > static_cast<uint8_t>(BindingType::kString)) {
+      return Fail(error_out, "unknown binding type");
+    }
+    binding.type = static_cast<BindingType>(type);
+    auto [value, value_size] = r.Blob();
+    if (!r.ok()) break;
+    try {
+      binding.default_value = nlohmann::json::from_msgpack(value, value + value_size);
+    } catch (const std::exception& e) {
+      return Fail(error_out, fmt::format("default of binding '{}': {}", binding.name, e.what()));
+    }
+    plan.bindings.push_back(std::move(binding));
+  }
+
+  uint32_t node_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < node_count && r.ok(); ++i) {
+    PlanNode node;
+    node.id = r.String();
+    node.op = r.String();
+    node.trace_key = r.String();
+    node.inputs = r.Strings();
+    auto [params, params_size] = r.Blob();
+    if (!r.ok()) break;
+    try {
+      node.params = nlohmann::json::from_msgpack(params, params + params_size);
+    } catch (const std::exception& e) {
+      return Fail(error_out, fmt::format("params of node '{}': {}", node.id, e.what()));
+    }
+    plan.nodes.push_back(std::move(node));
+  }
+
+  PlanGraph& graph = compiled.graph;
+  graph.node_count = static_cast<int32_t>(node_count);
+  graph.edge_count = r.Pod<int64_t>();
+  graph.input_offsets = r.Ints();
+  graph.input_edges = r.Ints();
+  graph.output_offsets = r.Ints();
+  graph.output_edges = r.Ints();
+  compiled.exec_order = r.Ints();
+  compiled.sink_indices = r.Ints();
+  compiled.bound_nodes = r.Ints();
+
+  compiled.pruned_nodes = r.Strings();
+  uint32_t merged_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < merged_count && r.ok(); ++i) {
+    std::string removed = r.String();
+    compiled.merged_nodes.emplace_back(std::move(removed), r.String());
+  }
+  uint32_t alias_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < alias_count && r.ok(); ++i) {
+    std::string requested = r.String();
+    compiled.sink_aliases.emplace_back(std::move(requested), r.String());
+  }
+  compiled.limit_rewrites = r.Strings();
+  compiled.diagnostics = r.String();
+
+  uint32_t liveness_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < liveness_count && r.ok(); ++i) {
+    ColumnLiveness liveness;
+    liveness.prune = r.Pod<uint8_t>() != 0;
+    liveness.live_keys = r.Ints();
+    compiled.liveness.push_back(std::move(liveness));
+  }
+  uint32_t chain_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < chain_count && r.ok(); ++i) {
+    compiled.fused_chains.push_back(FusedChain{r.Ints()});
+  }
+  compiled.fused_chain_of = r.Ints();
+  compiled.last_consumer = r.Ints();
+  uint32_t schema_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < schema_count && r.ok(); ++i) {
+    BatchSchema schema;
+    if (!ReadSchema(r, schema)) {
+      return Fail(error_out, "malformed input schema");
+    }
+    compiled.input_schemas.push_back(std::move(schema));
+  }
+  if (r.Pod<uint8_t>() != 0) {
+    BatchSchema schema;
+    if (!ReadSchema(r, schema)) {
+      return Fail(error_out, "malformed candidate schema");
+    }
+    compiled.candidate_schema = std::move(schema);
+  }
+  uint32_t expr_count = r.Pod<uint32_t>();
+  for (uint32_t i = 0; i < expr_count && r.ok(); ++i) {
+    std::shared_ptr<const CompiledExpr> expr;
+    if (!ReadCompiledExpr(r, expr)) {
+      return Fail(error_out, "malformed compiled expression");
+    }
+    compiled.compiled_exprs.push_back(std::move(expr));
+  }
+
+  ComplexityMetrics& metrics = compiled.complexity;
+  metrics.node_count = r.Pod<int64_t>();
+  metrics.edge_count = r.Pod<int64_t>();
+  metrics.max_depth = r.Pod<int64_t>();
+  metrics.fanout_peak = r.Pod<int64_t>();
+  metrics.fanin_peak = r.Pod<int64_t>();
+  metrics.top_fanout = ReadNodeInfos(r);
+  metrics.top_fanin = ReadNodeInfos(r);
+  metrics.longest_path = r.Strings();
+  metrics.estimated_ms = r.Pod<double>();
+  metrics.estimated_bytes = r.Pod<int64_t>();
+  metrics.top_cost = ReadNodeCosts(r);
+  metrics.peak_memory_bytes = r.Pod<int64_t>();
+  metrics.peak_memory_node = r.String();
+  metrics.top_memory = ReadNodeBytes(r);
+
+  if (!r.ok() || !r.AtEnd()) {
+    return Fail(error_out, "truncated or malformed payload");
+  }
+
+  // The checksum guards against corruption; these guard the executor's
+  // unchecked indexing against artifacts from a buggy writer
+  const int32_t n = graph.node_count;
+  if (!ValidCsr(graph.input_offsets, graph.input_edges, n) ||
+      !ValidCsr(graph.output_offsets, graph.output_edges, n) ||
+      !InRange(compiled.exec_order, n) || !InRange(compiled.sink_indices, n) ||
+      !InRange(compiled.bound_nodes, n) ||
+      compiled.liveness.size() != node_count || compiled.fused_chain_of.size() != node_count ||
+      compiled.last_consumer.size() != node_count ||
+      compiled.input_schemas.size() != node_count ||
+      compiled.compiled_exprs.size() != node_count) {
+    return Fail(error_out, "node index out of range");
+  }
+  for (int32_t consumer : compiled.last_consumer) {
+    if (consumer < -1 || consumer >= n) {
+      return Fail(error_out, "node index out of range");
+    }
+  }
+  for (const auto& chain : compiled.fused_chains) {
+    if (chain.nodes.empty() || !InRange(chain.nodes, n)) {
+      return Fail(error_out, "node index out of range");
+    }
+  }
+  for (int32_t chain : compiled.fused_chain_of) {
+    if (chain < -1 || chain >= static_cast<int32_t>(compiled.fused_chains.size())) {
+      return Fail(error_out, "fused chain index out of range");
+    }
+  }
+
+  // Derived lookups
+  graph.index_by_id.reserve(node_count);
+  for (int32_t i = 0; i < n; ++i) {
+    graph.index_by_id.emplace(plan.nodes[i].id, i);
+  }
+  for (int32_t node : compiled.exec_order) {
+    compiled.topo_order.push_back(plan.nodes[node].id);
+  }
+  for (int32_t node : compiled.sink_indices) {
+    compiled.sinks.push_back(plan.nodes[node].id);
+  }
+
+  out = std::move(compiled);
+  return true;
+}
+
+bool WritePlanArtifact(const CompiledPlan& plan, const KeyRegistry& registry,
+                       const std::string& path, std::string* error_out) {
+  std::vector<uint8_t> artifact = SerializePlanArtifact(plan, registry);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    if (error_out) {
+      *error_out = "Failed to open file for writing: " + path;
+    }
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(artifact.data()),
+             static_cast<std::streamsize>(artifact.size()));
+  if (!file) {
+    if (error_out) {
+      *error_out = "Failed to write file: " + path;
+    }
+    return false;
+  }
+  return true;
+}
+
+bool LoadPlanArtifact(const std::string& path, const KeyRegistry& registry, CompiledPlan& out,
+                      std::string* error_out) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    if (error_out) {
+      *error_out = "Failed to open file: " + path;
+    }
+    return false;
+  }
+  std::streamoff size = file.tellg();
+  if (size <= 0) {
+    return Fail(error_out, "empty file: " + path);
+  }
+
+  // One read straight into the buffer the deserializer parses
+  std::vector<uint8_t> bytes(static_cast<size_t>(size));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+    if (error_out) {
+      *error_out = "Failed to read file: " + path;
+    }
+    return false;
+  }
+  return DeserializePlanArtifact(bytes.data(), bytes.size(), registry, out, error_out);
+}
+
+bool IsPlanArtifactFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  char magic[sizeof(kPlanArtifactMagic)] = {};
+  file.read(magic, sizeof(magic));
+  return file && std::memcmp(magic, kPlanArtifactMagic, sizeof(magic)) == 0;
+}
+
+}  // namespace ranking_dsl
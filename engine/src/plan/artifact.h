@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+class KeyRegistry;
+
+/**
+ * Binary plan artifact: a CompiledPlan serialized after validation, topo
+ * sorting, and every compiler pass, so loading skips JSON parsing, trace_key
+ * regex checks, and compilation. Per-node results (liveness, last consumers,
+ * input schemas) are stored rather than recomputed, so loading never parses
+ * expressions or loads njs modules.
+ *
+ * Layout: a fixed header (magic "RDSLPLAN", format version, byte-order mark,
+ * key registry fingerprint, payload size, FNV-1a checksum) followed by a
+ * length-prefixed payload. Integer arrays (graph CSR, exec order, liveness,
+ * fused chains, last consumers, schema keys and types) are stored raw and copied out in bulk; node params are
+ * MessagePack. The artifact is native-endian and only loads with the key
+ * registry it was built against.
+ */
+inline constexpr char kPlanArtifactMagic[8] = {'R', 'D', 'S', 'L', 'P', 'L', 'A', 'N'};
+inline constexpr uint32_t kPlanArtifactVersion = 11;  // v11: sink aliases
+
+/**
+ * Fingerprint of a key registry (key IDs, names, types, f32vec dims).
+ * Liveness, param-derived key IDs and memory estimates in an artifact are
+ * only valid under the same keys.
+ */
+uint64_t KeyRegistryFingerprint(const KeyRegistry& registry);
+
+/**
+ * Serialize a compiled plan.
+ */
+std::vector<uint8_t> SerializePlanArtifact(const CompiledPlan& plan, const KeyRegistry& registry);
+
+/**
+ * Rebuild a compiled plan from artifact bytes.
+ * Fails on a bad header, checksum mismatch, other key registry, or
+ * out-of-range indices.
+ */
+bool DeserializePlanArtifact(const uint8_t* data, size_t size, const KeyRegistry& registry,
+                             CompiledPlan& out, std::string* error_out = nullptr);
+
+/**
+ * Write a compiled plan to an artifact file.
+ */
+bool WritePlanArtifact(const CompiledPlan& plan, const KeyRegistry& registry,
+                       const std::string& path, std::string* error_out = nullptr);
+
+/**
+ * Load an artifact file (read into memory in one call, then deserialized).
+ */
+bool LoadPlanArtifact(const std::string& path, const KeyRegistry& registry, CompiledPlan& out,
+                      std::string* error_out = nullptr);
+
+/**
+ * True if the file starts with the artifact magic.
+ */
+bool IsPlanArtifactFile(const std::string& path);
+
+}  // namespace ranking_dsl
@@ -0,0 +1,129 @@
+#include "plan/bindings.h"
+
+#include <fmt/format.h>
+
+namespace ranking_dsl {
+
+std::optional<nlohmann::json> CoerceBindingValue(BindingType type, const nlohmann::json& value) {
+  switch (type) {
+    case BindingType::kInt:
+      if (value.is_number_integer()) return value;
+      break;
+    case BindingType::kFloat:
+      if (value.is_number()) return nlohmann::json(value.get<double>());
+      break;
+    case BindingType::kBool:
+      if (value.is_boolean()) return value;
+      break;
+    case BindingType::kString:
+      if (value.is_string()) return value;
+      break;
+  }
+  return std::nullopt;
+}
+
+namespace {
+
+nlohmann::json ToJson(const ParamBindings::Value& value) {
+  return std::visit([](const auto& v) { return nlohmann::json(v); }, value);
+}
+
+}  // namespace
+
+std::optional<BindingType> ParseBindingType(const std::string& name) {
+  if (name == "int") return BindingType::kInt;
+  if (name == "float") return BindingType::kFloat;
+  if (name == "bool") return BindingType::kBool;
+  if (name == "string") return BindingType::kString;
+  return std::nullopt;
+}
+
+const char* BindingTypeName(BindingType type) {
+  switch (type) {
+    case BindingType::kInt: return "int";
+    case BindingType::kFloat: return "float";
+    case BindingType::kBool: return "bool";
+    case BindingType::kString: return "string";
+  }
+  return "unknown";
+}
+
+const std::string* BindingRefName(const nlohmann::json& value) {
+  if (!value.is_object() || value.size() != 1) {
+    return nullptr;
+  }
+  auto it = value.find("$bind");
+  if (it == value.end() || !it->is_string()) {
+    return nullptr;
+  }
+  return it->get_ptr<const std::string*>();
+}
+
+void CollectBindingRefs(const nlohmann::json& params, std::vector<std::string>& out) {
+  if (const std::string* name = BindingRefName(params)) {
+    out.push_back(*name);
+    return;
+  }
+  if (params.is_structured()) {
+    for (const auto& child : params) {
+      CollectBindingRefs(child, out);
+    }
+  }
+}
+
+bool ResolveBindingValues(const std::vector<PlanBinding>& declared,
+                          const ParamBindings* bindings,
+                          std::unordered_map<std::string, nlohmann::json>& out,
+                          std::string* error_out) {
+  out.clear();
+  for (const auto& binding : declared) {
+    const ParamBindings::Value* value = bindings ? bindings->Find(binding.name) : nullptr;
+    if (!value) {
+      if (binding.default_value.is_null()) {
+        if (error_out) {
+          *error_out = "Missing value for binding: " + binding.name;
+        }
+        return false;
+      }
+      out[binding.name] = binding.default_value;
+      continue;
+    }
+
+    nlohmann::json json_value = ToJson(*value);
+    auto coerced = CoerceBindingValue(binding.type, json_value);
+    if (!coerced) {
+      if (error_out) {
+        *error_out = fmt::format("Binding '{}' expects {}, got {}", binding.name,
+                                 BindingTypeName(binding.type), json_value.type_name());
+      }
+      return false;
+    }
+    out[binding.name] = std::move(*coerced);
+  }
+  return true;
+}
+
+nlohmann::json SubstituteBindings(const nlohmann::json& params,
+                                  const std::unordered_map<std::string, nlohmann::json>& values) {
+  if (const std::string* name = BindingRefName(params)) {
+    auto it = values.find(*name);
+    return it == values.end() ? params : it->second;
+  }
+  if (params.is_object()) {
+    nlohmann::json out = nlohmann::json::object();
+    for (auto it = params.begin(); it != params.end(); ++it) {
+      out[it.key()] = SubstituteBindings(it.value(), values);
+    }
+    return out;
+  }
+  if (params.is_array()) {
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& child : params) {
+      out.push_back(SubstituteBindings(child, values));
+    }
+    return out;
+  }
+  return params;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace ranking_dsl {
+
+/**
+ * Value types a plan binding can declare.
+ */
+enum class BindingType { kInt, kFloat, kBool, kString };
+
+/**
+ * Parse "int" | "float" | "bool" | "string".
+ */
+std::optional<BindingType> ParseBindingType(const std::string& name);
+
+/**
+ * Name of a binding type (inverse of ParseBindingType).
+ */
+const char* BindingTypeName(BindingType type);
+
+/**
+ * JSON form of `value` as `type` (ints widen to float), or nullopt if it
+ * does not match.
+ */
+std::optional<nlohmann::json> CoerceBindingValue(BindingType type, const nlohmann::json& value);
+
+/**
+ * A request-level value a plan declares, e.g. in plan JSON:
+ *
+ *   "bindings": {"sourcer_k": {"type": "int", "default": 100}}
+ *
+ * Node params reference it as {"$bind": "sourcer_k"}, anywhere in the params
+ * tree (including Expr IR constants).
+ */
+struct PlanBinding {
+  std::string name;
+  BindingType type = BindingType::kFloat;
+  nlohmann::json default_value;  // null = the request must supply a value
+};
+
+/**
+ * Typed per-request binding values (ExecContext::bindings).
+ */
+class ParamBindings {
+ public:
+  using Value = std::variant<int64_t, double, bool, std::string>;
+
+  void Set(const std::string& name, Value value) { values_[name] = std::move(value); }
+
+  const Value* Find(const std::string& name) const {
+    auto it = values_.find(name);
+    return it == values_.end() ? nullptr : &it->second;
+  }
+
+ private:
+  std::unordered_map<std::string, Value> values_;
+};
+
+/**
+ * If `value` is a binding reference ({"$bind": "name"}), return the name.
+ */
+const std::string* BindingRefName(const nlohmann::json& value);
+
+/**
+ * Collect the names of every binding referenced in a params tree.
+ */
+void CollectBindingRefs(const nlohmann::json& params, std::vector<std::string>& out);
+
+/**
+ * Resolve each declared binding to a JSON value: the request's value if
+ * given (type-checked; ints widen to float), else the declared default.
+ * Fails on a type mismatch or a missing value without default.
+ */
+bool ResolveBindingValues(const std::vector<PlanBinding>& declared,
+                          const ParamBindings* bindings,
+                          std::unordered_map<std::string, nlohmann::json>& out,
+                          std::string* error_out = nullptr);
+
+/**
+ * Copy `params` with every binding reference replaced by its resolved value.
+ */
+nlohmann::json SubstituteBindings(const nlohmann::json& params,
+                                  const std::unordered_map<std::string, nlohmann::json>& values);
+
+}  // namespace ranking_dsl
@@ -1,14 +1,18 @@
 #include "plan/compiler.h"
 
-#include <queue>
+#include <algorithm>
+#include <chrono>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <fmt/format.h>
 
+#include "expr/expr.h"
+#include "keys.h"
 #include "keys/registry.h"
 #include "nodes/registry.h"
 #include "plan/complexity.h"
+#include "plan/limit_pushdown.h"
 
 namespace ranking_dsl {
 
@@ -18,19 +22,58 @@ void PlanCompiler::SetComplexityBudget(const ComplexityBudget& budget) {
   budget_ = budget;
 }
 
+void PlanCompiler::SetCostModel(const CostModel& model) {
+  cost_model_ = model;
+}
+
+void PlanCompiler::SetCandidateSchema(const BatchSchema& schema) {
+  candidate_schema_ = schema;
+}
+
 void PlanCompiler::DisableComplexityCheck() {
   complexity_check_enabled_ = false;
 }
 
+void PlanCompiler::DisableFusion() {
+  fusion_enabled_ = false;
+}
+
+void PlanCompiler::DisableSubplanElimination() {
+  subplan_elimination_enabled_ = false;
+}
+
+void PlanCompiler::DisableLimitPushdown() {
+  limit_pushdown_enabled_ = false;
+}
+
 bool PlanCompiler::Compile(const Plan& plan, CompiledPlan& out, std::string* error_out) {
+  // Time each pass; a phase ends where the next one starts
+  std::vector<CompilePhase> phases;
+  auto phase_start = std::chrono::steady_clock::now();
+  auto end_phase = [&](const char* name) {
+    auto now = std::chrono::steady_clock::now();
+    phases.push_back({name, std::chrono::duration<double, std::milli>(now - phase_start).count()});
+    phase_start = now;
+  };
+
   // Validate node IDs are unique
   if (!ValidateNodeIds(plan, error_out)) {
     return false;
   }
 
+  // Intern node IDs once; every later pass works on integer indices
+  PlanGraph graph = BuildPlanGraph(plan);
+  if (!graph.unresolved_inputs.empty()) {
+    if (error_out) {
+      const auto& [node, input] = graph.unresolved_inputs.front();
+      *error_out = fmt::format("Node '{}' has unknown input: {}", plan.nodes[node].id, input);
+    }
+    return false;
+  }
+
   // Topological sort
-  std::vector<std::string> topo_order;
-  if (!TopologicalSort(plan, topo_order, error_out)) {
+  std::vector<int32_t> exec_order;
+  if (!TopologicalSort(graph, exec_order, error_out)) {
     return false;
   }
 
@@ -44,21 +87,224 @@ bool PlanCompiler::Compile(const Plan& plan, CompiledPlan& out, std::string* err
     return false;
   }
 
+  // Validate binding references
+  if (!ValidateBindings(plan, error_out)) {
+    return false;
+  }
+
+  // Validate sampled dump settings
+  if (!ValidateLogging(plan, graph, error_out)) {
+    return false;
+  }
+
+  end_phase("validate");
+
   // Validate complexity budgets
   ComplexityMetrics metrics;
-  if (!ValidateComplexity(plan, metrics, error_out)) {
+  if (!ValidateComplexity(plan, graph, exec_order, metrics, error_out)) {
+    return false;
+  }
+
+  end_phase("complexity");
+
+  // Pick sinks on the authored plan, so a default sink that gets merged away
+  // still resolves to the node that computes the same batch
+  std::vector<int32_t> sinks;
+  if (!SelectSinks(plan, graph, exec_order, sinks, error_out)) {
     return false;
   }
 
-  out.plan = plan;
-  out.topo_order = std::move(topo_order);
+  // Rewriting passes below replace the plan; sinks are carried by ID
+  Plan working = plan;
+  std::vector<std::string> sink_ids;
+  for (int32_t sink : sinks) {
+    sink_ids.push_back(plan.nodes[sink].id);
+  }
+  auto adopt = [&](Plan rewritten) {
+    working = std::move(rewritten);
+    graph = BuildPlanGraph(working);
+    TopologicalOrder(graph, exec_order);  // Rewrites never introduce a cycle
+
+    std::vector<bool> seen(graph.node_count, false);
+    sinks.clear();
+    for (const auto& id : sink_ids) {
+      int32_t node = graph.IndexOf(id);
+      if (!seen[node]) {
+        seen[node] = true;
+        sinks.push_back(node);
+      }
+    }
+  };
+
+  // Merge duplicated sub-plans
+  std::vector<std::pair<std::string, std::string>> merged;
+  std::vector<std::pair<std::string, std::string>> sink_aliases;
+  if (subplan_elimination_enabled_) {
+    SubplanEliminationResult cse = EliminateCommonSubplans(working, graph, exec_order);
+    if (!cse.merged.empty()) {
+      std::unordered_map<std::string, std::string> kept_by_removed(cse.merged.begin(),
+                                                                   cse.merged.end());
+      for (auto& id : sink_ids) {
+        auto it = kept_by_removed.find(id);
+        if (it != kept_by_removed.end()) {
+          sink_aliases.emplace_back(id, it->second);  // Still returned under its own ID
+          id = it->second;
+        }
+      }
+      merged = std::move(cse.merged);
+      for (auto& id : cse.plan.logging.dump_nodes) {
+        auto it = kept_by_removed.find(id);
+        if (it != kept_by_removed.end()) {
+          id = it->second;  // Dump the node that computes the same batch
+        }
+      }
+      adopt(std::move(cse.plan));
+    }
+  }
+
+  end_phase("cse");
+
+  // Push core:topk limits towards the sources
+  std::vector<std::string> limit_rewrites;
+  if (limit_pushdown_enabled_) {
+    LimitPushdownResult limits = PushDownLimits(working, graph, exec_order, sinks, registry_);
+    if (!limits.rewrites.empty()) {
+      limit_rewrites = std::move(limits.rewrites);
+      adopt(std::move(limits.plan));
+    }
+  }
+
+  end_phase("limit_pushdown");
+
+  // Drop nodes that cannot reach any sink
+  std::vector<int32_t> pruned;
+  PruneDeadNodes(graph, sinks, exec_order, pruned);
+
+  std::string diagnostics;
+  if (!pruned.empty()) {
+    diagnostics = fmt::format("Pruned {} node(s) that do not reach an output:", pruned.size());
+    for (int32_t node : pruned) {
+      const PlanNode& spec = working.nodes[node];
+      diagnostics += fmt::format("\n  - {} (op: {})", spec.id, spec.op);
+    }
+  }
+
+  end_phase("prune");
+
+  // Columns each node's output must keep for downstream nodes
+  out.liveness = ComputeColumnLiveness(working, graph, exec_order, sinks, registry_);
+  end_phase("liveness");
+
+  // Chains of row-independent nodes run block by block
+  out.fused_chains.clear();
+  out.fused_chain_of.assign(graph.node_count, -1);
+  if (fusion_enabled_) {
+    out.fused_chains = FindFusedChains(working, graph, exec_order, sinks);
+    for (size_t c = 0; c < out.fused_chains.size(); ++c) {
+      for (int32_t node : out.fused_chains[c].nodes) {
+        out.fused_chain_of[node] = static_cast<int32_t>(c);
+      }
+    }
+  }
+
+  // Outputs are dropped once their last consumer has run
+  out.last_consumer = ComputeLastConsumers(graph, exec_order, sinks, out.fused_chain_of,
+                                           out.fused_chains);
+
+  end_phase("fusion");
+
+  // Column types each node will see, so runners can bind typed readers
+  out.candidate_schema = candidate_schema_;
+  out.input_schemas = InferInputSchemas(working, graph, exec_order, out.liveness,
+                                        out.fused_chain_of, out.fused_chains, registry_,
+                                        candidate_schema_ ? &*candidate_schema_ : nullptr);
+
+  // Score formulas bind their loads to those schemas once, here, rather than
+  // per request. Numeric bindings used as expression constants become
+  // binding operands; a binding anywhere else (the output key, a signal)
+  // leaves the node to compile its substituted params per request.
+  out.compiled_exprs.assign(graph.node_count, nullptr);
+  for (int32_t node : exec_order) {
+    const PlanNode& spec = working.nodes[node];
+    if (spec.op != "core:score_formula") {
+      continue;
+    }
+    nlohmann::json other_params = spec.params;
+    other_params.erase("expr");
+    std::vector<std::string> refs;
+    CollectBindingRefs(other_params, refs);
+    if (!refs.empty()) {
+      continue;
+    }
+    std::string expr_error;
+    ExprNode expr = spec.params.contains("expr") ? ParseExpr(spec.params["expr"], &expr_error)
+                                                 : ExprNode{SignalExpr{keys::id::SCORE_BASE}};
+    if (!expr_error.empty()) {
+      continue;
+    }
+    auto compiled = std::make_shared<const CompiledExpr>(
+        CompiledExpr::Compile(expr, out.input_schemas[node], &registry_));
+    bool numeric = std::all_of(
+        compiled->Bindings().begin(), compiled->Bindings().end(), [&](const std::string& name) {
+          auto binding = std::find_if(working.bindings.begin(), working.bindings.end(),
+                                      [&](const PlanBinding& b) { return b.name == name; });
+          return binding != working.bindings.end() &&
+                 (binding->type == BindingType::kInt || binding->type == BindingType::kFloat);
+        });
+    if (numeric) {
+      out.compiled_exprs[node] = std::move(compiled);
+    }
+  }
+
+  end_phase("schemas");
+
+  // Peak working set of the rewritten, pruned plan
+  if (!ValidateMemory(working, graph, exec_order, sinks, out, metrics, error_out)) {
+    return false;
+  }
+  end_phase("memory");
+
+  out.topo_order.clear();
+  for (int32_t node : exec_order) {
+    out.topo_order.push_back(working.nodes[node].id);
+  }
+  out.sinks.clear();
+  for (int32_t node : sinks) {
+    out.sinks.push_back(working.nodes[node].id);
+  }
+  out.pruned_nodes.clear();
+  for (int32_t node : pruned) {
+    out.pruned_nodes.push_back(working.nodes[node].id);
+  }
+  out.merged_nodes = std::move(merged);
+  out.sink_aliases = std::move(sink_aliases);
+  out.bound_nodes.clear();
+  for (int32_t node : exec_order) {
+    std::vector<std::string> refs;
+    CollectBindingRefs(working.nodes[node].params, refs);
+    if (!refs.empty()) {
+      out.bound_nodes.push_back(node);
+    }
+  }
+  out.limit_rewrites = std::move(limit_rewrites);
+  out.plan = std::move(working);
+  out.graph = std::move(graph);
+  out.exec_order = std::move(exec_order);
+  out.sink_indices = std::move(sinks);
+  out.diagnostics = std::move(diagnostics);
   out.complexity = std::move(metrics);
+  end_phase("finalize");
+  out.phases = std::move(phases);
   return true;
 }
 
-bool PlanCompiler::ValidateComplexity(const Plan& plan, ComplexityMetrics& metrics, std::string* error_out) {
-  // Compute metrics (always, for reporting)
-  metrics = ComputeComplexityMetrics(plan);
+bool PlanCompiler::ValidateComplexity(const Plan& plan, const PlanGraph& graph,
+                                      const std::vector<int32_t>& exec_order,
+                                      ComplexityMetrics& metrics, std::string* error_out) {
+  // Compute metrics (always, for reporting). Cost is estimated on the
+  // authored plan, before pruning and limit pushdown, so it is an upper bound.
+  metrics = ComputeComplexityMetrics(plan, graph);
+  EstimatePlanCost(plan, graph, exec_order, cost_model_.value_or(CostModel::Default()), metrics);
 
   // Skip enforcement if disabled
   if (!complexity_check_enabled_) {
@@ -81,71 +327,121 @@ bool PlanCompiler::ValidateComplexity(const Plan& plan, ComplexityMetrics& metri
   return true;
 }
 
-bool PlanCompiler::ValidateNodeIds(const Plan& plan, std::string* error_out) {
-  std::unordered_set<std::string> seen;
-  for (const auto& node : plan.nodes) {
-    if (seen.count(node.id)) {
-      if (error_out) {
-        *error_out = "Duplicate node ID: " + node.id;
-      }
-      return false;
+bool PlanCompiler::ValidateMemory(const Plan& plan, const PlanGraph& graph,
+                                  const std::vector<int32_t>& exec_order,
+                                  const std::vector<int32_t>& sinks, CompiledPlan& out,
+                                  ComplexityMetrics& metrics, std::string* error_out) {
+  EstimateMemoryFootprint(plan, graph, exec_order, sinks, out.liveness, out.fused_chain_of,
+                          out.fused_chains, registry_, metrics);
+
+  if (!complexity_check_enabled_) {
+    return true;
+  }
+
+  ComplexityCheckResult result =
+      CheckMemoryBudget(metrics, budget_.value_or(ComplexityBudget::Default()));
+  if (!result.passed) {
+    if (error_out) {
+      *error_out = result.diagnostics;
     }
-    seen.insert(node.id);
+    return false;
   }
   return true;
 }
 
-bool PlanCompiler::TopologicalSort(const Plan& plan, std::vector<std::string>& out, std::string* error_out) {
-  // Build adjacency and in-degree maps
-  std::unordered_map<std::string, std::vector<std::string>> adj;  // node -> dependents
-  std::unordered_map<std::string, int> in_degree;
+bool PlanCompiler::SelectSinks(const Plan& plan, const PlanGraph& graph,
+                               const std::vector<int32_t>& exec_order,
+                               std::vector<int32_t>& sinks, std::string* error_out) {
+  sinks.clear();
 
-  for (const auto& node : plan.nodes) {
-    adj[node.id];  // Ensure entry exists
-    in_degree[node.id] = static_cast<int>(node.inputs.size());
+  // Default: the last node in execution order
+  if (plan.outputs.empty()) {
+    if (!exec_order.empty()) {
+      sinks.push_back(exec_order.back());
+    }
+    return true;
+  }
 
-    for (const auto& input : node.inputs) {
-      adj[input].push_back(node.id);
+  std::vector<bool> seen(graph.node_count, false);
+  for (const auto& output : plan.outputs) {
+    int32_t node = graph.IndexOf(output);
+    if (node < 0) {
+      if (error_out) {
+        *error_out = "Unknown output node: " + output;
+      }
+      return false;
+    }
+    if (!seen[node]) {
+      seen[node] = true;
+      sinks.push_back(node);
     }
   }
+  return true;
+}
 
-  // Kahn's algorithm
-  std::queue<std::string> queue;
-  for (const auto& node : plan.nodes) {
-    if (in_degree[node.id] == 0) {
-      queue.push(node.id);
+void PlanCompiler::PruneDeadNodes(const PlanGraph& graph, const std::vector<int32_t>& sinks,
+                                  std::vector<int32_t>& exec_order,
+                                  std::vector<int32_t>& pruned) {
+  // Walk input edges backwards from every sink
+  std::vector<bool> live(graph.node_count, false);
+  std::vector<int32_t> stack;
+  for (int32_t sink : sinks) {
+    if (!live[sink]) {
+      live[sink] = true;
+      stack.push_back(sink);
+    }
+  }
+  while (!stack.empty()) {
+    int32_t current = stack.back();
+    stack.pop_back();
+    for (int32_t input : graph.Inputs(current)) {
+      if (!live[input]) {
+        live[input] = true;
+        stack.push_back(input);
+      }
     }
   }
 
-  out.clear();
-  while (!queue.empty()) {
-    std::string current = queue.front();
-    queue.pop();
-    out.push_back(current);
+  pruned.clear();
+  std::vector<int32_t> kept;
+  kept.reserve(exec_order.size());
+  for (int32_t node : exec_order) {
+    (live[node] ? kept : pruned).push_back(node);
+  }
+  exec_order = std::move(kept);
+}
 
-    for (const auto& dependent : adj[current]) {
-      in_degree[dependent]--;
-      if (in_degree[dependent] == 0) {
-        queue.push(dependent);
+bool PlanCompiler::ValidateNodeIds(const Plan& plan, std::string* error_out) {
+  std::unordered_set<std::string> seen;
+  for (const auto& node : plan.nodes) {
+    if (seen.count(node.id)) {
+      if (error_out) {
+        *error_out = "Duplicate node ID: " + node.id;
       }
+      return false;
     }
+    seen.insert(node.id);
   }
+  return true;
+}
 
-  if (out.size() != plan.nodes.size()) {
+bool PlanCompiler::TopologicalSort(const PlanGraph& graph, std::vector<int32_t>& out,
+                                   std::string* error_out) {
+  // Kahn's algorithm over the CSR adjacency
+  if (!TopologicalOrder(graph, out)) {
     if (error_out) {
       *error_out = "Plan contains a cycle";
     }
     return false;
   }
-
   return true;
 }
 
 bool PlanCompiler::ValidateOps(const Plan& plan, std::string* error_out) {
   for (const auto& node : plan.nodes) {
-    // Check if op starts with known prefixes
-    if (node.op.rfind("core:", 0) == 0 || node.op.rfind("js:", 0) == 0) {
-      continue;  // Known prefix
+    // Check if op starts with known prefixes, or is an njs module node
+    if (node.op.rfind("core:", 0) == 0 || node.op.rfind("js:", 0) == 0 || node.op == "njs") {
+      continue;
     }
     if (error_out) {
       *error_out = "Unknown op type: " + node.op;
@@ -155,6 +451,69 @@ bool PlanCompiler::ValidateOps(const Plan& plan, std::string* error_out) {
   return true;
 }
 
+bool PlanCompiler::ValidateLogging(const Plan& plan, const PlanGraph& graph,
+                                   std::string* error_out) {
+  const PlanLogging& logging = plan.logging;
+  if (!(logging.sample_rate >= 0.0f && logging.sample_rate <= 1.0f)) {
+    if (error_out) {
+      *error_out = fmt::format("logging.sample_rate must be in [0, 1], got {}",
+                               logging.sample_rate);
+    }
+    return false;
+  }
+  for (const auto& id : logging.dump_nodes) {
+    if (graph.IndexOf(id) < 0) {
+      if (error_out) {
+        *error_out = fmt::format("logging.dump_nodes references unknown node: {}", id);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PlanCompiler::ValidateBindings(const Plan& plan, std::string* error_out) {
+  std::unordered_set<std::string> declared;
+  for (const auto& binding : plan.bindings) {
+    declared.insert(binding.name);
+  }
+
+  for (const auto& node : plan.nodes) {
+    std::vector<std::string> refs;
+    CollectBindingRefs(node.params, refs);
+    for (const auto& ref : refs) {
+      if (!declared.count(ref)) {
+        if (error_out) {
+          *error_out = fmt::format("Node '{}' references undeclared binding: {}", node.id, ref);
+        }
+        return false;
+      }
+    }
+    if (refs.empty() || !node.params.is_object()) {
+      continue;
+    }
+
+    // Key IDs drive liveness and fusion, so they must be fixed at compile time
+    std::vector<std::string> key_params = {"output_key_id", "key"};
+    if (const NodeSpec* spec = NodeRegistry::Instance().GetSpec(node.op)) {
+      if (spec->writes.kind == WritesDescriptor::Kind::kParamDerived) {
+        key_params.push_back(spec->writes.param_name);
+      }
+    }
+    for (const auto& param : key_params) {
+      auto it = node.params.find(param);
+      if (it != node.params.end() && BindingRefName(*it)) {
+        if (error_out) {
+          *error_out = fmt::format("Node '{}': param '{}' is a key ID and cannot be bound",
+                                   node.id, param);
+        }
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool PlanCompiler::ValidatePlanEnv(const Plan& plan, std::string* error_out) {
   const std::string& env = plan.meta.env;
 
@@ -3,23 +3,59 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "plan/plan.h"
 #include "plan/complexity.h"
+#include "plan/cse.h"
+#include "plan/fusion.h"
+#include "plan/graph.h"
+#include "plan/liveness.h"
+#include "plan/memory.h"
+#include "plan/schema.h"
 
 namespace ranking_dsl {
 
+class CompiledExpr;
 class KeyRegistry;
 class NodeRunner;
 
+/**
+ * Wall time of one compiler pass.
+ */
+struct CompilePhase {
+  std::string name;  // "validate", "complexity", "cse", ...
+  double ms = 0.0;
+};
+
 /**
  * Compiled plan ready for execution.
  */
 struct CompiledPlan {
   Plan plan;
-  std::vector<std::string> topo_order;  // Node IDs in execution order
+  std::vector<std::string> topo_order;  // Node IDs in execution order (live nodes only)
+  std::vector<std::string> sinks;       // Output node IDs; sinks[0] is the primary output
+  std::vector<std::string> pruned_nodes;  // Nodes that cannot reach a sink (never run)
+  std::vector<std::pair<std::string, std::string>> merged_nodes;  // {removed, kept} duplicates
+  std::vector<std::pair<std::string, std::string>> sink_aliases;  // {requested, kept} merged sinks
+  std::vector<std::string> limit_rewrites;  // Sourcer k caps and early truncations applied
+  std::vector<int32_t> bound_nodes;  // Scheduled nodes whose params reference bindings
+  std::string diagnostics;              // Non-fatal compiler warnings (empty if none)
   ComplexityMetrics complexity;         // Computed complexity metrics
+  std::vector<CompilePhase> phases;     // Compile time per pass, in pass order
+
+  // Dense integer form used by the executor (indices into plan.nodes)
+  PlanGraph graph;
+  std::vector<int32_t> exec_order;       // Mirrors topo_order
+  std::vector<int32_t> sink_indices;     // Mirrors sinks
+  std::vector<ColumnLiveness> liveness;  // Columns live after each node, by index
+  std::vector<FusedChain> fused_chains;  // Row-block pipelines (see FindFusedChains)
+  std::vector<int32_t> fused_chain_of;   // Per node: index into fused_chains, or -1
+  std::vector<int32_t> last_consumer;    // Per node: drop output after this node, or -1
+  std::vector<BatchSchema> input_schemas;  // Per node: columns of its input batch
+  std::vector<std::shared_ptr<const CompiledExpr>> compiled_exprs;  // Per node: score formula, or null
+  std::optional<BatchSchema> candidate_schema;  // Request-supplied candidates, if declared
   // Node runners are looked up at execution time
 };
 
@@ -36,27 +72,77 @@ class PlanCompiler {
    */
   void SetComplexityBudget(const ComplexityBudget& budget);
 
+  /**
+   * Set the cost model behind the estimated_ms budget.
+   * If not set, uses CostModel::Default().
+   */
+  void SetCostModel(const CostModel& model);
+
   /**
    * Disable complexity checking (for tests or special cases).
    */
   void DisableComplexityCheck();
 
+  /**
+   * Disable row-block fusion of fusible node chains.
+   */
+  void DisableFusion();
+
+  /**
+   * Disable common sub-plan elimination (duplicate nodes run separately).
+   */
+  void DisableSubplanElimination();
+
+  /**
+   * Disable pushing core:topk limits towards the sources.
+   */
+  void DisableLimitPushdown();
+
+  /**
+   * Declare the columns of request-supplied candidates
+   * (ExecContext::candidates). Sourcers emit those batches as supplied, so
+   * their output schema becomes this one; an unknown schema makes it
+   * unknown. Without a declaration, schemas assume sourcers generate their
+   * candidates, and the executor ignores them for requests that supply
+   * candidates.
+   */
+  void SetCandidateSchema(const BatchSchema& schema);
+
   /**
    * Compile a plan.
-   * Performs validation, complexity checking, and topological sorting.
+   * Performs validation, complexity checking, topological sorting, common
+   * sub-plan elimination, limit pushdown, dead-node elimination, column
+   * liveness analysis, node fusion, input schema inference, and the
+   * working-set memory check.
    */
   bool Compile(const Plan& plan, CompiledPlan& out, std::string* error_out = nullptr);
 
  private:
   const KeyRegistry& registry_;
   std::optional<ComplexityBudget> budget_;
+  std::optional<CostModel> cost_model_;
+  std::optional<BatchSchema> candidate_schema_;
   bool complexity_check_enabled_ = true;
+  bool fusion_enabled_ = true;
+  bool subplan_elimination_enabled_ = true;
+  bool limit_pushdown_enabled_ = true;
 
   bool ValidateNodeIds(const Plan& plan, std::string* error_out);
-  bool TopologicalSort(const Plan& plan, std::vector<std::string>& out, std::string* error_out);
+  bool TopologicalSort(const PlanGraph& graph, std::vector<int32_t>& out, std::string* error_out);
   bool ValidateOps(const Plan& plan, std::string* error_out);
   bool ValidatePlanEnv(const Plan& plan, std::string* error_out);
-  bool ValidateComplexity(const Plan& plan, ComplexityMetrics& metrics, std::string* error_out);
+  bool ValidateBindings(const Plan& plan, std::string* error_out);
+  bool ValidateLogging(const Plan& plan, const PlanGraph& graph, std::string* error_out);
+  bool ValidateComplexity(const Plan& plan, const PlanGraph& graph,
+                          const std::vector<int32_t>& exec_order, ComplexityMetrics& metrics,
+                          std::string* error_out);
+  bool ValidateMemory(const Plan& plan, const PlanGraph& graph,
+                      const std::vector<int32_t>& exec_order, const std::vector<int32_t>& sinks,
+                      CompiledPlan& out, ComplexityMetrics& metrics, std::string* error_out);
+  bool SelectSinks(const Plan& plan, const PlanGraph& graph, const std::vector<int32_t>& exec_order,
+                   std::vector<int32_t>& sinks, std::string* error_out);
+  void PruneDeadNodes(const PlanGraph& graph, const std::vector<int32_t>& sinks,
+                      std::vector<int32_t>& exec_order, std::vector<int32_t>& pruned);
 };
 
 }  // namespace ranking_dsl
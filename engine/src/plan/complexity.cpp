@@ -1,108 +1,404 @@
 #include "plan/complexity.h"
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
-#include <queue>
+#include <istream>
+#include <map>
+#include <optional>
 #include <sstream>
-#include <unordered_map>
-#include <unordered_set>
 
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
 
+#include "plan/bindings.h"
+
 namespace ranking_dsl {
 
-ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, int top_k) {
-  ComplexityMetrics metrics;
-  metrics.node_count = static_cast<int64_t>(plan.nodes.size());
+namespace {
 
-  if (plan.nodes.empty()) {
-    return metrics;
+// Rows assumed for a sourcer whose k is absent (matches core:sourcer)
+constexpr int64_t kDefaultSourcerRows = 100;
+
+struct CostSample {
+  double rows;
+  double ms;
+};
+
+// Integer param value; a bound param resolves to its binding's default
+std::optional<int64_t> IntParam(const Plan& plan, const PlanNode& node, const char* name) {
+  if (!node.params.is_object() || !node.params.contains(name)) {
+    return std::nullopt;
   }
+  const nlohmann::json* value = &node.params[name];
+  if (const std::string* binding = BindingRefName(*value)) {
+    value = nullptr;
+    for (const auto& declared : plan.bindings) {
+      if (declared.name == *binding) {
+        value = &declared.default_value;
+        break;
+      }
+    }
+  }
+  if (!value || !value->is_number()) {
+    return std::nullopt;
+  }
+  return std::max<int64_t>(value->get<int64_t>(), 0);
+}
 
-  // Build graph structures
-  std::unordered_map<std::string, const PlanNode*> node_map;
-  std::unordered_map<std::string, std::vector<std::string>> adj;      // node -> dependents
-  std::unordered_map<std::string, std::vector<std::string>> reverse;  // node -> inputs
-  std::unordered_map<std::string, int64_t> out_degree;
-  std::unordered_map<std::string, int64_t> in_degree;
+// Solve the 3x3 system a*x = b by Gaussian elimination; false if singular
+bool Solve3(double a[3][3], double b[3], double x[3]) {
+  for (int col = 0; col < 3; ++col) {
+    int pivot = col;
+    for (int row = col + 1; row < 3; ++row) {
+      if (std::abs(a[row][col]) > std::abs(a[pivot][col])) pivot = row;
+    }
+    if (std::abs(a[pivot][col]) < 1e-12) return false;
+    std::swap(a[col], a[pivot]);
+    std::swap(b[col], b[pivot]);
+    for (int row = col + 1; row < 3; ++row) {
+      double f = a[row][col] / a[col][col];
+      for (int k = col; k < 3; ++k) a[row][k] -= f * a[col][k];
+      b[row] -= f * b[col];
+    }
+  }
+  for (int row = 2; row >= 0; --row) {
+    double sum = b[row];
+    for (int k = row + 1; k < 3; ++k) sum -= a[row][k] * x[k];
+    x[row] = sum / a[row][row];
+  }
+  return true;
+}
 
-  for (const auto& node : plan.nodes) {
-    node_map[node.id] = &node;
-    adj[node.id];  // Ensure entry
-    reverse[node.id];
-    in_degree[node.id] = static_cast<int64_t>(node.inputs.size());
-    out_degree[node.id] = 0;
+// Least-squares fit of ms against rows. Tries the quadratic model, then a
+// linear one, then a pure per-row or pure fixed cost, keeping the first fit
+// whose coefficients are all non-negative.
+void FitOpCost(const std::vector<CostSample>& samples, OpCost& cost) {
+  const double n = static_cast<double>(samples.size());
+  double s1 = 0, s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0, t2 = 0;
+  for (const auto& sample : samples) {
+    double r = sample.rows;
+    s1 += r;
+    s2 += r * r;
+    s3 += r * r * r;
+    s4 += r * r * r * r;
+    t0 += sample.ms;
+    t1 += r * sample.ms;
+    t2 += r * r * sample.ms;
+  }
 
-    for (const auto& input : node.inputs) {
-      adj[input].push_back(node.id);
-      reverse[node.id].push_back(input);
-      metrics.edge_count++;
+  // Round-off on exact data can leave a zero term slightly negative; a term
+  // contributing under 1e-6 of the mean duration at the mean row count is zero
+  const double mean_rows = s1 / n;
+  const double tolerance = 1e-6 * std::abs(t0 / n);
+  auto non_negative = [&](double& coefficient, double scale) {
+    if (coefficient < 0 && -coefficient * scale <= tolerance) {
+      coefficient = 0;
     }
+    return coefficient >= 0;
+  };
+
+  double a[3][3] = {{n, s1, s2}, {s1, s2, s3}, {s2, s3, s4}};
+  double b[3] = {t0, t1, t2};
+  double x[3] = {0, 0, 0};
+  if (Solve3(a, b, x) && non_negative(x[0], 1.0) && non_negative(x[1], mean_rows) &&
+      non_negative(x[2], mean_rows * mean_rows)) {
+    cost.fixed_ms = x[0];
+    cost.per_row_ms = x[1];
+    cost.per_row_sq_ms = x[2];
+    return;
   }
 
-  // Compute out-degrees
-  for (const auto& [id, deps] : adj) {
-    out_degree[id] = static_cast<int64_t>(deps.size());
+  double det = n * s2 - s1 * s1;
+  if (std::abs(det) > 1e-12) {
+    double fixed = (s2 * t0 - s1 * t1) / det;
+    double per_row = (n * t1 - s1 * t0) / det;
+    if (non_negative(fixed, 1.0) && non_negative(per_row, mean_rows)) {
+      cost.fixed_ms = fixed;
+      cost.per_row_ms = per_row;
+      cost.per_row_sq_ms = 0;
+      return;
+    }
   }
 
-  // Find fanout and fanin peaks
-  for (const auto& node : plan.nodes) {
-    metrics.fanout_peak = std::max(metrics.fanout_peak, out_degree[node.id]);
-    metrics.fanin_peak = std::max(metrics.fanin_peak, in_degree[node.id]);
+  cost.per_row_sq_ms = 0;
+  if (s2 > 0 && t1 > 0) {
+    cost.fixed_ms = 0;
+    cost.per_row_ms = t1 / s2;
+  } else {
+    cost.fixed_ms = std::max(t0 / n, 0.0);
+    cost.per_row_ms = 0;
   }
+}
 
-  // Compute max depth using dynamic programming
-  // depth[v] = longest path ending at v
-  std::unordered_map<std::string, int64_t> depth;
-  std::unordered_map<std::string, std::string> predecessor;  // For path reconstruction
+OpCost ParseOpCost(const nlohmann::json& j) {
+  OpCost cost;
+  cost.fixed_ms = j.value("fixed_ms", 0.0);
+  cost.per_row_ms = j.value("per_row_ms", 0.0);
+  cost.per_row_sq_ms = j.value("per_row_sq_ms", 0.0);
+  cost.samples = j.value("samples", int64_t{0});
+  return cost;
+}
+
+nlohmann::json OpCostToJson(const OpCost& cost) {
+  nlohmann::json j;
+  j["fixed_ms"] = cost.fixed_ms;
+  j["per_row_ms"] = cost.per_row_ms;
+  j["per_row_sq_ms"] = cost.per_row_sq_ms;
+  j["samples"] = cost.samples;
+  return j;
+}
 
-  // Kahn's algorithm with depth tracking
-  std::queue<std::string> queue;
-  std::unordered_map<std::string, int64_t> remaining_in;
-  for (const auto& node : plan.nodes) {
-    remaining_in[node.id] = in_degree[node.id];
-    depth[node.id] = 1;  // Base depth
-    if (in_degree[node.id] == 0) {
-      queue.push(node.id);
+// The first node_end field CalibrateCostModel reads that has the wrong
+// JSON type, or empty if all present fields are usable
+std::string BadTraceField(const nlohmann::json& event) {
+  for (const char* field : {"op", "njs_file"}) {
+    if (event.contains(field) && !event[field].is_string()) {
+      return field;
+    }
+  }
+  for (const char* field : {"rows_in", "rows_out", "duration_ms"}) {
+    if (event.contains(field) && !event[field].is_number()) {
+      return field;
     }
   }
+  return "";
+}
 
-  std::string deepest_node;
-  int64_t max_depth = 0;
+}  // namespace
+
+const OpCost& CostModel::CostOf(const PlanNode& node) const {
+  if (node.op == "njs" && node.params.is_object() && node.params.contains("module") &&
+      node.params["module"].is_string()) {
+    auto it = ops.find("njs:" + node.params["module"].get<std::string>());
+    if (it != ops.end()) {
+      return it->second;
+    }
+  }
+  auto it = ops.find(node.op);
+  return it != ops.end() ? it->second : fallback;
+}
 
-  while (!queue.empty()) {
-    std::string current = queue.front();
-    queue.pop();
+CostModel CostModel::Default() {
+  // Coarse single-core figures for the built-in nodes; a calibrated model
+  // (rankdsl_engine --calibrate-cost-model) should replace them for budgets.
+  CostModel model;
+  model.ops["core:sourcer"] = {0.01, 0.00005, 0.0, 0};
+  model.ops["core:features"] = {0.01, 0.0002, 0.0, 0};
+  model.ops["core:model"] = {0.01, 0.0001, 0.0, 0};
+  model.ops["core:score_formula"] = {0.01, 0.0002, 0.0, 0};
+  model.ops["core:merge"] = {0.01, 0.0002, 0.0, 0};
+  model.ops["core:topk"] = {0.01, 0.0003, 0.0, 0};
+  model.ops["njs"] = {0.1, 0.002, 0.0, 0};
+  model.fallback = {0.05, 0.001, 0.0, 0};
+  return model;
+}
 
+CostModel CostModel::Parse(const std::string& json_str, std::string* error_out) {
+  try {
+    auto j = nlohmann::json::parse(json_str);
+    CostModel model;
+    if (j.contains("ops")) {
+      for (const auto& [op, cost] : j["ops"].items()) {
+        model.ops[op] = ParseOpCost(cost);
+      }
+    }
+    if (j.contains("fallback")) {
+      model.fallback = ParseOpCost(j["fallback"]);
+    }
+    return model;
+  } catch (const std::exception& e) {
+    if (error_out) {
+      *error_out = std::string("Failed to parse cost model: ") + e.what();
+    }
+    return CostModel();
+  }
+}
+
+CostModel CostModel::LoadFromFile(const std::string& path, std::string* error_out) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    if (error_out) {
+      *error_out = "Failed to open cost model file: " + path;
+    }
+    return CostModel();
+  }
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return Parse(buffer.str(), error_out);
+}
+
+std::string CostModel::Dump() const {
+  nlohmann::json j;
+  j["version"] = 1;
+  j["ops"] = nlohmann::json::object();
+  for (const auto& [op, cost] : ops) {
+    j["ops"][op] = OpCostToJson(cost);
+  }
+  j["fallback"] = OpCostToJson(fallback);
+  return j.dump(2);
+}
+
+CostModel CalibrateCostModel(std::istream& trace, const CostModel& base, std::string* error_out) {
+  std::map<std::string, std::vector<CostSample>> samples;
+  std::string line;
+  int64_t line_number = 0;
+  while (std::getline(trace, line)) {
+    ++line_number;
+    if (line.empty() || line[0] != '{') {
+      continue;  // Plan output and other non-trace lines
+    }
+    auto event = nlohmann::json::parse(line, nullptr, false);
+    if (event.is_discarded()) {
+      if (error_out) {
+        *error_out = fmt::format("Trace line {}: invalid JSON", line_number);
+      }
+      return base;
+    }
+    if (event.value("event", "") != "node_end" || event.contains("error")) {
+      continue;
+    }
+    std::string bad_field = BadTraceField(event);
+    if (!bad_field.empty()) {
+      if (error_out) {
+        *error_out = fmt::format("Trace line {}: {} has the wrong type", line_number, bad_field);
+      }
+      return base;
+    }
+    std::string op = event.value("op", "");
+    if (op.empty() || op == "fused") {
+      continue;  // A fused span covers several ops at once
+    }
+    double rows = static_cast<double>(std::max(event.value("rows_in", int64_t{0}),
+                                               event.value("rows_out", int64_t{0})));
+    CostSample sample{rows, event.value("duration_ms", 0.0)};
+    samples[op].push_back(sample);
+    if (op == "njs" && event.contains("njs_file")) {
+      samples["njs:" + event["njs_file"].get<std::string>()].push_back(sample);
+    }
+  }
+
+  CostModel model = base;
+  for (const auto& [op, op_samples] : samples) {
+    if (op_samples.size() < 2) {
+      continue;
+    }
+    auto it = base.ops.find(op);
+    OpCost cost = it != base.ops.end() ? it->second : base.fallback;
+    FitOpCost(op_samples, cost);
+    cost.samples = static_cast<int64_t>(op_samples.size());
+    model.ops[op] = cost;
+  }
+  return model;
+}
+
+std::vector<int64_t> EstimateRowCounts(const Plan& plan, const PlanGraph& graph,
+                                       const std::vector<int32_t>& order) {
+  std::vector<int64_t> rows_out(graph.node_count, 0);
+  for (int32_t node : order) {
+    const PlanNode& spec = plan.nodes[node];
+    auto inputs = graph.Inputs(node);
+    int64_t rows = inputs.empty() ? 0 : rows_out[inputs.front()];
+
+    if (spec.op == "core:sourcer") {
+      rows = IntParam(plan, spec, "k").value_or(kDefaultSourcerRows);
+    } else if (spec.op == "core:merge") {
+      rows = 0;
+      for (int32_t input : inputs) {
+        rows += rows_out[input];
+      }
+    } else if (spec.op == "core:topk") {
+      rows = std::min(rows, IntParam(plan, spec, "k").value_or(rows));
+    }
+    rows_out[node] = rows;
+  }
+  return rows_out;
+}
+
+void EstimatePlanCost(const Plan& plan, const PlanGraph& graph, const std::vector<int32_t>& order,
+                      const CostModel& model, ComplexityMetrics& metrics, int top_k) {
+  metrics.estimated_ms = 0.0;
+  metrics.top_cost.clear();
+
+  std::vector<int64_t> rows_out = EstimateRowCounts(plan, graph, order);
+  std::vector<ComplexityMetrics::NodeCost> costs;
+  costs.reserve(order.size());
+
+  for (int32_t node : order) {
+    const PlanNode& spec = plan.nodes[node];
+    auto inputs = graph.Inputs(node);
+    int64_t rows_in = inputs.empty() ? 0 : rows_out[inputs.front()];
+    int64_t rows = rows_out[node];
+
+    const OpCost& cost = model.CostOf(spec);
+    double r = static_cast<double>(std::max(rows_in, rows));
+    double ms = cost.fixed_ms + cost.per_row_ms * r + cost.per_row_sq_ms * r * r;
+    metrics.estimated_ms += ms;
+    costs.push_back({spec.id, spec.op, ms, rows});
+  }
+
+  std::stable_sort(costs.begin(), costs.end(),
+                   [](const auto& a, const auto& b) { return a.ms > b.ms; });
+  for (int i = 0; i < top_k && i < static_cast<int>(costs.size()); ++i) {
+    metrics.top_cost.push_back(costs[i]);
+  }
+}
+
+ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, int top_k) {
+  return ComputeComplexityMetrics(plan, BuildPlanGraph(plan), top_k);
+}
+
+ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, const PlanGraph& graph, int top_k) {
+  ComplexityMetrics metrics;
+  metrics.node_count = static_cast<int64_t>(plan.nodes.size());
+
+  if (plan.nodes.empty()) {
+    return metrics;
+  }
+
+  const int32_t n = graph.node_count;
+  metrics.edge_count = graph.edge_count;
+
+  // Find fanout and fanin peaks
+  for (int32_t i = 0; i < n; ++i) {
+    metrics.fanout_peak = std::max<int64_t>(metrics.fanout_peak, graph.OutDegree(i));
+    metrics.fanin_peak = std::max<int64_t>(metrics.fanin_peak, graph.InDegree(i));
+  }
+
+  // Compute max depth using dynamic programming over a topological order
+  // depth[v] = longest path ending at v
+  std::vector<int32_t> order;
+  TopologicalOrder(graph, order);  // Nodes on a cycle are simply not visited
+
+  std::vector<int64_t> depth(n, 1);         // Base depth
+  std::vector<int32_t> predecessor(n, -1);  // For path reconstruction
+
+  int32_t deepest_node = -1;
+  int64_t max_depth = 0;
+
+  for (int32_t current : order) {
     if (depth[current] > max_depth) {
       max_depth = depth[current];
       deepest_node = current;
     }
 
-    for (const auto& dep : adj[current]) {
+    for (int32_t dep : graph.Dependents(current)) {
       int64_t new_depth = depth[current] + 1;
       if (new_depth > depth[dep]) {
         depth[dep] = new_depth;
         predecessor[dep] = current;
       }
-      remaining_in[dep]--;
-      if (remaining_in[dep] == 0) {
-        queue.push(dep);
-      }
     }
   }
 
   metrics.max_depth = max_depth;
 
   // Reconstruct longest path (from deepest_node backwards)
-  if (!deepest_node.empty()) {
+  if (deepest_node >= 0) {
     std::vector<std::string> path;
-    std::string current = deepest_node;
-    while (!current.empty()) {
-      path.push_back(current);
-      auto it = predecessor.find(current);
-      current = (it != predecessor.end()) ? it->second : "";
+    for (int32_t current = deepest_node; current >= 0; current = predecessor[current]) {
+      path.push_back(plan.nodes[current].id);
     }
     std::reverse(path.begin(), path.end());
     metrics.longest_path = std::move(path);
@@ -110,8 +406,9 @@ ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, int top_k) {
 
   // Collect top-K fanout nodes
   std::vector<ComplexityMetrics::NodeInfo> fanout_nodes;
-  for (const auto& node : plan.nodes) {
-    fanout_nodes.push_back({node.id, node.op, out_degree[node.id]});
+  fanout_nodes.reserve(n);
+  for (int32_t i = 0; i < n; ++i) {
+    fanout_nodes.push_back({plan.nodes[i].id, plan.nodes[i].op, graph.OutDegree(i)});
   }
   std::sort(fanout_nodes.begin(), fanout_nodes.end(),
             [](const auto& a, const auto& b) { return a.degree > b.degree; });
@@ -121,8 +418,9 @@ ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, int top_k) {
 
   // Collect top-K fanin nodes
   std::vector<ComplexityMetrics::NodeInfo> fanin_nodes;
-  for (const auto& node : plan.nodes) {
-    fanin_nodes.push_back({node.id, node.op, in_degree[node.id]});
+  fanin_nodes.reserve(n);
+  for (int32_t i = 0; i < n; ++i) {
+    fanin_nodes.push_back({plan.nodes[i].id, plan.nodes[i].op, graph.InDegree(i)});
   }
   std::sort(fanin_nodes.begin(), fanin_nodes.end(),
             [](const auto& a, const auto& b) { return a.degree > b.degree; });
@@ -175,6 +473,10 @@ ComplexityCheckResult CheckComplexityBudget(
     violations.push_back(fmt::format("fanin_peak={} (hard_limit={})",
                                       metrics.fanin_peak, budget.fanin_peak_hard));
   }
+  if (budget.estimated_ms_hard > 0 && metrics.estimated_ms > budget.estimated_ms_hard) {
+    violations.push_back(fmt::format("estimated_ms={:.3f} (hard_limit={})",
+                                      metrics.estimated_ms, budget.estimated_ms_hard));
+  }
 
   // Check soft limits
   if (budget.edge_count_soft > 0 && metrics.edge_count > budget.edge_count_soft) {
@@ -235,6 +537,12 @@ ComplexityCheckResult CheckComplexityBudget(
     }
     ss << "\n";
 
+    ss << "  estimated_ms=" << fmt::format("{:.3f}", metrics.estimated_ms);
+    if (budget.estimated_ms_hard > 0) {
+      ss << " (hard_limit=" << budget.estimated_ms_hard << ")";
+    }
+    ss << "\n";
+
     // Top fanout nodes
     if (!metrics.top_fanout.empty()) {
       ss << "Top fanout nodes:\n";
@@ -255,6 +563,15 @@ ComplexityCheckResult CheckComplexityBudget(
       }
     }
 
+    // Most expensive nodes by the cost model
+    if (!metrics.top_cost.empty()) {
+      ss << "Top cost nodes:\n";
+      for (const auto& node : metrics.top_cost) {
+        ss << "  " << node.id << " " << node.op
+           << fmt::format(" est_ms={:.3f} rows={}", node.ms, node.rows) << "\n";
+      }
+    }
+
     // Longest path
     if (!metrics.longest_path.empty()) {
       ss << "Longest path (len=" << metrics.longest_path.size() << "):\n  ";
@@ -281,12 +598,62 @@ ComplexityCheckResult CheckComplexityBudget(
   return result;
 }
 
+ComplexityCheckResult CheckMemoryBudget(
+    const ComplexityMetrics& metrics,
+    const ComplexityBudget& budget) {
+  ComplexityCheckResult result;
+  bool peak_over = budget.peak_memory_bytes_hard > 0 &&
+                   metrics.peak_memory_bytes > budget.peak_memory_bytes_hard;
+  bool total_over = budget.estimated_bytes_hard > 0 &&
+                    metrics.estimated_bytes > budget.estimated_bytes_hard;
+  if (!peak_over && !total_over) {
+    return result;
+  }
+
+  result.passed = false;
+  result.error_code = "PLAN_MEMORY_TOO_LARGE";
+
+  std::ostringstream ss;
+  ss << "PLAN_MEMORY_TOO_LARGE:\n";
+  ss << "  peak_memory_bytes=" << metrics.peak_memory_bytes;
+  if (budget.peak_memory_bytes_hard > 0) {
+    ss << " (hard_limit=" << budget.peak_memory_bytes_hard << ")";
+  }
+  if (!metrics.peak_memory_node.empty()) {
+    ss << " at " << metrics.peak_memory_node;
+  }
+  ss << "\n";
+  ss << "  estimated_bytes=" << metrics.estimated_bytes;
+  if (budget.estimated_bytes_hard > 0) {
+    ss << " (hard_limit=" << budget.estimated_bytes_hard << ")";
+  }
+  ss << "\n";
+
+  if (!metrics.top_memory.empty()) {
+    ss << "Top memory nodes:\n";
+    for (const auto& node : metrics.top_memory) {
+      if (node.bytes > 0) {
+        ss << "  " << node.id << " " << node.op << " bytes=" << node.bytes
+           << " rows=" << node.rows << "\n";
+      }
+    }
+  }
+
+  ss << "Hint:\n";
+  ss << "  Lower sourcer k or add core:topk before wide features, and drop vector keys\n";
+  ss << "  no downstream node reads. See docs/complexity-governance.md for guidance.";
+
+  result.diagnostics = ss.str();
+  return result;
+}
+
 ComplexityBudget ComplexityBudget::Default() {
   ComplexityBudget budget;
   budget.node_count_hard = 2000;
   budget.max_depth_hard = 120;
   budget.fanout_peak_hard = 16;
   budget.fanin_peak_hard = 16;
+  budget.peak_memory_bytes_hard = int64_t{1} << 30;  // 1 GiB
   budget.edge_count_soft = 10000;
   budget.complexity_score_soft = 8000;
   return budget;
@@ -311,6 +678,15 @@ ComplexityBudget ComplexityBudget::Parse(const std::string& json_str, std::strin
       if (hard.contains("fanin_peak")) {
         budget.fanin_peak_hard = hard["fanin_peak"].get<int64_t>();
       }
+      if (hard.contains("estimated_ms")) {
+        budget.estimated_ms_hard = hard["estimated_ms"].get<double>();
+      }
+      if (hard.contains("estimated_bytes")) {
+        budget.estimated_bytes_hard = hard["estimated_bytes"].get<int64_t>();
+      }
+      if (hard.contains("peak_memory_bytes")) {
+        budget.peak_memory_bytes_hard = hard["peak_memory_bytes"].get<int64_t>();
+      }
     }
 
     if (j.contains("soft")) {
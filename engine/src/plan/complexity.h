@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <iosfwd>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "plan/graph.h"
 #include "plan/plan.h"
 
 namespace ranking_dsl {
@@ -27,8 +30,90 @@ struct ComplexityMetrics {
   std::vector<NodeInfo> top_fanout;  // Top-K by out-degree
   std::vector<NodeInfo> top_fanin;   // Top-K by in-degree
   std::vector<std::string> longest_path;  // Node IDs on longest path
+
+  // Cost model estimates (see EstimatePlanCost)
+  struct NodeCost {
+    std::string id;
+    std::string op;
+    double ms;
+    int64_t rows;
+  };
+  double estimated_ms = 0.0;     // Sum of per-node estimates (nodes run sequentially)
+  std::vector<NodeCost> top_cost;  // Top-K by estimated ms
+
+  // Working-set estimate (see EstimateMemoryFootprint)
+  struct NodeBytes {
+    std::string id;
+    std::string op;
+    int64_t bytes;  // Column bytes the node allocates
+    int64_t rows;
+  };
+  int64_t peak_memory_bytes = 0;      // Peak live column bytes during execution
+  int64_t estimated_bytes = 0;        // Column bytes allocated by all nodes
+  std::string peak_memory_node;       // Node (or fused chain head) running at the peak
+  std::vector<NodeBytes> top_memory;  // Top-K by bytes allocated
 };
 
+/**
+ * Cost coefficients for one op:
+ *   ms = fixed_ms + per_row_ms * rows + per_row_sq_ms * rows^2
+ * where rows = max(rows in, rows out). Bytes are not part of the cost
+ * model; they come from the key widths (see EstimateMemoryFootprint).
+ */
+struct OpCost {
+  double fixed_ms = 0.0;
+  double per_row_ms = 0.0;
+  double per_row_sq_ms = 0.0;
+  int64_t samples = 0;  // Trace events fitted (0 = built-in default)
+};
+
+/**
+ * Per-op cost model. njs modules are costed individually as
+ * "njs:<module path>", falling back to "njs", then to `fallback`.
+ */
+struct CostModel {
+  std::unordered_map<std::string, OpCost> ops;
+  OpCost fallback;
+
+  const OpCost& CostOf(const PlanNode& node) const;
+
+  // Built-in coefficients (rough; calibrate from traces for real budgets)
+  static CostModel Default();
+
+  // Parse from JSON: {"ops": {"core:model": {"fixed_ms": .., ...}}, "fallback": {..}}
+  static CostModel Parse(const std::string& json_str, std::string* error_out = nullptr);
+  static CostModel LoadFromFile(const std::string& path, std::string* error_out = nullptr);
+
+  // Serialize in the format Parse accepts
+  std::string Dump() const;
+};
+
+/**
+ * Fit cost coefficients from recorded traces (Tracer JSON lines; node_end
+ * events) and merge them over `base`. Ops with fewer than two samples keep
+ * the base coefficients. Fused spans are skipped (record profiles with
+ * fusion disabled to calibrate fusible ops). Invalid JSON or a wrongly typed
+ * node_end field sets `error_out` and returns `base`.
+ */
+CostModel CalibrateCostModel(std::istream& trace, const CostModel& base,
+                             std::string* error_out = nullptr);
+
+/**
+ * Expected output rows per node (indexed like plan.nodes) for the nodes in
+ * `order` (topological): sourcers emit `k`, core:topk caps at `k`,
+ * core:merge sums its inputs, other nodes keep their first input's rows.
+ * Bound params use the binding's default.
+ */
+std::vector<int64_t> EstimateRowCounts(const Plan& plan, const PlanGraph& graph,
+                                       const std::vector<int32_t>& order);
+
+/**
+ * Estimate cost for the nodes in `order` (topological), with expected rows
+ * from EstimateRowCounts.
+ */
+void EstimatePlanCost(const Plan& plan, const PlanGraph& graph, const std::vector<int32_t>& order,
+                      const CostModel& model, ComplexityMetrics& metrics, int top_k = 5);
+
 /**
  * Score weights for complexity score computation.
  */
@@ -50,6 +135,9 @@ struct ComplexityBudget {
   int64_t max_depth_hard = 0;
   int64_t fanout_peak_hard = 0;
   int64_t fanin_peak_hard = 0;
+  double estimated_ms_hard = 0.0;    // Cost model estimate (see EstimatePlanCost)
+  int64_t estimated_bytes_hard = 0;    // Total allocation (see EstimateMemoryFootprint)
+  int64_t peak_memory_bytes_hard = 0;  // Working-set estimate (see EstimateMemoryFootprint)
 
   // Soft limits (warnings only)
   int64_t edge_count_soft = 0;
@@ -83,6 +171,12 @@ struct ComplexityCheckResult {
  */
 ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, int top_k = 5);
 
+/**
+ * Compute complexity metrics from an already-interned plan graph.
+ */
+ComplexityMetrics ComputeComplexityMetrics(const Plan& plan, const PlanGraph& graph,
+                                           int top_k = 5);
+
 /**
  * Check if metrics are within budget.
  * Returns detailed diagnostics on failure.
@@ -91,6 +185,15 @@ ComplexityCheckResult CheckComplexityBudget(
     const ComplexityMetrics& metrics,
     const ComplexityBudget& budget);
 
+/**
+ * Check the memory estimates against budget.peak_memory_bytes_hard and
+ * budget.estimated_bytes_hard.
+ * Fails with error code PLAN_MEMORY_TOO_LARGE.
+ */
+ComplexityCheckResult CheckMemoryBudget(
+    const ComplexityMetrics& metrics,
+    const ComplexityBudget& budget);
+
 /**
  * Compute weighted complexity score.
  * S = a*N + b*D + c*F_out + d*F_in + e*E
@@ -0,0 +1,107 @@
+#include "plan/cse.h"
+
+#include <functional>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+namespace ranking_dsl {
+
+namespace {
+
+bool IsMergeable(const PlanNode& node) {
+  return node.op != "njs" && node.op.rfind("js:", 0) != 0;
+}
+
+}  // namespace
+
+SubplanEliminationResult EliminateCommonSubplans(const Plan& plan, const PlanGraph& graph,
+                                                 const std::vector<int32_t>& topo_order) {
+  const int32_t n = graph.node_count;
+
+  // canonical[i] = index of the node that computes the same batch as i
+  std::vector<int32_t> canonical(n);
+  for (int32_t i = 0; i < n; ++i) {
+    canonical[i] = i;
+  }
+
+  // nlohmann::json objects keep keys sorted, so dump() is canonical
+  std::vector<std::string> params_text(n);
+  std::unordered_map<size_t, std::vector<int32_t>> classes;  // hash -> representatives
+
+  // Topological order guarantees inputs are canonicalized first; ties in the
+  // order follow plan order, so the earliest duplicate becomes the keeper
+  for (int32_t node : topo_order) {
+    const PlanNode& spec = plan.nodes[node];
+    if (!IsMergeable(spec)) {
+      continue;
+    }
+    params_text[node] = spec.params.dump();
+
+    size_t hash = std::hash<std::string>{}(spec.op);
+    hash ^= std::hash<std::string>{}(params_text[node]) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    for (int32_t input : graph.Inputs(node)) {
+      hash ^= static_cast<size_t>(canonical[input]) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+
+    auto equivalent = [&](int32_t other) {
+      const PlanNode& other_spec = plan.nodes[other];
+      if (other_spec.op != spec.op || params_text[other] != params_text[node]) {
+        return false;
+      }
+      auto a = graph.Inputs(node);
+      auto b = graph.Inputs(other);
+      if (a.size() != b.size()) {
+        return false;
+      }
+      for (size_t k = 0; k < a.size(); ++k) {
+        if (canonical[a[k]] != canonical[b[k]]) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    auto& bucket = classes[hash];
+    for (int32_t representative : bucket) {
+      if (equivalent(representative)) {
+        canonical[node] = representative;
+        break;
+      }
+    }
+    if (canonical[node] == node) {
+      bucket.push_back(node);
+    }
+  }
+
+  // Rebuild the plan without duplicates, preserving plan order
+  SubplanEliminationResult result;
+  result.plan = plan;
+  result.plan.nodes.clear();
+  result.plan.outputs.clear();
+
+  auto canonical_id = [&](const std::string& id) -> const std::string& {
+    int32_t index = graph.IndexOf(id);
+    return index < 0 ? id : plan.nodes[canonical[index]].id;
+  };
+
+  for (int32_t i = 0; i < n; ++i) {
+    if (canonical[i] != i) {
+      result.merged.emplace_back(plan.nodes[i].id, plan.nodes[canonical[i]].id);
+      continue;
+    }
+    PlanNode node = plan.nodes[i];
+    for (auto& input : node.inputs) {
+      input = canonical_id(input);
+    }
+    result.plan.nodes.push_back(std::move(node));
+  }
+
+  for (const auto& output : plan.outputs) {
+    result.plan.outputs.push_back(canonical_id(output));
+  }
+
+  return result;
+}
+
+}  // namespace ranking_dsl
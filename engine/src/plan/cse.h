@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "plan/graph.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * Result of common sub-plan elimination.
+ */
+struct SubplanEliminationResult {
+  Plan plan;  // Duplicates removed; inputs and outputs point at the kept node
+  std::vector<std::pair<std::string, std::string>> merged;  // {removed ID, kept ID}
+};
+
+/**
+ * Merge equivalent nodes: same op, same (canonical JSON) params, and inputs
+ * that are themselves equivalent, in order. Visiting nodes in topological
+ * order lets whole duplicated sub-plans collapse, not just single nodes.
+ *
+ * The first node of each class in plan order is kept. trace_key does not
+ * affect equivalence. njs nodes are never merged (modules may keep state).
+ */
+SubplanEliminationResult EliminateCommonSubplans(const Plan& plan, const PlanGraph& graph,
+                                                 const std::vector<int32_t>& topo_order);
+
+}  // namespace ranking_dsl
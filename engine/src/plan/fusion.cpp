@@ -0,0 +1,78 @@
+#include "plan/fusion.h"
+
+#include <string>
+#include <unordered_map>
+
+#include "nodes/node_runner.h"
+#include "nodes/registry.h"
+
+namespace ranking_dsl {
+
+std::vector<FusedChain> FindFusedChains(const Plan& plan, const PlanGraph& graph,
+                                        const std::vector<int32_t>& exec_order,
+                                        const std::vector<int32_t>& sinks) {
+  const int32_t n = graph.node_count;
+  std::vector<bool> scheduled(n, false);
+  for (int32_t node : exec_order) {
+    scheduled[node] = true;
+  }
+  std::vector<bool> is_sink(n, false);
+  for (int32_t node : sinks) {
+    is_sink[node] = true;
+  }
+
+  // Fusible per the spec and backed by a runner with a block path
+  std::unordered_map<std::string, bool> op_fusible;
+  std::vector<bool> fusible(n, false);
+  for (int32_t node : exec_order) {
+    const std::string& op = plan.nodes[node].op;
+    auto [it, inserted] = op_fusible.try_emplace(op, false);
+    if (inserted) {
+      const NodeSpec* spec = NodeRegistry::Instance().GetSpec(op);
+      auto runner = spec && spec->fusible ? NodeRegistry::Instance().Create(op) : nullptr;
+      it->second = runner && runner->RunsBlocks();
+    }
+    fusible[node] = it->second;
+  }
+
+  // The node that `node` can hand its rows to inside a chain, or -1
+  auto next_in_chain = [&](int32_t node) -> int32_t {
+    if (!fusible[node] || is_sink[node]) {
+      return -1;
+    }
+    int32_t next = -1;
+    for (int32_t dependent : graph.Dependents(node)) {
+      if (!scheduled[dependent]) {
+        continue;
+      }
+      if (next >= 0) {
+        return -1;  // More than one consumer
+      }
+      next = dependent;
+    }
+    if (next < 0 || !fusible[next] || graph.InDegree(next) != 1) {
+      return -1;
+    }
+    return next;
+  };
+
+  std::vector<FusedChain> chains;
+  std::vector<bool> claimed(n, false);
+  for (int32_t node : exec_order) {
+    if (claimed[node] || !fusible[node]) {
+      continue;
+    }
+    FusedChain chain;
+    for (int32_t current = node; current >= 0; current = next_in_chain(current)) {
+      chain.nodes.push_back(current);
+      claimed[current] = true;
+    }
+    if (chain.nodes.size() >= 2) {
+      chains.push_back(std::move(chain));
+    }
+  }
+
+  return chains;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "plan/graph.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * A chain of fusible nodes run as one pipeline over row blocks.
+ * nodes[i + 1]'s only input is nodes[i], and nodes[i] feeds nothing else.
+ */
+struct FusedChain {
+  std::vector<int32_t> nodes;  // Node indices, in execution order
+};
+
+/**
+ * Find maximal chains (length >= 2) of nodes whose NodeSpec is fusible.
+ *
+ * Only scheduled nodes (exec_order) are considered. A node that is a sink or
+ * has more than one scheduled consumer ends a chain, since its full output
+ * batch is needed.
+ */
+std::vector<FusedChain> FindFusedChains(const Plan& plan, const PlanGraph& graph,
+                                        const std::vector<int32_t>& exec_order,
+                                        const std::vector<int32_t>& sinks);
+
+}  // namespace ranking_dsl
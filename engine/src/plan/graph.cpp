@@ -0,0 +1,74 @@
+#include "plan/graph.h"
+
+namespace ranking_dsl {
+
+int32_t PlanGraph::IndexOf(const std::string& id) const {
+  auto it = index_by_id.find(id);
+  return it == index_by_id.end() ? -1 : it->second;
+}
+
+PlanGraph BuildPlanGraph(const Plan& plan) {
+  PlanGraph graph;
+  graph.node_count = static_cast<int32_t>(plan.nodes.size());
+  graph.index_by_id.reserve(plan.nodes.size());
+  for (int32_t i = 0; i < graph.node_count; ++i) {
+    graph.index_by_id.emplace(plan.nodes[i].id, i);
+  }
+
+  // Input CSR (resolving IDs once) and dependent counts
+  graph.input_offsets.assign(graph.node_count + 1, 0);
+  std::vector<int32_t> dependent_count(graph.node_count, 0);
+  for (int32_t i = 0; i < graph.node_count; ++i) {
+    for (const auto& input : plan.nodes[i].inputs) {
+      int32_t from = graph.IndexOf(input);
+      if (from < 0) {
+        graph.unresolved_inputs.emplace_back(i, input);
+        continue;
+      }
+      graph.input_edges.push_back(from);
+      dependent_count[from]++;
+    }
+    graph.input_offsets[i + 1] = static_cast<int32_t>(graph.input_edges.size());
+  }
+  graph.edge_count = static_cast<int64_t>(graph.input_edges.size());
+
+  // Dependent CSR via counting sort on the source node
+  graph.output_offsets.assign(graph.node_count + 1, 0);
+  for (int32_t i = 0; i < graph.node_count; ++i) {
+    graph.output_offsets[i + 1] = graph.output_offsets[i] + dependent_count[i];
+  }
+  graph.output_edges.resize(graph.input_edges.size());
+  std::vector<int32_t> cursor(graph.output_offsets.begin(), graph.output_offsets.end() - 1);
+  for (int32_t i = 0; i < graph.node_count; ++i) {
+    for (int32_t from : graph.Inputs(i)) {
+      graph.output_edges[cursor[from]++] = i;
+    }
+  }
+
+  return graph;
+}
+
+bool TopologicalOrder(const PlanGraph& graph, std::vector<int32_t>& out) {
+  std::vector<int32_t> remaining(graph.node_count);
+  out.clear();
+  out.reserve(graph.node_count);
+  for (int32_t i = 0; i < graph.node_count; ++i) {
+    remaining[i] = graph.InDegree(i);
+    if (remaining[i] == 0) {
+      out.push_back(i);
+    }
+  }
+
+  // `out` doubles as the FIFO queue
+  for (size_t head = 0; head < out.size(); ++head) {
+    for (int32_t dependent : graph.Dependents(out[head])) {
+      if (--remaining[dependent] == 0) {
+        out.push_back(dependent);
+      }
+    }
+  }
+
+  return static_cast<int32_t>(out.size()) == graph.node_count;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * Dense integer view of a plan DAG.
+ *
+ * Node i is plan.nodes[i]. Edges are stored in CSR form in both directions,
+ * so traversals index flat arrays instead of hashing node ID strings.
+ * Duplicate input edges are kept (they count toward fan-in/fan-out).
+ */
+struct PlanGraph {
+  int32_t node_count = 0;
+  int64_t edge_count = 0;
+  std::unordered_map<std::string, int32_t> index_by_id;
+
+  // input_edges[input_offsets[i] .. input_offsets[i + 1]) are node i's inputs
+  std::vector<int32_t> input_offsets;
+  std::vector<int32_t> input_edges;
+
+  // Same layout for dependents (nodes that list i as an input)
+  std::vector<int32_t> output_offsets;
+  std::vector<int32_t> output_edges;
+
+  // Inputs that name no node in the plan: {node index, input ID}
+  std::vector<std::pair<int32_t, std::string>> unresolved_inputs;
+
+  std::span<const int32_t> Inputs(int32_t node) const {
+    return {input_edges.data() + input_offsets[node],
+            static_cast<size_t>(input_offsets[node + 1] - input_offsets[node])};
+  }
+
+  std::span<const int32_t> Dependents(int32_t node) const {
+    return {output_edges.data() + output_offsets[node],
+            static_cast<size_t>(output_offsets[node + 1] - output_offsets[node])};
+  }
+
+  int32_t InDegree(int32_t node) const {
+    return input_offsets[node + 1] - input_offsets[node];
+  }
+
+  int32_t OutDegree(int32_t node) const {
+    return output_offsets[node + 1] - output_offsets[node];
+  }
+
+  /**
+   * Index of a node ID, or -1 if the plan has no such node.
+   */
+  int32_t IndexOf(const std::string& id) const;
+};
+
+/**
+ * Intern a plan into a PlanGraph. Node IDs are hashed once here.
+ * With duplicate IDs, edges resolve to the first node with that ID.
+ */
+PlanGraph BuildPlanGraph(const Plan& plan);
+
+/**
+ * Kahn's algorithm over a PlanGraph (ties broken by plan order).
+ * Returns false if the graph contains a cycle.
+ */
+bool TopologicalOrder(const PlanGraph& graph, std::vector<int32_t>& out);
+
+}  // namespace ranking_dsl
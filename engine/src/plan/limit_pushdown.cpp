@@ -0,0 +1,169 @@
+#include "plan/limit_pushdown.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "keys.h"
+#include "nodes/registry.h"
+#include "plan/liveness.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+constexpr int64_t kUnbounded = std::numeric_limits<int64_t>::max();
+
+bool IsTopK(const PlanNode& node) {
+  return node.op == "core:topk" && node.params.contains("k") &&
+         node.params["k"].is_number_integer();
+}
+
+bool IsRowPreserving(const PlanNode& node) {
+  const NodeSpec* spec = NodeRegistry::Instance().GetSpec(node.op);
+  return spec && spec->fusible;
+}
+
+}  // namespace
+
+LimitPushdownResult PushDownLimits(const Plan& plan, const PlanGraph& graph,
+                                   const std::vector<int32_t>& exec_order,
+                                   const std::vector<int32_t>& sinks,
+                                   const KeyRegistry& registry) {
+  const int32_t n = graph.node_count;
+  std::vector<bool> is_sink(n, false);
+  for (int32_t node : sinks) {
+    is_sink[node] = true;
+  }
+
+  LimitPushdownResult result;
+  result.plan = plan;
+
+  // Sourcer k: the most rows any consumer can use from each node
+  std::vector<int64_t> need(n, kUnbounded);
+  for (auto it = exec_order.rbegin(); it != exec_order.rend(); ++it) {
+    int32_t node = *it;
+    if (is_sink[node] || graph.OutDegree(node) == 0) {
+      continue;
+    }
+    int64_t bound = 0;
+    for (int32_t consumer : graph.Dependents(node)) {
+      const PlanNode& spec = plan.nodes[consumer];
+      int64_t consumer_need = kUnbounded;
+      if (IsTopK(spec) && spec.params.value("push_to_sources", false)) {
+        consumer_need = std::max<int64_t>(spec.params["k"].get<int64_t>(), 0);
+      } else if (IsRowPreserving(spec)) {
+        consumer_need = need[consumer];
+      }
+      bound = std::max(bound, consumer_need);
+    }
+    need[node] = bound;
+  }
+
+  for (int32_t node : exec_order) {
+    PlanNode& spec = result.plan.nodes[node];
+    if (spec.op != "core:sourcer" || need[node] == kUnbounded) {
+      continue;
+    }
+    if (spec.params.contains("k") && !spec.params["k"].is_number_integer()) {
+      continue;  // Bound per request
+    }
+    int64_t k = spec.params.value("k", int64_t{100});
+    if (need[node] < k) {
+      spec.params["k"] = need[node];
+      result.rewrites.push_back(
+          fmt::format("{}: k {} -> {} (limit from downstream core:topk)", spec.id, k, need[node]));
+    }
+  }
+
+  // Early truncation: find the node that writes each topk's ranking key
+  struct Insertion {
+    int32_t writer;
+    int32_t consumer;  // First node after the writer on the path to the topk
+    int32_t topk;
+  };
+  std::vector<Insertion> insertions;
+  for (int32_t topk : exec_order) {
+    const PlanNode& spec = plan.nodes[topk];
+    if (!IsTopK(spec) || graph.InDegree(topk) != 1) {
+      continue;
+    }
+    int32_t key = spec.params.value("key", keys::id::SCORE_FINAL);
+
+    int32_t consumer = topk;
+    int32_t current = graph.Inputs(topk).front();
+    int32_t writer = -1;
+    while (true) {
+      NodeKeyAccess access = ResolveNodeKeyAccess(plan.nodes[current], registry);
+      if (std::find(access.writes.begin(), access.writes.end(), key) != access.writes.end()) {
+        writer = current;
+        break;
+      }
+      if (!IsRowPreserving(plan.nodes[current]) || is_sink[current] ||
+          graph.OutDegree(current) != 1 || graph.InDegree(current) != 1) {
+        break;
+      }
+      consumer = current;
+      current = graph.Inputs(current).front();
+    }
+
+    // Nothing to gain when the writer already feeds the topk directly
+    if (writer >= 0 && consumer != topk) {
+      insertions.push_back({writer, consumer, topk});
+    }
+  }
+
+  if (insertions.empty()) {
+    return result;
+  }
+
+  std::unordered_set<std::string> ids;
+  for (const auto& node : plan.nodes) {
+    ids.insert(node.id);
+  }
+
+  // Rebuild node order with each truncation placed right after its writer
+  std::vector<std::vector<PlanNode>> after(n);
+  for (const auto& insertion : insertions) {
+    const PlanNode& topk = plan.nodes[insertion.topk];
+    std::string id = topk.id + ".early";
+    for (int suffix = 2; ids.count(id); ++suffix) {
+      id = fmt::format("{}.early{}", topk.id, suffix);
+    }
+    ids.insert(id);
+
+    PlanNode early;
+    early.id = id;
+    early.op = "core:topk";
+    early.inputs = {plan.nodes[insertion.writer].id};
+    early.params = nlohmann::json::object();
+    early.params["k"] = topk.params["k"];
+    early.params["key"] = topk.params.value("key", keys::id::SCORE_FINAL);
+
+    for (auto& input : result.plan.nodes[insertion.consumer].inputs) {
+      if (input == plan.nodes[insertion.writer].id) {
+        input = id;
+      }
+    }
+    result.rewrites.push_back(fmt::format("{}: truncate to {} rows after {}", id,
+                                          early.params["k"].dump(),
+                                          plan.nodes[insertion.writer].id));
+    after[insertion.writer].push_back(std::move(early));
+  }
+
+  std::vector<PlanNode> nodes;
+  nodes.reserve(plan.nodes.size() + insertions.size());
+  for (int32_t i = 0; i < n; ++i) {
+    nodes.push_back(std::move(result.plan.nodes[i]));
+    for (auto& early : after[i]) {
+      nodes.push_back(std::move(early));
+    }
+  }
+  result.plan.nodes = std::move(nodes);
+  return result;
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plan/graph.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+class KeyRegistry;
+
+/**
+ * Result of limit pushdown.
+ */
+struct LimitPushdownResult {
+  Plan plan;                             // Rewritten plan (a copy when unchanged)
+  std::vector<std::string> rewrites;     // Human-readable description of each rewrite
+};
+
+/**
+ * Propagate core:topk row limits towards the sources.
+ *
+ * Two rewrites, both limited to paths through row-preserving (fusible) nodes
+ * that have no other consumer:
+ *
+ * - Early truncation: when the ranking key is written further upstream than
+ *   the topk's direct input, a copy of the topk (`<id>.early`) is inserted
+ *   right after the writer. This is exact: the nodes in between are
+ *   row-independent and do not touch the key.
+ * - Sourcer k: when a topk sets `push_to_sources`, every upstream core:sourcer
+ *   whose rows only reach that topk has `k` capped at the limit.
+ *
+ * Nodes that drop or merge rows (core:merge, njs) stop propagation, since a
+ * bound past them could leave fewer than k rows at the topk.
+ */
+LimitPushdownResult PushDownLimits(const Plan& plan, const PlanGraph& graph,
+                                   const std::vector<int32_t>& exec_order,
+                                   const std::vector<int32_t>& sinks,
+                                   const KeyRegistry& registry);
+
+}  // namespace ranking_dsl
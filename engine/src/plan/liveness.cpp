@@ -0,0 +1,164 @@
+#include "plan/liveness.h"
+
+#include <algorithm>
+#include <set>
+
+#include <nlohmann/json.hpp>
+
+#include "expr/expr.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "nodes/js/njs_runner.h"
+#include "nodes/registry.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+// A set of live keys; `all` means every column may be needed
+struct LiveSet {
+  bool all = false;
+  std::set<int32_t> keys;
+
+  void Merge(const LiveSet& other) {
+    if (all) return;
+    if (other.all) {
+      all = true;
+      keys.clear();
+      return;
+    }
+    keys.insert(other.keys.begin(), other.keys.end());
+  }
+};
+
+void AppendParamKeys(const nlohmann::json& value, std::vector<int32_t>& out) {
+  if (value.is_number_integer()) {
+    out.push_back(value.get<int32_t>());
+  } else if (value.is_array()) {
+    for (const auto& k : value) {
+      if (k.is_number_integer()) {
+        out.push_back(k.get<int32_t>());
+      }
+    }
+  }
+}
+
+}  // namespace
+
+NodeKeyAccess ResolveNodeKeyAccess(const PlanNode& node, const KeyRegistry& registry) {
+  NodeKeyAccess access;
+
+  if (node.op == "njs") {
+    NjsMeta meta;
+    if (!LoadNjsMeta(node.params, &registry, meta)) {
+      access.reads_all = true;
+      return access;
+    }
+    access.reads.assign(meta.reads.begin(), meta.reads.end());
+    access.writes.assign(meta.writes.begin(), meta.writes.end());
+    access.max_write_bytes = meta.budget.max_write_bytes;
+    return access;
+  }
+
+  const NodeSpec* spec = NodeRegistry::Instance().GetSpec(node.op);
+  if (!spec) {
+    access.reads_all = true;
+    return access;
+  }
+
+  access.reads = spec->reads;
+
+  if (spec->writes.kind == WritesDescriptor::Kind::kStatic) {
+    access.writes = spec->writes.static_keys;
+  } else if (node.params.contains(spec->writes.param_name)) {
+    AppendParamKeys(node.params[spec->writes.param_name], access.writes);
+  }
+
+  if (node.op == "core:score_formula") {
+    // Mirror the node's defaults: expr = signal(score.base), output = score.final
+    if (node.params.contains("expr")) {
+      std::string error;
+      ExprNode expr = ParseExpr(node.params["expr"], &error);
+      if (!error.empty()) {
+        access.reads_all = true;
+      }
+      auto ids = CollectKeyIds(expr, &registry);
+      access.reads.insert(access.reads.end(), ids.begin(), ids.end());
+    } else {
+      access.reads.push_back(keys::id::SCORE_BASE);
+    }
+    if (!node.params.contains("output_key_id")) {
+      access.writes.push_back(keys::id::SCORE_FINAL);
+    }
+  }
+
+  if (node.op == "core:topk") {
+    access.reads.push_back(node.params.value("key", keys::id::SCORE_FINAL));
+  }
+
+  return access;
+}
+
+std::vector<ColumnLiveness> ComputeColumnLiveness(const Plan& plan, const PlanGraph& graph,
+                                                  const std::vector<int32_t>& exec_order,
+                                                  const std::vector<int32_t>& sinks,
+                                                  const KeyRegistry& registry) {
+  std::vector<bool> scheduled(graph.node_count, false);
+  for (int32_t node : exec_order) {
+    scheduled[node] = true;
+  }
+  std::vector<bool> is_sink(graph.node_count, false);
+  for (int32_t node : sinks) {
+    is_sink[node] = true;
+  }
+
+  LiveSet sink_live;
+  sink_live.all = plan.output_keys.empty();
+  if (!sink_live.all) {
+    sink_live.keys.insert(plan.output_keys.begin(), plan.output_keys.end());
+  }
+
+  std::vector<LiveSet> live_in(graph.node_count);
+  std::vector<ColumnLiveness> result(graph.node_count);
+
+  for (auto it = exec_order.rbegin(); it != exec_order.rend(); ++it) {
+    int32_t node = *it;
+
+    // live_out = union of consumers' live_in, plus the plan output for sinks.
+    // Every input edge counts, not only the one the executor forwards today;
+    // pruned consumers never run.
+    LiveSet live_out;
+    if (is_sink[node]) {
+      live_out = sink_live;
+    }
+    for (int32_t consumer : graph.Dependents(node)) {
+      if (scheduled[consumer]) {
+        live_out.Merge(live_in[consumer]);
+      }
+    }
+    if (!live_out.all) {
+      live_out.keys.insert(plan.logging.dump_keys.begin(), plan.logging.dump_keys.end());
+    }
+
+    ColumnLiveness& liveness = result[node];
+    liveness.prune = !live_out.all;
+    liveness.live_keys.assign(live_out.keys.begin(), live_out.keys.end());
+
+    // live_in = reads + (live_out - writes)
+    NodeKeyAccess access = ResolveNodeKeyAccess(plan.nodes[node], registry);
+    LiveSet& in = live_in[node];
+    if (access.reads_all || live_out.all) {
+      in.all = true;
+    } else {
+      in.keys = std::move(live_out.keys);
+      for (int32_t key : access.writes) {
+        in.keys.erase(key);
+      }
+      in.keys.insert(access.reads.begin(), access.reads.end());
+    }
+  }
+
+  return result;
+}
+
+}  // namespace ranking_dsl
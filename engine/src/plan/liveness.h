@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plan/graph.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+class KeyRegistry;
+
+/**
+ * Keys a plan node reads and writes, resolved from its NodeSpec and params.
+ */
+struct NodeKeyAccess {
+  bool reads_all = false;        // Reads unknown: every incoming column is live
+  std::vector<int32_t> reads;
+  std::vector<int32_t> writes;
+  int64_t max_write_bytes = 0;   // njs meta.budget.max_write_bytes (0 = no cap)
+};
+
+/**
+ * Resolve the key access of a plan node.
+ *
+ * - NodeSpec reads, plus static or param-derived writes
+ * - core:score_formula reads the keys referenced by its expression
+ * - njs nodes use meta.reads / meta.writes from the module
+ * - Unknown ops (or njs modules that fail to load) read everything
+ */
+NodeKeyAccess ResolveNodeKeyAccess(const PlanNode& node, const KeyRegistry& registry);
+
+/**
+ * Columns that are still needed after a node has run.
+ */
+struct ColumnLiveness {
+  bool prune = false;              // False when any column may be needed downstream
+  std::vector<int32_t> live_keys;  // Sorted; only meaningful when prune is true
+};
+
+/**
+ * Backward liveness pass over the scheduled nodes of a plan.
+ *
+ * Sink outputs keep plan.output_keys (all columns if empty) plus
+ * plan.logging.dump_keys; each node keeps the union of what its consumers
+ * read or pass through: live_in = reads + (live_out - writes).
+ *
+ * Returns one entry per plan node, indexed like plan.nodes; nodes missing
+ * from exec_order are never pruned.
+ */
+std::vector<ColumnLiveness> ComputeColumnLiveness(const Plan& plan, const PlanGraph& graph,
+                                                  const std::vector<int32_t>& exec_order,
+                                                  const std::vector<int32_t>& sinks,
+                                                  const KeyRegistry& registry);
+
+}  // namespace ranking_dsl
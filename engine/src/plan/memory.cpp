@@ -0,0 +1,257 @@
+#include "plan/memory.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "nodes/js/batch_context.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+// f32vec keys without a declared dim are sized like core:features embeddings
+constexpr int64_t kDefaultVectorDim = 128;
+
+// Stands in for the writes of an njs module whose meta cannot be loaded
+constexpr int32_t kUnknownWrites = -1;
+
+// Key -> column ID
+using SimBatch = std::map<int32_t, int32_t>;
+
+// Reference-counted columns, as shared between batches by the executor
+class ColumnPool {
+ public:
+  int32_t Allocate(int64_t bytes) {
+    bytes_.push_back(bytes);
+    refs_.push_back(0);
+    live_bytes_ += bytes;
+    return static_cast<int32_t>(bytes_.size() - 1);
+  }
+
+  void Hold(const SimBatch& batch) {
+    for (const auto& [key, column] : batch) {
+      ++refs_[column];
+    }
+  }
+
+  void Release(const SimBatch& batch) {
+    for (const auto& [key, column] : batch) {
+      if (--refs_[column] == 0) {
+        live_bytes_ -= bytes_[column];
+      }
+    }
+  }
+
+  // Free columns allocated since `first` that no held batch kept
+  void FreeUnheld(int32_t first) {
+    for (size_t column = first; column < bytes_.size(); ++column) {
+      if (refs_[column] == 0) {
+        live_bytes_ -= bytes_[column];
+        refs_[column] = -1;  // Freed; never held again
+      }
+    }
+  }
+
+  int32_t Size() const { return static_cast<int32_t>(bytes_.size()); }
+  int64_t LiveBytes() const { return live_bytes_; }
+
+ private:
+  std::vector<int64_t> bytes_;
+  std::vector<int32_t> refs_;
+  int64_t live_bytes_ = 0;
+};
+
+int64_t ColumnBytes(const KeyRegistry& registry, int32_t key, int64_t rows) {
+  const KeyRegistry::KeyInfo* info = registry.GetById(key);
+  return (info ? KeyBytesPerRow(*info) : int64_t{8}) * rows;
+}
+
+// Run one node over `batch`: allocate the columns it writes into `pool`
+// and return the bytes allocated
+int64_t SimulateNode(const Plan& plan, const PlanGraph& graph, int32_t node,
+                     const std::vector<int64_t>& rows, const std::vector<SimBatch>& outputs,
+                     const KeyRegistry& registry, ColumnPool& pool, SimBatch& batch) {
+  const PlanNode& spec = plan.nodes[node];
+  const int64_t rows_out = rows[node];
+  int64_t allocated = 0;
+
+  // Row-selecting nodes copy every column they pass on
+  if (spec.op == "core:merge" || spec.op == "core:topk") {
+    SimBatch copied;
+    for (int32_t input : graph.Inputs(node)) {
+      for (const auto& [key, column] : outputs[input]) {
+        if (!copied.count(key)) {
+          int64_t bytes = ColumnBytes(registry, key, rows_out);
+          copied[key] = pool.Allocate(bytes);
+          allocated += bytes;
+        }
+      }
+    }
+    batch = std::move(copied);
+    return allocated;
+  }
+
+  NodeKeyAccess access = ResolveNodeKeyAccess(spec, registry);
+  std::vector<std::pair<int32_t, int64_t>> writes;
+  int64_t write_bytes = 0;
+  for (int32_t key : access.writes) {
+    writes.emplace_back(key, ColumnBytes(registry, key, rows_out));
+    write_bytes += writes.back().second;
+  }
+  if (spec.op == "njs") {
+    int64_t cap = access.max_write_bytes;
+    if (access.reads_all) {
+      cap = NjsBudget{}.max_write_bytes;  // Meta unavailable: assume the default budget
+      writes = {{kUnknownWrites, cap}};
+      write_bytes = cap;
+    }
+    if (cap > 0 && write_bytes > cap) {
+      // The runner fails a module that writes past its budget
+      for (auto& [key, bytes] : writes) {
+        bytes = bytes * cap / write_bytes;
+      }
+    }
+  }
+
+  for (const auto& [key, bytes] : writes) {
+    batch[key] = pool.Allocate(bytes);
+    allocated += bytes;
+  }
+  return allocated;
+}
+
+void Prune(const ColumnLiveness& liveness, SimBatch& batch) {
+  if (!liveness.prune) {
+    return;
+  }
+  for (auto it = batch.begin(); it != batch.end();) {
+    bool live = std::binary_search(liveness.live_keys.begin(), liveness.live_keys.end(),
+                                   it->first);
+    it = live ? std::next(it) : batch.erase(it);
+  }
+}
+
+}  // namespace
+
+int64_t KeyBytesPerRow(const KeyRegistry::KeyInfo& key) {
+  switch (key.type) {
+    case keys::KeyType::Bool:
+      return 1;
+    case keys::KeyType::I64:
+      return 8;
+    case keys::KeyType::F32:
+      return 4;
+    case keys::KeyType::String:
+      return static_cast<int64_t>(sizeof(std::string));
+    case keys::KeyType::Bytes:
+      return static_cast<int64_t>(sizeof(std::vector<uint8_t>));
+    case keys::KeyType::F32Vec:
+      return 4 * (key.dim > 0 ? static_cast<int64_t>(key.dim) : kDefaultVectorDim);
+  }
+  return 8;
+}
+
+std::vector<int32_t> ComputeLastConsumers(const PlanGraph& graph,
+                                          const std::vector<int32_t>& exec_order,
+                                          const std::vector<int32_t>& sinks,
+                                          const std::vector<int32_t>& fused_chain_of,
+                                          const std::vector<FusedChain>& fused_chains) {
+  std::vector<int32_t> position(graph.node_count, -1);
+  for (size_t i = 0; i < exec_order.size(); ++i) {
+    position[exec_order[i]] = static_cast<int32_t>(i);
+  }
+
+  // A fused chain runs when its head comes up
+  auto step_of = [&](int32_t node) {
+    int32_t chain = fused_chain_of.empty() ? -1 : fused_chain_of[node];
+    return chain >= 0 ? fused_chains[chain].nodes.front() : node;
+  };
+
+  std::vector<int32_t> last(graph.node_count, -1);
+  for (int32_t node : exec_order) {
+    int32_t step = step_of(node);
+    for (int32_t input : graph.Inputs(node)) {
+      if (step_of(input) == step) {
+        continue;  // Inside a chain: passed block by block
+      }
+      if (last[input] < 0 || position[step] > position[last[input]]) {
+        last[input] = step;
+      }
+    }
+  }
+  for (int32_t sink : sinks) {
+    last[sink] = -1;
+  }
+  return last;
+}
+
+void EstimateMemoryFootprint(const Plan& plan, const PlanGraph& graph,
+                             const std::vector<int32_t>& exec_order,
+                             const std::vector<int32_t>& sinks,
+                             const std::vector<ColumnLiveness>& liveness,
+                             const std::vector<int32_t>& fused_chain_of,
+                             const std::vector<FusedChain>& fused_chains,
+                             const KeyRegistry& registry, ComplexityMetrics& metrics,
+                             int top_k) {
+  metrics.peak_memory_bytes = 0;
+  metrics.estimated_bytes = 0;
+  metrics.peak_memory_node.clear();
+  metrics.top_memory.clear();
+
+  const std::vector<int64_t> rows = EstimateRowCounts(plan, graph, exec_order);
+  const std::vector<int32_t> last =
+      ComputeLastConsumers(graph, exec_order, sinks, fused_chain_of, fused_chains);
+
+  ColumnPool pool;
+  std::vector<SimBatch> outputs(graph.node_count);
+  std::vector<ComplexityMetrics::NodeBytes> allocations;
+
+  for (int32_t node : exec_order) {
+    int32_t chain = fused_chain_of.empty() ? -1 : fused_chain_of[node];
+    if (chain >= 0 && fused_chains[chain].nodes.front() != node) {
+      continue;  // Ran with its chain head
+    }
+    const std::vector<int32_t> step =
+        chain >= 0 ? fused_chains[chain].nodes : std::vector<int32_t>{node};
+
+    // A chain writes every member's columns into one batch; only the tail's
+    // liveness applies
+    int32_t first_column = pool.Size();
+    auto inputs = graph.Inputs(step.front());
+    SimBatch batch = inputs.empty() ? SimBatch{} : outputs[inputs.front()];
+    for (int32_t member : step) {
+      int64_t allocated =
+          SimulateNode(plan, graph, member, rows, outputs, registry, pool, batch);
+      allocations.push_back({plan.nodes[member].id, plan.nodes[member].op, allocated,
+                             rows[member]});
+      metrics.estimated_bytes += allocated;
+    }
+
+    if (pool.LiveBytes() > metrics.peak_memory_bytes) {
+      metrics.peak_memory_bytes = pool.LiveBytes();
+      metrics.peak_memory_node = plan.nodes[node].id;
+    }
+
+    int32_t tail = step.back();
+    Prune(liveness[tail], batch);
+    pool.Hold(batch);
+    outputs[tail] = std::move(batch);
+    pool.FreeUnheld(first_column);
+
+    for (int32_t input : inputs) {
+      if (last[input] == node) {
+        pool.Release(outputs[input]);
+        outputs[input].clear();
+      }
+    }
+  }
+
+  std::stable_sort(allocations.begin(), allocations.end(),
+                   [](const auto& a, const auto& b) { return a.bytes > b.bytes; });
+  for (int i = 0; i < top_k && i < static_cast<int>(allocations.size()); ++i) {
+    metrics.top_memory.push_back(allocations[i]);
+  }
+}
+
+}  // namespace ranking_dsl
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "keys/registry.h"
+#include "plan/complexity.h"
+#include "plan/fusion.h"
+#include "plan/graph.h"
+#include "plan/liveness.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * Bytes per row of a column holding `key`: the value width, with f32vec
+ * keys sized by their registry dim. Strings and bytes count their handle
+ * only.
+ */
+int64_t KeyBytesPerRow(const KeyRegistry::KeyInfo& key);
+
+/**
+ * For each node, the node after which the executor may drop its output:
+ * its last scheduled consumer, or the head of that consumer's fused chain.
+ * -1 for sinks (kept for the caller), unscheduled nodes, and fused chain
+ * members whose output is never materialized.
+ */
+std::vector<int32_t> ComputeLastConsumers(const PlanGraph& graph,
+                                          const std::vector<int32_t>& exec_order,
+                                          const std::vector<int32_t>& sinks,
+                                          const std::vector<int32_t>& fused_chain_of,
+                                          const std::vector<FusedChain>& fused_chains);
+
+/**
+ * Simulate execution and estimate the peak working set, in column bytes.
+ *
+ * Mirrors the executor: a node shares its input's columns and allocates the
+ * keys it writes (core:merge and core:topk copy every column), outputs are
+ * pruned to their live keys, and a node's output is dropped after its last
+ * consumer runs. Rows come from EstimateRowCounts; njs writes are capped by
+ * the module's max_write_bytes budget. Fills metrics.peak_memory_bytes,
+ * peak_memory_node, top_memory, and estimated_bytes (the sum of every
+ * node's allocation, as if nothing were freed).
+ */
+void EstimateMemoryFootprint(const Plan& plan, const PlanGraph& graph,
+                             const std::vector<int32_t>& exec_order,
+                             const std::vector<int32_t>& sinks,
+                             const std::vector<ColumnLiveness>& liveness,
+                             const std::vector<int32_t>& fused_chain_of,
+                             const std::vector<FusedChain>& fused_chains,
+                             const KeyRegistry& registry, ComplexityMetrics& metrics,
+                             int top_k = 5);
+
+}  // namespace ranking_dsl
@@ -80,6 +80,56 @@ bool ParsePlan(const nlohmann::json& json, Plan& out, std::string* error_out) {
           out.logging.dump_keys.push_back(key.get<int32_t>());
         }
       }
+      if (log_json.contains("dump_nodes")) {
+        for (const auto& node : log_json["dump_nodes"]) {
+          out.logging.dump_nodes.push_back(node.get<std::string>());
+        }
+      }
+    }
+
+    // Parse outputs (optional; named sink nodes)
+    out.outputs.clear();
+    if (json.contains("outputs")) {
+      for (const auto& output : json["outputs"]) {
+        out.outputs.push_back(output.get<std::string>());
+      }
+    }
+
+    // Parse output_keys (optional; enables column pruning)
+    out.output_keys.clear();
+    if (json.contains("output_keys")) {
+      for (const auto& key : json["output_keys"]) {
+        out.output_keys.push_back(key.get<int32_t>());
+      }
+    }
+
+    // Parse bindings (optional; request-level values referenced by params)
+    out.bindings.clear();
+    if (json.contains("bindings")) {
+      for (const auto& [name, binding_json] : json["bindings"].items()) {
+        PlanBinding binding;
+        binding.name = name;
+        auto type_name = binding_json.value("type", std::string("float"));
+        auto type = ParseBindingType(type_name);
+        if (!type) {
+          if (error_out) {
+            *error_out = "Binding '" + name + "': unknown type \"" + type_name + "\"";
+          }
+          return false;
+        }
+        binding.type = *type;
+        if (binding_json.contains("default")) {
+          auto value = CoerceBindingValue(binding.type, binding_json["default"]);
+          if (!value) {
+            if (error_out) {
+              *error_out = "Binding '" + name + "': default is not a " + type_name;
+            }
+            return false;
+          }
+          binding.default_value = std::move(*value);
+        }
+        out.bindings.push_back(std::move(binding));
+      }
     }
 
     return true;
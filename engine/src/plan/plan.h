@@ -8,6 +8,7 @@
 #include <nlohmann/json.hpp>
 
 #include "expr/expr.h"
+#include "plan/bindings.h"
 
 namespace ranking_dsl {
 
@@ -32,8 +33,9 @@ std::string ValidateTraceKey(const std::string& trace_key);
  * Logging configuration.
  */
 struct PlanLogging {
-  float sample_rate = 0.0f;
+  float sample_rate = 0.0f;             // Fraction of requests whose dump_keys are dumped
   std::vector<int32_t> dump_keys;
+  std::vector<std::string> dump_nodes;  // Dump after these nodes (empty = every node)
 };
 
 /**
@@ -52,6 +54,9 @@ struct Plan {
   PlanMeta meta;
   std::vector<PlanNode> nodes;
   PlanLogging logging;
+  std::vector<int32_t> output_keys;  // Keys read from the final batch (empty = all)
+  std::vector<std::string> outputs;  // Sink node IDs (empty = last node in topo order)
+  std::vector<PlanBinding> bindings;  // Request-level values params may reference
 };
 
 /**
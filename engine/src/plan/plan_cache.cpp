@@ -0,0 +1,298 @@
+#include "plan/plan_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include "keys/registry.h"
+#include "nodes/js/njs_bytecode_registry.h"
+#include "plan/artifact.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+// FNV-1a over length-prefixed fields, so ("ab", "c") and ("a", "bc") differ
+class ContentHasher {
+ public:
+  template <typename T>
+  void Pod(const T& value) {
+    Bytes(&value, sizeof(T));
+  }
+
+  void String(const std::string& value) {
+    Pod(static_cast<uint64_t>(value.size()));
+    Bytes(value.data(), value.size());
+  }
+
+  void Ints(const std::vector<int32_t>& values) {
+    Pod(static_cast<uint64_t>(values.size()));
+    Bytes(values.data(), values.size() * sizeof(int32_t));
+  }
+
+  uint64_t Digest() const { return hash_; }
+
+ private:
+  void Bytes(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+// Hash of a module file's source, memoized by path and re-read only when the
+// file's mtime or size changes, so cache hits cost a stat rather than a read
+std::string NjsSourceIdentity(const std::string& path) {
+  struct Entry {
+    std::filesystem::file_time_type mtime;
+    uintmax_t size = 0;
+    std::string identity;
+  };
+  static std::shared_mutex mutex;
+  static std::unordered_map<std::string, Entry> memo;
+
+  std::error_code ec;
+  auto mtime = std::filesystem::last_write_time(path, ec);
+  uintmax_t size = ec ? 0 : std::filesystem::file_size(path, ec);
+  if (ec) {
+    return {};  // Compiling fails to load the module too
+  }
+  {
+    std::shared_lock lock(mutex);
+    auto it = memo.find(path);
+    if (it != memo.end() && it->second.mtime == mtime && it->second.size == size) {
+      return it->second.identity;
+    }
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return {};
+  }
+  std::ostringstream source;
+  source << file.rdbuf();
+  ContentHasher h;
+  h.String(source.str());
+  std::string identity = "source:" + std::to_string(h.Digest());
+
+  std::unique_lock lock(mutex);
+  memo[path] = Entry{mtime, size, identity};
+  return identity;
+}
+
+// Code an njs node runs when its params do not pin it: the precompiled
+// module's digest, else the source on disk (resolved like NjsRunner).
+// A params.digest is hashed with the params and must be precompiled.
+std::string NjsModuleIdentity(const nlohmann::json& params) {
+  if (!params.is_object() || params.contains("digest")) {
+    return {};
+  }
+  std::string path = params.value("module", "");
+  if (path.empty()) {
+    return {};
+  }
+  if (const auto* module = NjsBytecodeRegistry::Instance().FindByPath(path)) {
+    return "digest:" + module->digest;
+  }
+  return NjsSourceIdentity(path);
+}
+
+}  // namespace
+
+uint64_t PlanContentHash(const Plan& plan) {
+  ContentHasher h;
+  h.String(plan.name);
+  h.Pod(plan.version);
+  h.String(plan.meta.env);
+  h.Pod(static_cast<uint64_t>(plan.nodes.size()));
+  for (const auto& node : plan.nodes) {
+    h.String(node.id);
+    h.String(node.op);
+    h.Pod(static_cast<uint64_t>(node.inputs.size()));
+    for (const auto& input : node.inputs) {
+      h.String(input);
+    }
+    h.String(node.params.dump());  // Object keys are sorted: canonical
+    h.String(node.trace_key);
+    if (node.op == "njs") {
+      h.String(NjsModuleIdentity(node.params));
+    }
+  }
+  h.Pod(plan.logging.sample_rate);
+  h.Ints(plan.logging.dump_keys);
+  h.Pod(static_cast<uint64_t>(plan.logging.dump_nodes.size()));
+  for (const auto& node : plan.logging.dump_nodes) {
+    h.String(node);
+  }
+  h.Ints(plan.output_keys);
+  h.Pod(static_cast<uint64_t>(plan.outputs.size()));
+  for (const auto& output : plan.outputs) {
+    h.String(output);
+  }
+  h.Pod(static_cast<uint64_t>(plan.bindings.size()));
+  for (const auto& binding : plan.bindings) {
+    h.String(binding.name);
+    h.Pod(binding.type);
+    h.String(binding.default_value.dump());
+  }
+  return h.Digest();
+}
+
+uint64_t ComplexityBudgetHash(const ComplexityBudget& budget) {
+  ContentHasher h;
+  h.Pod(budget.node_count_hard);
+  h.Pod(budget.max_depth_hard);
+  h.Pod(budget.fanout_peak_hard);
+  h.Pod(budget.fanin_peak_hard);
+  h.Pod(budget.estimated_ms_hard);
+  h.Pod(budget.estimated_bytes_hard);
+  h.Pod(budget.peak_memory_bytes_hard);
+  h.Pod(budget.edge_count_soft);
+  h.Pod(budget.complexity_score_soft);
+  h.Pod(budget.score_weights.node_count);
+  h.Pod(budget.score_weights.max_depth);
+  h.Pod(budget.score_weights.fanout_peak);
+  h.Pod(budget.score_weights.fanin_peak);
+  h.Pod(budget.score_weights.edge_count);
+  return h.Digest();
+}
+
+uint64_t CostModelHash(const CostModel& model) {
+  ContentHasher h;
+  h.String(model.Dump());  // Ops are emitted in key order: canonical
+  return h.Digest();
+}
+
+size_t PlanCache::CacheKeyHash::operator()(const CacheKey& key) const {
+  return static_cast<size_t>(key.plan_hash ^ (key.registry_fingerprint * 31) ^
+                             (key.budget_hash * 131) ^ (key.cost_model_hash * 8191));
+}
+
+PlanCache::PlanCache(const KeyRegistry& registry, std::optional<ComplexityBudget> budget,
+                     std::optional<CostModel> cost_model, size_t capacity)
+    : registry_(registry),
+      budget_(std::move(budget)),
+      cost_model_(std::move(cost_model)),
+      capacity_(capacity),
+      registry_fingerprint_(KeyRegistryFingerprint(registry)),
+      budget_hash_(ComplexityBudgetHash(budget_.value_or(ComplexityBudget::Default()))),
+      cost_model_hash_(CostModelHash(cost_model_.value_or(CostModel::Default()))) {}
+
+std::shared_ptr<const CompiledPlan> PlanCache::GetOrCompile(const Plan& plan,
+                                                            std::string* error_out) {
+  CacheKey key{PlanContentHash(plan), registry_fingerprint_, budget_hash_, cost_model_hash_};
+
+  std::promise<CompileResult> promise;
+  std::shared_future<CompileResult> result;
+  bool compile_here = false;
+  {
+    std::lock_guard<std::mutex> lock(entries_mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      ++stats_.hits;
+      result = it->second;
+    } else {
+      ++stats_.misses;
+      result = promise.get_future().share();
+      entries_.emplace(key, result);
+      insertion_order_.push_back(key);
+      compile_here = true;
+    }
+  }
+
+  if (compile_here) {
+    // Compile outside the lock; concurrent callers for this key wait on the future
+    CompileResult compiled;
+    PlanCompiler compiler(registry_);
+    if (budget_) {
+      compiler.SetComplexityBudget(*budget_);
+    }
+    if (cost_model_) {
+      compiler.SetCostModel(*cost_model_);
+    }
+    auto out = std::make_shared<CompiledPlan>();
+    if (compiler.Compile(plan, *out, &compiled.error)) {
+      compiled.plan = std::move(out);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(entries_mutex_);
+      if (!compiled.plan) {
+        // Failures are not cached: a fixed registry or retry may succeed
+        ++stats_.failures;
+        entries_.erase(key);
+        auto pos = std::find(insertion_order_.begin(), insertion_order_.end(), key);
+        if (pos != insertion_order_.end()) {
+          insertion_order_.erase(pos);
+        }
+      }
+      while (entries_.size() > capacity_ && !insertion_order_.empty()) {
+        entries_.erase(insertion_order_.front());
+        insertion_order_.pop_front();
+      }
+    }
+    promise.set_value(std::move(compiled));
+  }
+
+  const CompileResult& compiled = result.get();
+  if (!compiled.plan && error_out) {
+    *error_out = compiled.error;
+  }
+  return compiled.plan;
+}
+
+bool PlanCache::Publish(const std::string& name, const Plan& plan, std::string* error_out) {
+  auto compiled = GetOrCompile(plan, error_out);
+  if (!compiled) {
+    return false;
+  }
+  Publish(name, std::move(compiled));
+  return true;
+}
+
+void PlanCache::Publish(const std::string& name, std::shared_ptr<const CompiledPlan> compiled) {
+  Slot* slot = nullptr;
+  {
+    std::unique_lock<std::shared_mutex> lock(slots_mutex_);
+    auto& entry = slots_[name];
+    if (!entry) {
+      entry = std::make_unique<Slot>();
+    }
+    slot = entry.get();
+  }
+  // Slots are never removed, so the pointer outlives the lock. Readers that
+  // already loaded the old version keep it alive until their request ends.
+  std::atomic_store(&slot->plan, std::move(compiled));
+}
+
+std::shared_ptr<const CompiledPlan> PlanCache::Current(const std::string& name) const {
+  const Slot* slot = nullptr;
+  {
+    std::shared_lock<std::shared_mutex> lock(slots_mutex_);
+    auto it = slots_.find(name);
+    if (it == slots_.end()) {
+      return nullptr;
+    }
+    slot = it->second.get();
+  }
+  return std::atomic_load(&slot->plan);
+}
+
+PlanCache::Stats PlanCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(entries_mutex_);
+  Stats stats = stats_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+}  // namespace ranking_dsl
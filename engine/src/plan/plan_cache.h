@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "plan/compiler.h"
+
+namespace ranking_dsl {
+
+class KeyRegistry;
+
+/**
+ * Content hash of a plan: every field that affects compilation or execution
+ * (params hashed as canonical JSON, so key order does not matter).
+ *
+ * njs nodes referenced by path also hash the module they resolve to (the
+ * precompiled digest, or the source on disk), so editing a module changes
+ * the hash. Source hashes are memoized per path and recomputed only when the
+ * file's mtime or size changes, so a lookup costs a stat, not a read.
+ */
+uint64_t PlanContentHash(const Plan& plan);
+
+/**
+ * Hash of every budget limit and score weight.
+ */
+uint64_t ComplexityBudgetHash(const ComplexityBudget& budget);
+
+/**
+ * Hash of every op's cost coefficients (the model's canonical JSON).
+ */
+uint64_t CostModelHash(const CostModel& model);
+
+/**
+ * Thread-safe cache of compiled plans shared across requests and workers.
+ *
+ * Entries are keyed by (plan content hash, key registry fingerprint, budget
+ * hash, cost model hash) and hold immutable `shared_ptr<const CompiledPlan>`s. Concurrent
+ * lookups of the same uncompiled plan compile it once; the other callers wait
+ * for that result.
+ *
+ * Named slots support hot swap: Publish() installs a new plan version
+ * atomically, Current() returns a snapshot that stays valid for the caller
+ * (an in-flight request) after later publishes, RCU-style.
+ *
+ *   auto plan = cache.Current("homefeed");   // one atomic load per request
+ *   executor.Execute(*plan, ctx, &error);
+ */
+class PlanCache {
+ public:
+  /**
+   * @param registry Key registry used for every compile (must outlive the cache)
+   * @param budget Complexity budget (nullopt = the compiler default)
+   * @param cost_model Cost model behind estimated_ms (nullopt = CostModel::Default())
+   * @param capacity Max cached entries; the oldest are evicted first. Plans
+   *        held by slots or callers stay alive regardless.
+   */
+  explicit PlanCache(const KeyRegistry& registry,
+                     std::optional<ComplexityBudget> budget = std::nullopt,
+                     std::optional<CostModel> cost_model = std::nullopt,
+                     size_t capacity = 64);
+
+  /**
+   * Compiled plan for `plan`, compiling on a miss. nullptr on compile error.
+   */
+  std::shared_ptr<const CompiledPlan> GetOrCompile(const Plan& plan,
+                                                   std::string* error_out = nullptr);
+
+  /**
+   * Compile (or reuse) `plan` and make it the current version of `name`.
+   * On error the previous version stays current.
+   */
+  bool Publish(const std::string& name, const Plan& plan, std::string* error_out = nullptr);
+
+  /**
+   * Make an already compiled plan (e.g. a loaded artifact) current for `name`.
+   */
+  void Publish(const std::string& name, std::shared_ptr<const CompiledPlan> compiled);
+
+  /**
+   * Snapshot of the current version of `name` (nullptr if never published).
+   */
+  std::shared_ptr<const CompiledPlan> Current(const std::string& name) const;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;    // Lookups that compiled
+    uint64_t failures = 0;  // Compiles that failed (not cached)
+    size_t entries = 0;
+  };
+  Stats GetStats() const;
+
+ private:
+  struct CacheKey {
+    uint64_t plan_hash;
+    uint64_t registry_fingerprint;
+    uint64_t budget_hash;
+    uint64_t cost_model_hash;
+    bool operator==(const CacheKey&) const = default;
+  };
+  struct CacheKeyHash {
+    size_t operator()(const CacheKey& key) const;
+  };
+  struct CompileResult {
+    std::shared_ptr<const CompiledPlan> plan;
+    std::string error;
+  };
+  struct Slot {
+    std::shared_ptr<const CompiledPlan> plan;  // Accessed only via std::atomic_load/store
+  };
+
+  const KeyRegistry& registry_;
+  std::optional<ComplexityBudget> budget_;
+  std::optional<CostModel> cost_model_;
+  size_t capacity_;
+  uint64_t registry_fingerprint_;
+  uint64_t budget_hash_;
+  uint64_t cost_model_hash_;
+
+  mutable std::mutex entries_mutex_;
+  std::unordered_map<CacheKey, std::shared_future<CompileResult>, CacheKeyHash> entries_;
+  std::deque<CacheKey> insertion_order_;
+  Stats stats_;
+
+  mutable std::shared_mutex slots_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<Slot>> slots_;
+};
+
+}  // namespace ranking_dsl
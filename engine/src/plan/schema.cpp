@@ -0,0 +1,86 @@
+#include "plan/schema.h"
+
+#include <algorithm>
+
+namespace ranking_dsl {
+
+namespace {
+
+void Prune(const ColumnLiveness& liveness, BatchSchema& schema) {
+  if (!liveness.prune || !schema.known) {
+    return;
+  }
+  std::erase_if(schema.columns, [&](const auto& column) {
+    return !std::binary_search(liveness.live_keys.begin(), liveness.live_keys.end(),
+                               column.first);
+  });
+}
+
+}  // namespace
+
+ColumnType ColumnTypeOf(keys::KeyType type) {
+  switch (type) {
+    case keys::KeyType::Bool:
+      return ColumnType::Bool;
+    case keys::KeyType::I64:
+      return ColumnType::I64;
+    case keys::KeyType::F32:
+      return ColumnType::F32;
+    case keys::KeyType::String:
+      return ColumnType::String;
+    case keys::KeyType::Bytes:
+      return ColumnType::Bytes;
+    case keys::KeyType::F32Vec:
+      return ColumnType::F32Vec;
+  }
+  return ColumnType::Null;
+}
+
+std::vector<BatchSchema> InferInputSchemas(const Plan& plan, const PlanGraph& graph,
+                                           const std::vector<int32_t>& exec_order,
+                                           const std::vector<ColumnLiveness>& liveness,
+                                           const std::vector<int32_t>& fused_chain_of,
+                                           const std::vector<FusedChain>& fused_chains,
+                                           const KeyRegistry& registry,
+                                           const BatchSchema* candidate_schema) {
+  std::vector<BatchSchema> inputs(graph.node_count);
+  std::vector<BatchSchema> outputs(graph.node_count);
+
+  for (int32_t node : exec_order) {
+    auto node_inputs = graph.Inputs(node);
+    BatchSchema schema;
+    if (node_inputs.empty()) {
+      schema.known = true;  // Sources start from an empty batch
+    } else {
+      schema = outputs[node_inputs.front()];
+    }
+    inputs[node] = schema;
+
+    if (candidate_schema && plan.nodes[node].op == "core:sourcer") {
+      schema = *candidate_schema;  // Passes the request's candidates through
+    } else if (schema.known) {
+      NodeKeyAccess access = ResolveNodeKeyAccess(plan.nodes[node], registry);
+      if (access.reads_all) {
+        schema = BatchSchema{};  // Writes unknown too
+      }
+      for (int32_t key : access.writes) {
+        const KeyRegistry::KeyInfo* info = registry.GetById(key);
+        if (!info) {
+          schema = BatchSchema{};
+          break;
+        }
+        schema.Set(key, ColumnTypeOf(info->type));
+      }
+    }
+
+    // Within a fused chain, only the tail's output is pruned
+    int32_t chain = fused_chain_of.empty() ? -1 : fused_chain_of[node];
+    if (chain < 0 || fused_chains[chain].nodes.back() == node) {
+      Prune(liveness[node], schema);
+    }
+    outputs[node] = std::move(schema);
+  }
+  return inputs;
+}
+
+}  // namespace ranking_dsl
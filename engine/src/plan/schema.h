@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "keys.h"
+#include "keys/registry.h"
+#include "object/batch_schema.h"
+#include "plan/fusion.h"
+#include "plan/graph.h"
+#include "plan/liveness.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * Column type the engine stores values of a registry key type in.
+ */
+ColumnType ColumnTypeOf(keys::KeyType type);
+
+/**
+ * Infer the input batch schema of every node.
+ *
+ * Mirrors the executor: a node receives its first input's output (sources
+ * receive an empty batch), adds the keys it writes with their registry
+ * types, and its output is pruned to its live keys (fused chains prune at
+ * the tail only). Nodes whose writes are unknown (unknown ops, njs modules
+ * without loadable meta) make everything downstream unknown.
+ *
+ * With candidate_schema, sourcers emit request-supplied candidates of that
+ * schema instead of generating their own.
+ *
+ * Returns one entry per plan node, indexed like plan.nodes; nodes missing
+ * from exec_order get an unknown schema.
+ */
+std::vector<BatchSchema> InferInputSchemas(const Plan& plan, const PlanGraph& graph,
+                                           const std::vector<int32_t>& exec_order,
+                                           const std::vector<ColumnLiveness>& liveness,
+                                           const std::vector<int32_t>& fused_chain_of,
+                                           const std::vector<FusedChain>& fused_chains,
+                                           const KeyRegistry& registry,
+                                           const BatchSchema* candidate_schema = nullptr);
+
+}  // namespace ranking_dsl
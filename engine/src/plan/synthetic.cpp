@@ -0,0 +1,231 @@
+#include "plan/synthetic.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "keys.h"
+
+namespace ranking_dsl {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Merge levels and nodes needed to reduce width nodes to one
+struct Reduction {
+  size_t levels = 0;
+  size_t nodes = 0;
+};
+
+Reduction ReductionOf(size_t width, size_t fan_in) {
+  Reduction reduction;
+  while (width > 1) {
+    width = (width + fan_in - 1) / fan_in;
+    reduction.nodes += width;
+    reduction.levels += 1;
+  }
+  return reduction;
+}
+
+struct GenNode {
+  std::string id;
+  std::vector<size_t> inputs;  // Indices into the node list
+};
+
+class Generator {
+ public:
+  explicit Generator(const SyntheticPlanOptions& options)
+      : options_(options), rng_(options.seed) {}
+
+  json Build(const std::vector<size_t>& widths) {
+    std::vector<size_t> previous;
+    for (size_t layer = 0; layer < widths.size(); ++layer) {
+      std::vector<size_t> current;
+      for (size_t j = 0; j < widths[layer]; ++j) {
+        current.push_back(Add(fmt::format("n{}_{}", layer, j)));
+      }
+      if (layer == 0) {
+        for (size_t node : current) {
+          ops_[node] = "core:sourcer";
+        }
+      } else {
+        Connect(previous, current, layer % 2 == 1);
+      }
+      previous = std::move(current);
+    }
+
+    // Fan-in-way merge tree down to one node
+    for (size_t level = 0; previous.size() > 1; ++level) {
+      std::vector<size_t> current;
+      for (size_t start = 0; start < previous.size(); start += options_.fan_in) {
+        size_t node = Add(fmt::format("r{}_{}", level, current.size()));
+        size_t end = std::min(previous.size(), start + options_.fan_in);
+        nodes_[node].inputs.assign(previous.begin() + start, previous.begin() + end);
+        ops_[node] = "core:merge";
+        current.push_back(node);
+      }
+      previous = std::move(current);
+    }
+
+    size_t sink = Add("top");
+    nodes_[sink].inputs = previous;
+    ops_[sink] = "core:topk";
+
+    json plan = {{"name", "synthetic"}, {"version", 1}, {"outputs", {"top"}}};
+    json nodes = json::array();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      json node = {{"id", nodes_[i].id}, {"op", ops_[i]}, {"params", ParamsOf(i)}};
+      if (!nodes_[i].inputs.empty()) {
+        json inputs = json::array();
+        for (size_t input : nodes_[i].inputs) {
+          inputs.push_back(nodes_[input].id);
+        }
+        node["inputs"] = std::move(inputs);
+      }
+      nodes.push_back(std::move(node));
+    }
+    plan["nodes"] = std::move(nodes);
+    return plan;
+  }
+
+ private:
+  size_t Add(std::string id) {
+    nodes_.push_back({std::move(id), {}});
+    ops_.emplace_back();
+    consumers_.push_back(0);
+    return nodes_.size() - 1;
+  }
+
+  void Use(size_t node, size_t input) {
+    nodes_[node].inputs.push_back(input);
+    consumers_[input] += 1;
+  }
+
+  void Connect(const std::vector<size_t>& previous, const std::vector<size_t>& current,
+               bool mixing) {
+    // Every previous node feeds at least one current node
+    for (size_t j = 0; j < current.size(); ++j) {
+      Use(current[j], previous[j % previous.size()]);
+    }
+    for (size_t i = current.size(); i < previous.size(); ++i) {
+      Use(current[i % current.size()], previous[i]);
+    }
+
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    for (size_t node : current) {
+      auto& inputs = nodes_[node].inputs;
+      if (mixing && inputs.size() == 1 && coin(rng_) < options_.merge_fraction) {
+        std::uniform_int_distribution<size_t> pick(0, previous.size() - 1);
+        for (size_t tries = 0; inputs.size() < options_.fan_in && tries < 2 * options_.fan_in;
+             ++tries) {
+          size_t input = previous[pick(rng_)];
+          if (consumers_[input] < options_.fan_out &&
+              std::find(inputs.begin(), inputs.end(), input) == inputs.end()) {
+            Use(node, input);
+          }
+        }
+      }
+      if (inputs.size() > 1) {
+        ops_[node] = "core:merge";
+      } else if (!mixing) {
+        ops_[node] = "core:topk";
+      } else {
+        static const char* kUnaryOps[] = {"core:score_formula", "core:model", "core:features"};
+        ops_[node] = kUnaryOps[node % 3];
+      }
+    }
+  }
+
+  json ParamsOf(size_t node) {
+    const std::string& op = ops_[node];
+    json params;
+    if (op == "core:sourcer") {
+      params["k"] = 100;
+    } else if (op == "core:topk") {
+      params["k"] = 100;
+      params["key"] = keys::id::SCORE_BASE;
+    } else if (op == "core:merge") {
+      params["dedup"] = "first";
+    } else if (op == "core:score_formula") {
+      json signal = {{"op", "signal"}, {"key_id", keys::id::SCORE_BASE}};
+      json offset = {{"op", "const"}, {"value", 0.001 * static_cast<double>(node)}};
+      params["expr"] = {{"op", "add"}, {"args", {signal, offset}}};
+      params["output_key_id"] = keys::id::SCORE_ADJUSTED;
+    } else if (op == "core:features") {
+      params["keys"] = {keys::id::FEAT_FRESHNESS};
+    }
+
+    // Unique name (no sub-plan is a duplicate), padded to param_bytes
+    std::string name = nodes_[node].id;
+    size_t size = params.dump().size() + name.size() + 10;  // ,"name":""
+    if (size < options_.param_bytes) {
+      name.append(options_.param_bytes - size, 'x');
+    }
+    params["name"] = std::move(name);
+    return params;
+  }
+
+  const SyntheticPlanOptions& options_;
+  std::mt19937_64 rng_;
+  std::vector<GenNode> nodes_;
+  std::vector<std::string> ops_;
+  std::vector<size_t> consumers_;
+};
+
+}  // namespace
+
+bool GenerateSyntheticPlan(const SyntheticPlanOptions& options, json& out,
+                           std::string* error_out) {
+  auto fail = [&](const std::string& message) {
+    if (error_out) {
+      *error_out = message;
+    }
+    return false;
+  };
+  if (options.fan_in < 2) {
+    return fail("fan_in must be at least 2");
+  }
+  if (options.fan_out < 1) {
+    return fail("fan_out must be at least 1");
+  }
+  if (options.depth < 2 || options.nodes < options.depth) {
+    return fail(fmt::format("Need depth >= 2 and nodes >= depth (nodes {}, depth {})",
+                            options.nodes, options.depth));
+  }
+
+  // Widest body (sourcer layer + alternating layers) that fits, with the
+  // reduction tree and the sink taking the remaining depth
+  size_t width = 0;
+  size_t body_layers = 0;
+  for (size_t w = 1; w <= options.nodes; ++w) {
+    Reduction reduction = ReductionOf(w, options.fan_in);
+    if (reduction.levels + 2 > options.depth) {
+      break;
+    }
+    size_t layers = options.depth - 1 - reduction.levels;
+    if (w * layers + reduction.nodes + 1 > options.nodes) {
+      continue;
+    }
+    width = w;
+    body_layers = layers;
+  }
+
+  // Spread the remainder over the body layers before the last one, whose
+  // width the reduction tree was sized for
+  std::vector<size_t> widths(body_layers, width);
+  size_t used = width * body_layers + ReductionOf(width, options.fan_in).nodes + 1;
+  if (body_layers > 1) {
+    for (size_t i = 0; i < options.nodes - used; ++i) {
+      widths[i % (body_layers - 1)] += 1;
+    }
+  }
+
+  Generator generator(options);
+  out = generator.Build(widths);
+  return true;
+}
+
+}  // namespace ranking_dsl
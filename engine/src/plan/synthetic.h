@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace ranking_dsl {
+
+/**
+ * Shape of a generated plan.
+ */
+struct SyntheticPlanOptions {
+  size_t nodes = 100;           // Total node count (see GenerateSyntheticPlan)
+  size_t depth = 10;            // Longest path, in nodes
+  size_t fan_in = 4;            // Max inputs per core:merge (>= 2)
+  size_t fan_out = 4;           // Max consumers a node is picked for as an extra merge input
+  double merge_fraction = 0.3;  // Share of mixing-layer nodes that are core:merge
+  size_t param_bytes = 64;      // Approximate serialized params size per node
+  uint64_t seed = 1;
+};
+
+/**
+ * Generate a layered plan JSON (the format ParsePlan reads) for compile-time
+ * scalability measurements.
+ *
+ * Layer 0 is core:sourcer nodes. Body layers alternate between mixing layers
+ * (core:merge of up to fan_in nodes of the previous layer, or a unary
+ * core:score_formula / core:model / core:features) and core:topk layers, which
+ * keep estimated row counts bounded however deep the plan is. The last body
+ * layer is reduced by a tree of fan_in-way merges into a single core:topk
+ * sink, so every node reaches the output and nothing is pruned. Every node's
+ * params are distinct, so sub-plan elimination merges nothing.
+ *
+ * The node count is exact whenever depth leaves room for the reduction tree;
+ * shallow plans are capped at the widest body the tree can reduce.
+ * Generation is deterministic for a given seed.
+ */
+bool GenerateSyntheticPlan(const SyntheticPlanOptions& options, nlohmann::json& out,
+                           std::string* error_out = nullptr);
+
+}  // namespace ranking_dsl
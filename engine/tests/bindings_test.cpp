@@ -0,0 +1,191 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "plan/artifact.h"
+#include "plan/bindings.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// src(k bound) -> feat -> model -> final(w * score.ml + base); fused tail
+const char* kBoundPlan = R"({
+  "name": "bound",
+  "bindings": {
+    "k": {"type": "int", "default": 8},
+    "w_ml": {"type": "float", "default": 0}
+  },
+  "nodes": [
+    {"id": "src", "op": "core:sourcer", "params": {"name": "main", "k": {"$bind": "k"}}},
+    {"id": "feat", "op": "core:features", "inputs": ["src"]},
+    {"id": "model", "op": "core:model", "inputs": ["feat"]},
+    {"id": "final", "op": "core:score_formula", "inputs": ["model"],
+     "params": {"expr": {"op": "add", "args": [
+       {"op": "signal", "key_id": 3001},
+       {"op": "mul", "args": [{"op": "const", "value": {"$bind": "w_ml"}},
+                              {"op": "signal", "key_id": 3002}]}]}}}
+  ]
+})";
+
+}  // namespace
+
+TEST_CASE("Binding parsing and validation", "[plan][bindings]") {
+  Plan plan = ParseOrFail(kBoundPlan);
+  REQUIRE(plan.bindings.size() == 2);
+  REQUIRE(plan.bindings[0].name == "k");
+  REQUIRE(plan.bindings[0].type == BindingType::kInt);
+  REQUIRE(plan.bindings[1].default_value.is_number_float());  // 0 widened to 0.0
+
+  std::vector<std::string> refs;
+  CollectBindingRefs(plan.nodes[3].params, refs);
+  REQUIRE(refs == std::vector<std::string>{"w_ml"});
+
+  Plan invalid;
+  std::string error;
+  REQUIRE_FALSE(ParsePlan(json::parse(R"({"nodes": [], "bindings": {"x": {"type": "int", "default": "a"}}})"),
+                          invalid, &error));
+  REQUIRE(error == "Binding 'x': default is not a int");
+  REQUIRE_FALSE(ParsePlan(json::parse(R"({"nodes": [], "bindings": {"x": {"type": "vec"}}})"),
+                          invalid, &error));
+  REQUIRE(error == "Binding 'x': unknown type \"vec\"");
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+  CompiledPlan compiled;
+
+  SECTION("Undeclared references fail compilation") {
+    plan.bindings.pop_back();
+    REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(error == "Node 'final' references undeclared binding: w_ml");
+  }
+
+  SECTION("Key ID params cannot be bound") {
+    plan.nodes[3].params["output_key_id"] = {{"$bind", "k"}};
+    REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(error == "Node 'final': param 'output_key_id' is a key ID and cannot be bound");
+  }
+
+  SECTION("Bound nodes are recorded") {
+    REQUIRE(compiler.Compile(plan, compiled, &error));
+    std::vector<std::string> bound;
+    for (int32_t node : compiled.bound_nodes) {
+      bound.push_back(compiled.plan.nodes[node].id);
+    }
+    REQUIRE(bound == std::vector<std::string>{"src", "final"});
+  }
+}
+
+TEST_CASE("Binding resolution at execute time", "[executor][bindings]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+  CompiledPlan compiled;
+  std::string error;
+  REQUIRE(compiler.Compile(ParseOrFail(kBoundPlan), compiled, &error));
+  REQUIRE(compiled.fused_chains.size() == 1);
+  Executor executor(registry);
+
+  auto score_at = [](const CandidateBatch& batch, size_t row) {
+    return batch.GetF32Column(keys::id::SCORE_FINAL)->Get(row);
+  };
+
+  SECTION("Defaults apply without bindings") {
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(error.empty());
+    REQUIRE(result.RowCount() == 8);
+    REQUIRE(score_at(result, 0) == result.GetF32Column(keys::id::SCORE_BASE)->Get(0));
+  }
+
+  SECTION("One compiled plan serves different bindings") {
+    ParamBindings small;
+    small.Set("k", int64_t{3});
+    ParamBindings large;
+    large.Set("k", int64_t{20});
+    large.Set("w_ml", int64_t{2});  // int widens to float
+
+    ExecContext ctx;
+    ctx.bindings = &small;
+    CandidateBatch a = executor.Execute(compiled, ctx, &error);
+    ctx.bindings = &large;
+    CandidateBatch b = executor.Execute(compiled, ctx, &error);
+    REQUIRE(error.empty());
+    REQUIRE(a.RowCount() == 3);
+    REQUIRE(b.RowCount() == 20);
+
+    float base = b.GetF32Column(keys::id::SCORE_BASE)->Get(1);
+    float ml = b.GetF32Column(keys::id::SCORE_ML)->Get(1);
+    REQUIRE(score_at(b, 1) == base + 2.0f * ml);
+
+    // Plan params are untouched
+    REQUIRE(compiled.plan.nodes[0].params["k"] == json{{"$bind", "k"}});
+  }
+
+  SECTION("Bound formulas compile once, with the plan") {
+    int32_t final_node = compiled.graph.IndexOf("final");
+    REQUIRE(compiled.compiled_exprs[final_node] != nullptr);
+    REQUIRE(compiled.compiled_exprs[final_node]->Bindings() == std::vector<std::string>{"w_ml"});
+
+    PlanCompiler unfused_compiler(registry);
+    unfused_compiler.DisableFusion();
+    CompiledPlan unfused;
+    REQUIRE(unfused_compiler.Compile(ParseOrFail(kBoundPlan), unfused, &error));
+    REQUIRE(unfused.fused_chains.empty());
+
+    ParamBindings half;
+    half.Set("w_ml", 0.5);
+    ParamBindings triple;
+    triple.Set("w_ml", 3.0);
+    ExecContext ctx;
+
+    // Neither the fused nor the unfused runner compiles the formula again
+    uint64_t compiles = CompiledExpr::CompileCount();
+    for (const CompiledPlan* plan : {&compiled, &unfused}) {
+      for (const ParamBindings* bindings : {&half, &triple}) {
+        ctx.bindings = bindings;
+        CandidateBatch result = executor.Execute(*plan, ctx, &error);
+        REQUIRE(error.empty());
+        float w = bindings == &half ? 0.5f : 3.0f;
+        float base = result.GetF32Column(keys::id::SCORE_BASE)->Get(2);
+        float ml = result.GetF32Column(keys::id::SCORE_ML)->Get(2);
+        REQUIRE(score_at(result, 2) == base + w * ml);
+      }
+    }
+    REQUIRE(CompiledExpr::CompileCount() == compiles);
+  }
+
+  SECTION("Type mismatches fail the request") {
+    ParamBindings bad;
+    bad.Set("k", std::string("ten"));
+    ExecContext ctx;
+    ctx.bindings = &bad;
+    executor.Execute(compiled, ctx, &error);
+    REQUIRE(error == "Binding 'k' expects int, got string");
+  }
+
+  SECTION("Bindings survive the artifact round trip") {
+    auto bytes = SerializePlanArtifact(compiled, registry);
+    CompiledPlan loaded;
+    REQUIRE(DeserializePlanArtifact(bytes.data(), bytes.size(), registry, loaded, &error));
+    REQUIRE(loaded.bound_nodes == compiled.bound_nodes);
+    REQUIRE(loaded.plan.bindings.size() == 2);
+    REQUIRE(loaded.plan.bindings[0].default_value == 8);
+    int32_t final_node = loaded.graph.IndexOf("final");
+    REQUIRE(loaded.compiled_exprs[final_node]->Bindings() == std::vector<std::string>{"w_ml"});
+
+    ParamBindings bindings;
+    bindings.Set("k", int64_t{5});
+    ExecContext ctx;
+    ctx.bindings = &bindings;
+    REQUIRE(executor.Execute(loaded, ctx, &error).RowCount() == 5);
+  }
+}
@@ -1,5 +1,9 @@
+#include <sstream>
+
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
+#include <fmt/format.h>
 
 #include "plan/plan.h"
 #include "plan/compiler.h"
@@ -415,6 +419,167 @@ TEST_CASE("PlanCompiler complexity enforcement", "[complexity][compiler]") {
   }
 }
 
+TEST_CASE("Cost model estimates", "[complexity][cost]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  // sourcer(k=1000) -> features(2 keys) -> model(quadratic) -> topk(k=10)
+  Plan plan;
+  plan.name = "cost_plan";
+  plan.version = 1;
+  {
+    PlanNode node;
+    node.id = "src";
+    node.op = "core:sourcer";
+    node.params = {{"k", 1000}};
+    plan.nodes.push_back(node);
+  }
+  {
+    PlanNode node;
+    node.id = "feat";
+    node.op = "core:features";
+    node.inputs = {"src"};
+    node.params = {{"keys", {2001, 2002}}};
+    plan.nodes.push_back(node);
+  }
+  {
+    PlanNode node;
+    node.id = "slow";
+    node.op = "core:model";
+    node.inputs = {"feat"};
+    plan.nodes.push_back(node);
+  }
+  {
+    PlanNode node;
+    node.id = "top";
+    node.op = "core:topk";
+    node.inputs = {"slow"};
+    node.params = {{"k", 10}};
+    plan.nodes.push_back(node);
+  }
+
+  CostModel model;
+  model.ops["core:sourcer"] = {0.0, 0.0, 0.0, 0};
+  model.ops["core:features"] = {0.0, 0.001, 0.0, 0};
+  model.ops["core:model"] = {1.0, 0.0, 0.00001, 0};
+  model.ops["njs:njs/slow.njs"] = {2.0, 0.0, 0.0, 0};
+  model.fallback = {0.5, 0.0, 0.0, 0};
+
+  SECTION("njs modules are costed per module") {
+    PlanNode njs;
+    njs.op = "njs";
+    njs.params = {{"module", "njs/slow.njs"}};
+    REQUIRE(model.CostOf(njs).fixed_ms == 2.0);
+    njs.params["module"] = "njs/other.njs";
+    REQUIRE(model.CostOf(njs).fixed_ms == 0.5);  // Fallback
+  }
+
+  SECTION("Rows flow through the plan") {
+    ComplexityMetrics metrics;
+    PlanGraph graph = BuildPlanGraph(plan);
+    EstimatePlanCost(plan, graph, {0, 1, 2, 3}, model, metrics);
+
+    // feat: 1000 * 0.001; slow: 1 + 1e-5 * 1000^2; top: fallback 0.5
+    REQUIRE(metrics.estimated_ms == Catch::Approx(1.0 + 11.0 + 0.5));
+    REQUIRE(metrics.top_cost.front().id == "slow");
+    REQUIRE(metrics.top_cost[2].id == "top");
+    REQUIRE(metrics.top_cost[2].rows == 10);
+  }
+
+  SECTION("Bound k uses the binding default") {
+    Plan bound = plan;
+    bound.nodes[0].params["k"] = {{"$bind", "fanout"}};
+    bound.bindings.push_back({"fanout", BindingType::kInt, 10});
+
+    ComplexityMetrics metrics;
+    EstimatePlanCost(bound, BuildPlanGraph(bound), {0, 1, 2, 3}, model, metrics);
+    // feat: 10 * 0.001; slow: 1 + 1e-5 * 10^2; top: fallback 0.5
+    REQUIRE(metrics.estimated_ms == Catch::Approx(0.01 + 1.001 + 0.5));
+  }
+
+  SECTION("Compile rejects plans over the estimated budget") {
+    ComplexityBudget budget;
+    budget.estimated_ms_hard = 10.0;
+
+    PlanCompiler compiler(registry);
+    compiler.SetComplexityBudget(budget);
+    compiler.SetCostModel(model);
+
+    CompiledPlan out;
+    std::string error;
+    REQUIRE_FALSE(compiler.Compile(plan, out, &error));
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("estimated_ms=12.500"));
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("Top cost nodes:"));
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("slow core:model est_ms=11.000"));
+
+    budget.estimated_ms_hard = 20.0;
+    compiler.SetComplexityBudget(budget);
+    REQUIRE(compiler.Compile(plan, out, &error));
+    REQUIRE(out.complexity.estimated_ms == Catch::Approx(12.5));
+  }
+
+  SECTION("Budget parses estimated limits") {
+    auto parsed = ComplexityBudget::Parse(
+        R"({"hard": {"estimated_ms": 25.5, "estimated_bytes": 1048576}})");
+    REQUIRE(parsed.estimated_ms_hard == Catch::Approx(25.5));
+    REQUIRE(parsed.estimated_bytes_hard == 1048576);
+    REQUIRE(ComplexityBudget::Default().estimated_ms_hard == 0.0);
+  }
+
+  SECTION("Model round-trips through JSON") {
+    std::string error;
+    CostModel parsed = CostModel::Parse(model.Dump(), &error);
+    REQUIRE(error.empty());
+    REQUIRE(parsed.ops.size() == model.ops.size());
+    REQUIRE(parsed.ops["core:features"].per_row_ms == 0.001);
+    REQUIRE(parsed.fallback.fixed_ms == 0.5);
+  }
+}
+
+TEST_CASE("Cost model calibration from traces", "[complexity][cost]") {
+  // model: 0.5 + 0.01 * rows; njs module: 0.001 * rows^2; one fused span
+  std::ostringstream trace;
+  trace << "Top 3 results:\n";
+  for (int rows : {100, 200, 400, 800}) {
+    trace << fmt::format(
+        R"({{"event":"node_end","op":"core:model","duration_ms":{},"rows_in":{},"rows_out":{}}})",
+        0.5 + 0.01 * rows, rows, rows) << "\n";
+    trace << fmt::format(
+        R"({{"event":"node_end","op":"njs","njs_file":"njs/q.njs","duration_ms":{},"rows_in":{},"rows_out":{}}})",
+        0.001 * rows * rows, rows, rows) << "\n";
+  }
+  trace << R"({"event":"node_end","op":"fused","duration_ms":100.0,"rows_in":5,"rows_out":5})"
+        << "\n";
+
+  std::istringstream in(trace.str());
+  std::string error;
+  CostModel model = CalibrateCostModel(in, CostModel::Default(), &error);
+  REQUIRE(error.empty());
+
+  const OpCost& linear = model.ops.at("core:model");
+  REQUIRE(linear.samples == 4);
+  REQUIRE(linear.fixed_ms == Catch::Approx(0.5).margin(1e-6));
+  REQUIRE(linear.per_row_ms == Catch::Approx(0.01).margin(1e-6));
+  REQUIRE(linear.per_row_sq_ms == Catch::Approx(0.0).margin(1e-9));
+
+  const OpCost& quadratic = model.ops.at("njs:njs/q.njs");
+  REQUIRE(quadratic.per_row_sq_ms == Catch::Approx(0.001).margin(1e-6));
+  REQUIRE(model.ops.count("fused") == 0);
+
+  std::istringstream bad("{not json\n");
+  CalibrateCostModel(bad, CostModel::Default(), &error);
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("Trace line 1"));
+
+  // Wrongly typed fields are reported, not thrown
+  std::istringstream wrong_type(
+      "{\"event\":\"node_end\",\"op\":\"core:model\",\"duration_ms\":1.0}\n"
+      "{\"event\":\"node_end\",\"op\":\"njs\",\"njs_file\":7,\"duration_ms\":1.0}\n");
+  error.clear();
+  CostModel unchanged = CalibrateCostModel(wrong_type, CostModel::Default(), &error);
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("Trace line 2: njs_file"));
+  REQUIRE(unchanged.ops.count("njs:7") == 0);
+}
+
 TEST_CASE("Cross-check fixture plan metrics", "[complexity][cross-check]") {
   // This test verifies the C++ metrics match the TypeScript metrics
   // for the same fixture plan: test-fixtures/complexity-fixture.plan.json
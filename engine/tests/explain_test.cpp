@@ -0,0 +1,95 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "executor/explain.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+using Catch::Matchers::ContainsSubstring;
+
+TEST_CASE("Critical path follows the slowest dependency chain", "[explain]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(R"({
+    "name": "diamond",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 10}},
+      {"id": "fast", "op": "core:features", "inputs": ["src"]},
+      {"id": "slow", "op": "core:model", "inputs": ["src"]},
+      {"id": "join", "op": "core:merge", "inputs": ["fast", "slow"]}
+    ]
+  })"), kNoFusion | kNoLimitPushdown);
+
+  // Synthetic timings in execution order
+  ExecStats stats;
+  double wall_ms = 0.0;
+  for (int32_t node : compiled.exec_order) {
+    ExecStats::Node entry;
+    entry.node_id = compiled.plan.nodes[node].id;
+    entry.op = compiled.plan.nodes[node].op;
+    entry.plan_nodes = {node};
+    entry.wall_ms = entry.node_id == "slow" ? 5.0 : entry.node_id == "fast" ? 3.0 : 1.0;
+    wall_ms += entry.wall_ms;
+    stats.Add(entry);
+  }
+  stats.wall_ms = wall_ms;
+
+  std::vector<std::string> path;
+  for (size_t entry : CriticalPath(compiled, stats)) {
+    path.push_back(stats.nodes[entry].node_id);
+  }
+  REQUIRE(path == std::vector<std::string>{"src", "slow", "join"});
+
+  std::string report = FormatExplainAnalyze(compiled, stats);
+  REQUIRE_THAT(report, ContainsSubstring("* critical path (7.000 ms): src -> slow -> join"));
+  REQUIRE_THAT(report, ContainsSubstring("fast,slow"));  // join's inputs
+  REQUIRE(CriticalPath(compiled, ExecStats{}).empty());
+}
+
+TEST_CASE("EXPLAIN ANALYZE reports executed nodes", "[explain][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(R"({
+    "name": "explain_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 200}},
+      {"id": "feat", "op": "core:features", "inputs": ["src"], "params": {"keys": [2002]}},
+      {"id": "top", "op": "core:topk", "inputs": ["feat"], "params": {"k": 20, "key": 3001}}
+    ]
+  })"), kNoFusion | kNoLimitPushdown);
+
+  ExecStats stats;
+  ExecContext ctx;
+  ctx.stats = &stats;
+  Executor executor(registry);
+  std::string error;
+  REQUIRE(executor.Execute(compiled, ctx, &error).RowCount() == 20);
+
+  REQUIRE(stats.nodes.size() == 3);
+  REQUIRE(stats.wall_ms > 0.0);
+  const ExecStats::Node& feat = stats.nodes[1];
+  REQUIRE(feat.node_id == "feat");
+  REQUIRE(feat.plan_nodes.size() == 1);
+  REQUIRE(feat.rows_in == 200);
+  REQUIRE(feat.rows_out == 200);
+  REQUIRE(feat.columns_added == 1);
+  REQUIRE(feat.cpu_ms >= 0.0);
+  REQUIRE(stats.nodes[2].rows_out == 20);
+
+  std::string report = FormatExplainAnalyze(compiled, stats);
+  REQUIRE_THAT(report, ContainsSubstring("EXPLAIN ANALYZE explain_plan (3 nodes"));
+  REQUIRE_THAT(report, ContainsSubstring("core:topk"));
+  REQUIRE_THAT(report, ContainsSubstring("0.100"));  // top's selectivity
+  REQUIRE_THAT(report, ContainsSubstring("* critical path"));
+}
@@ -4,6 +4,7 @@
 #include <nlohmann/json.hpp>
 
 #include "expr/expr.h"
+#include "keys/registry.h"
 #include "object/obj.h"
 #include "keys.h"
 
@@ -297,4 +298,20 @@ TEST_CASE("CollectKeyIds", "[expr]") {
 
     REQUIRE(ids.empty());
   }
+  SECTION("Penalty resolves through registry") {
+    KeyRegistry registry;
+    registry.LoadFromCompiled();
+
+    auto j = json::parse(R"({"op": "add", "args": [
+      {"op": "signal", "key_id": 3001},
+      {"op": "penalty", "name": "constraints"}
+    ]})");
+    auto expr = ParseExpr(j);
+
+    REQUIRE(CollectKeyIds(expr).size() == 1);
+
+    auto ids = CollectKeyIds(expr, &registry);
+    REQUIRE(ids.size() == 2);
+    REQUIRE(ids[1] == keys::id::PENALTY_CONSTRAINTS);
+  }
 }
@@ -0,0 +1,264 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "executor/fused_pipeline.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "nodes/registry.h"
+#include "object/row_block.h"
+#include "plan/compiler.h"
+#include "plan/fusion.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// 600 rows spans three 256-row blocks, the last one partial
+json MakeChainPlan() {
+  return json::parse(R"({
+    "name": "fusion",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 600}},
+      {"id": "feat", "op": "core:features", "inputs": ["src"],
+       "params": {"keys": [2001, 2002, 2003]}},
+      {"id": "model", "op": "core:model", "inputs": ["feat"]},
+      {"id": "final", "op": "core:score_formula", "inputs": ["model"], "params": {
+        "expr": {"op": "add", "args": [
+          {"op": "mul", "args": [{"op": "const", "value": 0.5}, {"op": "signal", "key_id": 3002}]},
+          {"op": "cos", "a": {"op": "signal", "key_id": 2002}, "b": {"op": "signal", "key_id": 2003}},
+          {"op": "clamp", "x": {"op": "signal", "key_id": 1001},
+           "lo": {"op": "const", "value": 0}, "hi": {"op": "const", "value": 10}},
+          {"op": "min", "args": [{"op": "signal", "key_id": 3001}, {"op": "const", "value": 0.25}]},
+          {"op": "penalty", "name": "constraints"}
+        ]}
+      }}
+    ]
+  })");
+}
+
+// Writes feat.embedding with dim 2 in the first block and dim 3 after it
+class ShapeShiftingRunner : public NodeRunner {
+ public:
+  CandidateBatch Run(const ExecContext&, const CandidateBatch& input, const json&) override {
+    return input;
+  }
+  bool RunsBlocks() const override { return true; }
+  void RunBlock(const ExecContext&, RowBlock& block, const json&) override {
+    size_t dim = block.Begin() == 0 ? 2 : 3;
+    std::fill_n(block.WriteF32Vec(keys::id::FEAT_EMBEDDING, dim), block.Size() * dim, 1.0f);
+  }
+  std::string TypeName() const override { return "test:shape_shifting"; }
+};
+
+// Declared fusible but with no block path
+class RowOnlyRunner : public NodeRunner {
+ public:
+  CandidateBatch Run(const ExecContext&, const CandidateBatch& input, const json&) override {
+    return input;
+  }
+  std::string TypeName() const override { return "core:test_row_only"; }
+};
+
+}  // namespace
+
+TEST_CASE("Fused chain detection", "[fusion]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  SECTION("features -> model -> score_formula forms one chain") {
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(MakeChainPlan()));
+    REQUIRE(compiled.fused_chains.size() == 1);
+    const auto& nodes = compiled.fused_chains[0].nodes;
+    REQUIRE(nodes.size() == 3);
+    REQUIRE(compiled.plan.nodes[nodes.front()].id == "feat");
+    REQUIRE(compiled.plan.nodes[nodes.back()].id == "final");
+    REQUIRE(compiled.fused_chain_of[compiled.graph.IndexOf("src")] == -1);
+  }
+
+  SECTION("A node with two consumers ends the chain") {
+    json j = MakeChainPlan();
+    j["nodes"].push_back(json::parse(
+        R"({"id": "side", "op": "core:score_formula", "inputs": ["model"], "params": {}})"));
+    j["outputs"] = {"final", "side"};
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(j));
+    REQUIRE(compiled.fused_chains.size() == 1);
+    REQUIRE(compiled.fused_chains[0].nodes.size() == 2);  // feat + model
+  }
+
+  SECTION("Named outputs are not fused into their consumers") {
+    json j = MakeChainPlan();
+    j["outputs"] = {"final", "feat"};
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(j));
+    REQUIRE(compiled.fused_chains.size() == 1);
+    REQUIRE(compiled.plan.nodes[compiled.fused_chains[0].nodes.front()].id == "model");
+  }
+
+  SECTION("Runners without a block path are not fused") {
+    NodeSpec spec;
+    spec.op = "core:test_row_only";
+    spec.fusible = true;
+    NodeRegistry::Instance().Register(
+        "core:test_row_only", [] { return std::make_unique<RowOnlyRunner>(); }, spec);
+
+    json j = MakeChainPlan();
+    j["nodes"][2] = json::parse(R"({"id": "model", "op": "core:test_row_only", "inputs": ["feat"]})");
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(j));
+    REQUIRE(compiled.fused_chain_of[compiled.graph.IndexOf("model")] == -1);
+
+    // Called anyway, the default block path fails loudly
+    RowOnlyRunner runner;
+    CandidateBatch input(4);
+    RowBlock block(input);
+    block.Reset(0, 4);
+    REQUIRE_THROWS_AS(runner.RunBlock(ExecContext{}, block, json::object()), std::logic_error);
+  }
+
+  SECTION("DisableFusion") {
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(MakeChainPlan()), kNoFusion);
+    REQUIRE(compiled.fused_chains.empty());
+  }
+}
+
+TEST_CASE("Fused execution matches node-by-node execution", "[fusion][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Executor executor(registry);
+
+  CompiledPlan fused = CompileOrFail(registry, ParseOrFail(MakeChainPlan()));
+  CompiledPlan unfused = CompileOrFail(registry, ParseOrFail(MakeChainPlan()), kNoFusion);
+
+  std::string error;
+  CandidateBatch a = executor.Execute(fused, &error);
+  REQUIRE(error.empty());
+  CandidateBatch b = executor.Execute(unfused, &error);
+  REQUIRE(error.empty());
+
+  REQUIRE(a.RowCount() == 600);
+  REQUIRE(a.ColumnCount() == b.ColumnCount());
+  for (int32_t key : b.ColumnKeys()) {
+    REQUIRE(a.HasColumn(key));
+    size_t mismatches = 0;
+    for (size_t i = 0; i < b.RowCount(); ++i) {
+      mismatches += a.GetValue(i, key) == b.GetValue(i, key) ? 0 : 1;
+    }
+    REQUIRE(mismatches == 0);
+  }
+
+  SECTION("Intermediate-only columns stay in block scratch") {
+    json j = MakeChainPlan();
+    j["output_keys"] = {1001, 3999};
+    CandidateBatch pruned = executor.Execute(CompileOrFail(registry, ParseOrFail(j)), &error);
+    REQUIRE(pruned.ColumnCount() == 2);
+    auto* score = pruned.GetF32Column(keys::id::SCORE_FINAL);
+    REQUIRE(score != nullptr);
+    auto* expected = b.GetF32Column(keys::id::SCORE_FINAL);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < pruned.RowCount(); ++i) {
+      mismatches += score->Get(i) == expected->Get(i) ? 0 : 1;
+    }
+    REQUIRE(mismatches == 0);
+  }
+
+  SECTION("I64 inputs are promoted the same way in both paths") {
+    const size_t rows = 100;
+    auto base = std::make_shared<I64Column>(rows);
+    auto freshness = std::make_shared<I64Column>(rows);
+    auto ids = std::make_shared<I64Column>(rows);
+    for (size_t i = 0; i < rows; ++i) {
+      ids->Set(i, static_cast<int64_t>(i + 1));
+      base->Set(i, static_cast<int64_t>(i % 7));
+      freshness->Set(i, static_cast<int64_t>(i % 5));
+    }
+    CandidateBatch candidates(rows);
+    candidates.SetColumn(keys::id::CAND_CANDIDATE_ID, ids);
+    candidates.SetColumn(keys::id::SCORE_BASE, base);
+    candidates.SetColumn(keys::id::FEAT_FRESHNESS, freshness);
+
+    // src -> model -> final, with model reading the I64 columns directly
+    json j = MakeChainPlan();
+    j["nodes"].erase(1);
+    j["nodes"][1]["inputs"] = {"src"};
+    CompiledPlan fused_i64 = CompileOrFail(registry, ParseOrFail(j));
+    CompiledPlan unfused_i64 = CompileOrFail(registry, ParseOrFail(j), kNoFusion);
+    REQUIRE(fused_i64.fused_chain_of[fused_i64.graph.IndexOf("model")] != -1);
+
+    ExecContext ctx;
+    ctx.candidates = &candidates;
+    CandidateBatch x = executor.Execute(fused_i64, ctx, &error);
+    REQUIRE(error.empty());
+    CandidateBatch y = executor.Execute(unfused_i64, ctx, &error);
+    REQUIRE(error.empty());
+
+    auto* ml = y.GetF32Column(keys::id::SCORE_ML);
+    REQUIRE(ml != nullptr);
+    REQUIRE(ml->Get(3) == 0.6f * 3 + 0.4f * 3);
+    for (int32_t key : {keys::id::SCORE_ML, keys::id::SCORE_FINAL}) {
+      size_t mismatches = 0;
+      for (size_t i = 0; i < rows; ++i) {
+        mismatches += x.GetValue(i, key) == y.GetValue(i, key) ? 0 : 1;
+      }
+      REQUIRE(mismatches == 0);
+    }
+  }
+}
+
+TEST_CASE("A dim change between blocks fails the fused chain", "[fusion][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(MakeChainPlan()));
+  REQUIRE(compiled.fused_chains.size() == 1);
+  const FusedChain& chain = compiled.fused_chains[0];
+
+  std::vector<std::unique_ptr<NodeRunner>> runners;
+  std::vector<const nlohmann::json*> params;
+  json no_params = json::object();
+  for (size_t i = 0; i < chain.nodes.size(); ++i) {
+    runners.push_back(std::make_unique<ShapeShiftingRunner>());
+    params.push_back(&no_params);
+  }
+
+  ExecContext ctx;
+  ctx.registry = &registry;
+  CandidateBatch input(600);
+  CandidateBatch output(0);
+  std::string error;
+  REQUIRE_FALSE(RunFusedChain(ctx, compiled, chain, runners, params, input, output, &error));
+  REQUIRE(error.find("key 2002 with dim 3 at row 256") != std::string::npos);
+}
+
+TEST_CASE("RowBlock reads and writes", "[fusion][row_block]") {
+  ColumnBatch batch(4);
+  auto base = std::make_shared<F32Column>(4);
+  base->Set(0, 1.0f);
+  base->Set(2, 3.0f);  // Rows 1 and 3 stay null
+  batch.SetColumn(keys::id::SCORE_BASE, base);
+
+  RowBlock block(batch);
+  block.Reset(1, 3);
+
+  const float* values = block.ReadF32(keys::id::SCORE_BASE);
+  REQUIRE(values[0] == 0.0f);  // Null reads as 0
+  REQUIRE(values[1] == 3.0f);
+  REQUIRE(block.ReadF32(keys::id::SCORE_ML)[2] == 0.0f);  // Missing reads as 0
+
+  float* out = block.WriteF32(keys::id::SCORE_BASE);
+  out[0] = 7.0f;
+  REQUIRE(block.ReadF32(keys::id::SCORE_BASE)[0] == 7.0f);
+  REQUIRE(block.WrittenKeys().size() == 1);
+
+  // A new window discards writes
+  block.Reset(0, 1);
+  REQUIRE(block.WrittenKeys().empty());
+  REQUIRE(block.ReadF32(keys::id::SCORE_BASE)[0] == 1.0f);
+}
@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "nodes/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// sourcer(k=1000) -> features -> model -> score_formula -> topk(k=50)
+json Pipeline(const json& topk_params) {
+  return json{
+    {"name", "limits"},
+    {"nodes", json::array({
+      {{"id", "src"}, {"op", "core:sourcer"}, {"params", {{"name", "main"}, {"k", 1000}}}},
+      {{"id", "feat"}, {"op", "core:features"}, {"inputs", {"src"}}},
+      {{"id", "model"}, {"op", "core:model"}, {"inputs", {"feat"}}},
+      {{"id", "final"}, {"op", "core:score_formula"}, {"inputs", {"model"}}},
+      {{"id", "top"}, {"op", "core:topk"}, {"inputs", {"final"}}, {"params", topk_params}},
+    })},
+  };
+}
+
+std::vector<int64_t> CandidateIds(const CandidateBatch& batch) {
+  std::vector<int64_t> ids;
+  auto* column = batch.GetI64Column(keys::id::CAND_CANDIDATE_ID);
+  for (size_t i = 0; column && i < batch.RowCount(); ++i) {
+    ids.push_back(column->Get(i));
+  }
+  return ids;
+}
+
+const PlanNode& NodeOf(const CompiledPlan& compiled, const std::string& id) {
+  int32_t index = compiled.graph.IndexOf(id);
+  REQUIRE(index >= 0);
+  return compiled.plan.nodes[index];
+}
+
+}  // namespace
+
+TEST_CASE("core:topk keeps the highest scores", "[nodes][topk]") {
+  auto runner = NodeRegistry::Instance().Create("core:topk");
+  REQUIRE(runner);
+
+  ColumnBatch input(5);
+  auto ids = std::make_shared<I64Column>(5);
+  auto scores = std::make_shared<F32Column>(5);
+  const float values[] = {0.2f, 0.9f, 0.5f, 0.0f, 0.9f};
+  for (size_t i = 0; i < 5; ++i) {
+    ids->Set(i, static_cast<int64_t>(i + 1));
+    if (i != 3) {
+      scores->Set(i, values[i]);  // Row 3 stays null
+    }
+  }
+  input.SetColumn(keys::id::CAND_CANDIDATE_ID, ids);
+  input.SetColumn(keys::id::SCORE_FINAL, scores);
+
+  ExecContext ctx;
+  SECTION("Descending, ties in input order") {
+    auto output = runner->Run(ctx, input, json{{"k", 3}});
+    REQUIRE(CandidateIds(output) == std::vector<int64_t>{2, 5, 3});
+  }
+
+  SECTION("Nulls sort last; k larger than the batch keeps every row") {
+    auto output = runner->Run(ctx, input, json{{"k", 10}});
+    REQUIRE(CandidateIds(output) == std::vector<int64_t>{2, 5, 3, 1, 4});
+    REQUIRE(output.GetF32Column(keys::id::SCORE_FINAL)->IsNull(4));
+  }
+}
+
+TEST_CASE("Limit pushdown", "[plan][limits]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+  Executor executor(registry);
+
+  auto run = [&](const Plan& plan, bool pushdown, CompiledPlan& compiled) {
+    PlanCompiler plain(registry);
+    if (!pushdown) {
+      plain.DisableLimitPushdown();
+    }
+    std::string error;
+    REQUIRE(plain.Compile(plan, compiled, &error));
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(error.empty());
+    return CandidateIds(result);
+  };
+
+  SECTION("push_to_sources caps sourcer k") {
+    Plan plan = ParseOrFail(Pipeline({{"k", 50}, {"push_to_sources", true}}));
+    CompiledPlan pushed, baseline;
+    auto ids = run(plan, true, pushed);
+    REQUIRE(NodeOf(pushed, "src").params["k"] == 50);
+    REQUIRE(pushed.limit_rewrites.size() == 1);
+    REQUIRE(ids.size() == 50);
+    REQUIRE(ids == run(plan, false, baseline));
+    REQUIRE(NodeOf(baseline, "src").params["k"] == 1000);
+  }
+
+  SECTION("Sourcer k is left alone unless the plan allows it") {
+    Plan plan = ParseOrFail(Pipeline({{"k", 50}}));
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    REQUIRE(compiled.limit_rewrites.empty());
+    REQUIRE(NodeOf(compiled, "src").params["k"] == 1000);
+  }
+
+  SECTION("Another consumer of the sourcer blocks the cap") {
+    json j = Pipeline({{"k", 50}, {"push_to_sources", true}});
+    j["nodes"].push_back({{"id", "audit"}, {"op", "core:features"}, {"inputs", {"src"}}});
+    j["outputs"] = {"top", "audit"};
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(ParseOrFail(j), compiled));
+    REQUIRE(NodeOf(compiled, "src").params["k"] == 1000);
+  }
+
+  SECTION("core:merge stops propagation") {
+    json j = Pipeline({{"k", 50}, {"push_to_sources", true}});
+    j["nodes"][1]["inputs"] = {"dedup"};
+    j["nodes"].push_back({{"id", "dedup"}, {"op", "core:merge"}, {"inputs", {"src"}}});
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(ParseOrFail(j), compiled));
+    REQUIRE(compiled.limit_rewrites.empty());
+  }
+
+  SECTION("Early truncation after the node that writes the ranking key") {
+    Plan plan = ParseOrFail(Pipeline({{"k", 20}, {"key", keys::id::SCORE_BASE}}));
+    CompiledPlan pushed, baseline;
+    auto ids = run(plan, true, pushed);
+
+    const PlanNode& early = NodeOf(pushed, "top.early");
+    REQUIRE(early.op == "core:topk");
+    REQUIRE(early.inputs == std::vector<std::string>{"src"});
+    REQUIRE(NodeOf(pushed, "feat").inputs == std::vector<std::string>{"top.early"});
+    REQUIRE(pushed.sinks == std::vector<std::string>{"top"});
+
+    REQUIRE(ids.size() == 20);
+    REQUIRE(ids == run(plan, false, baseline));
+  }
+}
@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/liveness.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+bool Contains(const std::vector<int32_t>& keys, int32_t key) {
+  return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+const ColumnLiveness& LivenessOf(const CompiledPlan& compiled, const std::string& id) {
+  int32_t index = compiled.graph.IndexOf(id);
+  REQUIRE(index >= 0);
+  return compiled.liveness[index];
+}
+
+// sourcer -> features(freshness, embedding) -> model -> score_formula(0.5*ml + base)
+const char* kPipeline = R"({
+  "name": "liveness",
+  "nodes": [
+    {"id": "src", "op": "core:sourcer", "params": {"k": 8}},
+    {"id": "feat", "op": "core:features", "inputs": ["src"], "params": {"keys": [2001, 2002]}},
+    {"id": "model", "op": "core:model", "inputs": ["feat"]},
+    {"id": "final", "op": "core:score_formula", "inputs": ["model"], "params": {
+      "expr": {"op": "add", "args": [
+        {"op": "mul", "args": [{"op": "const", "value": 0.5}, {"op": "signal", "key_id": 3002}]},
+        {"op": "signal", "key_id": 3001}
+      ]},
+      "output_key_id": 3999
+    }}
+  ],
+  "output_keys": [1001, 3999]
+})";
+
+}  // namespace
+
+TEST_CASE("Node key access resolution", "[liveness]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  SECTION("Param-derived writes") {
+    PlanNode node{"feat", "core:features", {}, json::parse(R"({"keys": [2001]})"), ""};
+    auto access = ResolveNodeKeyAccess(node, registry);
+    REQUIRE_FALSE(access.reads_all);
+    REQUIRE(access.writes == std::vector<int32_t>{keys::id::FEAT_FRESHNESS});
+    REQUIRE(Contains(access.reads, keys::id::CAND_CANDIDATE_ID));
+  }
+
+  SECTION("Score formula reads its expression keys") {
+    PlanNode node{"final", "core:score_formula", {}, json::parse(R"({
+      "expr": {"op": "add", "args": [
+        {"op": "signal", "key_id": 3002},
+        {"op": "penalty", "name": "constraints"}
+      ]}
+    })"), ""};
+    auto access = ResolveNodeKeyAccess(node, registry);
+    REQUIRE(Contains(access.reads, keys::id::SCORE_ML));
+    REQUIRE(Contains(access.reads, keys::id::PENALTY_CONSTRAINTS));
+    REQUIRE(access.writes == std::vector<int32_t>{keys::id::SCORE_FINAL});
+  }
+
+  SECTION("Unknown ops read everything") {
+    PlanNode node{"x", "js:unknown/module@1.0.0", {}, json::object(), ""};
+    REQUIRE(ResolveNodeKeyAccess(node, registry).reads_all);
+  }
+}
+
+TEST_CASE("Column liveness analysis", "[liveness]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+
+  SECTION("Dead columns are dropped after their last reader") {
+    Plan plan = ParseOrFail(kPipeline);
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+
+    // The embedding is never read downstream
+    const auto& feat = LivenessOf(compiled, "feat");
+    REQUIRE(feat.prune);
+    REQUIRE_FALSE(Contains(feat.live_keys, keys::id::FEAT_EMBEDDING));
+    REQUIRE(Contains(feat.live_keys, keys::id::FEAT_FRESHNESS));
+
+    // Freshness is dead once the model has consumed it
+    const auto& model = LivenessOf(compiled, "model");
+    REQUIRE_FALSE(Contains(model.live_keys, keys::id::FEAT_FRESHNESS));
+    REQUIRE(Contains(model.live_keys, keys::id::SCORE_ML));
+    REQUIRE(Contains(model.live_keys, keys::id::SCORE_BASE));
+
+    const auto& final_node = LivenessOf(compiled, "final");
+    REQUIRE(final_node.live_keys ==
+            std::vector<int32_t>{keys::id::CAND_CANDIDATE_ID, keys::id::SCORE_FINAL});
+  }
+
+  SECTION("Dump keys stay live") {
+    Plan plan = ParseOrFail(kPipeline);
+    plan.logging.dump_keys = {keys::id::FEAT_EMBEDDING};
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    REQUIRE(Contains(LivenessOf(compiled, "final").live_keys, keys::id::FEAT_EMBEDDING));
+  }
+
+  SECTION("No output_keys disables pruning") {
+    Plan plan = ParseOrFail(kPipeline);
+    plan.output_keys.clear();
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    for (const auto& liveness : compiled.liveness) {
+      REQUIRE_FALSE(liveness.prune);
+    }
+  }
+
+  SECTION("Nodes with unknown reads keep everything upstream") {
+    Plan plan = ParseOrFail(kPipeline);
+    plan.nodes[2].op = "js:opaque/model@1.0.0";
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    REQUIRE_FALSE(LivenessOf(compiled, "feat").prune);
+    REQUIRE(LivenessOf(compiled, "model").prune);
+  }
+}
+
+TEST_CASE("Executor drops dead columns", "[liveness][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+
+  Plan plan = ParseOrFail(kPipeline);
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled));
+
+  Executor executor(registry);
+  std::string error;
+  CandidateBatch result = executor.Execute(compiled, &error);
+  REQUIRE(error.empty());
+  REQUIRE(result.RowCount() == 8);
+  REQUIRE(result.ColumnCount() == 2);
+  REQUIRE(result.HasColumn(keys::id::CAND_CANDIDATE_ID));
+  REQUIRE(result.HasColumn(keys::id::SCORE_FINAL));
+
+  // Without output_keys every column reaches the caller
+  plan.output_keys.clear();
+  REQUIRE(compiler.Compile(plan, compiled));
+  result = executor.Execute(compiled, &error);
+  REQUIRE(result.HasColumn(keys::id::FEAT_EMBEDDING));
+}
@@ -0,0 +1,191 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "executor/load_generator.h"
+#include "expr/expr.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+using Catch::Matchers::ContainsSubstring;
+
+namespace {
+
+CompiledPlan CompileTopK(const KeyRegistry& registry, int sourcer_k) {
+  Plan plan;
+  std::string error;
+  json plan_json = json::parse(R"({
+    "name": "load_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 100}},
+      {"id": "top", "op": "core:topk", "inputs": ["src"], "params": {"k": 10, "key": 3001}}
+    ]
+  })");
+  plan_json["nodes"][0]["params"]["k"] = sourcer_k;
+  REQUIRE(ParsePlan(plan_json, plan, &error));
+  PlanCompiler compiler(registry);
+  compiler.DisableLimitPushdown();
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+  return compiled;
+}
+
+}  // namespace
+
+TEST_CASE("Candidate corpus lines become request batches", "[loadgen]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  std::istringstream corpus(
+      R"([{"cand.candidate_id": 7, "score.base": 0.5}, {"cand.candidate_id": 8, "3001": 0.25}])"
+      "\n\n"
+      R"({"candidates": [{"cand.candidate_id": 9, "score.base": null}]})"
+      "\n");
+  std::vector<CandidateBatch> batches;
+  std::string error;
+  REQUIRE(ReadCandidateCorpus(corpus, registry, batches, &error));
+  REQUIRE(batches.size() == 2);
+  REQUIRE(batches[0].RowCount() == 2);
+  REQUIRE(batches[0].GetI64Column(keys::id::CAND_CANDIDATE_ID)->Get(1) == 8);
+  REQUIRE(batches[0].GetF32Column(keys::id::SCORE_BASE)->Get(1) == 0.25f);
+  REQUIRE(batches[1].GetF32Column(keys::id::SCORE_BASE)->IsNull(0));
+
+  for (const auto& [line, message] : std::vector<std::pair<std::string, std::string>>{
+           {R"([{"no.such_key": 1}])", "unknown key: no.such_key"},
+           {R"([{"cand.candidate_id": "x"}])", "cand.candidate_id expects i64"},
+           {R"([{"feat.embedding": [1, 2, 3]}])", "feat.embedding expects f32vec[128]"},
+           {R"({"rows": []})", "expected an array"},
+       }) {
+    std::istringstream bad(line);
+    std::vector<CandidateBatch> out;
+    REQUIRE_FALSE(ReadCandidateCorpus(bad, registry, out, &error));
+    REQUIRE_THAT(error, ContainsSubstring("Corpus line 1"));
+    REQUIRE_THAT(error, ContainsSubstring(message));
+  }
+
+  // Request candidates replace what the sourcer would generate
+  CompiledPlan compiled = CompileTopK(registry, 1);
+  Executor executor(registry);
+  ExecContext ctx;
+  ctx.candidates = &batches[0];
+  CandidateBatch result = executor.Execute(compiled, ctx, &error);
+  REQUIRE(result.RowCount() == 1);
+  REQUIRE(result.GetI64Column(keys::id::CAND_CANDIDATE_ID)->Get(0) == 7);
+
+  compiled = CompileTopK(registry, 100);
+  result = executor.Execute(compiled, ctx, &error);
+  REQUIRE(result.RowCount() == 2);
+}
+
+TEST_CASE("Formulas read corpus-only keys of supplied candidates", "[loadgen][schema]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  // feat.freshness is in every batch but never written by the plan;
+  // score.ml is in one batch only
+  std::istringstream lines(
+      R"([{"cand.candidate_id": 1, "score.base": 1.0, "feat.freshness": 0.25, "score.ml": 5}])"
+      "\n"
+      R"([{"cand.candidate_id": 2, "score.base": 2.0, "feat.freshness": 0.5}])"
+      "\n");
+  std::vector<CandidateBatch> corpus;
+  std::string error;
+  REQUIRE(ReadCandidateCorpus(lines, registry, corpus, &error));
+
+  BatchSchema schema = CandidateSchemaOf(corpus);
+  REQUIRE(schema.known);
+  REQUIRE(schema.TypeOf(keys::id::FEAT_FRESHNESS) == ColumnType::F32);
+  REQUIRE(schema.TypeOf(keys::id::CAND_CANDIDATE_ID) == ColumnType::I64);
+  REQUIRE_FALSE(schema.TypeOf(keys::id::SCORE_ML));
+  REQUIRE_FALSE(CandidateSchemaOf({}).known);
+
+  Plan plan;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "corpus_formula",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 10}},
+      {"id": "score", "op": "core:score_formula", "inputs": ["src"], "params": {
+        "expr": {"op": "add", "args": [
+          {"op": "signal", "key_id": 2001},
+          {"op": "signal", "key_id": 3001}
+        ]}
+      }}
+    ]
+  })"), plan, &error));
+
+  PlanCompiler declared_compiler(registry);
+  declared_compiler.SetCandidateSchema(schema);
+  CompiledPlan declared;
+  REQUIRE(declared_compiler.Compile(plan, declared, &error));
+  auto loads = declared.compiled_exprs[declared.graph.IndexOf("score")]->Loads();
+  REQUIRE(loads[0] == std::pair{keys::id::FEAT_FRESHNESS, CompiledExpr::Load::kF32});
+
+  // Undeclared, the schemas assume generated candidates (no feat.freshness);
+  // requests that supply candidates run without them
+  PlanCompiler generated_compiler(registry);
+  CompiledPlan generated;
+  REQUIRE(generated_compiler.Compile(plan, generated, &error));
+  REQUIRE_FALSE(generated.candidate_schema);
+
+  Executor executor(registry);
+  for (const CompiledPlan* compiled : {&declared, &generated}) {
+    for (size_t b = 0; b < corpus.size(); ++b) {
+      ExecContext ctx;
+      ctx.candidates = &corpus[b];
+      CandidateBatch result = executor.Execute(*compiled, ctx, &error);
+      REQUIRE(result.RowCount() == 1);
+      float expected = b == 0 ? 1.25f : 2.5f;
+      REQUIRE(result.GetF32Column(keys::id::SCORE_FINAL)->Get(0) == expected);
+    }
+  }
+}
+
+TEST_CASE("Open-loop load counts queueing in scheduled latency", "[loadgen]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileTopK(registry, 100);
+  std::vector<CandidateBatch> corpus = SyntheticCandidateCorpus(4, 50);
+  REQUIRE(corpus[3].RowCount() == 50);
+  REQUIRE(corpus[3].GetI64Column(keys::id::CAND_CANDIDATE_ID)->Get(0) == 151);
+
+  LoadOptions options;
+  options.threads = 2;
+  options.qps = 500;
+  options.duration = std::chrono::milliseconds(100);
+  options.warmup = std::chrono::milliseconds(20);
+  LoadReport report;
+  std::string error;
+  REQUIRE(RunLoad(compiled, registry, corpus, options, report, &error));
+  REQUIRE(report.requests == 50);  // Warm-up requests are not recorded
+  REQUIRE(report.errors == 0);
+  REQUIRE(report.latency_ns.count == 50);
+  REQUIRE(report.achieved_qps > 0.0);
+  REQUIRE(report.latency_ns.ValueAtQuantile(0.5) >= report.service_ns.ValueAtQuantile(0.5));
+  REQUIRE_THAT(FormatLoadReport(report), ContainsSubstring("p999"));
+  REQUIRE(LoadReportToJson(report)["latency_ms"].contains("p99"));
+
+  // One thread far below the offered rate: requests queue behind each other,
+  // which the scheduled latency shows and the service time does not
+  options.threads = 1;
+  options.qps = 200000;
+  options.duration = std::chrono::milliseconds(20);
+  options.warmup = std::chrono::milliseconds(0);
+  REQUIRE(RunLoad(compiled, registry, corpus, options, report, &error));
+  REQUIRE(report.requests == 4000);
+  REQUIRE(report.achieved_qps < options.qps);
+  REQUIRE(report.latency_ns.ValueAtQuantile(0.5) > 10 * report.service_ns.ValueAtQuantile(0.5));
+
+  options.threads = 0;
+  REQUIRE_FALSE(RunLoad(compiled, registry, corpus, options, report, &error));
+  REQUIRE_THAT(error, ContainsSubstring("at least one thread"));
+}
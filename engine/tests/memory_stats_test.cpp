@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "object/batch_builder.h"
+#include "object/memory_stats.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+TEST_CASE("Column bytes are split into allocated, copied and shared", "[memory_stats]") {
+  auto id_col = std::make_shared<I64Column>(1000);
+  auto score_col = std::make_shared<F32Column>(1000);
+  REQUIRE(id_col->ByteSize() >= 1000 * sizeof(int64_t));
+  REQUIRE(score_col->ByteSize() >= 1000 * sizeof(float));
+  REQUIRE(score_col->ByteSize() < id_col->ByteSize());
+
+  auto names = std::make_shared<StringColumn>(2);
+  size_t empty_bytes = names->ByteSize();
+  names->Set(0, std::string(200, 'x'));  // Beyond the inline buffer
+  REQUIRE(names->ByteSize() >= empty_bytes + 200);
+
+  ColumnBatch source(1000);
+  source.SetColumn(keys::id::CAND_CANDIDATE_ID, id_col);
+  source.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  // COW on score.base copies it; score.final is fresh; the id column is shared
+  BatchBuilder builder(source);
+  builder.Set(0, keys::id::SCORE_BASE, 0.5f);
+  builder.AddF32Column(keys::id::SCORE_FINAL, std::make_shared<F32Column>(1000));
+  ColumnBatch output = builder.Build();
+
+  NodeMemoryStats stats = AccountNodeMemory(source, output);
+  int64_t copied = static_cast<int64_t>(output.GetColumn(keys::id::SCORE_BASE)->ByteSize());
+  int64_t fresh = static_cast<int64_t>(output.GetColumn(keys::id::SCORE_FINAL)->ByteSize());
+  REQUIRE(stats.shared_bytes == static_cast<int64_t>(id_col->ByteSize()));
+  REQUIRE(stats.copied_bytes == copied);
+  REQUIRE(stats.allocated_bytes == copied + fresh);
+  REQUIRE(stats.live_bytes == -1);
+
+  // Shared columns count once while any holder remains
+  LiveColumnTracker live;
+  live.Hold(source);
+  live.Hold(output);
+  int64_t total = static_cast<int64_t>(id_col->ByteSize() + score_col->ByteSize()) + copied + fresh;
+  REQUIRE(live.LiveBytes() == total);
+  live.Release(source);
+  REQUIRE(live.LiveBytes() == total - static_cast<int64_t>(score_col->ByteSize()));
+  live.Release(output);
+  REQUIRE(live.LiveBytes() == 0);
+  REQUIRE(live.PeakBytes() == total);
+}
+
+TEST_CASE("Executor reports per-node memory when stats are requested", "[memory_stats][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "memory_stats_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 1000}},
+      {"id": "top", "op": "core:topk", "inputs": ["src"], "params": {"k": 10, "key": 3001}}
+    ]
+  })"), plan, &error));
+  PlanCompiler compiler(registry);
+  compiler.DisableLimitPushdown();
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+
+  ExecStats stats;
+  ExecContext ctx;
+  ctx.stats = &stats;
+  Executor executor(registry);
+  REQUIRE(executor.Execute(compiled, ctx, &error).RowCount() == 10);
+
+  REQUIRE(stats.nodes.size() == 2);
+  const ExecStats::Node& src = stats.nodes[0];
+  const ExecStats::Node& top = stats.nodes[1];
+  REQUIRE(src.node_id == "src");
+  REQUIRE(src.op == "core:sourcer");
+  REQUIRE(src.memory.allocated_bytes > 0);
+  REQUIRE(src.memory.shared_bytes == 0);
+  REQUIRE(src.memory.live_bytes == src.memory.allocated_bytes);
+
+  // Row selection copies every column into a 10-row batch
+  REQUIRE(top.memory.allocated_bytes > 0);
+  REQUIRE(top.memory.allocated_bytes < src.memory.allocated_bytes);
+  REQUIRE(top.memory.copied_bytes == top.memory.allocated_bytes);
+  REQUIRE(stats.allocated_bytes == src.memory.allocated_bytes + top.memory.allocated_bytes);
+  REQUIRE(stats.peak_live_bytes >= src.memory.allocated_bytes);
+
+  // Stats are reset per request
+  REQUIRE(executor.Execute(compiled, ctx, &error).RowCount() == 10);
+  REQUIRE(stats.nodes.size() == 2);
+}
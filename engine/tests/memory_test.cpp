@@ -0,0 +1,151 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "keys.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/memory.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// sourcer(1000 rows) -> features(embedding) -> features(query embedding) -> topk(10)
+const char* kTwoEmbeddings = R"({
+  "name": "memory",
+  "nodes": [
+    {"id": "src", "op": "core:sourcer", "params": {"k": 1000}},
+    {"id": "f1", "op": "core:features", "inputs": ["src"], "params": {"keys": [2002]}},
+    {"id": "f2", "op": "core:features", "inputs": ["f1"], "params": {"keys": [2003]}},
+    {"id": "top", "op": "core:topk", "inputs": ["f2"], "params": {"k": 10, "key": 3001}}
+  ],
+  "output_keys": [1001, 3001]
+})";
+
+}  // namespace
+
+TEST_CASE("Key widths come from registry types and dims", "[memory]") {
+  KeyRegistry::KeyInfo key;
+  key.type = keys::KeyType::F32;
+  REQUIRE(KeyBytesPerRow(key) == 4);
+  key.type = keys::KeyType::I64;
+  REQUIRE(KeyBytesPerRow(key) == 8);
+  key.type = keys::KeyType::F32Vec;
+  key.dim = 768;
+  REQUIRE(KeyBytesPerRow(key) == 768 * 4);
+  key.dim = 0;
+  REQUIRE(KeyBytesPerRow(key) == 128 * 4);  // Undeclared: core:features default
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  REQUIRE(registry.GetById(keys::id::FEAT_EMBEDDING)->dim == 128);
+
+  REQUIRE(registry.LoadFromJson(R"({"version": 1, "keys": [
+    {"id": 2002, "name": "feat.embedding", "type": "f32vec", "scope": "feature",
+     "owner": "x", "doc": "x", "dim": 768}]})"));
+  REQUIRE(KeyBytesPerRow(*registry.GetById(2002)) == 768 * 4);
+}
+
+TEST_CASE("Working-set estimate follows sharing and release", "[memory]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(kTwoEmbeddings);
+  CompiledPlan compiled = CompileOrFail(registry, plan, kNoFusion | kNoLimitPushdown);
+
+  const int32_t src = compiled.graph.IndexOf("src");
+  const int32_t f1 = compiled.graph.IndexOf("f1");
+  const int32_t top = compiled.graph.IndexOf("top");
+  REQUIRE(compiled.last_consumer[src] == f1);
+  REQUIRE(compiled.last_consumer[top] == -1);  // Sink
+
+  SECTION("Every column stays live without pruning") {
+    std::vector<ColumnLiveness> keep_all(compiled.graph.node_count);
+    ComplexityMetrics metrics;
+    EstimateMemoryFootprint(compiled.plan, compiled.graph, compiled.exec_order,
+                            compiled.sink_indices, keep_all, {}, {}, registry, metrics);
+
+    // src: (8 + 4) B x 1000; f1, f2: 512 B x 1000 each, sharing src's columns;
+    // top copies all four columns for 10 rows while f2's batch is still held
+    const int64_t base = 12 * 1000;
+    const int64_t embedding = 512 * 1000;
+    REQUIRE(metrics.peak_memory_bytes == base + 2 * embedding + (12 + 2 * 512) * 10);
+    REQUIRE(metrics.peak_memory_node == "top");
+    REQUIRE(metrics.top_memory.front().bytes == embedding);
+    REQUIRE(metrics.estimated_bytes == metrics.peak_memory_bytes);  // Nothing freed
+  }
+
+  SECTION("Dead embeddings are freed as soon as they are pruned") {
+    // Nothing reads either embedding, so each is dropped right after its node
+    const ComplexityMetrics& metrics = compiled.complexity;
+    REQUIRE(metrics.peak_memory_bytes == 12 * 1000 + 512 * 1000);
+    REQUIRE(metrics.peak_memory_node == "f1");
+    // Total allocation still counts both embeddings; top copies the two live keys
+    REQUIRE(metrics.estimated_bytes == 12 * 1000 + 2 * 512 * 1000 + 12 * 10);
+  }
+}
+
+TEST_CASE("njs writes are capped by the module write budget", "[memory]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(R"({
+    "name": "njs_memory",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 10}},
+      {"id": "js", "op": "njs", "inputs": ["src"], "params": {"module": "missing.njs"}}
+    ]
+  })");
+  PlanGraph graph = BuildPlanGraph(plan);
+  std::vector<ColumnLiveness> keep_all(graph.node_count);
+
+  // Meta unavailable: the default max_write_bytes budget is assumed
+  ComplexityMetrics metrics;
+  EstimateMemoryFootprint(plan, graph, {0, 1}, {1}, keep_all, {}, {}, registry, metrics);
+  REQUIRE(metrics.peak_memory_bytes == 12 * 10 + 1048576);
+}
+
+TEST_CASE("Compile fails over the memory budget", "[memory][compiler]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(kTwoEmbeddings);
+
+  ComplexityBudget budget = ComplexityBudget::Default();
+  budget.peak_memory_bytes_hard = 100000;
+
+  // Limit pushdown would cap the sourcer at the topk's 10 rows
+  PlanCompiler compiler(registry);
+  compiler.SetComplexityBudget(budget);
+  compiler.DisableLimitPushdown();
+  CompiledPlan compiled;
+  std::string error;
+  REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("PLAN_MEMORY_TOO_LARGE"));
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("hard_limit=100000"));
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("core:features bytes="));
+
+  auto parsed = ComplexityBudget::Parse(R"({"hard": {"peak_memory_bytes": 4096}})");
+  REQUIRE(parsed.peak_memory_bytes_hard == 4096);
+
+  // Total allocation is checked against estimated_bytes
+  budget.peak_memory_bytes_hard = 0;
+  budget.estimated_bytes_hard = 1000000;
+  compiler.SetComplexityBudget(budget);
+  REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("PLAN_MEMORY_TOO_LARGE"));
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("estimated_bytes=1036120 (hard_limit=1000000)"));
+  budget.estimated_bytes_hard = 0;
+  budget.peak_memory_bytes_hard = 100000;
+
+  // Disabling the complexity check skips the memory check too
+  PlanCompiler unchecked(registry);
+  unchecked.SetComplexityBudget(budget);
+  unchecked.DisableLimitPushdown();
+  unchecked.DisableComplexityCheck();
+  REQUIRE(unchecked.Compile(plan, compiled, &error));
+  REQUIRE(compiled.complexity.peak_memory_bytes > 100000);
+}
@@ -0,0 +1,264 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys/registry.h"
+#include "logging/metrics.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+using Catch::Matchers::ContainsSubstring;
+
+namespace {
+
+// Merged series for one plan, sorted by node
+std::vector<NodeMetrics> SeriesOf(const std::string& plan_name) {
+  std::vector<NodeMetrics> series;
+  for (auto& metrics : Metrics::Snapshot()) {
+    if (metrics.plan_name == plan_name) {
+      series.push_back(std::move(metrics));
+    }
+  }
+  return series;
+}
+
+}  // namespace
+
+TEST_CASE("Histogram buckets bound relative error", "[metrics]") {
+  for (uint64_t value : std::vector<uint64_t>{0, 1, 63, 64, 65, 1000, 123456789,
+                                              HistogramSnapshot::kMaxValue}) {
+    size_t bucket = HistogramSnapshot::BucketOf(value);
+    REQUIRE(bucket < HistogramSnapshot::kBucketCount);
+    uint64_t high = HistogramSnapshot::BucketMax(bucket);
+    REQUIRE(high >= value);
+    REQUIRE(high - value <= value / 32);
+    if (bucket > 0) {
+      REQUIRE(HistogramSnapshot::BucketMax(bucket - 1) < value);
+    }
+  }
+  REQUIRE(HistogramSnapshot::BucketOf(uint64_t{1} << 50) == HistogramSnapshot::kBucketCount - 1);
+
+  HistogramSnapshot histogram;
+  REQUIRE(histogram.ValueAtQuantile(0.5) == 0);
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.counts[HistogramSnapshot::BucketOf(value * 1000)] += 1;
+    histogram.count += 1;
+    histogram.max = value * 1000;
+  }
+  uint64_t p50 = histogram.ValueAtQuantile(0.5);
+  REQUIRE(p50 >= 500000);
+  REQUIRE(p50 <= 500000 + 500000 / 32);
+  REQUIRE(histogram.ValueAtQuantile(0.999) >= 999000);
+  REQUIRE(histogram.ValueAtQuantile(1.0) == 1000000);  // Capped at the max
+}
+
+TEST_CASE("Per-thread series merge on read", "[metrics]") {
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([] {
+      for (int i = 1; i <= 250; ++i) {
+        Metrics::RecordNode("merge_plan", "model", "core:model", std::chrono::microseconds(i),
+                            100, 10);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  Metrics::RecordNode("merge_plan", "top", "core:topk", std::chrono::milliseconds(2), 10, 5);
+
+  auto series = SeriesOf("merge_plan");
+  REQUIRE(series.size() == 2);
+  REQUIRE(series[0].node_id == "model");
+  REQUIRE(series[0].latency_ns.count == 1000);
+  REQUIRE(series[0].rows_in == 100000);
+  REQUIRE(series[0].rows_out == 10000);
+  REQUIRE(series[0].latency_ns.max == 250000);
+  REQUIRE(series[0].latency_ns.ValueAtQuantile(0.99) >= 247000);
+  REQUIRE(series[1].latency_ns.sum == 2000000);
+
+  std::ostringstream out;
+  Metrics::WritePrometheus(out);
+  std::string text = out.str();
+  REQUIRE_THAT(text, ContainsSubstring("# TYPE rankdsl_node_latency_seconds summary"));
+  REQUIRE_THAT(text, ContainsSubstring(
+      "rankdsl_node_latency_seconds_count{plan=\"merge_plan\",node=\"model\",op=\"core:model\"} "
+      "1000\n"));
+  REQUIRE_THAT(text, ContainsSubstring(
+      "rankdsl_node_latency_seconds{plan=\"merge_plan\",node=\"top\",op=\"core:topk\","
+      "quantile=\"0.999\"} 0.002"));
+  REQUIRE_THAT(text, ContainsSubstring(
+      "rankdsl_node_rows_in_total{plan=\"merge_plan\",node=\"model\",op=\"core:model\"} 100000\n"));
+
+  // Counter totals are exported only for counters that were sampled
+  PerfCounts perf;
+  perf.Set(PerfCounter::kInstructions, 1200);
+  Metrics::RecordNode("merge_plan", "top", "core:topk", std::chrono::milliseconds(1), 10, 5, &perf);
+  Metrics::RecordNode("merge_plan", "top", "core:topk", std::chrono::milliseconds(1), 10, 5, &perf);
+  REQUIRE(SeriesOf("merge_plan")[1].perf.Get(PerfCounter::kInstructions) == 2400);
+  std::ostringstream with_perf;
+  Metrics::WritePrometheus(with_perf);
+  REQUIRE_THAT(with_perf.str(), ContainsSubstring(
+      "rankdsl_node_perf_instructions_total{plan=\"merge_plan\",node=\"top\",op=\"core:topk\"} "
+      "2400\n"));
+  REQUIRE_THAT(with_perf.str(), !ContainsSubstring(
+      "rankdsl_node_perf_cycles_total{plan=\"merge_plan\""));
+}
+
+TEST_CASE("Exited threads fold into their series", "[metrics]") {
+  auto record_on_thread = [](int records) {
+    std::thread([records] {
+      for (int i = 0; i < records; ++i) {
+        Metrics::RecordNode("retire_plan", "model", "core:model", std::chrono::microseconds(5),
+                            10, 1);
+      }
+    }).join();
+  };
+  record_on_thread(3);
+  record_on_thread(4);
+  Metrics::RecordNode("retire_plan", "model", "core:model", std::chrono::microseconds(9), 10, 1);
+
+  // Retired totals and the live thread's cells merge into one series
+  auto series = SeriesOf("retire_plan");
+  REQUIRE(series.size() == 1);
+  REQUIRE(series[0].latency_ns.count == 8);
+  REQUIRE(series[0].latency_ns.max == 9000);
+  REQUIRE(series[0].rows_in == 80);
+}
+
+TEST_CASE("Series can be forgotten by plan and are capped", "[metrics]") {
+  Metrics::RecordNode("forget_plan", "model", "core:model", std::chrono::microseconds(1), 1, 1);
+  Metrics::RecordNode("kept_plan", "model", "core:model", std::chrono::microseconds(1), 1, 1);
+  Metrics::ForgetPlan("forget_plan");
+  REQUIRE(SeriesOf("forget_plan").empty());
+  REQUIRE(SeriesOf("kept_plan").size() == 1);
+
+  // Recording again starts a fresh series; the old cells are not reused
+  Metrics::RecordNode("forget_plan", "model", "core:model", std::chrono::microseconds(2), 1, 1);
+  auto series = SeriesOf("forget_plan");
+  REQUIRE(series.size() == 1);
+  REQUIRE(series[0].latency_ns.count == 1);
+  REQUIRE(series[0].latency_ns.sum == 2000);
+
+  // Past the cap, new series share the overflow series; existing ones still record
+  Metrics::SetMaxSeries(0);
+  for (const char* node : {"a", "b", "c"}) {
+    Metrics::RecordNode("capped_plan", node, "core:model", std::chrono::microseconds(1), 1, 1);
+  }
+  Metrics::RecordNode("kept_plan", "model", "core:model", std::chrono::microseconds(1), 1, 1);
+  Metrics::SetMaxSeries(4096);
+  REQUIRE(SeriesOf("capped_plan").empty());
+  REQUIRE(SeriesOf("kept_plan")[0].latency_ns.count == 2);
+  auto overflow = SeriesOf("_overflow");
+  REQUIRE(overflow.size() == 1);
+  REQUIRE(overflow[0].node_id == "_overflow");
+  REQUIRE(overflow[0].latency_ns.count >= 3);
+  Metrics::ForgetPlan("_overflow");
+}
+
+TEST_CASE("njs module executions record as their own series", "[metrics][njs]") {
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 2; ++t) {
+    workers.emplace_back([] {
+      for (int i = 1; i <= 10; ++i) {
+        Metrics::RecordNjsModule("metrics_module@1.0.0", std::chrono::microseconds(i),
+                                 std::chrono::microseconds(1), i == 10);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  const NjsModuleMetrics* module = nullptr;
+  auto modules = Metrics::NjsModuleSnapshot();
+  for (const auto& entry : modules) {
+    if (entry.module == "metrics_module@1.0.0") {
+      module = &entry;
+    }
+  }
+  REQUIRE(module);
+  REQUIRE(module->latency_ns.count == 20);
+  REQUIRE(module->latency_ns.max == 10000);
+  REQUIRE(module->cpu_ns == 20000);
+  REQUIRE(module->budget_exceeded == 2);
+  for (const auto& series : Metrics::Snapshot()) {
+    REQUIRE(series.node_id != "metrics_module@1.0.0");  // Not a node series
+  }
+
+  std::ostringstream out;
+  Metrics::WritePrometheus(out);
+  REQUIRE_THAT(out.str(), ContainsSubstring(
+      "rankdsl_njs_module_budget_exceeded_total{module=\"metrics_module@1.0.0\"} 2\n"));
+  REQUIRE_THAT(out.str(), ContainsSubstring(
+      "rankdsl_njs_module_cpu_seconds_total{module=\"metrics_module@1.0.0\"} 0.000020000\n"));
+}
+
+TEST_CASE("Executed nodes are recorded and exported to a file", "[metrics][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "metrics_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 20}},
+      {"id": "top", "op": "core:topk", "inputs": ["src"], "params": {"k": 5, "key": 3001}}
+    ]
+  })"), plan, &error));
+  PlanCompiler compiler(registry);
+  compiler.DisableLimitPushdown();
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+
+  Executor executor(registry);
+  for (int i = 0; i < 3; ++i) {
+    executor.Execute(compiled, &error);
+  }
+
+  auto series = SeriesOf("metrics_plan");
+  REQUIRE(series.size() == 2);
+  REQUIRE(series[0].node_id == "src");
+  REQUIRE(series[0].op == "core:sourcer");
+  REQUIRE(series[0].latency_ns.count == 3);
+  REQUIRE(series[0].rows_out == 60);
+  REQUIRE(series[1].rows_in == 60);
+  REQUIRE(series[1].rows_out == 15);
+
+  std::string path = "metrics_test.prom";
+  REQUIRE(Metrics::WritePrometheusFile(path, &error));
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  REQUIRE_THAT(contents.str(), ContainsSubstring(
+      "rankdsl_node_rows_out_total{plan=\"metrics_plan\",node=\"top\",op=\"core:topk\"} 15\n"));
+  std::remove(path.c_str());
+
+  // Periodic export rewrites the file until stopped
+  MetricsExportOptions options;
+  options.path = path;
+  options.interval = std::chrono::milliseconds(1);
+  REQUIRE(Metrics::StartExport(options, &error));
+  executor.Execute(compiled, &error);
+  Metrics::StopExport();
+  std::ifstream exported(path);
+  std::stringstream latest;
+  latest << exported.rdbuf();
+  REQUIRE_THAT(latest.str(), ContainsSubstring(
+      "rankdsl_node_rows_out_total{plan=\"metrics_plan\",node=\"top\",op=\"core:topk\"} 20\n"));
+  std::remove(path.c_str());
+
+  REQUIRE_FALSE(Metrics::WritePrometheusFile("/nonexistent/dir/metrics.prom", &error));
+  REQUIRE_THAT(error, ContainsSubstring("Cannot write metrics file"));
+}
@@ -3,12 +3,22 @@
 #include <catch2/matchers/catch_matchers_string.hpp>
 
 #include "nodes/js/njs_runner.h"
+#include "nodes/js/njs_bytecode.h"
+#include "nodes/js/njs_bytecode_registry.h"
 #include "nodes/js/batch_context.h"
 #include "object/column_batch.h"
 #include "object/batch_builder.h"
 #include "object/typed_column.h"
 #include "keys/registry.h"
+#include "logging/metrics.h"
+#include "executor/executor.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
 #include "keys.h"
+#include "plan_test_util.h"
+
+#include <fstream>
+#include <sstream>
 
 using namespace ranking_dsl;
 
@@ -221,6 +231,38 @@ TEST_CASE("BatchContext meta.writes enforcement", "[njs][enforcement]") {
   }
 }
 
+TEST_CASE("BatchContext meta.reads enforcement", "[njs][enforcement]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  auto id_col = std::make_shared<I64Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+  batch.SetColumn(keys::id::CAND_CANDIDATE_ID, id_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  BatchBuilder builder(batch);
+  NjsBudget budget;
+  std::set<int32_t> allowed_writes;
+  std::set<int32_t> allowed_reads = {keys::id::SCORE_BASE};  // Only SCORE_BASE allowed
+
+  BatchContext ctx(batch, builder, &registry, allowed_writes, budget, &allowed_reads);
+
+  SECTION("Read of declared key succeeds") {
+    REQUIRE(ctx.GetF32Raw(keys::id::SCORE_BASE).first == score_col->Data());
+    REQUIRE(ctx.RowCount() == 3);
+  }
+
+  SECTION("Read of undeclared key throws, even if the column is present") {
+    REQUIRE_THROWS_WITH(
+        ctx.GetI64Raw(keys::id::CAND_CANDIDATE_ID),
+        Catch::Matchers::ContainsSubstring("not in meta.reads"));
+    REQUIRE_THROWS_WITH(
+        ctx.GetF32(keys::id::SCORE_ML),
+        Catch::Matchers::ContainsSubstring("not in meta.reads"));
+  }
+}
+
 TEST_CASE("BatchContext budget enforcement", "[njs][budget]") {
   ColumnBatch batch(100);  // 100 rows
 
@@ -296,6 +338,7 @@ TEST_CASE("NjsRunner with column function", "[njs][runner]") {
 
   SECTION("Column-level function writes new column via zero-copy API") {
     NjsMeta meta;
+    meta.reads = {keys::id::SCORE_BASE};
     meta.writes = {keys::id::SCORE_FINAL};
     meta.budget.max_write_bytes = 1000000;
     meta.budget.max_write_cells = 1000;
@@ -328,6 +371,7 @@ TEST_CASE("NjsRunner with column function", "[njs][runner]") {
 
   SECTION("HasColumnWrites tracks usage") {
     NjsMeta meta;
+    meta.reads = {keys::id::SCORE_BASE};
     meta.writes = {keys::id::SCORE_FINAL};
 
     nlohmann::json params;
@@ -383,6 +427,15 @@ TEST_CASE("NjsMeta parsing", "[njs][meta]") {
     REQUIRE(meta.writes.empty());
     REQUIRE(meta.budget.max_write_bytes == 1048576);  // 1MB default
     REQUIRE(meta.budget.max_write_cells == 100000);   // 100k default
+    REQUIRE(meta.budget.max_cpu_ms == 50);            // 50ms default
+  }
+
+  SECTION("Parse CPU budget") {
+    auto j = nlohmann::json::parse(R"({"name": "cpu", "budget": {"max_cpu_ms": 5}})");
+
+    NjsMeta meta = NjsMeta::Parse(j);
+
+    REQUIRE(meta.budget.max_cpu_ms == 5);
   }
 }
 
@@ -396,6 +449,16 @@ static std::string GetTestDataDir() {
   return "engine/tests/testdata/";
 }
 
+// Merged metrics of one njs module (empty if it never ran)
+static NjsModuleMetrics ModuleMetrics(const std::string& module_key) {
+  for (auto& module : Metrics::NjsModuleSnapshot()) {
+    if (module.module == module_key) {
+      return module;
+    }
+  }
+  return NjsModuleMetrics{};
+}
+
 TEST_CASE("QuickJS execution - valid module", "[njs][quickjs]") {
   // Create input batch with score.base column (key 3001)
   auto score_col = std::make_shared<F32Column>(3);
@@ -459,6 +522,29 @@ TEST_CASE("QuickJS execution - unauthorized write fails", "[njs][quickjs][enforc
       Catch::Matchers::ContainsSubstring("not in meta.writes"));
 }
 
+TEST_CASE("QuickJS execution - undeclared read fails", "[njs][quickjs][enforcement]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+
+  NjsRunner runner;
+
+  nlohmann::json params;
+  params["module"] = GetTestDataDir() + "undeclared_read.njs";
+
+  // The module reads score.base without declaring it; the compiler would have
+  // pruned that column, so the read must fail rather than see a missing column
+  REQUIRE_THROWS_WITH(
+      runner.Run(exec_ctx, batch, params),
+      Catch::Matchers::ContainsSubstring("not in meta.reads"));
+}
+
 TEST_CASE("QuickJS execution - budget exceeded fails", "[njs][quickjs][budget]") {
   // Create a large input batch (100 rows) to exceed the budget
   auto score_col = std::make_shared<F32Column>(100);
@@ -546,6 +632,147 @@ TEST_CASE("NjsPolicy parsing", "[njs][policy]") {
     REQUIRE(policy.IsIoCsvReadAllowed("any_version", "1.0.0"));
     REQUIRE(policy.IsIoCsvReadAllowed("any_version", "2.0.0"));
   }
+
+  SECTION("CPU cap defaults and overrides") {
+    REQUIRE(policy.MaxCpuMs() == NjsPolicy::kDefaultMaxCpuMs);
+
+    std::string json = R"({
+      "max_cpu_ms": 100,
+      "modules": [
+        {"name": "heavy", "version": "1.0.0", "max_cpu_ms": 400}
+      ]
+    })";
+    std::string error;
+    REQUIRE(policy.LoadFromJson(json, &error));
+
+    REQUIRE(policy.MaxCpuMs() == 100);
+    REQUIRE(policy.MaxCpuMs("heavy", "1.0.0") == 400);
+    REQUIRE(policy.MaxCpuMs("heavy", "2.0.0") == 100);
+    REQUIRE(policy.MaxCpuMs("other", "1.0.0") == 100);
+  }
+
+  SECTION("Non-positive CPU caps are rejected") {
+    std::string error;
+    REQUIRE_FALSE(policy.LoadFromJson(R"({"max_cpu_ms": 0})", &error));
+    REQUIRE(error == "max_cpu_ms must be positive");
+    REQUIRE(policy.MaxCpuMs() == NjsPolicy::kDefaultMaxCpuMs);
+    REQUIRE_FALSE(policy.LoadFromJson(
+        R"({"modules": [{"name": "heavy", "max_cpu_ms": -1}]})", &error));
+    REQUIRE(error == "max_cpu_ms of module heavy must be positive");
+  }
+}
+
+// ============================================================================
+// CPU Budget and Latency Tests
+// ============================================================================
+
+TEST_CASE("QuickJS execution - CPU budget exceeded fails", "[njs][quickjs][budget]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+
+  NjsModuleMetrics before = ModuleMetrics("cpu_budget_exceeded@1.0.0");
+
+  NjsRunner runner;
+
+  nlohmann::json params;
+  params["module"] = GetTestDataDir() + "cpu_budget_exceeded.njs";
+
+  // The module loops forever; meta.budget.max_cpu_ms = 20 stops it
+  REQUIRE_THROWS_WITH(
+      runner.Run(exec_ctx, batch, params),
+      Catch::Matchers::ContainsSubstring("max_cpu_ms=20"));
+
+  NjsModuleMetrics after = ModuleMetrics("cpu_budget_exceeded@1.0.0");
+  REQUIRE(after.latency_ns.count == before.latency_ns.count + 1);
+  REQUIRE(after.budget_exceeded == before.budget_exceeded + 1);
+  REQUIRE(after.cpu_ns - before.cpu_ns >= 20'000'000);
+}
+
+TEST_CASE("QuickJS execution - policy caps CPU budget", "[njs][quickjs][budget][policy]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+
+  NjsPolicy policy;
+  policy.LoadFromJson(R"({"max_cpu_ms": 5})");
+
+  NjsRunner runner;
+  runner.SetPolicy(&policy);
+
+  nlohmann::json params;
+  params["module"] = GetTestDataDir() + "cpu_budget_exceeded.njs";
+
+  // meta asks for 20ms, but the policy caps it at 5ms
+  REQUIRE_THROWS_WITH(
+      runner.Run(exec_ctx, batch, params),
+      Catch::Matchers::ContainsSubstring("max_cpu_ms=5"));
+}
+
+TEST_CASE("QuickJS execution - request deadline stops module", "[njs][quickjs][deadline]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+  exec_ctx.deadline = std::chrono::steady_clock::now();  // Already expired
+
+  NjsRunner runner;
+
+  nlohmann::json params;
+  params["module"] = GetTestDataDir() + "cpu_budget_exceeded.njs";
+
+  REQUIRE_THROWS_WITH(
+      runner.Run(exec_ctx, batch, params),
+      Catch::Matchers::ContainsSubstring("request deadline"));
+}
+
+TEST_CASE("QuickJS execution - latency recorded per module", "[njs][quickjs][latency]") {
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+
+  NjsRunner runner;
+
+  nlohmann::json params;
+  params["module"] = GetTestDataDir() + "valid_module.njs";
+
+  const std::string module_key = "valid_module@1.0.0";
+  NjsModuleMetrics before = ModuleMetrics(module_key);
+  runner.Run(exec_ctx, batch, params);
+  runner.Run(exec_ctx, batch, params);
+
+  NjsModuleMetrics after = ModuleMetrics(module_key);
+  REQUIRE(after.latency_ns.count == before.latency_ns.count + 2);
+  REQUIRE(after.budget_exceeded == before.budget_exceeded);
+  REQUIRE(after.latency_ns.ValueAtQuantile(0.99) <= after.latency_ns.max);
+
+  std::ostringstream out;
+  Metrics::WritePrometheus(out);
+  REQUIRE_THAT(out.str(), Catch::Matchers::ContainsSubstring(
+                              "rankdsl_njs_module_latency_seconds_count{module=\"" + module_key));
 }
 
 TEST_CASE("NjsMeta parsing with capabilities", "[njs][meta][capabilities]") {
@@ -808,3 +1035,206 @@ TEST_CASE("Sandbox: zero IO budget means no IO allowed", "[njs][sandbox][accepta
       runner.Run(exec_ctx, batch, params),
       Catch::Matchers::ContainsSubstring("IO budget not configured"));
 }
+
+// ============================================================================
+// Precompiled Bytecode Tests
+// ============================================================================
+
+TEST_CASE("QuickJS execution - precompiled bytecode by digest", "[njs][quickjs][bytecode]") {
+  std::ifstream file(GetTestDataDir() + "valid_module.njs");
+  REQUIRE(file.is_open());
+  std::stringstream source;
+  source << file.rdbuf();
+
+  std::string error;
+  static std::vector<uint8_t> bytecode;  // Must outlive the registry entry
+  bytecode = CompileNjsBytecode(source.str(), "precompiled/valid_module.njs", &error);
+  REQUIRE(error.empty());
+  REQUIRE_FALSE(bytecode.empty());
+
+  NjsBytecodeRegistry::Instance().Register(
+      {"00c0ffee00c0ffee", "precompiled/valid_module.njs", bytecode.data(), bytecode.size()});
+
+  auto score_col = std::make_shared<F32Column>(3);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::SCORE_BASE, score_col);
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  ExecContext exec_ctx;
+  exec_ctx.registry = &registry;
+
+  // Embedded modules run even when the policy forbids filesystem loads
+  NjsPolicy policy;
+  policy.LoadFromJson(R"({"require_embedded": true})");
+
+  NjsRunner runner;
+  runner.SetPolicy(&policy);
+
+  SECTION("Resolve by digest without a module path") {
+    nlohmann::json params;
+    params["digest"] = "00c0ffee00c0ffee";
+
+    CandidateBatch result = runner.Run(exec_ctx, batch, params);
+
+    auto* ml_col = result.GetF32Column(keys::id::SCORE_ML);
+    REQUIRE(ml_col != nullptr);
+    REQUIRE(ml_col->Get(0) == Catch::Approx(42.0f));
+  }
+
+  SECTION("Resolve by registered path") {
+    nlohmann::json params;
+    params["module"] = "precompiled/valid_module.njs";
+
+    CandidateBatch result = runner.Run(exec_ctx, batch, params);
+
+    REQUIRE(result.HasColumn(keys::id::SCORE_ML));
+  }
+
+  SECTION("An unknown digest fails instead of falling back to the path") {
+    NjsRunner unrestricted;
+    nlohmann::json params;
+    params["digest"] = "badbadbadbadbad0";
+    params["module"] = "precompiled/valid_module.njs";
+
+    REQUIRE_THROWS_WITH(
+        unrestricted.Run(exec_ctx, batch, params),
+        Catch::Matchers::ContainsSubstring("No precompiled njs module with digest: badbadbadbadbad0"));
+
+    params["module"] = GetTestDataDir() + "valid_module.njs";
+    REQUIRE_THROWS_WITH(
+        unrestricted.Run(exec_ctx, batch, params),
+        Catch::Matchers::ContainsSubstring("No precompiled njs module with digest"));
+  }
+
+  SECTION("require_embedded rejects modules loaded from disk") {
+    nlohmann::json params;
+    params["module"] = GetTestDataDir() + "valid_module.njs";
+
+    REQUIRE_THROWS_WITH(
+        runner.Run(exec_ctx, batch, params),
+        Catch::Matchers::ContainsSubstring("not precompiled"));
+  }
+}
+
+TEST_CASE("CompileNjsBytecode reports syntax errors", "[njs][bytecode]") {
+  std::string error;
+  auto bytecode = CompileNjsBytecode("exports.meta = {", "broken.njs", &error);
+
+  REQUIRE(bytecode.empty());
+  REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("njs compile failed"));
+}
+
+TEST_CASE("LoadNjsMeta reads module meta without running it", "[njs][meta]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  SECTION("Reads and writes come from meta") {
+    nlohmann::json params;
+    params["module"] = GetTestDataDir() + "valid_module.njs";
+
+    NjsMeta meta;
+    std::string error;
+    REQUIRE(LoadNjsMeta(params, &registry, meta, &error));
+    REQUIRE(meta.reads.count(keys::id::SCORE_BASE) == 1);
+    REQUIRE(meta.writes.count(keys::id::SCORE_ML) == 1);
+  }
+
+  SECTION("Missing module is reported") {
+    nlohmann::json params;
+    params["module"] = GetTestDataDir() + "does_not_exist.njs";
+
+    NjsMeta meta;
+    std::string error;
+    REQUIRE_FALSE(LoadNjsMeta(params, &registry, meta, &error));
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("Failed to open"));
+  }
+}
+
+TEST_CASE("njs plans compile and execute end to end", "[njs][quickjs][plan]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Executor executor(registry);
+
+  // sourcer -> njs; only score.ml is returned, so liveness prunes by meta.reads
+  auto make_plan = [](const std::string& module) {
+    return nlohmann::json{
+      {"name", "njs_e2e"},
+      {"nodes", nlohmann::json::array({
+        {{"id", "src"}, {"op", "core:sourcer"}, {"params", {{"k", 4}}}},
+        {{"id", "js"}, {"op", "njs"}, {"inputs", {"src"}},
+         {"params", {{"module", GetTestDataDir() + module}}}},
+      })},
+      {"output_keys", {keys::id::SCORE_ML}},
+    };
+  };
+
+  SECTION("Declared reads stay live and the module runs") {
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(make_plan("valid_module.njs")));
+    const ColumnLiveness& src = compiled.liveness[compiled.graph.IndexOf("src")];
+    REQUIRE(src.prune);
+    REQUIRE(src.live_keys == std::vector<int32_t>{keys::id::SCORE_BASE});
+
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(error.empty());
+    REQUIRE(result.RowCount() == 4);
+    auto* ml_col = result.GetF32Column(keys::id::SCORE_ML);
+    REQUIRE(ml_col != nullptr);
+    REQUIRE(ml_col->Get(3) == Catch::Approx(42.0f));
+  }
+
+  SECTION("An undeclared read fails instead of seeing a pruned column") {
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(make_plan("undeclared_read.njs")));
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(result.RowCount() == 0);
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("js: "));
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("not in meta.reads"));
+  }
+
+  SECTION("A module past its CPU budget fails the request") {
+    CompiledPlan compiled =
+        CompileOrFail(registry, ParseOrFail(make_plan("cpu_budget_exceeded.njs")));
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(result.RowCount() == 0);
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("max_cpu_ms=20"));
+  }
+
+  SECTION("The request's njs policy caps the CPU budget") {
+    CompiledPlan compiled =
+        CompileOrFail(registry, ParseOrFail(make_plan("cpu_budget_exceeded.njs")));
+    NjsPolicy policy;
+    REQUIRE(policy.LoadFromJson(R"({"max_cpu_ms": 5})"));
+    ExecContext ctx;
+    ctx.njs_policy = &policy;
+    std::string error;
+    executor.Execute(compiled, ctx, &error);
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("max_cpu_ms=5"));
+  }
+
+  SECTION("require_embedded in the request's policy rejects disk modules") {
+    CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(make_plan("valid_module.njs")));
+    NjsPolicy policy;
+    REQUIRE(policy.LoadFromJson(R"({"require_embedded": true})"));
+    ExecContext ctx;
+    ctx.njs_policy = &policy;
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, ctx, &error);
+    REQUIRE(result.RowCount() == 0);
+    REQUIRE_THAT(error, Catch::Matchers::ContainsSubstring("not precompiled"));
+  }
+
+  SECTION("A module past the request deadline fails the request") {
+    CompiledPlan compiled =
+        CompileOrFail(registry, ParseOrFail(make_plan("cpu_budget_exceeded.njs")));
+    ExecContext ctx;
+    ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, ctx, &error);
+    REQUIRE(result.RowCount() == 0);
+    REQUIRE_FALSE(error.empty());
+  }
+}
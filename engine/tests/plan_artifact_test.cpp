@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "plan/artifact.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+const char* kPlan = R"({
+  "name": "artifact",
+  "version": 3,
+  "meta": {"env": "test"},
+  "nodes": [
+    {"id": "src", "op": "core:sourcer", "params": {"name": "main", "k": 40}, "trace_key": "src.main"},
+    {"id": "feat", "op": "core:features", "inputs": ["src"]},
+    {"id": "model", "op": "core:model", "inputs": ["feat"], "params": {"model_id": "default"}},
+    {"id": "final", "op": "core:score_formula", "inputs": ["model"],
+     "params": {"expr": {"op": "add", "args": [
+       {"op": "signal", "key_id": 3001},
+       {"op": "mul", "args": [{"op": "const", "value": 0.5}, {"op": "signal", "key_id": 3002}]}]}}},
+    {"id": "debug", "op": "core:features", "inputs": ["src"], "params": {"debug": true}},
+    {"id": "top", "op": "core:topk", "inputs": ["final"], "params": {"k": 10}}
+  ],
+  "logging": {"sample_rate": 0.25, "dump_keys": [3002]},
+  "outputs": ["top"],
+  "output_keys": [1001, 3999]
+})";
+
+}  // namespace
+
+TEST_CASE("Plan artifact round trip", "[plan][artifact]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileOrFail(registry, ParseOrFail(kPlan));
+  std::vector<uint8_t> bytes = SerializePlanArtifact(compiled, registry);
+
+  SECTION("Restores the compiled plan") {
+    CompiledPlan loaded;
+    std::string error;
+    REQUIRE(DeserializePlanArtifact(bytes.data(), bytes.size(), registry, loaded, &error));
+
+    REQUIRE(loaded.plan.name == "artifact");
+    REQUIRE(loaded.plan.version == 3);
+    REQUIRE(loaded.plan.meta.env == "test");
+    REQUIRE(loaded.plan.logging.sample_rate == 0.25f);
+    REQUIRE(loaded.plan.logging.dump_keys == compiled.plan.logging.dump_keys);
+    REQUIRE(loaded.plan.output_keys == compiled.plan.output_keys);
+    REQUIRE(loaded.plan.nodes.size() == compiled.plan.nodes.size());
+    for (size_t i = 0; i < compiled.plan.nodes.size(); ++i) {
+      REQUIRE(loaded.plan.nodes[i].id == compiled.plan.nodes[i].id);
+      REQUIRE(loaded.plan.nodes[i].inputs == compiled.plan.nodes[i].inputs);
+      REQUIRE(loaded.plan.nodes[i].params == compiled.plan.nodes[i].params);
+      REQUIRE(loaded.plan.nodes[i].trace_key == compiled.plan.nodes[i].trace_key);
+    }
+
+    REQUIRE(loaded.topo_order == compiled.topo_order);
+    REQUIRE(loaded.sinks == compiled.sinks);
+    REQUIRE(loaded.pruned_nodes == std::vector<std::string>{"debug"});
+    REQUIRE(loaded.diagnostics == compiled.diagnostics);
+    REQUIRE(loaded.graph.IndexOf("final") == compiled.graph.IndexOf("final"));
+    REQUIRE(loaded.graph.input_edges == compiled.graph.input_edges);
+    REQUIRE(loaded.graph.output_offsets == compiled.graph.output_offsets);
+    REQUIRE(loaded.fused_chain_of == compiled.fused_chain_of);
+    REQUIRE(loaded.fused_chains.size() == compiled.fused_chains.size());
+    REQUIRE(loaded.last_consumer == compiled.last_consumer);
+    REQUIRE(loaded.input_schemas == compiled.input_schemas);
+    for (size_t i = 0; i < compiled.liveness.size(); ++i) {
+      REQUIRE(loaded.liveness[i].prune == compiled.liveness[i].prune);
+      REQUIRE(loaded.liveness[i].live_keys == compiled.liveness[i].live_keys);
+    }
+    REQUIRE(loaded.complexity.max_depth == compiled.complexity.max_depth);
+    REQUIRE(loaded.complexity.longest_path == compiled.complexity.longest_path);
+
+    Executor executor(registry);
+    CandidateBatch expected = executor.Execute(compiled, &error);
+    CandidateBatch actual = executor.Execute(loaded, &error);
+    REQUIRE(error.empty());
+    REQUIRE(actual.RowCount() == 10);
+    for (size_t i = 0; i < actual.RowCount(); ++i) {
+      REQUIRE(actual.GetValue(i, keys::id::CAND_CANDIDATE_ID) ==
+              expected.GetValue(i, keys::id::CAND_CANDIDATE_ID));
+    }
+  }
+
+  SECTION("Rejects corruption and truncation") {
+    std::string error;
+    CompiledPlan loaded;
+    std::vector<uint8_t> corrupt = bytes;
+    corrupt.back() ^= 0xff;
+    REQUIRE_FALSE(DeserializePlanArtifact(corrupt.data(), corrupt.size(), registry, loaded, &error));
+    REQUIRE(error == "Invalid plan artifact: checksum mismatch");
+
+    REQUIRE_FALSE(DeserializePlanArtifact(bytes.data(), bytes.size() - 1, registry, loaded, &error));
+    REQUIRE(error == "Invalid plan artifact: payload size mismatch");
+
+    REQUIRE_FALSE(DeserializePlanArtifact(bytes.data(), 4, registry, loaded, &error));
+    REQUIRE(error == "Invalid plan artifact: truncated header");
+  }
+
+  SECTION("Rejects a different key registry") {
+    KeyRegistry other;
+    REQUIRE(other.LoadFromJson(R"({"version": 1, "keys": []})"));
+    CompiledPlan loaded;
+    std::string error;
+    REQUIRE_FALSE(DeserializePlanArtifact(bytes.data(), bytes.size(), other, loaded, &error));
+    REQUIRE(error == "Invalid plan artifact: built against a different key registry");
+  }
+
+  SECTION("File round trip") {
+    auto path = std::filesystem::temp_directory_path() / "rankdsl_artifact_test.rdslplan";
+    std::string error;
+    REQUIRE(WritePlanArtifact(compiled, registry, path.string(), &error));
+    REQUIRE(IsPlanArtifactFile(path.string()));
+
+    CompiledPlan loaded;
+    REQUIRE(LoadPlanArtifact(path.string(), registry, loaded, &error));
+    REQUIRE(loaded.topo_order == compiled.topo_order);
+    std::filesystem::remove(path);
+  }
+}
+
+TEST_CASE("Key registry fingerprint covers f32vec dims", "[plan][artifact]") {
+  auto registry_json = [](int dim) {
+    return "{\"version\": 1, \"keys\": [{\"id\": 2002, \"name\": \"feat.embedding\", "
+           "\"type\": \"f32vec\", \"dim\": " + std::to_string(dim) +
+           ", \"scope\": \"feature\", \"owner\": \"test\", \"doc\": \"\"}]}";
+  };
+  KeyRegistry narrow;
+  KeyRegistry wide;
+  REQUIRE(narrow.LoadFromJson(registry_json(64)));
+  REQUIRE(wide.LoadFromJson(registry_json(128)));
+  REQUIRE(KeyRegistryFingerprint(narrow) != KeyRegistryFingerprint(wide));
+  REQUIRE(KeyRegistryFingerprint(narrow) == KeyRegistryFingerprint(narrow));
+}
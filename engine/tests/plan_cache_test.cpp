@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "keys/registry.h"
+#include "plan/plan.h"
+#include "plan/plan_cache.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+Plan MakePlan(int k, const char* params_order = "name_first") {
+  json params = std::string(params_order) == "name_first"
+                    ? json::parse(R"({"name": "main", "k": 0})")
+                    : json::parse(R"({"k": 0, "name": "main"})");
+  params["k"] = k;
+  json j = {
+    {"name", "cached"},
+    {"nodes", json::array({
+      {{"id", "src"}, {"op", "core:sourcer"}, {"params", params}},
+      {{"id", "final"}, {"op", "core:score_formula"}, {"inputs", {"src"}}},
+    })},
+  };
+  Plan plan;
+  REQUIRE(ParsePlan(j, plan));
+  return plan;
+}
+
+}  // namespace
+
+TEST_CASE("Plan content hash", "[plan][cache]") {
+  REQUIRE(PlanContentHash(MakePlan(10)) == PlanContentHash(MakePlan(10, "k_first")));
+  REQUIRE(PlanContentHash(MakePlan(10)) != PlanContentHash(MakePlan(11)));
+
+  ComplexityBudget budget = ComplexityBudget::Default();
+  uint64_t base = ComplexityBudgetHash(budget);
+  budget.max_depth_hard += 1;
+  REQUIRE(ComplexityBudgetHash(budget) != base);
+
+  CostModel model = CostModel::Default();
+  uint64_t model_hash = CostModelHash(model);
+  model.ops["core:sourcer"].per_row_ms *= 2;
+  REQUIRE(CostModelHash(model) != model_hash);
+}
+
+TEST_CASE("Plan content hash covers njs module source", "[plan][cache][njs]") {
+  auto path = std::filesystem::temp_directory_path() / "rankdsl_cache_test.njs";
+  auto write_module = [&](const char* source) {
+    std::ofstream file(path, std::ios::trunc);
+    file << source;
+  };
+  json j = {
+    {"name", "njs_cached"},
+    {"nodes", json::array({
+      {{"id", "src"}, {"op", "core:sourcer"}, {"params", {{"k", 10}}}},
+      {{"id", "js"}, {"op", "njs"}, {"inputs", {"src"}},
+       {"params", {{"module", path.string()}}}},
+    })},
+  };
+  Plan plan;
+  REQUIRE(ParsePlan(j, plan));
+
+  write_module("exports.meta = {writes: [Keys.SCORE_ML]};");
+  uint64_t before = PlanContentHash(plan);
+  REQUIRE(PlanContentHash(plan) == before);
+
+  // Same params, edited module: a cached plan would run stale liveness and meta
+  write_module("exports.meta = {writes: [Keys.SCORE_FINAL]};");
+  uint64_t edited = PlanContentHash(plan);
+  REQUIRE(edited != before);
+
+  // Unchanged mtime and size: the memoized source hash is reused, not re-read
+  auto mtime = std::filesystem::last_write_time(path);
+  write_module("exports.meta = {reads:  [Keys.SCORE_FINAL]};");  // Same length
+  std::filesystem::last_write_time(path, mtime);
+  REQUIRE(PlanContentHash(plan) == edited);
+
+  std::filesystem::last_write_time(path, mtime + std::chrono::seconds(1));
+  REQUIRE(PlanContentHash(plan) != edited);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Plan cache", "[plan][cache]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCache cache(registry);
+
+  SECTION("Identical plans share one compiled instance") {
+    auto first = cache.GetOrCompile(MakePlan(10));
+    auto second = cache.GetOrCompile(MakePlan(10, "k_first"));
+    REQUIRE(first);
+    REQUIRE(first == second);
+    REQUIRE(cache.GetOrCompile(MakePlan(20)) != first);
+
+    auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.entries == 2);
+  }
+
+  SECTION("Concurrent lookups compile once") {
+    Plan plan = MakePlan(30);
+    std::vector<std::shared_ptr<const CompiledPlan>> results(8);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < results.size(); ++i) {
+      workers.emplace_back([&, i] { results[i] = cache.GetOrCompile(plan); });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (const auto& result : results) {
+      REQUIRE(result == results.front());
+    }
+    REQUIRE(cache.GetStats().misses == 1);
+  }
+
+  SECTION("Compiles use the cache's cost model") {
+    ComplexityBudget budget = ComplexityBudget::Default();
+    budget.estimated_ms_hard = 1.0;
+    CostModel slow = CostModel::Default();
+    slow.ops["core:sourcer"].fixed_ms = 5.0;
+
+    PlanCache default_model(registry, budget);
+    PlanCache slow_model(registry, budget, slow);
+    REQUIRE(default_model.GetOrCompile(MakePlan(10)));
+    std::string error;
+    REQUIRE_FALSE(slow_model.GetOrCompile(MakePlan(10), &error));
+    REQUIRE(error.find("estimated_ms=5.") != std::string::npos);
+  }
+
+  SECTION("Compile errors are reported and not cached") {
+    Plan plan = MakePlan(10);
+    plan.nodes[1].inputs = {"missing"};
+    std::string error;
+    REQUIRE_FALSE(cache.GetOrCompile(plan, &error));
+    REQUIRE(error == "Node 'final' has unknown input: missing");
+    REQUIRE_FALSE(cache.GetOrCompile(plan));
+    auto stats = cache.GetStats();
+    REQUIRE(stats.failures == 2);
+    REQUIRE(stats.entries == 0);
+  }
+
+  SECTION("Hot swap keeps in-flight snapshots") {
+    REQUIRE(cache.Current("feed") == nullptr);
+    REQUIRE(cache.Publish("feed", MakePlan(10)));
+    auto in_flight = cache.Current("feed");
+    REQUIRE(in_flight->plan.nodes[0].params["k"] == 10);
+
+    REQUIRE(cache.Publish("feed", MakePlan(20)));
+    REQUIRE(cache.Current("feed")->plan.nodes[0].params["k"] == 20);
+    REQUIRE(in_flight->plan.nodes[0].params["k"] == 10);
+
+    // A failed publish leaves the current version in place
+    Plan broken = MakePlan(30);
+    broken.nodes[1].inputs = {"missing"};
+    REQUIRE_FALSE(cache.Publish("feed", broken));
+    REQUIRE(cache.Current("feed")->plan.nodes[0].params["k"] == 20);
+  }
+
+  SECTION("Capacity evicts the oldest entries") {
+    PlanCache small(registry, std::nullopt, std::nullopt, 2);
+    auto kept = small.GetOrCompile(MakePlan(1));
+    small.GetOrCompile(MakePlan(2));
+    small.GetOrCompile(MakePlan(3));
+    REQUIRE(small.GetStats().entries == 2);
+    REQUIRE(kept->plan.nodes[0].params["k"] == 1);  // Still owned by the caller
+    REQUIRE(small.GetOrCompile(MakePlan(1)) != kept);
+  }
+}
@@ -2,8 +2,12 @@
 
 #include <nlohmann/json.hpp>
 
+#include "executor/executor.h"
+#include "plan/artifact.h"
 #include "plan/plan.h"
 #include "plan/compiler.h"
+#include "plan/graph.h"
+#include "keys.h"
 #include "keys/registry.h"
 #include "logging/trace.h"
 
@@ -272,3 +276,213 @@ TEST_CASE("Tracer span naming", "[trace]") {
     REQUIRE(Tracer::DeriveTracePrefix("path\\to\\module.njs") == "module");
   }
 }
+
+TEST_CASE("Dead-node elimination", "[plan][prune]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  PlanCompiler compiler(registry);
+
+  // "experiment" branches off the sourcer but never reaches "final"
+  auto j = json::parse(R"({
+    "name": "branches",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 4}},
+      {"id": "experiment", "op": "core:features", "inputs": ["src"], "params": {"keys": [2002]}},
+      {"id": "final", "op": "core:score_formula", "inputs": ["src"], "params": {}}
+    ]
+  })");
+
+  SECTION("Default sink is the last node; unreachable nodes are pruned") {
+    Plan plan;
+    REQUIRE(ParsePlan(j, plan));
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+
+    REQUIRE(compiled.sinks == std::vector<std::string>{"final"});
+    REQUIRE(compiled.topo_order == std::vector<std::string>{"src", "final"});
+    REQUIRE(compiled.pruned_nodes == std::vector<std::string>{"experiment"});
+    REQUIRE(compiled.diagnostics.find("experiment (op: core:features)") != std::string::npos);
+  }
+
+  SECTION("Named outputs keep every sink") {
+    j["outputs"] = {"final", "experiment"};
+    Plan plan;
+    REQUIRE(ParsePlan(j, plan));
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+
+    REQUIRE(compiled.sinks == std::vector<std::string>{"final", "experiment"});
+    REQUIRE(compiled.pruned_nodes.empty());
+    REQUIRE(compiled.diagnostics.empty());
+
+    Executor executor(registry);
+    std::string error;
+    auto outputs = executor.ExecuteOutputs(compiled, ExecContext{}, &error);
+    REQUIRE(error.empty());
+    REQUIRE(outputs.size() == 2);
+    REQUIRE(outputs["final"].HasColumn(keys::id::SCORE_FINAL));
+    REQUIRE(outputs["experiment"].HasColumn(keys::id::FEAT_EMBEDDING));
+
+    // Execute returns the first named output
+    CandidateBatch primary = executor.Execute(compiled, &error);
+    REQUIRE(primary.HasColumn(keys::id::SCORE_FINAL));
+    REQUIRE_FALSE(primary.HasColumn(keys::id::FEAT_EMBEDDING));
+  }
+
+  SECTION("Unknown output node is rejected") {
+    j["outputs"] = {"missing"};
+    Plan plan;
+    REQUIRE(ParsePlan(j, plan));
+    CompiledPlan compiled;
+    std::string error;
+    REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(error == "Unknown output node: missing");
+  }
+}
+
+TEST_CASE("Plan graph interning", "[plan][graph]") {
+  auto j = json::parse(R"({
+    "name": "diamond",
+    "nodes": [
+      {"id": "d", "op": "core:merge", "inputs": ["b", "c"]},
+      {"id": "a", "op": "core:sourcer"},
+      {"id": "b", "op": "core:features", "inputs": ["a"]},
+      {"id": "c", "op": "core:model", "inputs": ["a"]}
+    ]
+  })");
+  Plan plan;
+  REQUIRE(ParsePlan(j, plan));
+
+  PlanGraph graph = BuildPlanGraph(plan);
+  REQUIRE(graph.node_count == 4);
+  REQUIRE(graph.edge_count == 4);
+  REQUIRE(graph.IndexOf("a") == 1);
+  REQUIRE(graph.IndexOf("missing") == -1);
+  REQUIRE(graph.InDegree(0) == 2);
+  REQUIRE(graph.OutDegree(1) == 2);
+
+  auto inputs = graph.Inputs(0);
+  REQUIRE(std::vector<int32_t>(inputs.begin(), inputs.end()) == std::vector<int32_t>{2, 3});
+  auto dependents = graph.Dependents(1);
+  REQUIRE(std::vector<int32_t>(dependents.begin(), dependents.end()) ==
+          std::vector<int32_t>{2, 3});
+
+  std::vector<int32_t> order;
+  REQUIRE(TopologicalOrder(graph, order));
+  REQUIRE(order == std::vector<int32_t>{1, 2, 3, 0});
+
+  SECTION("Unknown inputs fail compilation") {
+    plan.nodes[2].inputs = {"nope"};
+    KeyRegistry registry;
+    registry.LoadFromCompiled();
+    PlanCompiler compiler(registry);
+    CompiledPlan compiled;
+    std::string error;
+    REQUIRE_FALSE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(error == "Node 'b' has unknown input: nope");
+  }
+}
+
+TEST_CASE("Common sub-plan elimination", "[plan][cse]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  auto j = json::parse(R"({
+    "name": "duplicated_branches",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"name": "main", "k": 8}},
+      {"id": "feat1", "op": "core:features", "inputs": ["src"]},
+      {"id": "feat2", "op": "core:features", "inputs": ["src"]},
+      {"id": "model1", "op": "core:model", "inputs": ["feat1"],
+       "params": {"model_id": "default", "version": 2}},
+      {"id": "model2", "op": "core:model", "inputs": ["feat2"],
+       "params": {"version": 2, "model_id": "default"}},
+      {"id": "model3", "op": "core:model", "inputs": ["feat2"],
+       "params": {"model_id": "other"}},
+      {"id": "merge", "op": "core:merge", "inputs": ["model1", "model2", "model3"]}
+    ]
+  })");
+  Plan plan;
+  REQUIRE(ParsePlan(j, plan));
+
+  PlanCompiler compiler(registry);
+  compiler.DisableComplexityCheck();
+
+  SECTION("Duplicates collapse transitively into the first node") {
+    CompiledPlan compiled;
+    std::string error;
+    REQUIRE(compiler.Compile(plan, compiled, &error));
+
+    using Merge = std::pair<std::string, std::string>;
+    REQUIRE(compiled.merged_nodes == std::vector<Merge>{{"feat2", "feat1"}, {"model2", "model1"}});
+    REQUIRE(compiled.plan.nodes.size() == 5);
+    REQUIRE(compiled.graph.node_count == 5);
+
+    const PlanNode& merge = compiled.plan.nodes.back();
+    REQUIRE(merge.inputs == std::vector<std::string>{"model1", "model1", "model3"});
+    REQUIRE(compiled.plan.nodes[compiled.graph.IndexOf("model3")].inputs ==
+            std::vector<std::string>{"feat1"});
+    REQUIRE(compiled.sinks == std::vector<std::string>{"merge"});
+  }
+
+  SECTION("Outputs naming a removed node resolve to the kept node") {
+    plan.outputs = {"model2", "model1"};
+    CompiledPlan compiled;
+    std::string error;
+    REQUIRE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(compiled.sinks == std::vector<std::string>{"model1"});
+    REQUIRE(compiled.pruned_nodes == std::vector<std::string>{"model3", "merge"});
+
+    using Alias = std::pair<std::string, std::string>;
+    REQUIRE(compiled.sink_aliases == std::vector<Alias>{{"model2", "model1"}});
+  }
+
+  SECTION("Every requested output is returned when identical sinks merge") {
+    plan.outputs = {"model1", "model2"};
+    CompiledPlan compiled;
+    std::string error;
+    REQUIRE(compiler.Compile(plan, compiled, &error));
+    REQUIRE(compiled.sinks == std::vector<std::string>{"model1"});
+
+    Executor executor(registry);
+    auto outputs = executor.ExecuteOutputs(compiled, ExecContext{}, &error);
+    REQUIRE(error.empty());
+    REQUIRE(outputs.size() == 2);
+    REQUIRE(outputs["model1"].RowCount() == 8);
+    REQUIRE(outputs["model2"].GetF32Column(keys::id::SCORE_ML) ==
+            outputs["model1"].GetF32Column(keys::id::SCORE_ML));
+
+    // Artifacts keep the alias
+    auto bytes = SerializePlanArtifact(compiled, registry);
+    CompiledPlan loaded;
+    REQUIRE(DeserializePlanArtifact(bytes.data(), bytes.size(), registry, loaded, &error));
+    REQUIRE(loaded.sink_aliases == compiled.sink_aliases);
+    REQUIRE(executor.ExecuteOutputs(loaded, ExecContext{}, &error).count("model2") == 1);
+  }
+
+  SECTION("Different params or inputs are not merged") {
+    plan.nodes[2].params = {{"feature_set", "extra"}};
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    REQUIRE(compiled.merged_nodes.empty());
+    REQUIRE(compiled.plan.nodes.size() == 7);
+  }
+
+  SECTION("Can be disabled") {
+    compiler.DisableSubplanElimination();
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    REQUIRE(compiled.merged_nodes.empty());
+    REQUIRE(compiled.topo_order.size() == 7);
+  }
+
+  SECTION("Merged plan executes") {
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled));
+    Executor executor(registry);
+    std::string error;
+    CandidateBatch result = executor.Execute(compiled, &error);
+    REQUIRE(error.empty());
+    REQUIRE(result.RowCount() > 0);
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * Plan helpers shared by the compiler and executor tests. Each fails the
+ * running test case with the parser or compiler error.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+namespace ranking_dsl {
+
+/**
+ * Compiler rewrites a test can switch off when they would change the rows
+ * or batches under test.
+ */
+enum CompileFlags : unsigned {
+  kAllPasses = 0,
+  kNoFusion = 1u << 0,
+  kNoLimitPushdown = 1u << 1,
+};
+
+inline Plan ParseOrFail(const nlohmann::json& j) {
+  Plan plan;
+  std::string error;
+  if (!ParsePlan(j, plan, &error)) {
+    FAIL(error);
+  }
+  return plan;
+}
+
+inline Plan ParseOrFail(const char* text) {
+  return ParseOrFail(nlohmann::json::parse(text));
+}
+
+inline CompiledPlan CompileOrFail(const KeyRegistry& registry, const Plan& plan,
+                                  unsigned flags = kAllPasses) {
+  PlanCompiler compiler(registry);
+  if (flags & kNoFusion) {
+    compiler.DisableFusion();
+  }
+  if (flags & kNoLimitPushdown) {
+    compiler.DisableLimitPushdown();
+  }
+  CompiledPlan compiled;
+  std::string error;
+  if (!compiler.Compile(plan, compiled, &error)) {
+    FAIL(error);
+  }
+  return compiled;
+}
+
+}  // namespace ranking_dsl
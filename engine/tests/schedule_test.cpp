@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "executor/schedule.h"
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+using Catch::Approx;
+using Catch::Matchers::ContainsSubstring;
+
+namespace {
+
+// src -> {fast, slow} -> join
+CompiledPlan CompileDiamond(const KeyRegistry& registry) {
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "diamond",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 10}},
+      {"id": "fast", "op": "core:features", "inputs": ["src"]},
+      {"id": "slow", "op": "core:model", "inputs": ["src"]},
+      {"id": "join", "op": "core:merge", "inputs": ["fast", "slow"]}
+    ]
+  })"), plan, &error));
+  PlanCompiler compiler(registry);
+  compiler.DisableFusion();
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+  return compiled;
+}
+
+const ScheduleAnalysis::Node& NodeOf(const ScheduleAnalysis& analysis, const std::string& id) {
+  for (const auto& node : analysis.nodes) {
+    if (node.node_id == id) {
+      return node;
+    }
+  }
+  FAIL("no node " << id);
+  return analysis.nodes.front();
+}
+
+}  // namespace
+
+TEST_CASE("Schedule analysis computes slack and unlimited-core latency", "[schedule]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileDiamond(registry);
+  ScheduleAnalysis analysis;
+  std::string error;
+
+  SECTION("Sequential run") {
+    // fast and slow ran one after the other; slow waited 3 ms for a core
+    std::vector<ScheduleSpan> spans = {
+        {"join", 109, 110}, {"src", 100, 101}, {"slow", 104, 109}, {"fast", 101, 104}};
+    REQUIRE(AnalyzeSchedule(compiled, spans, analysis, &error));
+
+    REQUIRE(analysis.nodes.size() == 4);
+    REQUIRE(analysis.nodes.front().node_id == "src");
+    REQUIRE(analysis.nodes.back().node_id == "join");
+    REQUIRE(analysis.total_node_ms == Approx(10.0));
+    REQUIRE(analysis.observed_ms == Approx(10.0));
+    REQUIRE(analysis.unlimited_cores_ms == Approx(7.0));
+
+    REQUIRE(NodeOf(analysis, "slow").wait_ms == Approx(3.0));
+    REQUIRE(NodeOf(analysis, "slow").earliest_start_ms == Approx(1.0));
+    REQUIRE(NodeOf(analysis, "fast").slack_ms == Approx(2.0));
+    REQUIRE(NodeOf(analysis, "fast").latest_start_ms == Approx(3.0));
+    REQUIRE_FALSE(NodeOf(analysis, "fast").critical);
+    REQUIRE(NodeOf(analysis, "join").inputs.size() == 2);
+
+    std::vector<std::string> path;
+    for (size_t i : analysis.critical_path) {
+      REQUIRE(analysis.nodes[i].critical);
+      path.push_back(analysis.nodes[i].node_id);
+    }
+    REQUIRE(path == std::vector<std::string>{"src", "slow", "join"});
+    REQUIRE_THAT(FormatScheduleAnalysis(analysis),
+                 ContainsSubstring("* critical path (7.000 ms): src -> slow -> join"));
+  }
+
+  SECTION("Parallel run matches the unlimited-core bound") {
+    std::vector<ScheduleSpan> spans = {
+        {"src", 0, 1}, {"fast", 1, 4}, {"slow", 1, 6}, {"join", 6, 7}};
+    REQUIRE(AnalyzeSchedule(compiled, spans, analysis, &error));
+    REQUIRE(analysis.observed_ms == Approx(7.0));
+    REQUIRE(analysis.unlimited_cores_ms == Approx(7.0));
+    REQUIRE(NodeOf(analysis, "join").wait_ms == Approx(0.0));
+  }
+
+  SECTION("Spans must name plan nodes once") {
+    REQUIRE_FALSE(AnalyzeSchedule(compiled, {{"nope", 0, 1}}, analysis, &error));
+    REQUIRE_THAT(error, ContainsSubstring("names no node"));
+    REQUIRE_FALSE(AnalyzeSchedule(compiled, {{"src", 0, 1}, {"src", 2, 3}}, analysis, &error));
+    REQUIRE_THAT(error, ContainsSubstring("more than one span"));
+  }
+}
+
+TEST_CASE("Schedules are read from traces and executor stats", "[schedule][executor]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  CompiledPlan compiled = CompileDiamond(registry);
+
+  // Two requests; the last one is analyzed
+  std::istringstream trace(
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"src\",\"ts_us\":500,"
+      "\"duration_ms\":0.5}\n"
+      "{\"event\":\"request_end\",\"plan_name\":\"diamond\",\"ts_us\":600}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"other\",\"node_id\":\"x\",\"ts_us\":900,"
+      "\"duration_ms\":1}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"src\",\"ts_us\":2000,"
+      "\"duration_ms\":1}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"fast+slow\","
+      "\"ts_us\":5000,\"duration_ms\":3}\n"
+      "{\"event\":\"request_end\",\"plan_name\":\"diamond\",\"ts_us\":5100}\n");
+  std::vector<ScheduleSpan> spans;
+  std::string error;
+  REQUIRE(ReadTraceSpans(trace, "diamond", spans, &error));
+  REQUIRE(spans.size() == 2);
+  REQUIRE(spans[0].start_ms == Approx(1.0));
+  REQUIRE(spans[1].end_ms == Approx(5.0));
+
+  // A span covering several nodes (fused chain) counts once
+  ScheduleAnalysis analysis;
+  REQUIRE(AnalyzeSchedule(compiled, spans, analysis, &error));
+  REQUIRE(analysis.nodes.size() == 2);
+  REQUIRE(analysis.nodes[1].inputs == std::vector<size_t>{0});
+  REQUIRE(analysis.unlimited_cores_ms == Approx(4.0));
+
+  // Requests on two threads interleave; each is delimited by its own request_end
+  std::istringstream interleaved(
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"src\",\"ts_us\":1000,"
+      "\"duration_ms\":1,\"tid\":1}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"src\",\"ts_us\":1500,"
+      "\"duration_ms\":1,\"tid\":2}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"fast+slow\","
+      "\"ts_us\":4000,\"duration_ms\":3,\"tid\":1}\n"
+      "{\"event\":\"node_end\",\"plan_name\":\"diamond\",\"node_id\":\"fast+slow\","
+      "\"ts_us\":3500,\"duration_ms\":2,\"tid\":2}\n"
+      "{\"event\":\"request_end\",\"plan_name\":\"diamond\",\"ts_us\":3600,\"tid\":2}\n"
+      "{\"event\":\"request_end\",\"plan_name\":\"diamond\",\"ts_us\":4100,\"tid\":1}\n");
+  REQUIRE(ReadTraceSpans(interleaved, "diamond", spans, &error));
+  REQUIRE(spans.size() == 2);
+  REQUIRE(spans[0].end_ms == Approx(1.0));
+  REQUIRE(spans[1].end_ms == Approx(4.0));
+  REQUIRE(AnalyzeSchedule(compiled, spans, analysis, &error));
+
+  std::istringstream empty("not a trace\n");
+  REQUIRE_FALSE(ReadTraceSpans(empty, "diamond", spans, &error));
+  REQUIRE_THAT(error, ContainsSubstring("no node_end events"));
+
+  // Executor stats carry start offsets
+  ExecStats stats;
+  ExecContext ctx;
+  ctx.stats = &stats;
+  Executor executor(registry);
+  executor.Execute(compiled, ctx, &error);
+  REQUIRE(AnalyzeSchedule(compiled, SpansOf(stats), analysis, &error));
+  REQUIRE(analysis.nodes.size() == stats.nodes.size());
+  REQUIRE(analysis.nodes.front().start_ms == Approx(0.0).margin(1.0));
+  REQUIRE(analysis.unlimited_cores_ms <= analysis.total_node_ms + 1e-9);
+  for (size_t i = 1; i < stats.nodes.size(); ++i) {
+    REQUIRE(stats.nodes[i].start_ms >= stats.nodes[i - 1].start_ms);
+  }
+}
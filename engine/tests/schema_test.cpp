@@ -0,0 +1,248 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "expr/expr.h"
+#include "keys.h"
+#include "keys/registry.h"
+#include "object/row_block.h"
+#include "object/typed_column.h"
+#include "plan/artifact.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+#include "plan/schema.h"
+
+#include "plan_test_util.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// candidate_id (I64) + freshness (F32) + score.ml (never written) + penalty;
+// features also writes score.adjusted, which nothing reads
+const char* kFormulaPlan = R"({
+  "name": "schema",
+  "nodes": [
+    {"id": "src", "op": "core:sourcer", "params": {"k": 5}},
+    {"id": "feat", "op": "core:features", "inputs": ["src"], "params": {"keys": [2001, 3003]}},
+    {"id": "score", "op": "core:score_formula", "inputs": ["feat"], "params": {
+      "expr": {"op": "add", "args": [
+        {"op": "signal", "key_id": 1001},
+        {"op": "signal", "key_id": 2001},
+        {"op": "signal", "key_id": 3002},
+        {"op": "penalty", "name": "constraints"}
+      ]},
+      "output_key_id": 3999
+    }}
+  ],
+  "output_keys": [1001, 3999]
+})";
+
+}  // namespace
+
+TEST_CASE("Input schemas follow writes and pruning", "[schema][compiler]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(kFormulaPlan);
+
+  PlanCompiler compiler(registry);
+  compiler.DisableFusion();
+  CompiledPlan compiled;
+  std::string error;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+
+  const BatchSchema& src = compiled.input_schemas[compiled.graph.IndexOf("src")];
+  REQUIRE(src.known);
+  REQUIRE(src.columns.empty());
+
+  // Dead columns are pruned before score_formula sees them
+  const BatchSchema& score = compiled.input_schemas[compiled.graph.IndexOf("score")];
+  REQUIRE(score.known);
+  REQUIRE(score.TypeOf(keys::id::CAND_CANDIDATE_ID) == ColumnType::I64);
+  REQUIRE(score.TypeOf(keys::id::FEAT_FRESHNESS) == ColumnType::F32);
+  REQUIRE_FALSE(score.TypeOf(keys::id::SCORE_BASE));
+  REQUIRE_FALSE(score.TypeOf(keys::id::SCORE_ADJUSTED));
+  REQUIRE_FALSE(score.TypeOf(keys::id::SCORE_ML));
+
+  auto loads = CompiledExpr::Compile(ParseExpr(plan.nodes[2].params["expr"]), score, &registry)
+                   .Loads();
+  REQUIRE(loads.size() == 4);
+  REQUIRE(loads[0].second == CompiledExpr::Load::kI64);
+  REQUIRE(loads[1].second == CompiledExpr::Load::kF32);
+  REQUIRE(loads[2].second == CompiledExpr::Load::kAbsent);
+  REQUIRE(loads[3] == std::pair{keys::id::PENALTY_CONSTRAINTS, CompiledExpr::Load::kAbsent});
+
+  // The compiler binds the formula once; other nodes get none
+  const auto& score_expr = compiled.compiled_exprs[compiled.graph.IndexOf("score")];
+  REQUIRE(score_expr);
+  REQUIRE(score_expr->Loads() == loads);
+  REQUIRE_FALSE(compiled.compiled_exprs[compiled.graph.IndexOf("feat")]);
+
+  // Artifacts store schemas and compiled formulas rather than rebuilding them on load
+  std::vector<uint8_t> artifact = SerializePlanArtifact(compiled, registry);
+  CompiledPlan loaded;
+  REQUIRE(DeserializePlanArtifact(artifact.data(), artifact.size(), registry, loaded, &error));
+  REQUIRE(loaded.input_schemas == compiled.input_schemas);
+  const auto& loaded_expr = loaded.compiled_exprs[loaded.graph.IndexOf("score")];
+  REQUIRE(loaded_expr);
+  REQUIRE(loaded_expr->Loads() == loads);
+  REQUIRE_FALSE(loaded.compiled_exprs[loaded.graph.IndexOf("feat")]);
+
+  // Specialized kernels produce candidate_id + freshness
+  Executor executor(registry);
+  CandidateBatch out = executor.Execute(compiled, &error);
+  REQUIRE(out.RowCount() == 5);
+  auto* ids = out.GetI64Column(keys::id::CAND_CANDIDATE_ID);
+  auto* final_score = out.GetF32Column(keys::id::SCORE_FINAL);
+  REQUIRE(ids);
+  REQUIRE(final_score);
+  for (size_t i = 0; i < out.RowCount(); ++i) {
+    int64_t id = ids->Get(i);
+    float freshness = static_cast<float>(id % 100) / 100.0f;
+    REQUIRE(final_score->Get(i) == Catch::Approx(static_cast<float>(id) + freshness));
+    REQUIRE_FALSE(final_score->IsNull(i));
+  }
+}
+
+TEST_CASE("Fused chains prune only at the tail", "[schema][fusion]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(kFormulaPlan);
+
+  PlanCompiler compiler(registry);
+  CompiledPlan compiled;
+  std::string error;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+  REQUIRE(compiled.fused_chains.size() == 1);
+
+  // Inside the features -> score_formula chain, score.adjusted is still present
+  const BatchSchema& score = compiled.input_schemas[compiled.graph.IndexOf("score")];
+  REQUIRE(score.TypeOf(keys::id::SCORE_ADJUSTED) == ColumnType::F32);
+  REQUIRE_FALSE(score.TypeOf(keys::id::SCORE_BASE));  // Pruned after the sourcer
+
+  // Chain members evaluate their own precompiled formula; results match the
+  // unfused plan's
+  CompiledPlan unfused = CompileOrFail(registry, plan, kNoFusion);
+  Executor executor(registry);
+  CandidateBatch fused_out = executor.Execute(compiled, &error);
+  CandidateBatch unfused_out = executor.Execute(unfused, &error);
+  REQUIRE(fused_out.RowCount() == 5);
+  REQUIRE(unfused_out.RowCount() == 5);
+  auto* fused_score = fused_out.GetF32Column(keys::id::SCORE_FINAL);
+  auto* unfused_score = unfused_out.GetF32Column(keys::id::SCORE_FINAL);
+  REQUIRE(fused_score);
+  REQUIRE(unfused_score);
+  for (size_t i = 0; i < fused_out.RowCount(); ++i) {
+    REQUIRE(fused_score->Get(i) == unfused_score->Get(i));
+  }
+}
+
+TEST_CASE("Unknown writes make downstream schemas unknown", "[schema]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan = ParseOrFail(R"({
+    "name": "njs_schema",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 10}},
+      {"id": "js", "op": "njs", "inputs": ["src"], "params": {"module": "missing.njs"}},
+      {"id": "score", "op": "core:score_formula", "inputs": ["js"],
+       "params": {"expr": {"op": "signal", "key_id": 3001}}}
+    ]
+  })");
+  PlanGraph graph = BuildPlanGraph(plan);
+  std::vector<ColumnLiveness> keep_all(graph.node_count);
+
+  auto schemas = InferInputSchemas(plan, graph, {0, 1, 2}, keep_all, {}, {}, registry);
+  REQUIRE(schemas[1].known);
+  REQUIRE(schemas[1].TypeOf(keys::id::SCORE_BASE) == ColumnType::F32);
+  REQUIRE_FALSE(schemas[2].known);
+
+  auto loads = CompiledExpr::Compile(SignalExpr{keys::id::SCORE_BASE}, schemas[2]).Loads();
+  REQUIRE(loads.front().second == CompiledExpr::Load::kProbe);
+}
+
+TEST_CASE("Compiled expressions match row-wise evaluation", "[schema][expr]") {
+  auto ids = std::make_shared<I64Column>(3);
+  ids->Set(0, 7);
+  ids->Set(2, 42);  // Row 1 stays null
+  auto base = std::make_shared<F32Column>(3);
+  base->Set(0, 0.5f);
+  base->Set(1, -2.0f);
+  base->Set(2, 3.0f);
+  ColumnBatch batch(3);
+  batch.SetColumn(keys::id::CAND_CANDIDATE_ID, ids);
+  batch.SetColumn(keys::id::SCORE_BASE, base);
+
+  ExprNode expr = ParseExpr(json::parse(R"({"op": "clamp",
+    "x": {"op": "mul", "args": [
+      {"op": "signal", "key_id": 1001},
+      {"op": "max", "args": [{"op": "signal", "key_id": 3001}, {"op": "const", "value": 0.25}]}
+    ]},
+    "lo": {"op": "min", "args": []},
+    "hi": {"op": "add", "args": [{"op": "const", "value": 10}, {"op": "signal", "key_id": 3002}]}
+  })"));
+
+  BatchSchema exact;
+  exact.known = true;
+  exact.Set(keys::id::CAND_CANDIDATE_ID, ColumnType::I64);
+  exact.Set(keys::id::SCORE_BASE, ColumnType::F32);
+
+  // Wrong about candidate_id's type: that load falls back to probing
+  BatchSchema stale = exact;
+  stale.Set(keys::id::CAND_CANDIDATE_ID, ColumnType::F32);
+
+  // Missing score.base, which the batch has: the absent load probes it
+  BatchSchema missing;
+  missing.known = true;
+  missing.Set(keys::id::CAND_CANDIDATE_ID, ColumnType::I64);
+
+  RowBlock block(batch);
+  block.Reset(0, batch.RowCount());
+  for (const BatchSchema& schema : {exact, stale, missing, BatchSchema{}}) {
+    CompiledExpr compiled = CompiledExpr::Compile(expr, schema);
+    std::vector<float> out(batch.RowCount());
+    compiled.Eval(batch, out.data());
+    std::vector<float> block_out(batch.RowCount());
+    compiled.EvalBlock(block, block_out.data());
+    for (size_t i = 0; i < batch.RowCount(); ++i) {
+      REQUIRE(out[i] == EvalExpr(expr, batch, i));
+      REQUIRE(block_out[i] == out[i]);
+    }
+  }
+}
+
+TEST_CASE("Compiled expressions rebuild only from well-formed programs", "[schema][expr]") {
+  ExprNode expr = ParseExpr(json::parse(R"({"op": "clamp",
+    "x": {"op": "signal", "key_id": 3001},
+    "lo": {"op": "const", "value": 0},
+    "hi": {"op": "const", "value": 1}
+  })"));
+  CompiledExpr compiled = CompiledExpr::Compile(expr, BatchSchema{});
+
+  CompiledExpr rebuilt;
+  REQUIRE(CompiledExpr::FromProgram(compiled.Program(), compiled.Bindings(), rebuilt));
+  REQUIRE(rebuilt.Loads() == compiled.Loads());
+
+  // Clamp with one operand on the stack
+  auto program = compiled.Program();
+  program.erase(program.begin() + 1, program.begin() + 3);
+  REQUIRE_FALSE(CompiledExpr::FromProgram(program, {}, rebuilt));
+
+  // Two results left on the stack
+  program = compiled.Program();
+  program.pop_back();
+  REQUIRE_FALSE(CompiledExpr::FromProgram(program, {}, rebuilt));
+
+  // A binding operand past Bindings()
+  ExprNode bound_expr = ParseExpr(json::parse(R"({"op": "mul", "args": [
+    {"op": "signal", "key_id": 3001},
+    {"op": "const", "value": {"$bind": "w"}}
+  ]})"));
+  CompiledExpr bound = CompiledExpr::Compile(bound_expr, BatchSchema{});
+  REQUIRE(bound.Bindings() == std::vector<std::string>{"w"});
+  REQUIRE(CompiledExpr::FromProgram(bound.Program(), bound.Bindings(), rebuilt));
+  REQUIRE_FALSE(CompiledExpr::FromProgram(bound.Program(), {}, rebuilt));
+}
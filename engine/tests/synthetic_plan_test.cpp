@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "keys/registry.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+#include "plan/synthetic.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+using Catch::Matchers::ContainsSubstring;
+
+TEST_CASE("Synthetic plans have the requested shape and compile", "[synthetic][compiler]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+
+  struct Shape {
+    size_t nodes;
+    size_t depth;
+  };
+  for (Shape shape : std::vector<Shape>{{2000, 120}, {1000, 32}, {250, 8}, {30, 30}}) {
+    SyntheticPlanOptions options;
+    options.nodes = shape.nodes;
+    options.depth = shape.depth;
+    options.param_bytes = 256;
+    json plan_json;
+    std::string error;
+    REQUIRE(GenerateSyntheticPlan(options, plan_json, &error));
+
+    Plan plan;
+    REQUIRE(ParsePlan(plan_json, plan, &error));
+    PlanCompiler compiler(registry);  // Default budget: 2000 nodes, depth 120, peaks 16
+    CompiledPlan compiled;
+    REQUIRE(compiler.Compile(plan, compiled, &error));
+    INFO("nodes " << shape.nodes << " depth " << shape.depth);
+    REQUIRE(compiled.complexity.node_count == static_cast<int64_t>(shape.nodes));
+    REQUIRE(compiled.complexity.max_depth == static_cast<int64_t>(shape.depth));
+    REQUIRE(compiled.complexity.fanin_peak <= static_cast<int64_t>(options.fan_in));
+    REQUIRE(compiled.pruned_nodes.empty());
+    REQUIRE(compiled.merged_nodes.empty());
+    REQUIRE(plan_json["nodes"][0]["params"].dump().size() >= options.param_bytes);
+
+    // Every pass is timed, in order
+    REQUIRE(compiled.phases.size() == 10);
+    REQUIRE(compiled.phases.front().name == "validate");
+    REQUIRE(compiled.phases.back().name == "finalize");
+    for (const auto& phase : compiled.phases) {
+      REQUIRE(phase.ms >= 0.0);
+    }
+  }
+
+  // Deterministic per seed
+  SyntheticPlanOptions options;
+  json a, b, c;
+  REQUIRE(GenerateSyntheticPlan(options, a));
+  REQUIRE(GenerateSyntheticPlan(options, b));
+  options.seed = 2;
+  REQUIRE(GenerateSyntheticPlan(options, c));
+  REQUIRE(a == b);
+  REQUIRE(a != c);
+
+  std::string error;
+  options.fan_in = 1;
+  REQUIRE_FALSE(GenerateSyntheticPlan(options, a, &error));
+  REQUIRE_THAT(error, ContainsSubstring("fan_in"));
+  options.fan_in = 4;
+  options.nodes = 5;
+  options.depth = 10;
+  REQUIRE_FALSE(GenerateSyntheticPlan(options, a, &error));
+  REQUIRE_THAT(error, ContainsSubstring("nodes >= depth"));
+}
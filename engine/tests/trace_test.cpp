@@ -0,0 +1,403 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "executor/executor.h"
+#include "keys/registry.h"
+#include "logging/trace.h"
+#include "object/column_batch.h"
+#include "object/typed_column.h"
+#include "plan/compiler.h"
+#include "plan/plan.h"
+
+using namespace ranking_dsl;
+using json = nlohmann::json;
+
+namespace {
+
+// Events written for plan_name (plus trace_dropped lines)
+std::vector<json> ReadEvents(const std::string& output, const std::string& plan_name) {
+  std::vector<json> events;
+  std::istringstream lines(output);
+  std::string line;
+  while (std::getline(lines, line)) {
+    json event = json::parse(line);
+    if (event.value("plan_name", plan_name) == plan_name) {
+      events.push_back(std::move(event));
+    }
+  }
+  return events;
+}
+
+// Routes trace output to a string for the duration of a test
+class CapturedTrace {
+ public:
+  explicit CapturedTrace(TraceOptions options) {
+    Tracer::Flush();  // Earlier events go to the previous stream
+    was_enabled_ = Tracer::IsEnabled();
+    Tracer::SetEnabled(true);
+    options.out = &out_;
+    Tracer::Configure(options);
+  }
+
+  ~CapturedTrace() {
+    Tracer::Flush();
+    Tracer::Configure(TraceOptions{});
+    Tracer::SetEnabled(was_enabled_);
+  }
+
+  std::string Output() {
+    Tracer::Flush();
+    return out_.str();
+  }
+
+  // Output after restoring the default settings (closes a Chrome trace array)
+  std::string Close() {
+    Tracer::Configure(TraceOptions{});
+    return out_.str();
+  }
+
+ private:
+  std::ostringstream out_;
+  bool was_enabled_ = true;
+};
+
+}  // namespace
+
+TEST_CASE("Trace events are written as JSON lines on flush", "[trace]") {
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);  // Flush() only
+  CapturedTrace trace(options);
+
+  TraceContext ctx;
+  ctx.trace_prefix = "rank_vm";
+  ctx.njs_file = "njs/rank_vm.njs";
+  Tracer::LogNodeStart("trace_plan", "vm", "njs", "score", &ctx);
+  Tracer::LogNodeEnd("trace_plan", "vm", "njs", 1.5, 100, 10, "", "score", &ctx);
+  Tracer::LogNodeEnd("trace_plan", "top", "core:topk", 0.25, 10, 5, "boom");
+
+  auto events = ReadEvents(trace.Output(), "trace_plan");
+  REQUIRE(events.size() == 3);
+
+  REQUIRE(events[0]["event"] == "node_start");
+  REQUIRE(events[0]["span_name"] == "njs(score)");
+  REQUIRE(events[0]["trace_prefix"] == "rank_vm");
+  REQUIRE(events[0]["njs_file"] == "njs/rank_vm.njs");
+  REQUIRE_FALSE(events[0].contains("duration_ms"));
+
+  REQUIRE(events[1]["event"] == "node_end");
+  REQUIRE(events[1]["duration_ms"] == 1.5);
+  REQUIRE(events[1]["rows_in"] == 100);
+  REQUIRE(events[1]["rows_out"] == 10);
+  REQUIRE(events[1]["ts_us"] >= events[0]["ts_us"]);
+  REQUIRE(events[1]["tid"] == events[0]["tid"]);
+
+  REQUIRE(events[2]["span_name"] == "core:topk");
+  REQUIRE(events[2]["error"] == "boom");
+  REQUIRE_FALSE(events[2].contains("trace_key"));
+  REQUIRE_FALSE(events[2].contains("njs_file"));
+}
+
+TEST_CASE("Full trace rings drop and count events", "[trace]") {
+  TraceOptions options;
+  options.ring_capacity = 4;
+  options.flush_interval = std::chrono::milliseconds(0);
+  CapturedTrace trace(options);
+  uint64_t dropped_before = Tracer::DroppedEvents();
+
+  // A new thread gets a ring with the small capacity
+  std::thread worker([] {
+    for (int i = 0; i < 10; ++i) {
+      Tracer::LogNodeEnd("drop_plan", "n" + std::to_string(i), "core:model", 0.1, 1, 1);
+    }
+  });
+  worker.join();
+  REQUIRE(Tracer::DroppedEvents() - dropped_before == 6);
+
+  auto events = ReadEvents(trace.Output(), "drop_plan");
+  REQUIRE(events.size() == 5);
+  REQUIRE(events[0]["node_id"] == "n0");
+  REQUIRE(events[3]["node_id"] == "n3");
+  REQUIRE(events[4]["event"] == "trace_dropped");
+  REQUIRE(events[4]["count"] == 6);
+}
+
+TEST_CASE("Full sample dump queues drop and count dumps", "[trace]") {
+  TraceOptions options;
+  options.dump_queue_capacity = 2;
+  options.flush_interval = std::chrono::milliseconds(0);
+  CapturedTrace trace(options);
+  uint64_t dropped_before = Tracer::DroppedEvents();
+
+  auto scores = std::make_shared<F32Column>(4);
+  ColumnBatch batch(4);
+  batch.SetColumn(3001, scores);
+  for (int i = 0; i < 5; ++i) {
+    Tracer::LogSampleDump("dump_queue_plan", "n" + std::to_string(i), batch, {3001});
+  }
+  REQUIRE(Tracer::DroppedEvents() - dropped_before == 3);
+  REQUIRE(scores.use_count() == 4);  // Queued dumps share the column; dropped ones let go
+
+  auto events = ReadEvents(trace.Output(), "dump_queue_plan");
+  REQUIRE(events.size() == 3);
+  REQUIRE(events[0]["event"] == "sample_dump");
+  REQUIRE(events[1]["node_id"] == "n1");
+  REQUIRE(events[2]["event"] == "trace_dropped");
+  REQUIRE(events[2]["count"] == 3);
+  REQUIRE(scores.use_count() == 2);  // Written dumps release the column
+}
+
+TEST_CASE("Disabled tracing records nothing", "[trace]") {
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);
+  CapturedTrace trace(options);
+
+  Tracer::SetEnabled(false);
+  Tracer::LogNodeStart("quiet_plan", "src", "core:sourcer");
+  Tracer::SetEnabled(true);
+  REQUIRE(ReadEvents(trace.Output(), "quiet_plan").empty());
+}
+
+TEST_CASE("Sampled requests dump keys after the named nodes", "[trace][sampling]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "dump_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 5}},
+      {"id": "model", "op": "core:model", "inputs": ["src"]}
+    ],
+    "logging": {"sample_rate": 1.0, "dump_keys": [1001, 3001, 3002], "dump_nodes": ["src"]}
+  })"), plan, &error));
+
+  PlanCompiler compiler(registry);
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);
+  options.sample_dump_rows = 3;
+  CapturedTrace trace(options);
+
+  Executor executor(registry);
+  executor.Execute(compiled, &error);
+  ExecContext unsampled;
+  unsampled.sample = false;
+  executor.Execute(compiled, unsampled, &error);
+
+  std::vector<json> dumps;
+  for (auto& event : ReadEvents(trace.Output(), "dump_plan")) {
+    if (event["event"] == "sample_dump") {
+      dumps.push_back(std::move(event));
+    }
+  }
+  REQUIRE(dumps.size() == 1);
+  REQUIRE(dumps[0]["node_id"] == "src");
+  REQUIRE(dumps[0]["rows"] == 5);
+  REQUIRE(dumps[0]["dump_keys"] == json::array({1001, 3001}));  // score.ml not yet written
+  REQUIRE(dumps[0]["topN"].size() == 3);
+  REQUIRE(dumps[0]["topN"][0]["1001"] == 1);
+  REQUIRE(dumps[0]["topN"][0]["3001"] == 1.0);
+
+  SECTION("Sample rates are probabilities") {
+    REQUIRE_FALSE(Tracer::ShouldSample(0.0));
+    REQUIRE(Tracer::ShouldSample(1.0));
+    int sampled = 0;
+    for (int i = 0; i < 10000; ++i) {
+      sampled += Tracer::ShouldSample(0.25) ? 1 : 0;
+    }
+    REQUIRE(sampled > 2000);
+    REQUIRE(sampled < 3000);
+  }
+
+  SECTION("Dump settings are validated") {
+    Plan bad = plan;
+    bad.logging.dump_nodes = {"missing"};
+    REQUIRE_FALSE(compiler.Compile(bad, compiled, &error));
+    REQUIRE(error == "logging.dump_nodes references unknown node: missing");
+
+    bad = plan;
+    bad.logging.sample_rate = 1.5f;
+    REQUIRE_FALSE(compiler.Compile(bad, compiled, &error));
+  }
+}
+
+TEST_CASE("Chrome trace output nests spans on per-thread tracks", "[trace][chrome]") {
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);
+  options.format = TraceFormat::kChromeTrace;
+  CapturedTrace trace(options);
+
+  TraceContext ctx;
+  ctx.trace_prefix = "rank_vm";
+  ctx.njs_file = "njs/rank_vm.njs";
+  Tracer::LogNodeStart("chrome_plan", "vm", "njs", "score", &ctx);
+  Tracer::LogNodeStart("chrome_plan", "vm", "core:model",
+                       Tracer::PrefixedTraceKey(ctx.trace_prefix, "inner"), &ctx);
+  Tracer::LogNodeEnd("chrome_plan", "vm", "core:model", 0.5, 10, 10, "",
+                     Tracer::PrefixedTraceKey(ctx.trace_prefix, "inner"), &ctx);
+  Tracer::LogNodeEnd("chrome_plan", "vm", "njs", 1.5, 100, 10, "", "score", &ctx);
+  std::thread worker([] {
+    Tracer::LogNodeStart("chrome_plan", "top", "core:topk");
+    Tracer::LogNodeEnd("chrome_plan", "top", "core:topk", 0.25, 10, 5);
+  });
+  worker.join();
+
+  json events = json::parse(trace.Close());
+  REQUIRE(events.is_array());
+
+  std::vector<json> spans;
+  std::vector<json> rows;
+  std::vector<json> tracks;
+  for (const auto& event : events) {
+    if (event["ph"] == "M") {
+      tracks.push_back(event);
+    } else if (event["ph"] == "C") {
+      rows.push_back(event);
+    } else if (event["args"].value("plan_name", "") == "chrome_plan") {
+      spans.push_back(event);
+    }
+  }
+  REQUIRE(spans.size() == 6);
+  REQUIRE(tracks.size() == 2);
+
+  // B/E pairs on one track nest: njs(score) encloses the prefixed native call
+  REQUIRE(spans[0]["ph"] == "B");
+  REQUIRE(spans[0]["name"] == "njs(score)");
+  REQUIRE(spans[0]["args"]["trace_prefix"] == "rank_vm");
+  REQUIRE(spans[1]["name"] == "core:model(rank_vm::inner)");
+  REQUIRE(spans[2]["ph"] == "E");
+  REQUIRE(spans[2]["name"] == "core:model(rank_vm::inner)");
+  REQUIRE(spans[3]["ph"] == "E");
+  REQUIRE(spans[3]["args"]["rows_in"] == 100);
+  REQUIRE(spans[3]["ts"] >= spans[0]["ts"]);
+  REQUIRE(spans[0]["tid"] == spans[3]["tid"]);
+  REQUIRE(spans[4]["tid"] != spans[0]["tid"]);
+  REQUIRE(spans[4]["cat"] == "core:topk");
+
+  REQUIRE(rows.size() == 3);
+  REQUIRE(rows[2]["name"] == "rows");
+  REQUIRE(rows[2]["args"]["rows_out"] == 5);
+
+  SECTION("Unsampled requests log no spans") {
+    KeyRegistry registry;
+    registry.LoadFromCompiled();
+    Plan plan;
+    std::string error;
+    REQUIRE(ParsePlan(json::parse(R"({
+      "name": "unsampled_plan",
+      "nodes": [{"id": "src", "op": "core:sourcer", "params": {"k": 5}}]
+    })"), plan, &error));
+    CompiledPlan compiled;
+    REQUIRE(PlanCompiler(registry).Compile(plan, compiled, &error));
+
+    TraceOptions never = options;
+    never.format = TraceFormat::kJsonLines;
+    never.request_sample_rate = 0.0;
+    CapturedTrace quiet(never);
+    Executor executor(registry);
+    executor.Execute(compiled, &error);
+    REQUIRE(ReadEvents(quiet.Output(), "unsampled_plan").empty());
+
+    ExecContext forced;
+    forced.trace = true;
+    executor.Execute(compiled, forced, &error);
+    REQUIRE(ReadEvents(quiet.Output(), "unsampled_plan").size() == 3);  // + request_end
+  }
+}
+
+TEST_CASE("Hardware counter deltas attach to node_end when available", "[trace][perf]") {
+  PerfCounts start;
+  start.Set(PerfCounter::kCycles, 100);
+  start.Set(PerfCounter::kInstructions, 50);
+  PerfCounts end = start;
+  end.Set(PerfCounter::kCycles, 350);
+  end.Set(PerfCounter::kLlcLoads, 7);  // Absent at start: left out
+  PerfCounts delta = PerfCounts::Delta(start, end);
+  REQUIRE(delta.Get(PerfCounter::kCycles) == 250);
+  REQUIRE(delta.Get(PerfCounter::kInstructions) == 0);
+  REQUIRE_FALSE(delta.Has(PerfCounter::kLlcLoads));
+
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "perf_plan",
+    "nodes": [{"id": "src", "op": "core:sourcer", "params": {"k": 1000}}]
+  })"), plan, &error));
+  CompiledPlan compiled;
+  REQUIRE(PlanCompiler(registry).Compile(plan, compiled, &error));
+
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);
+  CapturedTrace trace(options);
+  ExecContext ctx;
+  ctx.perf_counters = true;
+  Executor executor(registry);
+  REQUIRE(executor.Execute(compiled, ctx, &error).RowCount() == 1000);
+
+  auto events = ReadEvents(trace.Output(), "perf_plan");
+  REQUIRE(events.size() == 3);
+  std::string perf_error;
+  if (PerfCounterGroup::ForCurrentThread(&perf_error)) {
+    REQUIRE(events[1]["perf"].is_object());
+    if (events[1]["perf"].contains("instructions")) {
+      REQUIRE(events[1]["perf"]["instructions"] > 0);
+    }
+  } else {
+    // Unavailable (non-Linux, perf_event_paranoid, seccomp): plain spans
+    WARN("hardware counters unavailable: " << perf_error);
+    REQUIRE_FALSE(perf_error.empty());
+    REQUIRE_FALSE(events[1].contains("perf"));
+  }
+}
+
+TEST_CASE("Traced requests attach memory to node_end and close with request_end",
+          "[trace][memory_stats]") {
+  KeyRegistry registry;
+  registry.LoadFromCompiled();
+  Plan plan;
+  std::string error;
+  REQUIRE(ParsePlan(json::parse(R"({
+    "name": "memory_trace_plan",
+    "nodes": [
+      {"id": "src", "op": "core:sourcer", "params": {"k": 100}},
+      {"id": "top", "op": "core:topk", "inputs": ["src"], "params": {"k": 5, "key": 3001}}
+    ]
+  })"), plan, &error));
+  PlanCompiler compiler(registry);
+  compiler.DisableLimitPushdown();
+  CompiledPlan compiled;
+  REQUIRE(compiler.Compile(plan, compiled, &error));
+
+  TraceOptions options;
+  options.flush_interval = std::chrono::milliseconds(0);
+  CapturedTrace trace(options);
+  Executor executor(registry);
+  REQUIRE(executor.Execute(compiled, &error).RowCount() == 5);
+
+  auto events = ReadEvents(trace.Output(), "memory_trace_plan");
+  REQUIRE(events.size() == 5);
+  const json& src_end = events[1];
+  REQUIRE(src_end["node_id"] == "src");
+  REQUIRE(src_end["memory"]["allocated_bytes"] > 0);
+  REQUIRE(src_end["memory"]["shared_bytes"] == 0);
+  REQUIRE(src_end["memory"]["live_bytes"] == src_end["memory"]["allocated_bytes"]);
+  REQUIRE_FALSE(src_end["memory"].contains("njs_heap_bytes"));
+
+  const json& request_end = events[4];
+  REQUIRE(request_end["event"] == "request_end");
+  REQUIRE(request_end["rows_out"] == 5);
+  REQUIRE(request_end["allocated_bytes"] ==
+          src_end["memory"]["allocated_bytes"].get<int64_t>() +
+              events[3]["memory"]["allocated_bytes"].get<int64_t>());
+  REQUIRE(request_end["peak_live_bytes"] >= src_end["memory"]["allocated_bytes"]);
+}
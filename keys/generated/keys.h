@@ -31,6 +31,7 @@ struct KeyDef {
   int32_t id;
   std::string_view name;
   KeyType type;
+  uint32_t dim;  // f32vec dimension (0 = not declared)
 };
 
 /**
@@ -65,17 +66,17 @@ namespace id {
  * All key definitions.
  */
 inline constexpr std::array<KeyDef, 11> kAllKeys = {{
-  {1001, "cand.candidate_id", KeyType::I64},
-  {2001, "feat.freshness", KeyType::F32},
-  {2002, "feat.embedding", KeyType::F32Vec},
-  {2003, "feat.query_embedding", KeyType::F32Vec},
-  {3001, "score.base", KeyType::F32},
-  {3002, "score.ml", KeyType::F32},
-  {3003, "score.adjusted", KeyType::F32},
-  {3999, "score.final", KeyType::F32},
-  {4001, "penalty.constraints", KeyType::F32},
-  {4002, "penalty.diversity", KeyType::F32},
-  {9001, "debug.node_timings", KeyType::String},
+  {1001, "cand.candidate_id", KeyType::I64, 0},
+  {2001, "feat.freshness", KeyType::F32, 0},
+  {2002, "feat.embedding", KeyType::F32Vec, 128},
+  {2003, "feat.query_embedding", KeyType::F32Vec, 128},
+  {3001, "score.base", KeyType::F32, 0},
+  {3002, "score.ml", KeyType::F32, 0},
+  {3003, "score.adjusted", KeyType::F32, 0},
+  {3999, "score.final", KeyType::F32, 0},
+  {4001, "penalty.constraints", KeyType::F32, 0},
+  {4002, "penalty.diversity", KeyType::F32, 0},
+  {9001, "debug.node_timings", KeyType::String, 0},
 }};
 
 /**
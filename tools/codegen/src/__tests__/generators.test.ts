@@ -22,6 +22,7 @@ const testRegistry: Registry = {
       scope: 'feature',
       owner: 'team-b',
       doc: 'Embedding vector',
+      dim: 128,
     },
     {
       id: 3001,
@@ -133,6 +134,10 @@ describe('generateCpp', () => {
     expect(output).toContain('KeyType::F32Vec');
     expect(output).toContain('KeyType::I64');
 
+    // Check vector dims (0 when not declared)
+    expect(output).toContain('{2001, "feat.embedding", KeyType::F32Vec, 128}');
+    expect(output).toContain('{1001, "score.base", KeyType::F32, 0}');
+
     // Check GetKeyById function
     expect(output).toContain('GetKeyById');
   });
@@ -164,6 +169,7 @@ describe('generateJson', () => {
       owner: 'team-a',
       doc: 'Base retrieval score',
     });
+    expect(obj.keys[1]!.dim).toBe(128);
   });
 
   it('generates pretty-printed JSON', () => {
@@ -232,6 +232,26 @@ describe('validateSemantics', () => {
     expect(errors[0]!.message).toContain('Duplicate key name');
   });
 
+  it('rejects dim on non-vector keys', () => {
+    const registry = {
+      version: 1,
+      keys: [
+        {
+          id: 1001,
+          name: 'score.base',
+          type: 'f32' as const,
+          scope: 'score' as const,
+          owner: 'team-a',
+          doc: 'A',
+          dim: 4,
+        },
+      ],
+    };
+    const errors = validateSemantics(registry);
+    expect(errors.length).toBe(1);
+    expect(errors[0]!.message).toContain('dim is for f32vec keys');
+  });
+
   it('returns empty array for valid registry', () => {
     const registry = {
       version: 1,
@@ -78,6 +78,7 @@ export function generateCpp(registry: Registry): string {
   lines.push('  int32_t id;');
   lines.push('  std::string_view name;');
   lines.push('  KeyType type;');
+  lines.push('  uint32_t dim;  // f32vec dimension (0 = not declared)');
   lines.push('};');
   lines.push('');
 
@@ -123,7 +124,7 @@ export function generateCpp(registry: Registry): string {
   );
   for (const key of registry.keys) {
     const typeEnum = toKeyTypeEnum(key.type);
-    lines.push(`  {${key.id}, "${key.name}", ${typeEnum}},`);
+    lines.push(`  {${key.id}, "${key.name}", ${typeEnum}, ${key.dim ?? 0}},`);
   }
   lines.push('}};');
   lines.push('');
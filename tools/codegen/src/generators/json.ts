@@ -16,6 +16,7 @@ export interface KeyJson {
   scope: string;
   owner: string;
   doc: string;
+  dim?: number;
 }
 
 /**
@@ -39,6 +40,7 @@ export function generateJsonObject(registry: Registry): RegistryJson {
       scope: key.scope,
       owner: key.owner,
       doc: key.doc,
+      ...(key.dim !== undefined ? { dim: key.dim } : {}),
     })),
   };
 }
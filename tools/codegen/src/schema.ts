@@ -60,6 +60,14 @@ export const KeyDefSchema = z.object({
 
   /** Documentation string. */
   doc: z.string().min(1).describe('Documentation string'),
+
+  /** Vector dimension (f32vec keys only). */
+  dim: z
+    .number()
+    .int()
+    .positive()
+    .optional()
+    .describe('Vector dimension (f32vec keys only)'),
 });
 
 /**
@@ -154,5 +162,16 @@ export function validateSemantics(registry: Registry): ValidationError[] {
     }
   }
 
+  // dim only applies to vector keys
+  for (let i = 0; i < registry.keys.length; i++) {
+    const key = registry.keys[i]!;
+    if (key.dim !== undefined && key.type !== 'f32vec') {
+      errors.push({
+        path: ['keys', i, 'dim'],
+        message: `Key "${key.name}" has dim but type ${key.type} (dim is for f32vec keys)`,
+      });
+    }
+  }
+
   return errors;
 }
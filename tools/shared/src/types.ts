@@ -123,6 +123,19 @@ export interface PlanLogging {
   sample_rate?: number;
   /** Key IDs to dump. */
   dump_keys?: number[];
+  /** Node IDs to dump after (default: every node). */
+  dump_nodes?: string[];
+}
+
+/**
+ * A request-level value a plan declares. Params reference it as
+ * `{"$bind": "<name>"}`; the engine substitutes it per request.
+ */
+export interface PlanBinding {
+  /** Value type. */
+  type: 'int' | 'float' | 'bool' | 'string';
+  /** Value used when the request supplies none (omit to require one). */
+  default?: number | boolean | string;
 }
 
 /**
@@ -137,6 +150,12 @@ export interface Plan {
   nodes: NodeSpec[];
   /** Logging configuration. */
   logging?: PlanLogging;
+  /** Sink node IDs (default: the last node). Nodes that reach none are pruned. */
+  outputs?: string[];
+  /** Key IDs read from the output batch; enables column pruning. */
+  output_keys?: number[];
+  /** Request-level bindings, by name. */
+  bindings?: Record<string, PlanBinding>;
 }
 
 /**